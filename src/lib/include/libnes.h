@@ -24,8 +24,30 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <stdint.h>
+
 #define NES_NO_DEBUG 0
 
+#define NES_AUDIO_NONE 0
+#define NES_AUDIO_NULL 1
+#define NES_AUDIO_RAW 2
+#define NES_AUDIO_WAV 3
+#define NES_AUDIO_CALLBACK 4
+
+#define NES_HASH_NONE 0
+#define NES_HASH_FRAME 0x1
+#define NES_HASH_RAM 0x2
+
+#define NES_FRAME_HEIGHT 240
+#define NES_FRAME_WIDTH 256
+
+#define NES_PACING_UNCAPPED 0
+#define NES_PACING_REALTIME 1
+
+#define NES_PIPELINE_NONE 0
+#define NES_PIPELINE_BLOCK 1
+#define NES_PIPELINE_DROP 2
+
 typedef enum {
 	NES_ERR_NONE = 0,
 	NES_ERR_FAILURE,
@@ -35,12 +57,45 @@ typedef enum {
 
 #define NES_SUCCESS(_ERR_) ((_ERR_) == NES_ERR_NONE)
 
+typedef void (*nes_audio_cb)(
+	void *user,
+	const int16_t *samples,
+	uint32_t count
+	);
+
+typedef void (*nes_frame_cb)(
+	void *user,
+	uint64_t frame,
+	const uint8_t *pixels
+	);
+
 typedef struct {
 	int major;
 	int minor;
 	void *session;
 } nes_context;
 
+neserr_t nes_audio_enable(
+	nes_context *context,
+	unsigned type,
+	const char *path,
+	nes_audio_cb callback,
+	void *user
+	);
+
+neserr_t nes_hash(
+	nes_context *context,
+	uint64_t *frame,
+	uint64_t *frame_hash,
+	uint64_t *ram_hash
+	);
+
+neserr_t nes_hash_enable(
+	nes_context *context,
+	unsigned flags,
+	const char *path
+	);
+
 neserr_t nes_initialize(
 	nes_context *context
 	);
@@ -49,12 +104,54 @@ int nes_is_valid(
 	nes_context *context
 	);
 
+neserr_t nes_load(
+	nes_context *context,
+	const char *path
+	);
+
+neserr_t nes_pipeline_enable(
+	nes_context *context,
+	unsigned type,
+	unsigned capacity,
+	nes_frame_cb callback,
+	void *user
+	);
+
+neserr_t nes_reset(
+	nes_context *context
+	);
+
 neserr_t nes_run(
 	nes_context *context,
 	const char *input,
 	int debug
 	);
 
+neserr_t nes_run_cycles(
+	nes_context *context,
+	uint64_t cycles,
+	uint64_t *elapsed
+	);
+
+neserr_t nes_run_frames(
+	nes_context *context,
+	const char *input,
+	int debug,
+	unsigned pacing,
+	uint64_t frames,
+	double *rate
+	);
+
+neserr_t nes_step_frame(
+	nes_context *context,
+	uint64_t frames,
+	uint64_t *frame
+	);
+
+neserr_t nes_stop(
+	nes_context *context
+	);
+
 neserr_t nes_uninitialize(
 	nes_context *context
 	);
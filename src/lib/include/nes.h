@@ -28,6 +28,7 @@
 
 #include "nes_defines.h"
 #include "nes_exception.h"
+#include "nes_hash.h"
 #include "nes_cpu_code.h"
 #include "nes_rom_header.h"
 
@@ -39,10 +40,17 @@ using namespace NES;
 #endif // TEST
 
 #include "nes_test.h"
+#include "nes_test_apu.h"
+#include "nes_test_archive.h"
+#include "nes_test_battery.h"
+#include "nes_test_checkpoint.h"
 #include "nes_test_cpu.h"
 #include "nes_test_memory.h"
+#include "nes_test_pool.h"
 #include "nes_test_ppu.h"
+#include "nes_test_rewind.h"
 #include "nes_test_rom.h"
+#include "nes_test_session.h"
 
 using namespace NES::TEST;
 #endif // NDEBUG
@@ -52,14 +60,60 @@ using namespace NES::TEST;
 #endif // COMP
 
 #include "nes_memory.h"
-#include "nes_cpu.h"
-#include "nes_ppu.h"
 #include "nes_rom.h"
+#include "nes_mapper.h"
+#include "nes_ppu.h"
+#include "nes_apu.h"
+#include "nes_cpu.h"
+#include "nes_cpu_lanes.h"
 
 using namespace NES::COMP;
 
+#include "nes_rewind.h"
+#include "nes_archive.h"
+#include "nes_battery.h"
+#include "nes_checkpoint.h"
+
 namespace NES {
 
+	class _nes;
+
+	typedef std::function<void(_nes &)> nes_command;
+
+	typedef enum {
+		NES_RUN_PACING_UNCAPPED = 0,
+		NES_RUN_PACING_REALTIME,
+	} nes_pacing_t;
+
+	typedef enum {
+		NES_SNAPSHOT_APU = 0,
+		NES_SNAPSHOT_CPU,
+		NES_SNAPSHOT_FRAME,
+		NES_SNAPSHOT_MAPPER,
+		NES_SNAPSHOT_OAM,
+		NES_SNAPSHOT_PPU,
+		NES_SNAPSHOT_RAM,
+		NES_SNAPSHOT_RAM_CHARACTER,
+		NES_SNAPSHOT_RAM_PROGRAM,
+		NES_SNAPSHOT_VRAM,
+	} nes_snapshot_t;
+
+	#define NES_SNAPSHOT_MAX NES_SNAPSHOT_VRAM
+
+	typedef struct {
+		uint32_t length;			// snapshot length in bytes
+		uint32_t magic;				// snapshot magic
+		uint32_t mapper;			// rom mapper
+		uint32_t rom;				// rom crc32
+		uint32_t sections;			// section count
+		uint32_t version;			// snapshot version
+	} nes_snapshot_header;
+
+	typedef struct {
+		uint32_t length;			// payload length in bytes
+		uint32_t tag;				// section tag
+	} nes_snapshot_section;
+
 	typedef class _nes {
 
 		public:
@@ -68,6 +122,8 @@ namespace NES {
 
 			static _nes *acquire(void);
 
+			nes_apu_ptr acquire_apu(void);
+
 			nes_cpu_ptr acquire_cpu(void);
 
 			nes_memory_ptr acquire_memory(void);
@@ -76,15 +132,70 @@ namespace NES {
 
 			nes_rom_ptr acquire_rom(void);
 
+			uint64_t archive(
+				__in nes_archive &archive
+				);
+
+			uint64_t checkpoint(void);
+
+			uint64_t checkpoint_retained(void);
+
+			static _nes *create(void);
+
+			uint64_t hash(
+				__out uint64_t &frame,
+				__out uint64_t &ram
+				);
+
 			void initialize(void);
 
 			static bool is_allocated(void);
 
+			bool is_battery_open(void);
+
 			bool is_initialized(void);
 
-			void run(
+			bool is_running(void);
+
+			void load(
+				__in const std::string &path
+				);
+
+			void lock(void);
+
+			void post(
+				__in const nes_command &command
+				);
+
+			void reset(void);
+
+			void restore(
+				__in const uint8_t *buffer,
+				__in size_t length
+				);
+
+			void restore_archive(
+				__in nes_archive &archive,
+				__in uint64_t key
+				);
+
+			void restore_checkpoint(
+				__in uint64_t id
+				);
+
+			uint64_t rewind(
+				__in uint64_t frames
+				);
+
+			double run(
 				__in const std::string &input,
-				__in_opt bool debug = false
+				__in_opt bool debug = false,
+				__in_opt nes_pacing_t pacing = NES_RUN_PACING_REALTIME,
+				__in_opt uint64_t frames = 0
+				);
+
+			uint64_t run_cycles(
+				__in uint64_t cycles
 				);
 
 #ifndef NDEBUG
@@ -96,19 +207,74 @@ namespace NES {
 				);
 #endif // NDEBUG
 
+			void set_audio(
+				__in uint32_t type,
+				__in_opt const std::string &path = std::string(),
+				__in_opt const nes_apu_output &output = nes_apu_output()
+				);
+
+			void set_battery(
+				__in uint32_t interval,
+				__in_opt const std::string &path = std::string()
+				);
+
+			void set_checkpoint(
+				__in size_t chain
+				);
+
+			void set_hash(
+				__in uint32_t flags,
+				__in_opt const std::string &path = std::string()
+				);
+
+			void set_pipeline(
+				__in uint32_t type,
+				__in_opt size_t capacity = NES_PPU_PIPELINE_CAPACITY_DEFAULT,
+				__in_opt const nes_ppu_output &output = nes_ppu_output()
+				);
+
+			void set_rewind(
+				__in size_t capacity,
+				__in_opt uint32_t interval = NES_REWIND_INTERVAL_DEFAULT
+				);
+
+			size_t snapshot(
+				__out uint8_t *buffer,
+				__in size_t length
+				);
+
+			size_t snapshot_length(void);
+
+			uint64_t step_frame(void);
+
+			void stop(void);
+
 			std::string to_string(
 				__in_opt uint16_t address = 0,
 				__in_opt uint16_t offset = 0,
 				__in_opt bool verbose = false
 				);
 
+			bool try_lock(void);
+
 			void uninitialize(void);
 
+			void unload(void);
+
+			void unlock(void);
+
 			static std::string version(void);
 
 		protected:
 
-			_nes(void);
+			_nes(
+				__in nes_memory_ptr memory,
+				__in nes_ppu_ptr ppu,
+				__in nes_apu_ptr apu,
+				__in nes_cpu_ptr cpu,
+				__in nes_rom_ptr rom,
+				__in_opt bool owned = false
+				);
 
 			_nes(
 				__in const _nes &other
@@ -120,10 +286,57 @@ namespace NES {
 
 			static void _delete(void);
 
+			void capture(void);
+
+			void dispatch(void);
+
+			std::chrono::nanoseconds frame_period(void);
+
+			void pace(
+				__inout std::chrono::steady_clock::time_point &deadline,
+				__in std::chrono::nanoseconds period
+				);
+
+			void persist(void);
+
+			void replay(
+				__in uint64_t frame
+				);
+
+			void snapshot_layout(
+				__out size_t (&length)[NES_SNAPSHOT_MAX + 1]
+				);
+
+			void snapshot_section(
+				__out uint8_t *buffer,
+				__inout size_t &offset,
+				__in uint32_t tag,
+				__in const void *data,
+				__in size_t length
+				);
+
+			std::vector<uint8_t> m_archive_snapshot;
+
+			nes_battery m_battery;
+
+			uint32_t m_battery_interval;
+
+			std::string m_battery_path;
+
+			nes_checkpoint m_checkpoint;
+
+			std::vector<uint8_t> m_checkpoint_snapshot;
+
+			std::deque<nes_command> m_command;
+
+			std::mutex m_command_lock;
+
 			bool m_initialized;
 
 			static _nes *m_instance;
 
+			nes_apu_ptr m_instance_apu;
+
 			nes_cpu_ptr m_instance_cpu;
 
 			nes_memory_ptr m_instance_memory;
@@ -132,11 +345,25 @@ namespace NES {
 
 			nes_rom_ptr m_instance_rom;
 
+			nes_mapper_ptr m_mapper;
+
+			bool m_owned;
+
+			nes_rewind m_rewind;
+
+			std::vector<uint8_t> m_rewind_snapshot;
+
+			std::atomic<bool> m_running;
+
 		private:
 
 			std::recursive_mutex m_lock;
 
+			size_t m_lock_depth;
+
 	} nes, *nes_ptr;
 }
 
+#include "nes_pool.h"
+
 #endif // NES_H_
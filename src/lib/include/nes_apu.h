@@ -0,0 +1,701 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_APU_H_
+#define NES_APU_H_
+
+namespace NES {
+
+	namespace COMP {
+
+		typedef enum {
+			NES_APU_SINK_NONE = 0,
+			NES_APU_SINK_NULL,
+			NES_APU_SINK_RAW,
+			NES_APU_SINK_WAV,
+			NES_APU_SINK_CALLBACK,
+		} nes_apu_sink_t;
+
+		#define NES_APU_SINK_MAX NES_APU_SINK_CALLBACK
+
+		typedef enum {
+			NES_APU_SYNC_LAZY = 0,
+			NES_APU_SYNC_LOCKSTEP,
+		} nes_apu_sync_t;
+
+		#define NES_APU_SYNC_MAX NES_APU_SYNC_LOCKSTEP
+
+		typedef struct {
+			uint8_t decay;
+			uint8_t divider;
+			bool start;
+		} nes_apu_envelope;
+
+		typedef struct {
+			uint8_t control;
+			bool enabled;
+			nes_apu_envelope envelope;
+			uint8_t length;
+			uint16_t period;
+			uint8_t sequence;
+			uint8_t sweep;
+			uint8_t sweep_divider;
+			bool sweep_reload;
+			uint16_t timer;
+		} nes_apu_pulse;
+
+		typedef struct {
+			uint8_t control;
+			bool enabled;
+			uint8_t length;
+			uint8_t linear;
+			bool linear_reload;
+			uint16_t period;
+			uint8_t sequence;
+			uint16_t timer;
+		} nes_apu_triangle;
+
+		typedef struct {
+			uint8_t control;
+			bool enabled;
+			nes_apu_envelope envelope;
+			uint8_t length;
+			bool mode;
+			uint16_t period;
+			uint16_t shift;
+			uint16_t timer;
+		} nes_apu_noise;
+
+		typedef struct {
+			uint16_t address;
+			uint8_t bits;
+			uint8_t buffer;
+			bool buffer_empty;
+			uint8_t control;
+			uint16_t current;
+			bool irq;
+			uint16_t length;
+			uint8_t level;
+			uint16_t remaining;
+			uint8_t shift;
+			bool silence;
+			uint16_t timer;
+		} nes_apu_dmc;
+
+		typedef struct {
+			nes_apu_dmc dmc;
+			uint8_t frame_control;
+			uint32_t frame_cycle;
+			bool frame_irq;
+			nes_apu_noise noise;
+			nes_apu_pulse pulse_1;
+			nes_apu_pulse pulse_2;
+			nes_apu_triangle triangle;
+		} nes_apu_state;
+
+		typedef struct {
+			int32_t amplitude;			// last mixed amplitude
+			uint32_t blip_time;			// cycles into the resampler frame
+			uint8_t changed;			// mixer output changed
+			uint64_t cycles;			// elapsed cycles
+			uint64_t master;			// master clock
+			uint32_t stall;				// pending dmc stall cycles
+			nes_apu_state state;			// channel and frame counter state
+		} nes_apu_snapshot;
+
+		typedef class _nes_apu_buffer {
+
+			public:
+
+				_nes_apu_buffer(
+					__in size_t capacity
+					);
+
+				~_nes_apu_buffer(void);
+
+				size_t capacity(void);
+
+				void clear(void);
+
+				size_t overflow(void);
+
+				size_t pop(
+					__out int16_t *samples,
+					__in size_t count
+					);
+
+				bool push(
+					__in int16_t sample
+					);
+
+				size_t size(void);
+
+			protected:
+
+				_nes_apu_buffer(
+					__in const _nes_apu_buffer &other
+					);
+
+				_nes_apu_buffer &operator=(
+					__in const _nes_apu_buffer &other
+					);
+
+				std::vector<int16_t> m_buffer;
+
+				std::atomic<size_t> m_head;
+
+				size_t m_mask;
+
+				std::atomic<size_t> m_overflow;
+
+				std::atomic<size_t> m_tail;
+
+		} nes_apu_buffer, *nes_apu_buffer_ptr;
+
+		typedef class _nes_apu_blip {
+
+			public:
+
+				_nes_apu_blip(void);
+
+				~_nes_apu_blip(void);
+
+				void add_delta(
+					__in uint32_t time,
+					__in int32_t delta
+					);
+
+				size_t available(void);
+
+				void clear(void);
+
+				void end_frame(
+					__in uint32_t time
+					);
+
+				size_t read(
+					__inout nes_apu_buffer &buffer
+					);
+
+				void set_rates(
+					__in uint32_t clock,
+					__in uint32_t sample,
+					__in uint32_t frame
+					);
+
+			protected:
+
+				_nes_apu_blip(
+					__in const _nes_apu_blip &other
+					);
+
+				_nes_apu_blip &operator=(
+					__in const _nes_apu_blip &other
+					);
+
+				void generate(void);
+
+				std::vector<int32_t> m_buffer;
+
+				uint64_t m_factor;
+
+				int32_t m_integrator;
+
+				std::vector<int32_t> m_kernel;
+
+				uint64_t m_offset;
+
+		} nes_apu_blip, *nes_apu_blip_ptr;
+
+		typedef class _nes_apu_sink {
+
+			public:
+
+				virtual ~_nes_apu_sink(void);
+
+				virtual void close(void) = 0;
+
+				virtual void open(
+					__in const std::string &path,
+					__in uint32_t rate
+					) = 0;
+
+				virtual void write(
+					__in const int16_t *samples,
+					__in size_t count
+					) = 0;
+
+			protected:
+
+				_nes_apu_sink(void);
+
+				_nes_apu_sink(
+					__in const _nes_apu_sink &other
+					);
+
+				_nes_apu_sink &operator=(
+					__in const _nes_apu_sink &other
+					);
+
+		} nes_apu_sink, *nes_apu_sink_ptr;
+
+		typedef std::function<void(const int16_t *, size_t)> nes_apu_output;
+
+		typedef class _nes_apu_sink_callback :
+				public _nes_apu_sink {
+
+			public:
+
+				_nes_apu_sink_callback(
+					__in const nes_apu_output &output
+					);
+
+				virtual ~_nes_apu_sink_callback(void);
+
+				virtual void close(void);
+
+				virtual void open(
+					__in const std::string &path,
+					__in uint32_t rate
+					);
+
+				virtual void write(
+					__in const int16_t *samples,
+					__in size_t count
+					);
+
+			protected:
+
+				nes_apu_output m_output;
+
+		} nes_apu_sink_callback, *nes_apu_sink_callback_ptr;
+
+		typedef class _nes_apu_sink_null :
+				public _nes_apu_sink {
+
+			public:
+
+				_nes_apu_sink_null(void);
+
+				virtual ~_nes_apu_sink_null(void);
+
+				virtual void close(void);
+
+				virtual void open(
+					__in const std::string &path,
+					__in uint32_t rate
+					);
+
+				virtual void write(
+					__in const int16_t *samples,
+					__in size_t count
+					);
+
+		} nes_apu_sink_null, *nes_apu_sink_null_ptr;
+
+		typedef class _nes_apu_sink_raw :
+				public _nes_apu_sink {
+
+			public:
+
+				_nes_apu_sink_raw(void);
+
+				virtual ~_nes_apu_sink_raw(void);
+
+				virtual void close(void);
+
+				virtual void open(
+					__in const std::string &path,
+					__in uint32_t rate
+					);
+
+				virtual void write(
+					__in const int16_t *samples,
+					__in size_t count
+					);
+
+			protected:
+
+				void write_data(
+					__in const void *data,
+					__in size_t length
+					);
+
+				int m_file;
+
+				uint64_t m_length;
+
+				uint32_t m_rate;
+
+		} nes_apu_sink_raw, *nes_apu_sink_raw_ptr;
+
+		typedef class _nes_apu_sink_wav :
+				public _nes_apu_sink_raw {
+
+			public:
+
+				_nes_apu_sink_wav(void);
+
+				virtual ~_nes_apu_sink_wav(void);
+
+				virtual void close(void);
+
+				virtual void open(
+					__in const std::string &path,
+					__in uint32_t rate
+					);
+
+			protected:
+
+				static void header(
+					__out uint8_t *data,
+					__in uint32_t rate,
+					__in uint64_t length
+					);
+
+				static void header_field(
+					__out uint8_t *data,
+					__in uint32_t value,
+					__in size_t length
+					);
+
+		} nes_apu_sink_wav, *nes_apu_sink_wav_ptr;
+
+		typedef class _nes_apu_writer {
+
+			public:
+
+				_nes_apu_writer(void);
+
+				~_nes_apu_writer(void);
+
+				bool is_active(void);
+
+				bool is_failed(void);
+
+				void notify(void);
+
+				void start(
+					__in nes_apu_buffer &buffer,
+					__in nes_apu_sink_t type,
+					__in const std::string &path,
+					__in uint32_t rate,
+					__in_opt const nes_apu_output &output = nes_apu_output()
+					);
+
+				void stop(void);
+
+				uint64_t written(void);
+
+			protected:
+
+				_nes_apu_writer(
+					__in const _nes_apu_writer &other
+					);
+
+				_nes_apu_writer &operator=(
+					__in const _nes_apu_writer &other
+					);
+
+				void drain(void);
+
+				void run(void);
+
+				static nes_apu_sink_ptr sink_create(
+					__in nes_apu_sink_t type,
+					__in const nes_apu_output &output
+					);
+
+				std::atomic<bool> m_active;
+
+				std::vector<int16_t> m_batch;
+
+				nes_apu_buffer_ptr m_buffer;
+
+				std::condition_variable m_condition;
+
+				std::atomic<bool> m_failed;
+
+				nes_apu_sink_ptr m_sink;
+
+				std::thread m_thread;
+
+				std::atomic<uint64_t> m_written;
+
+			private:
+
+				std::mutex m_lock;
+
+		} nes_apu_writer, *nes_apu_writer_ptr;
+
+		typedef class _nes_apu {
+
+			public:
+
+				~_nes_apu(void);
+
+				static _nes_apu *acquire(void);
+
+				nes_apu_buffer &buffer(void);
+
+				static _nes_apu *create(
+					__in nes_memory_ptr memory
+					);
+
+				uint64_t cycles(void);
+
+				void initialize(void);
+
+				bool irq_pending(void);
+
+				static bool is_allocated(void);
+
+				bool is_initialized(void);
+
+				bool is_sink_failed(void);
+
+				bool is_started(void);
+
+				uint64_t master(void);
+
+				uint64_t next_event(void);
+
+				uint32_t poll_stall(void);
+
+				uint8_t read(
+					__in uint16_t address
+					);
+
+				void reset(void);
+
+				void restore(
+					__in const nes_apu_snapshot &snapshot
+					);
+
+				uint32_t sample_rate(void);
+
+				void set_sample_rate(
+					__in uint32_t rate
+					);
+
+				void set_mapper(
+					__in nes_mapper_ptr mapper
+					);
+
+				void set_master(
+					__in uint64_t master
+					);
+
+				void set_sink(
+					__in nes_apu_sink_t type,
+					__in_opt const std::string &path = std::string(),
+					__in_opt const nes_apu_output &output = nes_apu_output()
+					);
+
+				void set_sync(
+					__in nes_apu_sync_t sync
+					);
+
+				void snapshot(
+					__out nes_apu_snapshot &snapshot
+					);
+
+				void start(void);
+
+				void step(void);
+
+				void stop(void);
+
+				nes_apu_sink_t sink(void);
+
+				nes_apu_sync_t sync(void);
+
+				void synchronize(
+					__in uint64_t master
+					);
+
+				std::string to_string(
+					__in_opt bool verbose = false
+					);
+
+				void uninitialize(void);
+
+				void write(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+			protected:
+
+				_nes_apu(
+					__in nes_memory_ptr memory
+					);
+
+				_nes_apu(
+					__in const _nes_apu &other
+					);
+
+				_nes_apu &operator=(
+					__in const _nes_apu &other
+					);
+
+				static void _delete(void);
+
+				void advance(
+					__in uint64_t cycles
+					);
+
+				void advance_cycle(void);
+
+				void clock_dmc(void);
+
+				static void clock_envelope(
+					__inout nes_apu_envelope &envelope,
+					__in uint8_t control
+					);
+
+				void clock_frame(void);
+
+				static void clock_frame_half(
+					__inout nes_apu_state &state
+					);
+
+				static void clock_frame_quarter(
+					__inout nes_apu_state &state
+					);
+
+				static void clock_noise(
+					__inout nes_apu_noise &noise
+					);
+
+				static void clock_sweep(
+					__inout nes_apu_pulse &pulse,
+					__in bool complement
+					);
+
+				void clock_timers(void);
+
+				uint32_t cycles_idle(void);
+
+				void dmc_fetch(void);
+
+				static void dmc_restart(
+					__inout nes_apu_dmc &dmc
+					);
+
+				static uint8_t envelope_volume(
+					__in const nes_apu_envelope &envelope,
+					__in uint8_t control
+					);
+
+				static uint32_t frame_next(
+					__in const nes_apu_state &state
+					);
+
+				int32_t mix(void);
+
+				void mix_generate(void);
+
+				static uint8_t output_noise(
+					__in const nes_apu_noise &noise
+					);
+
+				static uint8_t output_pulse(
+					__in const nes_apu_pulse &pulse,
+					__in bool complement
+					);
+
+				static uint8_t output_triangle(
+					__in const nes_apu_triangle &triangle
+					);
+
+				void skip(
+					__in uint32_t cycles
+					);
+
+				static uint32_t skip_timer(
+					__inout uint16_t &timer,
+					__in uint16_t reload,
+					__in uint32_t cycles
+					);
+
+				static uint16_t sweep_target(
+					__in const nes_apu_pulse &pulse,
+					__in bool complement
+					);
+
+				static void write_pulse(
+					__inout nes_apu_pulse &pulse,
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+#ifndef NDEBUG
+				friend class NES::TEST::_nes_test_apu;
+#endif // NDEBUG
+
+				int32_t m_amplitude;
+
+				nes_apu_blip m_blip;
+
+				uint32_t m_blip_time;
+
+				nes_apu_buffer m_buffer;
+
+				bool m_changed;
+
+				uint64_t m_cycles;
+
+				bool m_initialized;
+
+				static _nes_apu *m_instance;
+
+				nes_mapper_ptr m_mapper;
+
+				uint64_t m_master;
+
+				nes_memory_ptr m_memory;
+
+				std::vector<int32_t> m_mix_pulse;
+
+				std::vector<int32_t> m_mix_tnd;
+
+				uint32_t m_sample_rate;
+
+				nes_apu_sink_t m_sink;
+
+				nes_apu_output m_sink_output;
+
+				std::string m_sink_path;
+
+				uint32_t m_stall;
+
+				bool m_started;
+
+				nes_apu_state m_state;
+
+				nes_apu_sync_t m_sync;
+
+				nes_apu_writer m_writer;
+
+		} nes_apu, *nes_apu_ptr;
+	}
+}
+
+#endif // NES_APU_H_
@@ -0,0 +1,227 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_APU_TYPE_H_
+#define NES_APU_TYPE_H_
+
+#include "nes_type.h"
+
+namespace NES {
+
+	namespace COMP {
+
+		#define APU_BLIP_BASS_SHIFT 9
+		#define APU_BLIP_CUTOFF 0.9
+		#define APU_BLIP_FRAME_CYCLES 0x1000
+		#define APU_BLIP_KERNEL_BITS 14
+		#define APU_BLIP_PHASE_BITS 5
+		#define APU_BLIP_PHASES (1 << APU_BLIP_PHASE_BITS)
+		#define APU_BLIP_TIME_BITS 32
+		#define APU_BLIP_WIDTH 16
+		#define APU_BUFFER_CAPACITY 0x4000
+		#define APU_CPU_FREQUENCY 1789773
+		#define APU_DMC_ADDRESS_BASE 0xc000
+		#define APU_DMC_ADDRESS_MAX UINT16_MAX
+		#define APU_DMC_ADDRESS_MIN 0x8000
+		#define APU_DMC_ADDRESS_SCALE 64
+		#define APU_DMC_CONTROL_IRQ 0x80
+		#define APU_DMC_CONTROL_LOOP 0x40
+		#define APU_DMC_CONTROL_RATE 0xf
+		#define APU_DMC_LENGTH_SCALE 16
+		#define APU_DMC_LEVEL_MASK 0x7f
+		#define APU_DMC_LEVEL_MAX 125
+		#define APU_DMC_LEVEL_MIN 2
+		#define APU_DMC_LEVEL_STEP 2
+		#define APU_DMC_STALL_CYCLES 4
+		#define APU_DUTY_LENGTH 8
+		#define APU_ENVELOPE_CONSTANT 0x10
+		#define APU_ENVELOPE_LOOP 0x20
+		#define APU_ENVELOPE_MAX 0xf
+		#define APU_ENVELOPE_VOLUME 0xf
+		#define APU_FRAME_INHIBIT 0x40
+		#define APU_FRAME_MODE 0x80
+		#define APU_LENGTH_SHIFT 3
+		#define APU_MASTER_DIVIDER 12
+		#define APU_MIX_PULSE_DIVIDEND 95.52
+		#define APU_MIX_PULSE_DIVISOR 8128.0
+		#define APU_MIX_PULSE_LENGTH 31
+		#define APU_MIX_SCALE INT16_MAX
+		#define APU_MIX_TND_DIVIDEND 163.67
+		#define APU_MIX_TND_DIVISOR 24329.0
+		#define APU_MIX_TND_LENGTH 203
+		#define APU_MIX_TND_NOISE 2
+		#define APU_MIX_TND_TRIANGLE 3
+		#define APU_NOISE_FEEDBACK_LONG 1
+		#define APU_NOISE_FEEDBACK_SHORT 6
+		#define APU_NOISE_MODE 0x80
+		#define APU_NOISE_PERIOD 0xf
+		#define APU_NOISE_SHIFT_INIT 1
+		#define APU_NOISE_SHIFT_TOP 14
+		#define APU_PERIOD_HIGH_MASK 0x7
+		#define APU_PULSE_DUTY_SHIFT 6
+		#define APU_PULSE_PERIOD_MAX 0x7ff
+		#define APU_PULSE_PERIOD_MIN 8
+		#define APU_REGISTER_BASE 0x4000
+		#define APU_REGISTER_DMC_ADDRESS 0x4012
+		#define APU_REGISTER_DMC_CONTROL 0x4010
+		#define APU_REGISTER_DMC_LENGTH 0x4013
+		#define APU_REGISTER_DMC_LOAD 0x4011
+		#define APU_REGISTER_FRAME 0x4017
+		#define APU_REGISTER_JOYPAD 0x4016
+		#define APU_REGISTER_MAX 0x4017
+		#define APU_REGISTER_NOISE_CONTROL 0x400c
+		#define APU_REGISTER_NOISE_LENGTH 0x400f
+		#define APU_REGISTER_NOISE_PERIOD 0x400e
+		#define APU_REGISTER_PULSE_1_CONTROL 0x4000
+		#define APU_REGISTER_PULSE_1_HIGH 0x4003
+		#define APU_REGISTER_PULSE_1_LOW 0x4002
+		#define APU_REGISTER_PULSE_1_SWEEP 0x4001
+		#define APU_REGISTER_PULSE_2_CONTROL 0x4004
+		#define APU_REGISTER_PULSE_2_HIGH 0x4007
+		#define APU_REGISTER_PULSE_2_LOW 0x4006
+		#define APU_REGISTER_PULSE_2_SWEEP 0x4005
+		#define APU_REGISTER_STATUS 0x4015
+		#define APU_REGISTER_TRIANGLE_CONTROL 0x4008
+		#define APU_REGISTER_TRIANGLE_HIGH 0x400b
+		#define APU_REGISTER_TRIANGLE_LOW 0x400a
+		#define APU_SAMPLE_RATE_DEFAULT 44100
+		#define APU_SAMPLE_RATE_MAX 192000
+		#define APU_SINK_MODE 0644
+		#define APU_SINK_WAV_BITS 16
+		#define APU_SINK_WAV_CHANNELS 1
+		#define APU_SINK_WAV_DATA "data"
+		#define APU_SINK_WAV_FORMAT "fmt "
+		#define APU_SINK_WAV_FORMAT_LENGTH 16
+		#define APU_SINK_WAV_FORMAT_PCM 1
+		#define APU_SINK_WAV_HEADER_LENGTH 44
+		#define APU_SINK_WAV_RIFF "RIFF"
+		#define APU_SINK_WAV_TAG_LENGTH 4
+		#define APU_SINK_WAV_WAVE "WAVE"
+		#define APU_STATUS_DMC 0x10
+		#define APU_STATUS_DMC_IRQ 0x80
+		#define APU_STATUS_FRAME_IRQ 0x40
+		#define APU_STATUS_NOISE 0x8
+		#define APU_STATUS_PULSE_1 0x1
+		#define APU_STATUS_PULSE_2 0x2
+		#define APU_STATUS_TRIANGLE 0x4
+		#define APU_SWEEP_ENABLE 0x80
+		#define APU_SWEEP_NEGATE 0x8
+		#define APU_SWEEP_PERIOD 0x70
+		#define APU_SWEEP_PERIOD_SHIFT 4
+		#define APU_SWEEP_SHIFT 0x7
+		#define APU_SYNC_HORIZON APU_FRAME_STEP_4_LENGTH
+		#define APU_TRIANGLE_CONTROL 0x80
+		#define APU_TRIANGLE_LINEAR 0x7f
+		#define APU_TRIANGLE_PERIOD_MIN 2
+		#define APU_TRIANGLE_SEQUENCE_LENGTH 32
+		#define APU_WRITER_BATCH 0x1000
+		#define APU_WRITER_TIMEOUT 10
+
+		enum {
+			APU_FRAME_STEP_QUARTER_1 = 7457,
+			APU_FRAME_STEP_HALF_1 = 14913,
+			APU_FRAME_STEP_QUARTER_3 = 22371,
+			APU_FRAME_STEP_HALF_2 = 29829,
+			APU_FRAME_STEP_4_LENGTH = 29830,
+			APU_FRAME_STEP_5_HALF_2 = 37281,
+			APU_FRAME_STEP_5_LENGTH = 37282,
+		};
+
+		static const uint8_t APU_DUTY[][APU_DUTY_LENGTH] = {
+			{ 0, 1, 0, 0, 0, 0, 0, 0, },
+			{ 0, 1, 1, 0, 0, 0, 0, 0, },
+			{ 0, 1, 1, 1, 1, 0, 0, 0, },
+			{ 1, 0, 0, 1, 1, 1, 1, 1, },
+			};
+
+		static const uint16_t APU_DMC_RATE[] = {
+			428, 380, 340, 320, 286, 254, 226, 214, 
+			190, 160, 142, 128, 106, 84, 72, 54,
+			};
+
+		static const uint8_t APU_LENGTH[] = {
+			10, 254, 20, 2, 40, 4, 80, 6, 
+			160, 8, 60, 10, 14, 12, 26, 14,
+			12, 16, 24, 18, 48, 20, 96, 22, 
+			192, 24, 72, 26, 16, 28, 32, 30,
+			};
+
+		static const uint16_t APU_NOISE_PERIOD_TABLE[] = {
+			4, 8, 16, 32, 64, 96, 128, 160, 
+			202, 254, 380, 508, 762, 1016, 2034, 4068,
+			};
+
+		static const uint8_t APU_TRIANGLE_SEQUENCE[APU_TRIANGLE_SEQUENCE_LENGTH] = {
+			15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+			0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+			};
+
+		#define NES_APU_HEADER NES_HEADER "::APU"
+
+		#ifndef NDEBUG
+		#define NES_APU_EXCEPTION_HEADER NES_APU_HEADER
+		#else
+		#define NES_APU_EXCEPTION_HEADER EXCEPTION_HEADER
+		#endif // NDEBUG
+
+		enum {
+			NES_APU_EXCEPTION_ALLOCATED = 0,
+			NES_APU_EXCEPTION_INITIALIZED,
+			NES_APU_EXCEPTION_INVALID_SAMPLE_RATE,
+			NES_APU_EXCEPTION_INVALID_SINK,
+			NES_APU_EXCEPTION_INVALID_SYNC,
+			NES_APU_EXCEPTION_SINK_OPEN,
+			NES_APU_EXCEPTION_SINK_WRITE,
+			NES_APU_EXCEPTION_STARTED,
+			NES_APU_EXCEPTION_STOPPED,
+			NES_APU_EXCEPTION_UNINITIALIZED,
+		};
+
+		#define NES_APU_EXCEPTION_MAX NES_APU_EXCEPTION_UNINITIALIZED
+
+		static const std::string NES_APU_EXCEPTION_STR[] = {
+			"Failed to allocate apu component",
+			"Apu component is initialized",
+			"Invalid apu sample rate",
+			"Invalid apu audio sink",
+			"Invalid apu synchronization mode",
+			"Failed to open apu audio sink",
+			"Failed to write apu audio sink",
+			"Apu component is started",
+			"Apu component is stopped",
+			"Apu component is uninitialized",
+			};
+
+		#define NES_APU_EXCEPTION_STRING(_TYPE_) \
+			((_TYPE_) > NES_APU_EXCEPTION_MAX ? EXCEPTION_UNKNOWN : \
+			CHECK_STR(NES_APU_EXCEPTION_STR[_TYPE_]))
+
+		#define THROW_NES_APU_EXCEPTION(_EXCEPT_) \
+			THROW_EXCEPTION(NES_APU_EXCEPTION_HEADER, \
+			NES_APU_EXCEPTION_STRING(_EXCEPT_))
+		#define THROW_NES_APU_EXCEPTION_MESSAGE(_EXCEPT_, _FORMAT_, ...) \
+			THROW_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_HEADER, \
+			NES_APU_EXCEPTION_STRING(_EXCEPT_), _FORMAT_, __VA_ARGS__)
+
+		class _nes_apu;
+		typedef _nes_apu nes_apu, *nes_apu_ptr;
+	}
+}
+
+#endif // NES_APU_TYPE_H_
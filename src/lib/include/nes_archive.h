@@ -0,0 +1,135 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_ARCHIVE_H_
+#define NES_ARCHIVE_H_
+
+namespace NES {
+
+	#define NES_ARCHIVE_INDEX_EXTENSION ".idx"
+
+	typedef struct {
+		uint64_t capacity;			// index slots
+		uint64_t count;				// stored states
+		uint32_t magic;				// archive magic
+		uint64_t reference_length;		// reference state length
+		uint64_t reference_offset;		// reference state data offset
+		uint32_t version;			// archive version
+	} nes_archive_header;
+
+	typedef struct {
+		uint64_t key;				// state hash
+		uint32_t length;			// encoded length
+		uint64_t offset;			// encoded data offset
+		uint32_t raw;				// decoded length
+	} nes_archive_slot;
+
+	typedef class _nes_archive {
+
+		public:
+
+			_nes_archive(void);
+
+			~_nes_archive(void);
+
+			void close(void);
+
+			bool contains(
+				__in uint64_t key
+				);
+
+			size_t count(void);
+
+			size_t get(
+				__in uint64_t key,
+				__out std::vector<uint8_t> &state
+				);
+
+			bool is_open(void);
+
+			void open(
+				__in const std::string &path
+				);
+
+			uint64_t put(
+				__in const uint8_t *state,
+				__in size_t length
+				);
+
+			std::string to_string(
+				__in_opt bool verbose = false
+				);
+
+		protected:
+
+			_nes_archive(
+				__in const _nes_archive &other
+				);
+
+			_nes_archive &operator=(
+				__in const _nes_archive &other
+				);
+
+			uint64_t append(
+				__in const uint8_t *data,
+				__in size_t length
+				);
+
+			nes_archive_slot *find(
+				__in uint64_t key
+				);
+
+			void grow(void);
+
+			void map(
+				__in size_t length
+				);
+
+			void release(void);
+
+			uint8_t *m_data;
+
+			int m_data_file;
+
+			size_t m_data_length;
+
+			size_t m_data_mapped;
+
+			nes_archive_header *m_header;
+
+			int m_index_file;
+
+			size_t m_index_length;
+
+			std::string m_path;
+
+			std::vector<uint8_t> m_scratch;
+
+			nes_archive_slot *m_slot;
+
+			std::vector<uint8_t> m_zero;
+
+		private:
+
+			std::mutex m_lock;
+
+	} nes_archive, *nes_archive_ptr;
+}
+
+#endif // NES_ARCHIVE_H_
@@ -0,0 +1,89 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_ARCHIVE_TYPE_H_
+#define NES_ARCHIVE_TYPE_H_
+
+#include "nes_type.h"
+
+namespace NES {
+
+	#define ARCHIVE_CLOSED "CLOSED"
+	#define ARCHIVE_DATA_MAGIC 0x4154414e
+	#define ARCHIVE_DATA_RESERVE 0x40000000
+	#define ARCHIVE_FILE_MODE 0644
+	#define ARCHIVE_INDEX_CAPACITY 0x10000
+	#define ARCHIVE_INDEX_LOAD 2
+	#define ARCHIVE_INDEX_MAGIC 0x5844494e
+	#define ARCHIVE_INDEX_TEMPORARY ".tmp"
+	#define ARCHIVE_OPEN "OPEN"
+	#define ARCHIVE_STATE_MAX UINT32_MAX
+	#define ARCHIVE_VERSION 1
+
+	typedef struct {
+		uint32_t magic;				// archive magic
+		uint32_t version;			// archive version
+	} nes_archive_data_header;
+
+	#define NES_ARCHIVE_HEADER NES_HEADER "::ARCHIVE"
+
+	#ifndef NDEBUG
+	#define NES_ARCHIVE_EXCEPTION_HEADER NES_ARCHIVE_HEADER
+	#else
+	#define NES_ARCHIVE_EXCEPTION_HEADER EXCEPTION_HEADER
+	#endif // NDEBUG
+
+	enum {
+		NES_ARCHIVE_EXCEPTION_CLOSED = 0,
+		NES_ARCHIVE_EXCEPTION_FILE,
+		NES_ARCHIVE_EXCEPTION_INVALID_STATE,
+		NES_ARCHIVE_EXCEPTION_MALFORMED,
+		NES_ARCHIVE_EXCEPTION_MAPPING,
+		NES_ARCHIVE_EXCEPTION_NOT_FOUND,
+		NES_ARCHIVE_EXCEPTION_OPEN,
+	};
+
+	#define NES_ARCHIVE_EXCEPTION_MAX NES_ARCHIVE_EXCEPTION_OPEN
+
+	static const std::string NES_ARCHIVE_EXCEPTION_STR[] = {
+		"Archive is closed",
+		"Failed to access archive file",
+		"Invalid archive state",
+		"Archive is malformed",
+		"Failed to map archive file",
+		"State does not exist in archive",
+		"Archive is open",
+		};
+
+	#define NES_ARCHIVE_EXCEPTION_STRING(_TYPE_) \
+		((_TYPE_) > NES_ARCHIVE_EXCEPTION_MAX ? EXCEPTION_UNKNOWN : \
+		CHECK_STR(NES_ARCHIVE_EXCEPTION_STR[_TYPE_]))
+
+	#define THROW_NES_ARCHIVE_EXCEPTION(_EXCEPT_) \
+		THROW_EXCEPTION(NES_ARCHIVE_EXCEPTION_HEADER, \
+		NES_ARCHIVE_EXCEPTION_STRING(_EXCEPT_))
+	#define THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(_EXCEPT_, _FORMAT_, ...) \
+		THROW_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_HEADER, \
+		NES_ARCHIVE_EXCEPTION_STRING(_EXCEPT_), _FORMAT_, __VA_ARGS__)
+
+	class _nes_archive;
+	typedef _nes_archive nes_archive, *nes_archive_ptr;
+}
+
+#endif // NES_ARCHIVE_TYPE_H_
@@ -0,0 +1,87 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_BATTERY_H_
+#define NES_BATTERY_H_
+
+namespace NES {
+
+	#define NES_BATTERY_EXTENSION ".sav"
+	#define NES_BATTERY_INTERVAL_DEFAULT 60
+
+	typedef class _nes_battery {
+
+		public:
+
+			_nes_battery(void);
+
+			~_nes_battery(void);
+
+			void close(void);
+
+			bool flush(
+				__in_opt bool sync = false
+				);
+
+			bool is_open(void);
+
+			size_t length(void);
+
+			void open(
+				__in const std::string &path,
+				__inout uint8_t *ram,
+				__in size_t length
+				);
+
+			std::string path(void);
+
+			static std::string save_path(
+				__in const std::string &image
+				);
+
+			std::string to_string(
+				__in_opt bool verbose = false
+				);
+
+		protected:
+
+			_nes_battery(
+				__in const _nes_battery &other
+				);
+
+			_nes_battery &operator=(
+				__in const _nes_battery &other
+				);
+
+			void release(void);
+
+			int m_file;
+
+			size_t m_length;
+
+			uint8_t *m_mapping;
+
+			std::string m_path;
+
+			uint8_t *m_ram;
+
+	} nes_battery, *nes_battery_ptr;
+}
+
+#endif // NES_BATTERY_H_
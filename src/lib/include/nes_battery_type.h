@@ -0,0 +1,75 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_BATTERY_TYPE_H_
+#define NES_BATTERY_TYPE_H_
+
+#include "nes_type.h"
+
+namespace NES {
+
+	#define BATTERY_CLOSED "CLOSED"
+	#define BATTERY_FILE_MODE 0644
+	#define BATTERY_OPEN "OPEN"
+	#define BATTERY_PATH_DELIMITER "./"
+
+	#define NES_BATTERY_HEADER NES_HEADER "::BATTERY"
+
+	#ifndef NDEBUG
+	#define NES_BATTERY_EXCEPTION_HEADER NES_BATTERY_HEADER
+	#else
+	#define NES_BATTERY_EXCEPTION_HEADER EXCEPTION_HEADER
+	#endif // NDEBUG
+
+	enum {
+		NES_BATTERY_EXCEPTION_CLOSED = 0,
+		NES_BATTERY_EXCEPTION_FILE,
+		NES_BATTERY_EXCEPTION_INVALID_RAM,
+		NES_BATTERY_EXCEPTION_LOCKED,
+		NES_BATTERY_EXCEPTION_MAPPING,
+		NES_BATTERY_EXCEPTION_OPEN,
+	};
+
+	#define NES_BATTERY_EXCEPTION_MAX NES_BATTERY_EXCEPTION_OPEN
+
+	static const std::string NES_BATTERY_EXCEPTION_STR[] = {
+		"Battery is closed",
+		"Failed to access battery file",
+		"Invalid battery ram",
+		"Battery file is in use",
+		"Failed to map battery file",
+		"Battery is open",
+		};
+
+	#define NES_BATTERY_EXCEPTION_STRING(_TYPE_) \
+		((_TYPE_) > NES_BATTERY_EXCEPTION_MAX ? EXCEPTION_UNKNOWN : \
+		CHECK_STR(NES_BATTERY_EXCEPTION_STR[_TYPE_]))
+
+	#define THROW_NES_BATTERY_EXCEPTION(_EXCEPT_) \
+		THROW_EXCEPTION(NES_BATTERY_EXCEPTION_HEADER, \
+		NES_BATTERY_EXCEPTION_STRING(_EXCEPT_))
+	#define THROW_NES_BATTERY_EXCEPTION_MESSAGE(_EXCEPT_, _FORMAT_, ...) \
+		THROW_EXCEPTION_MESSAGE(NES_BATTERY_EXCEPTION_HEADER, \
+		NES_BATTERY_EXCEPTION_STRING(_EXCEPT_), _FORMAT_, __VA_ARGS__)
+
+	class _nes_battery;
+	typedef _nes_battery nes_battery, *nes_battery_ptr;
+}
+
+#endif // NES_BATTERY_TYPE_H_
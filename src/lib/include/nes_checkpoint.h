@@ -0,0 +1,139 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_CHECKPOINT_H_
+#define NES_CHECKPOINT_H_
+
+namespace NES {
+
+	#define NES_CHECKPOINT_CHAIN_DEFAULT 64
+	#define NES_CHECKPOINT_PAGE_LENGTH 0x100
+
+	typedef struct {
+		std::vector<uint8_t> data;		// dirty page contents
+		uint64_t id;				// checkpoint id
+		std::vector<uint32_t> page;		// dirty page indices
+	} nes_checkpoint_delta;
+
+	typedef std::shared_ptr<const std::vector<uint8_t>> nes_checkpoint_base_ref;
+
+	typedef std::shared_ptr<const nes_checkpoint_delta> nes_checkpoint_delta_ref;
+
+	typedef class _nes_checkpoint {
+
+		public:
+
+			_nes_checkpoint(void);
+
+			~_nes_checkpoint(void);
+
+			uint64_t base(void);
+
+			size_t chain(void);
+
+			void clear(void);
+
+			uint64_t commit(
+				__inout std::vector<uint8_t> &snapshot
+				);
+
+			bool compact(void);
+
+			bool empty(void);
+
+			void initialize(
+				__in_opt size_t chain = NES_CHECKPOINT_CHAIN_DEFAULT
+				);
+
+			bool is_initialized(void);
+
+			uint64_t last(void);
+
+			void reconstruct(
+				__in uint64_t id,
+				__out std::vector<uint8_t> &snapshot
+				);
+
+			uint64_t retained(void);
+
+			std::string to_string(
+				__in_opt bool verbose = false
+				);
+
+			void uninitialize(void);
+
+		protected:
+
+			_nes_checkpoint(
+				__in const _nes_checkpoint &other
+				);
+
+			_nes_checkpoint &operator=(
+				__in const _nes_checkpoint &other
+				);
+
+			static void apply(
+				__inout std::vector<uint8_t> &snapshot,
+				__in const nes_checkpoint_delta &delta
+				);
+
+			static void compactor(void);
+
+			void schedule(void);
+
+			nes_checkpoint_base_ref m_base;
+
+			uint64_t m_base_id;
+
+			size_t m_chain;
+
+			static std::condition_variable m_compactor_condition;
+
+			static std::mutex m_compactor_lock;
+
+			static std::deque<_nes_checkpoint *> m_compactor_queue;
+
+			static std::mutex m_compactor_state_lock;
+
+			static bool m_compactor_stop;
+
+			static std::thread m_compactor_thread;
+
+			static size_t m_compactor_users;
+
+			std::vector<uint8_t> m_current;
+
+			std::deque<nes_checkpoint_delta_ref> m_delta;
+
+			uint64_t m_generation;
+
+			bool m_initialized;
+
+			uint64_t m_next;
+
+			bool m_scheduled;
+
+		private:
+
+			std::mutex m_lock;
+
+	} nes_checkpoint, *nes_checkpoint_ptr;
+}
+
+#endif // NES_CHECKPOINT_H_
@@ -0,0 +1,68 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_CHECKPOINT_TYPE_H_
+#define NES_CHECKPOINT_TYPE_H_
+
+#include "nes_type.h"
+
+namespace NES {
+
+	#define NES_CHECKPOINT_HEADER NES_HEADER "::CHECKPOINT"
+
+	#ifndef NDEBUG
+	#define NES_CHECKPOINT_EXCEPTION_HEADER NES_CHECKPOINT_HEADER
+	#else
+	#define NES_CHECKPOINT_EXCEPTION_HEADER EXCEPTION_HEADER
+	#endif // NDEBUG
+
+	enum {
+		NES_CHECKPOINT_EXCEPTION_INITIALIZED = 0,
+		NES_CHECKPOINT_EXCEPTION_INVALID_CHAIN,
+		NES_CHECKPOINT_EXCEPTION_INVALID_ID,
+		NES_CHECKPOINT_EXCEPTION_INVALID_SNAPSHOT,
+		NES_CHECKPOINT_EXCEPTION_UNINITIALIZED,
+	};
+
+	#define NES_CHECKPOINT_EXCEPTION_MAX NES_CHECKPOINT_EXCEPTION_UNINITIALIZED
+
+	static const std::string NES_CHECKPOINT_EXCEPTION_STR[] = {
+		"Checkpoint is initialized",
+		"Invalid checkpoint chain length",
+		"Invalid checkpoint id",
+		"Invalid checkpoint snapshot",
+		"Checkpoint is uninitialized",
+		};
+
+	#define NES_CHECKPOINT_EXCEPTION_STRING(_TYPE_) \
+		((_TYPE_) > NES_CHECKPOINT_EXCEPTION_MAX ? EXCEPTION_UNKNOWN : \
+		CHECK_STR(NES_CHECKPOINT_EXCEPTION_STR[_TYPE_]))
+
+	#define THROW_NES_CHECKPOINT_EXCEPTION(_EXCEPT_) \
+		THROW_EXCEPTION(NES_CHECKPOINT_EXCEPTION_HEADER, \
+		NES_CHECKPOINT_EXCEPTION_STRING(_EXCEPT_))
+	#define THROW_NES_CHECKPOINT_EXCEPTION_MESSAGE(_EXCEPT_, _FORMAT_, ...) \
+		THROW_EXCEPTION_MESSAGE(NES_CHECKPOINT_EXCEPTION_HEADER, \
+		NES_CHECKPOINT_EXCEPTION_STRING(_EXCEPT_), _FORMAT_, __VA_ARGS__)
+
+	class _nes_checkpoint;
+	typedef _nes_checkpoint nes_checkpoint, *nes_checkpoint_ptr;
+}
+
+#endif // NES_CHECKPOINT_TYPE_H_
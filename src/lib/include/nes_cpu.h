@@ -24,6 +24,22 @@ namespace NES {
 
 	namespace COMP {
 
+		typedef struct {
+			uint64_t apu_event;			// next apu event (master clock)
+			uint8_t apu_irq;			// apu irq pending
+			uint8_t apu_sync;			// apu master clock synchronized
+			uint64_t cycles;			// elapsed cycles
+			uint8_t mapper_irq;			// mapper irq pending
+			uint64_t ppu_event;			// next ppu event (master clock)
+			uint8_t ppu_poll;			// ppu nmi poll pending
+			uint8_t register_a;			// accumulator
+			uint8_t register_p;			// status flags
+			uint16_t register_pc;			// program counter
+			uint8_t register_sp;			// stack pointer
+			uint8_t register_x;			// index x
+			uint8_t register_y;			// index y
+		} nes_cpu_snapshot;
+
 		typedef class _nes_cpu {
 
 			public:
@@ -34,7 +50,13 @@ namespace NES {
 
 				void clear(void);
 
-				uint32_t cycles(void);
+				static _nes_cpu *create(
+					__in nes_memory_ptr memory,
+					__in nes_ppu_ptr ppu,
+					__in nes_apu_ptr apu
+					);
+
+				uint64_t cycles(void);
 
 				void initialize(void);
 
@@ -44,12 +66,30 @@ namespace NES {
 
 				bool is_initialized(void);
 
+				nes_mapper_ptr mapper(void);
+
+				uint64_t master(void);
+
 				void nmi(void);
 
 				void reset(void);
 
+				void restore(
+					__in const nes_cpu_snapshot &snapshot
+					);
+
+				void set_mapper(
+					__in nes_mapper_ptr mapper
+					);
+
+				void snapshot(
+					__out nes_cpu_snapshot &snapshot
+					);
+
 				void step(void);
 
+				void synchronize(void);
+
 				std::string to_string(
 					__in_opt bool verbose = false
 					);
@@ -58,7 +98,11 @@ namespace NES {
 
 			protected:
 
-				_nes_cpu(void);
+				_nes_cpu(
+					__in nes_memory_ptr memory,
+					__in nes_ppu_ptr ppu,
+					__in nes_apu_ptr apu
+					);
 
 				_nes_cpu(
 					__in const _nes_cpu &other
@@ -252,27 +296,47 @@ namespace NES {
 
 				void subroutine_return(void);
 
+				void synchronize_apu(void);
+
 #ifndef NDEBUG
 				friend class NES::TEST::_nes_test_cpu;
 #endif // NDEBUG
 
-				uint32_t m_cycles;
+				friend class _nes_cpu_lanes;
+
+				nes_apu_ptr m_apu;
+
+				uint64_t m_apu_event;
+
+				bool m_apu_irq;
+
+				bool m_apu_sync;
+
+				uint64_t m_cycles;
 
 				static _nes_cpu *m_instance;
 
 				bool m_initialized;
 
+				nes_mapper_ptr m_mapper;
+
+				bool m_mapper_irq;
+
 				nes_memory_ptr m_memory;
 
+				nes_ppu_ptr m_ppu;
+
+				uint64_t m_ppu_event;
+
+				bool m_ppu_poll;
+
+				uint8_t *m_ram;
+
 				uint8_t m_register_a, m_register_p, m_register_sp, 
 					m_register_x, m_register_y;
 
 				uint16_t m_register_pc;
 
-			private:
-
-				std::recursive_mutex m_lock;
-
 		} nes_cpu, *nes_cpu_ptr;
 	}
 }
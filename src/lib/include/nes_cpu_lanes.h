@@ -0,0 +1,223 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_CPU_LANES_H_
+#define NES_CPU_LANES_H_
+
+namespace NES {
+
+	namespace COMP {
+
+		typedef struct {
+			uint8_t a;				// accumulator
+			uint64_t cycles;			// elapsed cycles
+			uint8_t p;				// status flags
+			uint16_t pc;				// program counter
+			uint8_t sp;				// stack pointer
+			uint8_t x;				// index x
+			uint8_t y;				// index y
+		} nes_cpu_lane;
+
+		typedef class _nes_cpu_lanes {
+
+			public:
+
+				~_nes_cpu_lanes(void);
+
+				static _nes_cpu_lanes *create(
+					__in nes_rom &rom,
+					__in size_t count
+					);
+
+				size_t count(void);
+
+				size_t groups(void);
+
+				void initialize(void);
+
+				bool is_initialized(void);
+
+				nes_cpu_lane lane(
+					__in size_t index
+					);
+
+				uint8_t *ram(
+					__in size_t index
+					);
+
+				void reset(void);
+
+				uint64_t scalar(void);
+
+				void step(
+					__in_opt size_t count = 1
+					);
+
+				std::string to_string(
+					__in_opt bool verbose = false
+					);
+
+				void uninitialize(void);
+
+				uint64_t vector(void);
+
+			protected:
+
+				_nes_cpu_lanes(
+					__in nes_rom &rom,
+					__in size_t count
+					);
+
+				_nes_cpu_lanes(
+					__in const _nes_cpu_lanes &other
+					);
+
+				_nes_cpu_lanes &operator=(
+					__in const _nes_cpu_lanes &other
+					);
+
+				void advance(
+					__in size_t first,
+					__in uint16_t length,
+					__in uint32_t cycles
+					);
+
+				void execute(
+					__in size_t index
+					);
+
+				bool execute_vector(
+					__in uint16_t pc,
+					__in size_t first
+					);
+
+				uint8_t fetch(
+					__in uint16_t address
+					);
+
+				void vector_add(
+					__in uint8_t value,
+					__in size_t first
+					);
+
+				void vector_assign(
+					__inout std::vector<uint8_t> &target,
+					__in const std::vector<uint8_t> &source,
+					__in size_t first
+					);
+
+				void vector_assign(
+					__inout std::vector<uint8_t> &target,
+					__in uint8_t value,
+					__in size_t first
+					);
+
+				void vector_bitwise(
+					__in uint8_t mask,
+					__in uint8_t set,
+					__in uint8_t toggle,
+					__in size_t first
+					);
+
+				void vector_branch(
+					__in uint8_t flag,
+					__in bool set,
+					__in uint16_t pc,
+					__in size_t first
+					);
+
+				void vector_compare(
+					__in const std::vector<uint8_t> &source,
+					__in uint8_t value,
+					__in size_t first
+					);
+
+				void vector_flag(
+					__in uint8_t flag,
+					__in bool set,
+					__in size_t first
+					);
+
+				void vector_flags(
+					__in const std::vector<uint8_t> &source,
+					__in size_t first
+					);
+
+				void vector_increment(
+					__inout std::vector<uint8_t> &target,
+					__in uint8_t delta,
+					__in size_t first
+					);
+
+				bool vector_load(
+					__inout std::vector<uint8_t> &target,
+					__in cpu_mode_t mode,
+					__in uint16_t pc,
+					__in uint32_t cycles,
+					__in size_t first
+					);
+
+				bool vector_store(
+					__in const std::vector<uint8_t> &source,
+					__in cpu_mode_t mode,
+					__in uint16_t pc,
+					__in uint32_t cycles,
+					__in size_t first
+					);
+
+				nes_apu_ptr m_apu;
+
+				size_t m_count;
+
+				nes_cpu_ptr m_cpu;
+
+				std::vector<uint64_t> m_cycles;
+
+				size_t m_groups;
+
+				bool m_initialized;
+
+				nes_mapper_ptr m_mapper;
+
+				std::vector<uint8_t> m_mask;
+
+				nes_memory_ptr m_memory;
+
+				std::vector<uint8_t> m_pending;
+
+				nes_ppu_ptr m_ppu;
+
+				std::vector<uint8_t> m_ram;
+
+				std::vector<uint8_t> m_register_a, m_register_p, m_register_sp,
+					m_register_x, m_register_y;
+
+				std::vector<uint16_t> m_register_pc;
+
+				nes_rom &m_rom;
+
+				uint64_t m_scalar;
+
+				uint64_t m_vector;
+
+		} nes_cpu_lanes, *nes_cpu_lanes_ptr;
+	}
+}
+
+#endif // NES_CPU_LANES_H_
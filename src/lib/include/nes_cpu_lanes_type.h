@@ -0,0 +1,79 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_CPU_LANES_TYPE_H_
+#define NES_CPU_LANES_TYPE_H_
+
+#include "nes_type.h"
+
+namespace NES {
+
+	namespace COMP {
+
+		#define CPU_LANES_LENGTH_ABSOLUTE 3
+		#define CPU_LANES_LENGTH_IMMEDIATE 2
+		#define CPU_LANES_LENGTH_IMPLIED 1
+		#define CPU_LANES_MAX 0x1000
+		#define CPU_LANES_RAM_LENGTH 0x800
+
+		#define NES_CPU_LANES_HEADER NES_HEADER "::CPU::LANES"
+
+		#ifndef NDEBUG
+		#define NES_CPU_LANES_EXCEPTION_HEADER NES_CPU_LANES_HEADER
+		#else
+		#define NES_CPU_LANES_EXCEPTION_HEADER EXCEPTION_HEADER
+		#endif // NDEBUG
+
+		enum {
+			NES_CPU_LANES_EXCEPTION_ALLOCATED = 0,
+			NES_CPU_LANES_EXCEPTION_INITIALIZED,
+			NES_CPU_LANES_EXCEPTION_INVALID_COUNT,
+			NES_CPU_LANES_EXCEPTION_INVALID_LANE,
+			NES_CPU_LANES_EXCEPTION_UNINITIALIZED,
+			NES_CPU_LANES_EXCEPTION_UNSUPPORTED_MAPPER,
+		};
+
+		#define NES_CPU_LANES_EXCEPTION_MAX NES_CPU_LANES_EXCEPTION_UNSUPPORTED_MAPPER
+
+		static const std::string NES_CPU_LANES_EXCEPTION_STR[] = {
+			"Failed to allocate cpu lanes",
+			"Cpu lanes are initialized",
+			"Invalid cpu lane count",
+			"Invalid cpu lane",
+			"Cpu lanes are uninitialized",
+			"Unsupported cpu lanes mapper",
+			};
+
+		#define NES_CPU_LANES_EXCEPTION_STRING(_TYPE_) \
+			((_TYPE_) > NES_CPU_LANES_EXCEPTION_MAX ? EXCEPTION_UNKNOWN : \
+			CHECK_STR(NES_CPU_LANES_EXCEPTION_STR[_TYPE_]))
+
+		#define THROW_NES_CPU_LANES_EXCEPTION(_EXCEPT_) \
+			THROW_EXCEPTION(NES_CPU_LANES_EXCEPTION_HEADER, \
+			NES_CPU_LANES_EXCEPTION_STRING(_EXCEPT_))
+		#define THROW_NES_CPU_LANES_EXCEPTION_MESSAGE(_EXCEPT_, _FORMAT_, ...) \
+			THROW_EXCEPTION_MESSAGE(NES_CPU_LANES_EXCEPTION_HEADER, \
+			NES_CPU_LANES_EXCEPTION_STRING(_EXCEPT_), _FORMAT_, __VA_ARGS__)
+
+		class _nes_cpu_lanes;
+		typedef _nes_cpu_lanes nes_cpu_lanes, *nes_cpu_lanes_ptr;
+	}
+}
+
+#endif // NES_CPU_LANES_TYPE_H_
@@ -41,6 +41,8 @@ namespace NES {
 		#define CPU_INTERRUPT_IRQ_ADDRESS 0xfffe
 		#define CPU_INTERRUPT_NMI_ADDRESS 0xfffa
 		#define CPU_INTERRUPT_RESET_ADDRESS 0xfffc
+		#define CPU_MASTER_DIVIDER 12
+		#define CPU_RAM_LENGTH 0x800
 		#define CPU_REGISTER_A_INIT 0
 		#define CPU_REGISTER_P_INIT \
 			(CPU_FLAG_INTERRUPT_DISABLED | CPU_FLAG_ZERO)
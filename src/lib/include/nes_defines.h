@@ -20,15 +20,23 @@
 #ifndef NES_DEFINES_H_
 #define NES_DEFINES_H_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdbool>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace NES {
@@ -82,6 +90,8 @@ namespace NES {
 		_ATOMIC_CALL(std::mutex, _MUTEX_)
 	#define ATOMIC_CALL_RECUR(_MUTEX_) \
 		_ATOMIC_CALL(std::recursive_mutex, _MUTEX_)
+	#define SESSION_CALL(_SESSION_) \
+		std::lock_guard<_nes> __SESSION(_SESSION_)
 
 	#define _CONCAT_STR(_STR_) # _STR_
 	#define CONCAT_STR(_STR_) _CONCAT_STR(_STR_)
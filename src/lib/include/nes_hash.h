@@ -0,0 +1,99 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_HASH_H_
+#define NES_HASH_H_
+
+namespace NES {
+
+	#define HASH_CRC32_SEED_DEFAULT 0
+	#define HASH_LANES 8
+	#define HASH_SEED_DEFAULT 0
+	#define HASH_SHA1_LEN 20
+
+	typedef class _nes_hash {
+
+		public:
+
+			static uint32_t crc32(
+				__in const void *data,
+				__in size_t length,
+				__in_opt uint32_t seed = HASH_CRC32_SEED_DEFAULT
+				);
+
+			static uint64_t generate(
+				__in const void *data,
+				__in size_t length,
+				__in_opt uint64_t seed = HASH_SEED_DEFAULT
+				);
+
+			static void sha1(
+				__in const void *data,
+				__in size_t length,
+				__out uint8_t *digest
+				);
+
+		protected:
+
+			_nes_hash(void);
+
+			_nes_hash(
+				__in const _nes_hash &other
+				);
+
+			_nes_hash &operator=(
+				__in const _nes_hash &other
+				);
+
+			static void accumulate(
+				__inout uint64_t *accumulator,
+				__in const uint8_t *data,
+				__in const uint8_t *key
+				);
+
+			static uint64_t avalanche(
+				__in uint64_t value
+				);
+
+			static void crc32_generate(
+				__out uint32_t *table
+				);
+
+			static const uint32_t *crc32_table(void);
+
+			static uint64_t mix(
+				__in uint64_t value,
+				__in uint64_t other
+				);
+
+			static void scramble(
+				__inout uint64_t *accumulator,
+				__in const uint8_t *key
+				);
+
+			static void sha1_blocks(
+				__inout uint32_t *state,
+				__in const uint8_t *data,
+				__in size_t blocks
+				);
+
+	} nes_hash, *nes_hash_ptr;
+}
+
+#endif // NES_HASH_H_
@@ -0,0 +1,370 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_MAPPER_H_
+#define NES_MAPPER_H_
+
+namespace NES {
+
+	namespace COMP {
+
+		typedef enum {
+			NES_MAPPER_NROM = 0,
+			NES_MAPPER_MMC1,
+			NES_MAPPER_UXROM,
+			NES_MAPPER_CNROM,
+			NES_MAPPER_MMC3,
+			NES_MAPPER_AXROM = 7,
+		} nes_mapper_t;
+
+		typedef enum {
+			NES_MAPPER_MIRRORING_HORZ = ROM_MIRRORING_HORZ,
+			NES_MAPPER_MIRRORING_VERT = ROM_MIRRORING_VERT,
+			NES_MAPPER_MIRRORING_FOUR_SCREEN = ROM_MIRRORING_FOUR_SCREEN,
+			NES_MAPPER_MIRRORING_SINGLE_LOW,
+			NES_MAPPER_MIRRORING_SINGLE_HIGH,
+		} nes_mapper_mirroring_t;
+
+		#define NES_MAPPER_MIRRORING_MAX NES_MAPPER_MIRRORING_SINGLE_HIGH
+
+		#define NES_MAPPER_CHARACTER_PAGES 8
+		#define NES_MAPPER_MMC1_REGISTERS 4
+		#define NES_MAPPER_MMC3_REGISTERS 8
+		#define NES_MAPPER_NAMETABLE_PAGES 4
+		#define NES_MAPPER_PROGRAM_PAGES 4
+		#define NES_MAPPER_SNAPSHOT_REGISTERS 16
+
+		typedef struct {
+			uint32_t character[NES_MAPPER_CHARACTER_PAGES];	// character page offsets
+			uint8_t irq;				// irq pending
+			uint8_t mirroring;			// nametable mirroring
+			uint32_t nametable[NES_MAPPER_NAMETABLE_PAGES];	// nametable page offsets
+			uint32_t program[NES_MAPPER_PROGRAM_PAGES];	// program page offsets
+			uint8_t ram_enabled;			// program ram enabled
+			uint8_t registers[NES_MAPPER_SNAPSHOT_REGISTERS];	// mapper registers
+		} nes_mapper_snapshot;
+
+		typedef class _nes_mapper {
+
+			public:
+
+				virtual ~_nes_mapper(void);
+
+				static _nes_mapper *create(
+					__in nes_rom &rom,
+					__in uint8_t *nametable
+					);
+
+				bool irq_pending(void);
+
+				virtual uint32_t irq_scanlines(void);
+
+				uint16_t mapper(void);
+
+				nes_mapper_mirroring_t mirroring(void);
+
+				uint8_t read_cpu(
+					__in uint16_t address
+					);
+
+				uint8_t read_ppu(
+					__in uint16_t address
+					);
+
+				virtual void reset(void);
+
+				virtual void restore(
+					__in const nes_mapper_snapshot &snapshot
+					);
+
+				virtual void scanline(
+					__in uint32_t count
+					);
+
+				virtual void snapshot(
+					__out nes_mapper_snapshot &snapshot
+					);
+
+				std::string to_string(
+					__in_opt bool verbose = false
+					);
+
+				void write_cpu(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+				void write_ppu(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+			protected:
+
+				_nes_mapper(
+					__in nes_rom &rom,
+					__in uint8_t *nametable
+					);
+
+				_nes_mapper(
+					__in const _nes_mapper &other
+					);
+
+				_nes_mapper &operator=(
+					__in const _nes_mapper &other
+					);
+
+				void map_character(
+					__in uint8_t page,
+					__in uint8_t count,
+					__in int32_t bank
+					);
+
+				void map_mirroring(
+					__in nes_mapper_mirroring_t mirroring
+					);
+
+				void map_program(
+					__in uint8_t page,
+					__in uint8_t count,
+					__in int32_t bank
+					);
+
+				static uint32_t page_offset(
+					__in const uint8_t *base,
+					__in const uint8_t *page
+					);
+
+				static const uint8_t *page_pointer(
+					__in const uint8_t *base,
+					__in size_t length,
+					__in size_t page_length,
+					__in uint32_t offset
+					);
+
+				virtual void write_register(
+					__in uint16_t address,
+					__in uint8_t value
+					) = 0;
+
+				uint8_t *m_character[NES_MAPPER_CHARACTER_PAGES];
+
+				uint8_t *m_character_data;
+
+				size_t m_character_length;
+
+				bool m_character_writable;
+
+				nes_rom_descriptor m_descriptor;
+
+				nes_rom_image_ref m_image;
+
+				bool m_irq;
+
+				nes_mapper_mirroring_t m_mirroring;
+
+				uint8_t *m_nametable[NES_MAPPER_NAMETABLE_PAGES];
+
+				uint8_t *m_nametable_base;
+
+				const uint8_t *m_program[NES_MAPPER_PROGRAM_PAGES];
+
+				const uint8_t *m_program_data;
+
+				size_t m_program_length;
+
+				uint8_t *m_ram;
+
+				bool m_ram_enabled;
+
+				size_t m_ram_length;
+
+		} nes_mapper, *nes_mapper_ptr;
+
+		typedef class _nes_mapper_axrom :
+				public _nes_mapper {
+
+			public:
+
+				_nes_mapper_axrom(
+					__in nes_rom &rom,
+					__in uint8_t *nametable
+					);
+
+				virtual void reset(void);
+
+			protected:
+
+				virtual void write_register(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+		} nes_mapper_axrom, *nes_mapper_axrom_ptr;
+
+		typedef class _nes_mapper_cnrom :
+				public _nes_mapper {
+
+			public:
+
+				_nes_mapper_cnrom(
+					__in nes_rom &rom,
+					__in uint8_t *nametable
+					);
+
+				virtual void reset(void);
+
+			protected:
+
+				virtual void write_register(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+		} nes_mapper_cnrom, *nes_mapper_cnrom_ptr;
+
+		typedef class _nes_mapper_mmc1 :
+				public _nes_mapper {
+
+			public:
+
+				_nes_mapper_mmc1(
+					__in nes_rom &rom,
+					__in uint8_t *nametable
+					);
+
+				virtual void reset(void);
+
+				virtual void restore(
+					__in const nes_mapper_snapshot &snapshot
+					);
+
+				virtual void snapshot(
+					__out nes_mapper_snapshot &snapshot
+					);
+
+			protected:
+
+				void update(void);
+
+				virtual void write_register(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+				uint8_t m_register[NES_MAPPER_MMC1_REGISTERS];
+
+				uint8_t m_shift;
+
+		} nes_mapper_mmc1, *nes_mapper_mmc1_ptr;
+
+		typedef class _nes_mapper_mmc3 :
+				public _nes_mapper {
+
+			public:
+
+				_nes_mapper_mmc3(
+					__in nes_rom &rom,
+					__in uint8_t *nametable
+					);
+
+				virtual uint32_t irq_scanlines(void);
+
+				virtual void reset(void);
+
+				virtual void restore(
+					__in const nes_mapper_snapshot &snapshot
+					);
+
+				virtual void scanline(
+					__in uint32_t count
+					);
+
+				virtual void snapshot(
+					__out nes_mapper_snapshot &snapshot
+					);
+
+			protected:
+
+				void update(void);
+
+				virtual void write_register(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+				uint8_t m_bank_select;
+
+				uint8_t m_irq_counter;
+
+				bool m_irq_enabled;
+
+				uint8_t m_irq_latch;
+
+				bool m_irq_reload;
+
+				uint8_t m_register[NES_MAPPER_MMC3_REGISTERS];
+
+		} nes_mapper_mmc3, *nes_mapper_mmc3_ptr;
+
+		typedef class _nes_mapper_nrom :
+				public _nes_mapper {
+
+			public:
+
+				_nes_mapper_nrom(
+					__in nes_rom &rom,
+					__in uint8_t *nametable
+					);
+
+				virtual void reset(void);
+
+			protected:
+
+				virtual void write_register(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+		} nes_mapper_nrom, *nes_mapper_nrom_ptr;
+
+		typedef class _nes_mapper_uxrom :
+				public _nes_mapper {
+
+			public:
+
+				_nes_mapper_uxrom(
+					__in nes_rom &rom,
+					__in uint8_t *nametable
+					);
+
+				virtual void reset(void);
+
+			protected:
+
+				virtual void write_register(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
+		} nes_mapper_uxrom, *nes_mapper_uxrom_ptr;
+	}
+}
+
+#endif // NES_MAPPER_H_
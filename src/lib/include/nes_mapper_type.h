@@ -0,0 +1,139 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_MAPPER_TYPE_H_
+#define NES_MAPPER_TYPE_H_
+
+#include "nes_type.h"
+
+namespace NES {
+
+	namespace COMP {
+
+		#define MAPPER_AXROM_BANK 0x7
+		#define MAPPER_AXROM_MIRRORING 0x10
+		#define MAPPER_CHARACTER_BANK_2KB 2
+		#define MAPPER_CHARACTER_BANK_4KB 4
+		#define MAPPER_CHARACTER_MAX 0x1fff
+		#define MAPPER_CHARACTER_PAGE_LEN 0x400
+		#define MAPPER_CHARACTER_PAGE_SHIFT 10
+		#define MAPPER_CPU_BASE 0x4020
+		#define MAPPER_MMC1_CONTROL_CHARACTER 0x10
+		#define MAPPER_MMC1_CONTROL_MIRRORING 0x3
+		#define MAPPER_MMC1_CONTROL_PROGRAM 0xc
+		#define MAPPER_MMC1_CONTROL_PROGRAM_SHIFT 2
+		#define MAPPER_MMC1_PROGRAM_BANK 0xf
+		#define MAPPER_MMC1_PROGRAM_RAM_DISABLE 0x10
+		#define MAPPER_MMC1_REGISTER_SHIFT 13
+		#define MAPPER_MMC1_RESET 0x80
+		#define MAPPER_MMC1_SHIFT 0x10
+		#define MAPPER_MMC1_SHIFT_LENGTH 4
+		#define MAPPER_MMC3_BANK_CHARACTER_INVERT 0x80
+		#define MAPPER_MMC3_BANK_PROGRAM 0x3f
+		#define MAPPER_MMC3_BANK_PROGRAM_SWAP 0x40
+		#define MAPPER_MMC3_BANK_SELECT 0x7
+		#define MAPPER_MMC3_MIRRORING_HORZ 0x1
+		#define MAPPER_MMC3_PROGRAM_RAM_ENABLE 0x80
+		#define MAPPER_MMC3_REGISTER_MASK 0xe001
+		#define MAPPER_NAMETABLE_BASE 0x2000
+		#define MAPPER_NAMETABLE_END 0x3f00
+		#define MAPPER_NAMETABLE_LEN 0x400
+		#define MAPPER_NAMETABLE_SHIFT 10
+		#define MAPPER_PROGRAM_BANK_16KB 2
+		#define MAPPER_PROGRAM_BASE 0x8000
+		#define MAPPER_PROGRAM_PAGE_LEN 0x2000
+		#define MAPPER_PROGRAM_PAGE_SHIFT 13
+		#define MAPPER_RAM_BASE 0x6000
+		#define MAPPER_SNAPSHOT_UNMAPPED UINT32_MAX
+
+		enum {
+			MAPPER_MMC1_REGISTER_CONTROL = 0,
+			MAPPER_MMC1_REGISTER_CHARACTER_0,
+			MAPPER_MMC1_REGISTER_CHARACTER_1,
+			MAPPER_MMC1_REGISTER_PROGRAM,
+		};
+
+		enum {
+			MAPPER_MMC1_MIRRORING_SINGLE_LOW = 0,
+			MAPPER_MMC1_MIRRORING_SINGLE_HIGH,
+			MAPPER_MMC1_MIRRORING_VERT,
+			MAPPER_MMC1_MIRRORING_HORZ,
+		};
+
+		enum {
+			MAPPER_MMC1_PROGRAM_SWITCH_32KB = 0,
+			MAPPER_MMC1_PROGRAM_SWITCH_32KB_ALT,
+			MAPPER_MMC1_PROGRAM_FIX_FIRST,
+			MAPPER_MMC1_PROGRAM_FIX_LAST,
+		};
+
+		enum {
+			MAPPER_MMC3_REGISTER_BANK_SELECT = 0x8000,
+			MAPPER_MMC3_REGISTER_BANK_DATA = 0x8001,
+			MAPPER_MMC3_REGISTER_MIRRORING = 0xa000,
+			MAPPER_MMC3_REGISTER_PROGRAM_RAM = 0xa001,
+			MAPPER_MMC3_REGISTER_IRQ_LATCH = 0xc000,
+			MAPPER_MMC3_REGISTER_IRQ_RELOAD = 0xc001,
+			MAPPER_MMC3_REGISTER_IRQ_DISABLE = 0xe000,
+			MAPPER_MMC3_REGISTER_IRQ_ENABLE = 0xe001,
+		};
+
+		#define NES_MAPPER_HEADER NES_HEADER "::MAPPER"
+
+		#ifndef NDEBUG
+		#define NES_MAPPER_EXCEPTION_HEADER NES_MAPPER_HEADER
+		#else
+		#define NES_MAPPER_EXCEPTION_HEADER EXCEPTION_HEADER
+		#endif // NDEBUG
+
+		enum {
+			NES_MAPPER_EXCEPTION_ALLOCATED = 0,
+			NES_MAPPER_EXCEPTION_INVALID_ADDRESS,
+			NES_MAPPER_EXCEPTION_INVALID_MIRRORING,
+			NES_MAPPER_EXCEPTION_INVALID_SNAPSHOT,
+			NES_MAPPER_EXCEPTION_UNSUPPORTED,
+		};
+
+		#define NES_MAPPER_EXCEPTION_MAX NES_MAPPER_EXCEPTION_UNSUPPORTED
+
+		static const std::string NES_MAPPER_EXCEPTION_STR[] = {
+			"Failed to allocate mapper",
+			"Invalid mapper address",
+			"Invalid mapper mirroring",
+			"Invalid mapper snapshot",
+			"Mapper is unsupported",
+			};
+
+		#define NES_MAPPER_EXCEPTION_STRING(_TYPE_) \
+			((_TYPE_) > NES_MAPPER_EXCEPTION_MAX ? EXCEPTION_UNKNOWN : \
+			CHECK_STR(NES_MAPPER_EXCEPTION_STR[_TYPE_]))
+
+		#define THROW_NES_MAPPER_EXCEPTION(_EXCEPT_) \
+			THROW_EXCEPTION(NES_MAPPER_EXCEPTION_HEADER, \
+			NES_MAPPER_EXCEPTION_STRING(_EXCEPT_))
+		#define THROW_NES_MAPPER_EXCEPTION_MESSAGE(_EXCEPT_, _FORMAT_, ...) \
+			THROW_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_HEADER, \
+			NES_MAPPER_EXCEPTION_STRING(_EXCEPT_), _FORMAT_, __VA_ARGS__)
+
+		class _nes_mapper;
+		typedef _nes_mapper nes_mapper, *nes_mapper_ptr;
+	}
+}
+
+#endif // NES_MAPPER_TYPE_H_
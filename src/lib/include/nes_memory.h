@@ -72,6 +72,8 @@ namespace NES {
 					__in nes_memory_t type
 					);
 
+				static _nes_memory *create(void);
+
 				static std::string flag_as_string(
 					__in uint8_t flag,
 					__in_opt bool verbose = false
@@ -147,10 +149,6 @@ namespace NES {
 
 				nes_memory_block m_mmu, m_ppu, m_ppu_oam;
 
-			private:
-
-				std::recursive_mutex m_lock;
-
 		} nes_memory, *nes_memory_ptr;
 	}
 }
@@ -0,0 +1,218 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NES_POOL_H_
+#define NES_POOL_H_
+
+namespace NES {
+
+	typedef enum {
+		NES_POOL_STATUS_FRAME = 0,		// frame stepped (dropped when the queue is full)
+		NES_POOL_STATUS_DONE,			// budget exhausted (never dropped)
+		NES_POOL_STATUS_ERROR,			// step failed (never dropped)
+	} nes_pool_status_t;
+
+	#define NES_POOL_STATUS_MAX NES_POOL_STATUS_ERROR
+
+	#define NES_POOL_QUEUE_CAPACITY_DEFAULT 0x400
+
+	typedef struct {
+		uint64_t frame;				// frame completed
+		size_t handle;				// session handle
+		uint32_t remaining;			// frames left in budget
+		nes_pool_status_t status;		// completion status
+		size_t worker;				// worker index
+	} nes_pool_completion;
+
+	typedef class _nes_pool_queue {
+
+		public:
+
+			_nes_pool_queue(
+				__in size_t capacity
+				);
+
+			~_nes_pool_queue(void);
+
+			size_t capacity(void);
+
+			bool pop(
+				__out nes_pool_completion &completion
+				);
+
+			bool push(
+				__in const nes_pool_completion &completion
+				);
+
+			size_t size(void);
+
+		protected:
+
+			_nes_pool_queue(
+				__in const _nes_pool_queue &other
+				);
+
+			_nes_pool_queue &operator=(
+				__in const _nes_pool_queue &other
+				);
+
+			std::vector<nes_pool_completion> m_completion;
+
+			std::atomic<size_t> m_head;
+
+			size_t m_mask;
+
+			std::vector<std::atomic<size_t>> m_sequence;
+
+			std::atomic<size_t> m_tail;
+
+	} nes_pool_queue, *nes_pool_queue_ptr;
+
+	typedef struct {
+		std::atomic<uint32_t> budget;
+		size_t handle;
+		std::atomic<bool> scheduled;
+		nes_ptr session;
+	} nes_pool_session;
+
+	typedef struct {
+		std::mutex lock;
+		std::deque<nes_pool_session *> queue;
+		std::thread thread;
+	} nes_pool_worker;
+
+	typedef class _nes_pool {
+
+		public:
+
+			_nes_pool(void);
+
+			~_nes_pool(void);
+
+			size_t add(
+				__in nes_ptr session
+				);
+
+			uint32_t budget(
+				__in size_t handle
+				);
+
+			size_t dropped(void);
+
+			void initialize(
+				__in_opt size_t workers = 0,
+				__in_opt bool affinity = false,
+				__in_opt size_t capacity = NES_POOL_QUEUE_CAPACITY_DEFAULT
+				);
+
+			bool is_initialized(void);
+
+			bool poll(
+				__out nes_pool_completion &completion
+				);
+
+			void run(
+				__in size_t handle,
+				__in uint32_t frames
+				);
+
+			size_t sessions(void);
+
+			std::string to_string(
+				__in_opt bool verbose = false
+				);
+
+			void uninitialize(void);
+
+			void wait(void);
+
+			size_t workers(void);
+
+		protected:
+
+#ifndef NDEBUG
+			friend class NES::TEST::_nes_test_pool;
+#endif // NDEBUG
+
+			_nes_pool(
+				__in const _nes_pool &other
+				);
+
+			_nes_pool &operator=(
+				__in const _nes_pool &other
+				);
+
+			bool dequeue(
+				__in size_t worker,
+				__out nes_pool_session *&session
+				);
+
+			void enqueue(
+				__in size_t worker,
+				__in nes_pool_session *session
+				);
+
+			void execute(
+				__in size_t worker,
+				__in nes_pool_session *session
+				);
+
+			void work(
+				__in size_t index
+				);
+
+			std::atomic<size_t> m_active;
+
+			bool m_affinity;
+
+			nes_pool_queue *m_completion;
+
+			std::atomic<size_t> m_dropped;
+
+			std::condition_variable m_idle;
+
+			bool m_initialized;
+
+			std::atomic<size_t> m_next;
+
+			std::deque<nes_pool_completion> m_overflow;
+
+			std::mutex m_overflow_lock;
+
+			std::atomic<size_t> m_queued;
+
+			std::vector<nes_pool_session *> m_sessions;
+
+			std::condition_variable m_signal;
+
+			std::mutex m_signal_lock;
+
+			std::atomic<bool> m_stop;
+
+			std::vector<nes_pool_worker *> m_workers;
+
+		private:
+
+			std::recursive_mutex m_lock;
+
+	} nes_pool, *nes_pool_ptr;
+}
+
+#endif // NES_POOL_H_
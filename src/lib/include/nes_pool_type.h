@@ -0,0 +1,80 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NES_POOL_TYPE_H_
+#define NES_POOL_TYPE_H_
+
+#include "nes_type.h"
+
+namespace NES {
+
+	#define POOL_QUEUE_CAPACITY_MIN 2
+	#define POOL_WORKERS_DEFAULT 1
+
+	#define NES_POOL_HEADER NES_HEADER "::POOL"
+
+	#ifndef NDEBUG
+	#define NES_POOL_EXCEPTION_HEADER NES_POOL_HEADER
+	#else
+	#define NES_POOL_EXCEPTION_HEADER EXCEPTION_HEADER
+	#endif // NDEBUG
+
+	enum {
+		NES_POOL_EXCEPTION_ALLOCATED = 0,
+		NES_POOL_EXCEPTION_INITIALIZED,
+		NES_POOL_EXCEPTION_INVALID_HANDLE,
+		NES_POOL_EXCEPTION_INVALID_SESSION,
+		NES_POOL_EXCEPTION_UNINITIALIZED,
+	};
+
+	#define NES_POOL_EXCEPTION_MAX NES_POOL_EXCEPTION_UNINITIALIZED
+
+	static const std::string NES_POOL_EXCEPTION_STR[] = {
+		"Failed to allocate pool",
+		"Pool is initialized",
+		"Invalid pool handle",
+		"Invalid pool session",
+		"Pool is uninitialized",
+		};
+
+	#define NES_POOL_EXCEPTION_STRING(_TYPE_) \
+		((_TYPE_) > NES_POOL_EXCEPTION_MAX ? EXCEPTION_UNKNOWN : \
+		CHECK_STR(NES_POOL_EXCEPTION_STR[_TYPE_]))
+
+	#define THROW_NES_POOL_EXCEPTION(_EXCEPT_) \
+		THROW_EXCEPTION(NES_POOL_EXCEPTION_HEADER, \
+		NES_POOL_EXCEPTION_STRING(_EXCEPT_))
+	#define THROW_NES_POOL_EXCEPTION_MESSAGE(_EXCEPT_, _FORMAT_, ...) \
+		THROW_EXCEPTION_MESSAGE(NES_POOL_EXCEPTION_HEADER, \
+		NES_POOL_EXCEPTION_STRING(_EXCEPT_), _FORMAT_, __VA_ARGS__)
+
+	static const std::string NES_POOL_STATUS_STR[] = {
+		"frame", "done", "error",
+		};
+
+	#define NES_POOL_STATUS_STRING(_TYPE_) \
+		((_TYPE_) > NES_POOL_STATUS_MAX ? UNKNOWN : \
+		CHECK_STR(NES_POOL_STATUS_STR[_TYPE_]))
+
+	class _nes_pool;
+	typedef _nes_pool nes_pool, *nes_pool_ptr;
+}
+
+#endif // NES_POOL_TYPE_H_
@@ -24,6 +24,143 @@ namespace NES {
 
 	namespace COMP {
 
+		typedef enum {
+			NES_PPU_HASH_NONE = 0,
+			NES_PPU_HASH_FRAME = 0x1,
+			NES_PPU_HASH_RAM = 0x2,
+		} nes_ppu_hash_t;
+
+		#define NES_PPU_HASH_MASK (NES_PPU_HASH_FRAME | NES_PPU_HASH_RAM)
+
+		typedef enum {
+			NES_PPU_PIPELINE_NONE = 0,
+			NES_PPU_PIPELINE_BLOCK,
+			NES_PPU_PIPELINE_DROP,
+		} nes_ppu_pipeline_t;
+
+		#define NES_PPU_PIPELINE_CAPACITY_DEFAULT 8
+		#define NES_PPU_PIPELINE_MAX NES_PPU_PIPELINE_DROP
+
+		typedef enum {
+			NES_PPU_SYNC_LAZY = 0,
+			NES_PPU_SYNC_LOCKSTEP,
+			NES_PPU_SYNC_VALIDATE,
+		} nes_ppu_sync_t;
+
+		#define NES_PPU_SYNC_MAX NES_PPU_SYNC_VALIDATE
+
+		typedef struct {
+			uint16_t address;
+			uint16_t address_temp;
+			uint8_t buffer;
+			uint8_t bus;
+			uint8_t control;
+			uint16_t dot;
+			uint8_t fine_x;
+			uint64_t frame;
+			bool latch;
+			uint8_t mask;
+			bool nmi;
+			uint8_t oam_address;
+			bool odd;
+			uint16_t scanline;
+			uint8_t status;
+		} nes_ppu_state;
+
+		typedef struct {
+			uint64_t cycles;			// elapsed cycles
+			uint64_t master;			// master clock
+			nes_ppu_state state;			// register and timing state
+		} nes_ppu_snapshot;
+
+		typedef struct {
+			uint64_t frame;				// frame index after the completed frames
+			uint32_t frames;			// frames completed since the previous publish
+			uint32_t hash;				// hash flags (see NES_PPU_HASH_*)
+			std::vector<uint8_t> pixels;		// framebuffer copy
+			std::vector<uint8_t> ram;		// cpu ram copy (when hashing ram)
+		} nes_ppu_frame;
+
+		typedef std::function<void(const nes_ppu_frame &)> nes_ppu_output;
+
+		typedef class _nes_ppu_pipeline {
+
+			public:
+
+				_nes_ppu_pipeline(void);
+
+				~_nes_ppu_pipeline(void);
+
+				size_t capacity(void);
+
+				void commit(void);
+
+				uint64_t consumed(void);
+
+				uint64_t dropped(void);
+
+				void flush(void);
+
+				bool is_active(void);
+
+				bool is_failed(void);
+
+				nes_ppu_frame *reserve(void);
+
+				size_t size(void);
+
+				void start(
+					__in nes_ppu_pipeline_t type,
+					__in size_t capacity,
+					__in const nes_ppu_output &consumer
+					);
+
+				void stop(void);
+
+			protected:
+
+				_nes_ppu_pipeline(
+					__in const _nes_ppu_pipeline &other
+					);
+
+				_nes_ppu_pipeline &operator=(
+					__in const _nes_ppu_pipeline &other
+					);
+
+				void run(void);
+
+				std::atomic<bool> m_active;
+
+				std::condition_variable m_condition;
+
+				nes_ppu_output m_consumer;
+
+				std::atomic<uint64_t> m_dropped;
+
+				std::atomic<bool> m_failed;
+
+				std::atomic<size_t> m_head;
+
+				std::atomic<bool> m_idle;
+
+				size_t m_mask;
+
+				std::vector<nes_ppu_frame> m_slot;
+
+				std::atomic<size_t> m_tail;
+
+				std::thread m_thread;
+
+				nes_ppu_pipeline_t m_type;
+
+				std::atomic<size_t> m_waiting;
+
+			private:
+
+				std::mutex m_lock;
+
+		} nes_ppu_pipeline, *nes_ppu_pipeline_ptr;
+
 		typedef class _nes_ppu {
 
 			public:
@@ -38,7 +175,22 @@ namespace NES {
 					__in nes_memory_t type
 					);
 
-				uint32_t cycles(void);
+				static _nes_ppu *create(
+					__in nes_memory_ptr memory
+					);
+
+				uint64_t cycles(void);
+
+				uint64_t frame(void);
+
+				const std::vector<uint8_t> &frame_buffer(void);
+
+				uint64_t hash(
+					__out uint64_t &frame,
+					__out uint64_t &ram
+					);
+
+				uint32_t hash_flags(void);
 
 				void initialize(void);
 
@@ -48,23 +200,83 @@ namespace NES {
 
 				bool is_started(void);
 
+				nes_mapper_ptr mapper(void);
+
+				uint64_t master(void);
+
+				uint64_t next_event(void);
+
+				nes_ppu_pipeline &pipeline(void);
+
+				bool poll_nmi(void);
+
+				uint8_t read(
+					__in uint16_t address
+					);
+
+				void rebase(
+					__in uint64_t master
+					);
+
 				void reset(void);
 
+				void restore(
+					__in const nes_ppu_snapshot &snapshot,
+					__in_opt const uint8_t *frame = NULL
+					);
+
+				void set_hash(
+					__in uint32_t flags,
+					__in_opt const std::string &path = std::string()
+					);
+
+				void set_mapper(
+					__in nes_mapper_ptr mapper
+					);
+
+				void set_pipeline(
+					__in nes_ppu_pipeline_t type,
+					__in_opt size_t capacity = NES_PPU_PIPELINE_CAPACITY_DEFAULT,
+					__in_opt const nes_ppu_output &output = nes_ppu_output()
+					);
+
+				void set_sync(
+					__in nes_ppu_sync_t sync
+					);
+
+				void snapshot(
+					__out nes_ppu_snapshot &snapshot,
+					__out_opt uint8_t *frame = NULL
+					);
+
 				void start(void);
 
 				void step(void);
 
 				void stop(void);
 
+				nes_ppu_sync_t sync(void);
+
+				void synchronize(
+					__in uint64_t master
+					);
+
 				std::string to_string(
 					__in_opt bool verbose = false
 					);
 
 				void uninitialize(void);
 
+				void write(
+					__in uint16_t address,
+					__in uint8_t value
+					);
+
 			protected:
 
-				_nes_ppu(void);
+				_nes_ppu(
+					__in nes_memory_ptr memory
+					);
 
 				_nes_ppu(
 					__in const _nes_ppu &other
@@ -76,6 +288,41 @@ namespace NES {
 
 				static void _delete(void);
 
+				static uint32_t advance(
+					__inout nes_ppu_state &state,
+					__in uint64_t dots
+					);
+
+				static uint32_t advance_dot(
+					__inout nes_ppu_state &state
+					);
+
+				void clock_mapper(
+					__in uint64_t frame,
+					__in uint32_t position
+					);
+
+				static bool compare(
+					__in const nes_ppu_state &state,
+					__in const nes_ppu_state &other
+					);
+
+				static uint32_t frame_length(
+					__in const nes_ppu_state &state
+					);
+
+				void hash_record(
+					__in uint32_t flags,
+					__in const uint8_t *pixels,
+					__in const uint8_t *ram,
+					__in uint64_t frame,
+					__in uint32_t frames
+					);
+
+				void hash_update(
+					__in uint32_t frames
+					);
+
 				uint8_t load(
 					__in nes_memory_t type,
 					__in uint16_t address
@@ -86,6 +333,23 @@ namespace NES {
 					__in uint16_t address
 					);
 
+				static uint16_t mirror(
+					__in uint16_t address
+					);
+
+				void pipeline_consume(
+					__in const nes_ppu_frame &frame
+					);
+
+				static uint32_t scanline_clocks(
+					__in uint32_t position
+					);
+
+				uint64_t scanline_distance(
+					__in uint32_t position,
+					__in uint32_t clocks
+					);
+
 				void store(
 					__in nes_memory_t type,
 					__in uint16_t address,
@@ -102,19 +366,39 @@ namespace NES {
 				friend class NES::TEST::_nes_test_ppu;
 #endif // NDEBUG
 
-				uint32_t m_cycles;
+				uint64_t m_cycles;
+
+				std::vector<uint8_t> m_frame_buffer;
+
+				uint32_t m_hash;
+
+				uint64_t m_hash_frame;
+
+				uint64_t m_hash_index;
+
+				uint64_t m_hash_ram;
+
+				std::ofstream m_hash_stream;
 
 				bool m_initialized;
 
 				static _nes_ppu *m_instance;
 
+				nes_mapper_ptr m_mapper;
+
+				uint64_t m_master;
+
 				nes_memory_ptr m_memory;
 
+				nes_ppu_output m_output;
+
+				nes_ppu_pipeline m_pipeline;
+
 				bool m_started;
 
-			private:
+				nes_ppu_state m_state;
 
-				std::recursive_mutex m_lock;
+				nes_ppu_sync_t m_sync;
 
 		} nes_ppu, *nes_ppu_ptr;
 	}
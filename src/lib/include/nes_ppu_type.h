@@ -26,6 +26,52 @@ namespace NES {
 
 	namespace COMP {
 
+		#define PPU_CONTROL_INCREMENT 0x4
+		#define PPU_CONTROL_NMI 0x80
+		#define PPU_DOTS_PER_SCANLINE 341
+		#define PPU_DOT_MAPPER 260
+		#define PPU_DOT_VBLANK 1
+		#define PPU_FRAME_HEIGHT 240
+		#define PPU_FRAME_WIDTH 256
+		#define PPU_HASH_RAM_LENGTH 0x800
+		#define PPU_HASH_RECORD_LENGTH 4
+		#define PPU_INCREMENT_ACROSS 1
+		#define PPU_INCREMENT_DOWN 0x20
+		#define PPU_MAPPER_CLOCKS (PPU_FRAME_HEIGHT + 1)
+		#define PPU_MASK_RENDER (0x8 | 0x10)
+		#define PPU_MASTER_DIVIDER 4
+		#define PPU_OAM_DMA_CYCLES 513
+		#define PPU_PALETTE_BASE 0x3f00
+		#define PPU_PALETTE_MASK 0x1f
+		#define PPU_PIPELINE_CAPACITY_MIN 2
+		#define PPU_REGISTER_ADDRESS 6
+		#define PPU_REGISTER_BASE 0x2000
+		#define PPU_REGISTER_CONTROL 0
+		#define PPU_REGISTER_DATA 7
+		#define PPU_REGISTER_MASK 1
+		#define PPU_REGISTER_MAX 0x3fff
+		#define PPU_REGISTER_OAM_ADDRESS 3
+		#define PPU_REGISTER_OAM_DATA 4
+		#define PPU_REGISTER_OAM_DMA 0x4014
+		#define PPU_REGISTER_SCROLL 5
+		#define PPU_REGISTER_SELECT 0x7
+		#define PPU_REGISTER_STATUS 2
+		#define PPU_SCANLINES_PER_FRAME 262
+		#define PPU_SCANLINE_PRERENDER 261
+		#define PPU_SCANLINE_VBLANK 241
+		#define PPU_STATUS_VBLANK 0x80
+
+		#define PPU_POSITION(_SCANLINE_, _DOT_) \
+			(((_SCANLINE_) * PPU_DOTS_PER_SCANLINE) + (_DOT_))
+		#define PPU_POSITION_FRAME \
+			PPU_POSITION(PPU_SCANLINES_PER_FRAME, 0)
+		#define PPU_POSITION_MAPPER_PRERENDER \
+			PPU_POSITION(PPU_SCANLINE_PRERENDER, PPU_DOT_MAPPER)
+		#define PPU_POSITION_VBLANK_CLEAR \
+			PPU_POSITION(PPU_SCANLINE_PRERENDER, PPU_DOT_VBLANK)
+		#define PPU_POSITION_VBLANK_SET \
+			PPU_POSITION(PPU_SCANLINE_VBLANK, PPU_DOT_VBLANK)
+
 		#define NES_PPU_HEADER NES_HEADER "::PPU"
 
 		#ifndef NDEBUG
@@ -36,8 +82,15 @@ namespace NES {
 
 		enum {
 			NES_PPU_EXCEPTION_ALLOCATED = 0,
+			NES_PPU_EXCEPTION_DIVERGED,
+			NES_PPU_EXCEPTION_HASH_STREAM,
 			NES_PPU_EXCEPTION_INITIALIZED,
+			NES_PPU_EXCEPTION_INVALID_HASH,
+			NES_PPU_EXCEPTION_INVALID_PIPELINE,
+			NES_PPU_EXCEPTION_INVALID_SYNC,
 			NES_PPU_EXCEPTION_INVALID_TYPE,
+			NES_PPU_EXCEPTION_PIPELINE_CONSUMER,
+			NES_PPU_EXCEPTION_REGRESSED,
 			NES_PUU_EXCEPTION_STARTED,
 			NES_PUU_EXCEPTION_STOPPED,
 			NES_PPU_EXCEPTION_UNINITIALIZED,
@@ -47,8 +100,15 @@ namespace NES {
 
 		static const std::string NES_PPU_EXCEPTION_STR[] = {
 			"Failed to allocate ppu component",
+			"Ppu lazy catch-up diverged from lockstep",
+			"Failed to open ppu hash stream",
 			"Ppu component is initialized",
+			"Invalid ppu hash flags",
+			"Invalid ppu pipeline mode",
+			"Invalid ppu synchronization mode",
 			"Invalid memory type",
+			"Ppu pipeline consumer failed",
+			"Ppu master clock ran backwards",
 			"Ppu component is started",
 			"Ppu component is stopped",
 			"Ppu component is uninitialized",
@@ -0,0 +1,131 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_REWIND_H_
+#define NES_REWIND_H_
+
+namespace NES {
+
+	#define NES_REWIND_CAPACITY_DEFAULT 0x400000
+	#define NES_REWIND_INTERVAL_DEFAULT 4
+
+	typedef struct {
+		uint64_t frame;				// frame restored by the delta
+		size_t length;				// encoded delta length
+		size_t offset;				// encoded delta offset in ring
+	} nes_rewind_entry;
+
+	typedef class _nes_rewind {
+
+		public:
+
+			_nes_rewind(void);
+
+			~_nes_rewind(void);
+
+			size_t capacity(void);
+
+			void clear(void);
+
+			size_t count(void);
+
+			static void decode(
+				__in const uint8_t *delta,
+				__in size_t length,
+				__inout uint8_t *state,
+				__in size_t state_length
+				);
+
+			static size_t encode(
+				__in const uint8_t *previous,
+				__in const uint8_t *current,
+				__in size_t length,
+				__out uint8_t *delta
+				);
+
+			static size_t encode_bound(
+				__in size_t length
+				);
+
+			bool empty(void);
+
+			uint64_t frame(void);
+
+			void initialize(
+				__in_opt size_t capacity = NES_REWIND_CAPACITY_DEFAULT,
+				__in_opt uint32_t interval = NES_REWIND_INTERVAL_DEFAULT
+				);
+
+			uint32_t interval(void);
+
+			bool is_initialized(void);
+
+			bool pop(void);
+
+			void push(
+				__in uint64_t frame,
+				__inout std::vector<uint8_t> &snapshot
+				);
+
+			size_t size(void);
+
+			const std::vector<uint8_t> &snapshot(void);
+
+			std::string to_string(
+				__in_opt bool verbose = false
+				);
+
+			void uninitialize(void);
+
+		protected:
+
+			_nes_rewind(
+				__in const _nes_rewind &other
+				);
+
+			_nes_rewind &operator=(
+				__in const _nes_rewind &other
+				);
+
+			size_t reserve(
+				__in size_t length
+				);
+
+			std::vector<uint8_t> m_buffer;
+
+			std::deque<nes_rewind_entry> m_entry;
+
+			uint64_t m_frame;
+
+			size_t m_head;
+
+			bool m_initialized;
+
+			uint32_t m_interval;
+
+			std::vector<uint8_t> m_scratch;
+
+			size_t m_size;
+
+			std::vector<uint8_t> m_snapshot;
+
+	} nes_rewind, *nes_rewind_ptr;
+}
+
+#endif // NES_REWIND_H_
@@ -0,0 +1,76 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NES_REWIND_TYPE_H_
+#define NES_REWIND_TYPE_H_
+
+#include "nes_type.h"
+
+namespace NES {
+
+	#define REWIND_LEB_MASK 0x7f
+	#define REWIND_LEB_MORE 0x80
+	#define REWIND_LEB_SHIFT 7
+	#define REWIND_LITERAL_MAX 0x80
+	#define REWIND_TOKEN_RUN 0x80
+	#define REWIND_TOKEN_RUN_LONG 0xff
+	#define REWIND_TOKEN_RUN_MAX (REWIND_TOKEN_RUN_LONG - REWIND_TOKEN_RUN)
+
+	#define NES_REWIND_HEADER NES_HEADER "::REWIND"
+
+	#ifndef NDEBUG
+	#define NES_REWIND_EXCEPTION_HEADER NES_REWIND_HEADER
+	#else
+	#define NES_REWIND_EXCEPTION_HEADER EXCEPTION_HEADER
+	#endif // NDEBUG
+
+	enum {
+		NES_REWIND_EXCEPTION_INITIALIZED = 0,
+		NES_REWIND_EXCEPTION_INVALID_CAPACITY,
+		NES_REWIND_EXCEPTION_INVALID_DELTA,
+		NES_REWIND_EXCEPTION_INVALID_INTERVAL,
+		NES_REWIND_EXCEPTION_UNINITIALIZED,
+	};
+
+	#define NES_REWIND_EXCEPTION_MAX NES_REWIND_EXCEPTION_UNINITIALIZED
+
+	static const std::string NES_REWIND_EXCEPTION_STR[] = {
+		"Rewind is initialized",
+		"Invalid rewind capacity",
+		"Invalid rewind delta",
+		"Invalid rewind interval",
+		"Rewind is uninitialized",
+		};
+
+	#define NES_REWIND_EXCEPTION_STRING(_TYPE_) \
+		((_TYPE_) > NES_REWIND_EXCEPTION_MAX ? EXCEPTION_UNKNOWN : \
+		CHECK_STR(NES_REWIND_EXCEPTION_STR[_TYPE_]))
+
+	#define THROW_NES_REWIND_EXCEPTION(_EXCEPT_) \
+		THROW_EXCEPTION(NES_REWIND_EXCEPTION_HEADER, \
+		NES_REWIND_EXCEPTION_STRING(_EXCEPT_))
+	#define THROW_NES_REWIND_EXCEPTION_MESSAGE(_EXCEPT_, _FORMAT_, ...) \
+		THROW_EXCEPTION_MESSAGE(NES_REWIND_EXCEPTION_HEADER, \
+		NES_REWIND_EXCEPTION_STRING(_EXCEPT_), _FORMAT_, __VA_ARGS__)
+
+	class _nes_rewind;
+	typedef _nes_rewind nes_rewind, *nes_rewind_ptr;
+}
+
+#endif // NES_REWIND_TYPE_H_
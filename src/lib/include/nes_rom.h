@@ -24,6 +24,62 @@ namespace NES {
 
 	namespace COMP {
 
+		typedef class _nes_rom_image {
+
+			public:
+
+				_nes_rom_image(
+					__in const nes_memory_block &block
+					);
+
+				_nes_rom_image(
+					__inout nes_memory_block &&block
+					);
+
+				~_nes_rom_image(void);
+
+				const uint8_t *data(void) const;
+
+				bool is_mapped(void) const;
+
+				static std::shared_ptr<const _nes_rom_image> map(
+					__in const std::string &input
+					);
+
+				size_t size(void) const;
+
+			protected:
+
+				_nes_rom_image(void);
+
+				_nes_rom_image(
+					__in const _nes_rom_image &other
+					);
+
+				_nes_rom_image &operator=(
+					__in const _nes_rom_image &other
+					);
+
+				nes_memory_block m_block;
+
+				const uint8_t *m_data;
+
+				void *m_mapping;
+
+				size_t m_size;
+
+		} nes_rom_image, *nes_rom_image_ptr;
+
+		typedef std::shared_ptr<const nes_rom_image> nes_rom_image_ref;
+
+		typedef struct {
+			nes_rom_descriptor descriptor;
+			uint32_t fields;
+			nes_rom_hash hash;
+		} nes_rom_database_entry;
+
+		typedef std::multimap<uint32_t, nes_rom_database_entry> nes_rom_database;
+
 		typedef class _nes_rom {
 
 			public:
@@ -42,6 +98,21 @@ namespace NES {
 					__in size_t index
 					);
 
+				static _nes_rom *create(void);
+
+				const uint8_t *data_character(void);
+
+				const uint8_t *data_program(void);
+
+				const nes_rom_descriptor &descriptor(void);
+
+				static void descriptor_parse(
+					__in const nes_rom_header &header,
+					__out nes_rom_descriptor &descriptor
+					);
+
+				const nes_rom_hash &hash(void);
+
 				size_t header(
 					__out nes_rom_header &head
 					);
@@ -51,6 +122,8 @@ namespace NES {
 					__in_opt bool verbose = false
 					);
 
+				nes_rom_image_ref image(void);
+
 				void initialize(void);
 
 				static bool is_allocated(void);
@@ -59,14 +132,39 @@ namespace NES {
 
 				bool is_loaded(void);
 
+				std::string key(void);
+
 				void load(
 					__in const nes_memory_block &block
 					);
 
+				void load(
+					__inout nes_memory_block &&block
+					);
+
+				void load(
+					__in const nes_rom_image_ref &image
+					);
+
 				void load(
 					__in const std::string &input
 					);
 
+				nes_memory_block &ram_character(void);
+
+				nes_memory_block &ram_program(void);
+
+				static bool scan(
+					__in const uint8_t *data,
+					__in size_t length,
+					__out nes_rom_descriptor &descriptor,
+					__out nes_rom_hash &hash
+					);
+
+				void set_database(
+					__in_opt const std::string &path = std::string()
+					);
+
 				size_t size(void);
 
 				std::string to_string(
@@ -95,11 +193,50 @@ namespace NES {
 
 				static void _delete(void);
 
+				void attach(
+					__in const nes_rom_image_ref &image
+					);
+
+				bool database_apply(
+					__inout nes_rom_descriptor &descriptor,
+					__in const nes_rom_hash &hash
+					);
+
+				static bool database_parse(
+					__inout nes_rom_database_entry &entry,
+					__in const std::string &token
+					);
+
+				static bool database_value(
+					__in const std::string &value,
+					__in const std::string *names,
+					__in size_t count,
+					__out uint32_t &result
+					);
+
+				static size_t length_ram(
+					__in uint8_t shift
+					);
+
+				static size_t length_rom(
+					__in uint8_t low,
+					__in uint8_t high,
+					__in size_t unit
+					);
+
 				static bool validate(
 					__in const nes_rom_header &header
 					);
 
-				nes_memory_block m_block;
+				nes_rom_database m_database;
+
+				nes_rom_descriptor m_descriptor;
+
+				nes_rom_hash m_hash;
+
+				nes_rom_header m_header;
+
+				nes_rom_image_ref m_image;
 
 				bool m_initialized;
 
@@ -107,9 +244,9 @@ namespace NES {
 
 				bool m_loaded;
 
-			private:
+				nes_memory_block m_ram_character;
 
-				std::recursive_mutex m_lock;
+				nes_memory_block m_ram_program;
 
 		} nes_rom, *nes_rom_ptr;
 	}
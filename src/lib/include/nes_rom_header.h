@@ -24,6 +24,9 @@ namespace NES {
 
 	#define RAM_PROGRAM_LEN 0x2000
 	#define ROM_INES_2 2
+	#define ROM_INES_2_EXPONENT 0xf
+	#define ROM_INES_2_EXPONENT_MAX 0x1c
+	#define ROM_INES_2_RAM_LEN 0x40
 	#define ROM_INES_2_RES_LEN 2
 	#define ROM_INES_RES_LEN 5
 	#define ROM_MAGIC "\x4E\x45\x53\x1A"
@@ -33,6 +36,23 @@ namespace NES {
 	#define ROM_SIZE_MAX 0x1e84800 // 32MB
 	#define ROM_TRAINER_LEN 0x200
 
+	enum {
+		ROM_MIRRORING_HORZ = 0,
+		ROM_MIRRORING_VERT,
+		ROM_MIRRORING_FOUR_SCREEN,
+	};
+
+	#define ROM_MIRRORING_MAX ROM_MIRRORING_FOUR_SCREEN
+
+	enum {
+		ROM_TIMING_NTSC = 0,
+		ROM_TIMING_PAL,
+		ROM_TIMING_DUAL,
+		ROM_TIMING_DENDY,
+	};
+
+	#define ROM_TIMING_MAX ROM_TIMING_DENDY
+
 	enum {
 		FLAG_6_MIRRORING_HORZ = 0,
 		FLAG_6_MIRRORING_VERT,
@@ -146,6 +166,31 @@ namespace NES {
 			nes_rom_header_ines_2 ines_2;
 		} extension;
 	} nes_rom_header;
+
+	typedef struct {
+		bool battery;				// battery-backed prg ram present
+		size_t character_length;		// chr rom length (bytes)
+		size_t character_nvram_length;		// battery-backed chr ram length (bytes)
+		size_t character_offset;		// chr rom offset (bytes)
+		size_t character_ram_length;		// chr ram length (bytes)
+		bool corrected;				// header corrected from rom database
+		uint8_t format;				// rom format (1=ines, 2=ines2)
+		uint16_t mapper;			// mapper
+		uint8_t mapper_sub;			// submapper
+		uint8_t mirroring;			// mirroring (see ROM_MIRRORING_*)
+		size_t program_length;			// prg rom length (bytes)
+		size_t program_nvram_length;		// battery-backed prg ram length (bytes)
+		size_t program_offset;			// prg rom offset (bytes)
+		size_t program_ram_length;		// prg ram length (bytes)
+		uint8_t timing;				// tv system (see ROM_TIMING_*)
+		bool trainer;				// trainer present
+		size_t trainer_offset;			// trainer offset (bytes)
+	} nes_rom_descriptor;
+
+	typedef struct {
+		uint32_t crc32;				// crc32 of prg+chr rom
+		uint8_t sha1[HASH_SHA1_LEN];		// sha-1 of prg+chr rom
+	} nes_rom_hash;
 }
 
 #endif // NES_ROM_HEADER_H_
@@ -26,6 +26,41 @@ namespace NES {
 
 	namespace COMP {
 
+		#define ROM_DATABASE_COMMENT '#'
+		#define ROM_DATABASE_CRC32_LEN 8
+		#define ROM_DATABASE_SEPARATOR '='
+
+		enum {
+			ROM_DATABASE_KEY_BATTERY = 0,
+			ROM_DATABASE_KEY_CHARACTER_NVRAM,
+			ROM_DATABASE_KEY_CHARACTER_RAM,
+			ROM_DATABASE_KEY_CRC32,
+			ROM_DATABASE_KEY_MAPPER,
+			ROM_DATABASE_KEY_MAPPER_SUB,
+			ROM_DATABASE_KEY_MIRRORING,
+			ROM_DATABASE_KEY_PROGRAM_NVRAM,
+			ROM_DATABASE_KEY_PROGRAM_RAM,
+			ROM_DATABASE_KEY_SHA1,
+			ROM_DATABASE_KEY_TIMING,
+		};
+
+		#define ROM_DATABASE_KEY_MAX ROM_DATABASE_KEY_TIMING
+
+		static const std::string ROM_DATABASE_KEY_STR[] = {
+			"battery", "chr_nvram", "chr_ram", "crc32", "mapper", "submapper",
+			"mirroring", "prg_nvram", "prg_ram", "sha1", "timing",
+			};
+
+		#define ROM_DATABASE_FIELD(_KEY_) (1 << (_KEY_))
+
+		static const std::string ROM_MIRRORING_STR[] = {
+			"horz", "vert", "four",
+			};
+
+		static const std::string ROM_TIMING_STR[] = {
+			"ntsc", "pal", "dual", "dendy",
+			};
+
 		#define NES_ROM_HEADER NES_HEADER "::ROM"
 
 		#ifndef NDEBUG
@@ -36,10 +71,12 @@ namespace NES {
 
 		enum {
 			NES_ROM_EXCEPTION_ALLOCATED = 0,
+			NES_ROM_EXCEPTION_DATABASE,
 			NES_ROM_EXCEPTION_FILE_NOT_FOUND,
 			NES_ROM_EXCEPTION_INITIALIZED,
 			NES_ROM_EXCEPTION_INVALID_INDEX,
 			NES_ROM_EXCEPTION_MALFORMED,
+			NES_ROM_EXCEPTION_MAPPING,
 			NES_ROM_EXCEPTION_UNINITIALIZED,
 			NES_ROM_EXCEPTION_UNLOADED,
 			NES_ROM_EXCEPTION_UNSUPPORTED,
@@ -49,10 +86,12 @@ namespace NES {
 
 		static const std::string NES_ROM_EXCEPTION_STR[] = {
 			"Failed to allocate rom component",
+			"Rom database is malformed",
 			"File does not exist",
 			"Rom component is initialized",
 			"Invalid rom index",
 			"Rom is malformed",
+			"Failed to map rom file",
 			"Rom component is uninitialized",
 			"Rom component is unloaded",
 			"Rom format is unsupported",
@@ -47,6 +47,10 @@ namespace NES {
 					__in void *context
 					);
 
+				static nes_test_t create(
+					__in void *context
+					);
+
 				static nes_test_t cycles(
 					__in void *context
 					);
@@ -295,6 +299,10 @@ namespace NES {
 					__in void *context
 					);
 
+				static nes_test_t lanes(
+					__in void *context
+					);
+
 				static nes_test_t nmi(
 					__in void *context
 					);
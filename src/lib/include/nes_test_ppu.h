@@ -41,6 +41,10 @@ namespace NES {
 					__in void *context
 					);
 
+				static nes_test_t hash(
+					__in void *context
+					);
+
 				static nes_test_t initialize(
 					__in void *context
 					);
@@ -53,6 +57,10 @@ namespace NES {
 					__in void *context
 					);
 
+				static nes_test_t pipeline(
+					__in void *context
+					);
+
 				static nes_test_t reset(
 					__in void *context
 					);
@@ -71,6 +79,10 @@ namespace NES {
 					__in void *context
 					);
 
+				static nes_test_t synchronize(
+					__in void *context
+					);
+
 				static nes_test_t test_initialize(
 					__in void *context
 					);
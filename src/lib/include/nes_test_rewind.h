@@ -0,0 +1,46 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NDEBUG
+#ifndef NES_TEST_REWIND_H_
+#define NES_TEST_REWIND_H_
+
+namespace NES {
+
+	class _nes;
+
+	namespace TEST {
+
+		typedef class _nes_test_rewind {
+
+			public:
+
+				static nes_test_t ring(
+					__in void *context
+					);
+
+				static nes_test_set set_generate(void);
+
+		} nes_test_rewind, *nes_test_rewind_ptr;
+	}
+}
+
+#endif // NES_TEST_REWIND_H_
+#endif // NDEBUG
@@ -41,10 +41,26 @@ namespace NES {
 					__in void *context
 					);
 
+				static nes_test_t database(
+					__in void *context
+					);
+
+				static nes_test_t descriptor(
+					__in void *context
+					);
+
+				static nes_test_t hash(
+					__in void *context
+					);
+
 				static nes_test_t header(
 					__in void *context
 					);
 
+				static nes_test_t ines_2(
+					__in void *context
+					);
+
 				static nes_test_t initialize(
 					__in void *context
 					);
@@ -65,6 +81,25 @@ namespace NES {
 					__in void *context
 					);
 
+				static nes_test_t mapper(
+					__in void *context
+					);
+
+				static void mapper_image(
+					__out std::vector<uint8_t> &block,
+					__in uint16_t mapper,
+					__in uint8_t program,
+					__in uint8_t character
+					);
+
+				static nes_test_t mapper_irq(
+					__in void *context
+					);
+
+				static nes_test_t scan(
+					__in void *context
+					);
+
 				static nes_test_set set_generate(void);
 
 				static nes_test_t size(
@@ -0,0 +1,72 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NDEBUG
+#ifndef NES_TEST_SESSION_H_
+#define NES_TEST_SESSION_H_
+
+namespace NES {
+
+	class _nes;
+
+	namespace TEST {
+
+		typedef class _nes_test_session {
+
+			public:
+
+				static nes_test_t cycles(
+					__in void *context
+					);
+
+				static nes_test_t pacing(
+					__in void *context
+					);
+
+				static nes_test_t post(
+					__in void *context
+					);
+
+				static bool session_create(
+					__inout std::vector<_nes *> &sessions,
+					__in size_t count,
+					__in_opt bool load = true
+					);
+
+				static void session_destroy(
+					__inout std::vector<_nes *> &sessions
+					);
+
+				static nes_test_set set_generate(void);
+
+				static nes_test_t snapshot(
+					__in void *context
+					);
+
+				static nes_test_t wrap(
+					__in void *context
+					);
+
+		} nes_test_session, *nes_test_session_ptr;
+	}
+}
+
+#endif // NES_TEST_SESSION_H_
+#endif // NDEBUG
@@ -22,7 +22,20 @@
 
 namespace NES {
 
+	#define NES_FRAME_RATE_NTSC 60.0988
+	#define NES_FRAME_RATE_PAL 50.007
 	#define NES_HEADER "NES"
+	#define NES_RUN_PACING_MAX NES_RUN_PACING_REALTIME
+	#define NES_RUN_PACING_SPIN 1000000
+	#define NES_SNAPSHOT_ALIGN(_LEN_) \
+		(((_LEN_) + (NES_SNAPSHOT_ALIGNMENT - 1)) & ~(NES_SNAPSHOT_ALIGNMENT - 1))
+	#define NES_SNAPSHOT_ALIGNMENT 8
+	#define NES_SNAPSHOT_MAGIC 0x53454e4c
+	#define NES_SNAPSHOT_OAM_LENGTH 0x100
+	#define NES_SNAPSHOT_RAM_LENGTH 0x4020
+	#define NES_SNAPSHOT_VERSION 2
+	#define NES_SNAPSHOT_VRAM_BASE 0x2000
+	#define NES_SNAPSHOT_VRAM_LENGTH 0x2000
 
 	#ifndef NDEBUG
 	#define NES_EXCEPTION_HEADER NES_HEADER
@@ -33,15 +46,25 @@ namespace NES {
 	enum {
 		NES_EXCEPTION_ALLOCATED = 0,
 		NES_EXCEPTION_INITIALIZED,
+		NES_EXCEPTION_INVALID_PACING,
+		NES_EXCEPTION_INVALID_SNAPSHOT,
+		NES_EXCEPTION_RUNNING,
+		NES_EXCEPTION_SNAPSHOT_LENGTH,
 		NES_EXCEPTION_UNINITIALIZED,
+		NES_EXCEPTION_UNLOADED,
 	};
 
-	#define NES_EXCEPTION_MAX NES_EXCEPTION_UNINITIALIZED
+	#define NES_EXCEPTION_MAX NES_EXCEPTION_UNLOADED
 
 	static const std::string NES_EXCEPTION_STR[] = {
 		"Failed to allocate library",
 		"Library is initialized",
+		"Invalid pacing mode",
+		"Invalid snapshot",
+		"Library is running",
+		"Snapshot buffer is too small",
 		"Library is uninitialized",
+		"Library is unloaded",
 		};
 
 	#define NES_EXCEPTION_STRING(_TYPE_) \
@@ -25,6 +25,143 @@
 extern "C" {
 #endif // __cplusplus
 
+neserr_t 
+nes_audio_enable(
+	__inout nes_context *context,
+	__in unsigned type,
+	__in_opt const char *path,
+	__in_opt nes_audio_cb callback,
+	__in_opt void *user
+	)
+{
+	nes_apu_output output;
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context || (type > NES_AUDIO_CALLBACK)) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if((((type == NES_AUDIO_RAW) || (type == NES_AUDIO_WAV)) && !path)
+			|| ((type == NES_AUDIO_CALLBACK) && !callback)) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	if(callback) {
+		output = [callback, user](const int16_t *samples, size_t count) {
+				callback(user, samples, count);
+			};
+	}
+
+	try {
+		((nes_ptr) context->session)->set_audio(type, path ? path : std::string(), output);
+	} catch(nes_exception &exc) {
+		std::cerr << exc.to_string(true) << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	} catch(std::exception &exc) {
+		std::cerr << exc.what() << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+exit:
+	return result;
+}
+
+neserr_t 
+nes_hash(
+	__in nes_context *context,
+	__out uint64_t *frame,
+	__out uint64_t *frame_hash,
+	__out uint64_t *ram_hash
+	)
+{
+	uint64_t index, hash_frame, hash_ram;
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context || !frame_hash) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	try {
+		index = ((nes_ptr) context->session)->hash(hash_frame, hash_ram);
+	} catch(nes_exception &exc) {
+		std::cerr << exc.to_string(true) << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	} catch(std::exception &exc) {
+		std::cerr << exc.what() << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+	if(frame) {
+		*frame = index;
+	}
+
+	*frame_hash = hash_frame;
+
+	if(ram_hash) {
+		*ram_hash = hash_ram;
+	}
+
+exit:
+	return result;
+}
+
+neserr_t 
+nes_hash_enable(
+	__inout nes_context *context,
+	__in unsigned flags,
+	__in_opt const char *path
+	)
+{
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(flags & ~(NES_HASH_FRAME | NES_HASH_RAM)) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	try {
+		((nes_ptr) context->session)->set_hash(flags, path ? path : std::string());
+	} catch(nes_exception &exc) {
+		std::cerr << exc.to_string(true) << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	} catch(std::exception &exc) {
+		std::cerr << exc.what() << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+exit:
+	return result;
+}
+
 neserr_t 
 nes_initialize(
 	__inout nes_context *context
@@ -45,21 +182,21 @@ nes_initialize(
 
 	try {
 
-		inst = nes::acquire();
+		inst = nes::create();
 		if(!inst) {
 			result = NES_ERR_FAILURE;
 			goto exit;
 		}
 
-		if(!inst->is_initialized()) {
-			inst->initialize();
-		}
+		inst->initialize();
 	} catch(nes_exception &exc) {
 		std::cerr << exc.to_string(true) << std::endl;
+		delete inst;
 		result = NES_ERR_FAILURE;
 		goto exit;
 	} catch(std::exception &exc) {
 		std::cerr << exc.what() << std::endl;
+		delete inst;
 		result = NES_ERR_FAILURE;
 		goto exit;
 	}
@@ -98,6 +235,121 @@ exit:
 	return result;
 }
 
+neserr_t 
+nes_load(
+	__inout nes_context *context,
+	__in const char *path
+	)
+{
+	nes_ptr inst = NULL;
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context || !path) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	inst = (nes_ptr) context->session;
+	if(!inst->is_initialized()) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	try {
+		inst->load(path);
+	} catch(...) {
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+exit:
+	return result;
+}
+
+neserr_t 
+nes_pipeline_enable(
+	__inout nes_context *context,
+	__in unsigned type,
+	__in unsigned capacity,
+	__in_opt nes_frame_cb callback,
+	__in_opt void *user
+	)
+{
+	nes_ppu_output output;
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context || (type > NES_PIPELINE_DROP)) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	if(callback) {
+		output = [callback, user](const nes_ppu_frame &frame) {
+				callback(user, frame.frame - 1, &frame.pixels[0]);
+			};
+	}
+
+	try {
+		((nes_ptr) context->session)->set_pipeline(type, capacity, output);
+	} catch(nes_exception &exc) {
+		std::cerr << exc.to_string(true) << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	} catch(std::exception &exc) {
+		std::cerr << exc.what() << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+exit:
+	return result;
+}
+
+neserr_t 
+nes_reset(
+	__inout nes_context *context
+	)
+{
+	nes_ptr inst = NULL;
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	inst = (nes_ptr) context->session;
+	if(!inst->is_initialized() || !inst->acquire_rom()->is_loaded()) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	try {
+		inst->reset();
+	} catch(...) {
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+exit:
+	return result;
+}
+
 neserr_t 
 nes_run(
 	__inout nes_context *context,
@@ -133,6 +385,160 @@ exit:
 	return result;
 }
 
+neserr_t 
+nes_run_cycles(
+	__inout nes_context *context,
+	__in uint64_t cycles,
+	__out_opt uint64_t *elapsed
+	)
+{
+	uint64_t value;
+	nes_ptr inst = NULL;
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	inst = (nes_ptr) context->session;
+	if(!inst->is_initialized() || !inst->acquire_rom()->is_loaded()) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	try {
+		value = inst->run_cycles(cycles);
+	} catch(...) {
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+	if(elapsed) {
+		*elapsed = value;
+	}
+
+exit:
+	return result;
+}
+
+neserr_t 
+nes_run_frames(
+	__inout nes_context *context,
+	__in const char *input,
+	__in int debug,
+	__in unsigned pacing,
+	__in uint64_t frames,
+	__out_opt double *rate
+	)
+{
+	double value;
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context || !input || (pacing > NES_PACING_REALTIME)) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	try {
+		value = ((nes_ptr) context->session)->run(input, debug != NES_NO_DEBUG, 
+			(nes_pacing_t) pacing, frames);
+	} catch(nes_exception &exc) {
+		std::cerr << exc.to_string(true) << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	} catch(std::exception &exc) {
+		std::cerr << exc.what() << std::endl;
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+	if(rate) {
+		*rate = value;
+	}
+
+exit:
+	return result;
+}
+
+neserr_t 
+nes_step_frame(
+	__inout nes_context *context,
+	__in uint64_t frames,
+	__out_opt uint64_t *frame
+	)
+{
+	uint64_t iter = 0, value = 0;
+	nes_ptr inst = NULL;
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	inst = (nes_ptr) context->session;
+	if(!inst->is_initialized() || !inst->acquire_rom()->is_loaded()) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	try {
+
+		for(value = inst->acquire_ppu()->frame(); iter < frames; ++iter) {
+			value = inst->step_frame();
+		}
+	} catch(...) {
+		result = NES_ERR_FAILURE;
+		goto exit;
+	}
+
+	if(frame) {
+		*frame = value;
+	}
+
+exit:
+	return result;
+}
+
+neserr_t 
+nes_stop(
+	__inout nes_context *context
+	)
+{
+	neserr_t result = NES_ERR_NONE;
+
+	if(!context) {
+		result = NES_ERR_INVALID_ARGUMENT;
+		goto exit;
+	}
+
+	if(!context->session) {
+		result = NES_ERR_INVALID_STATE;
+		goto exit;
+	}
+
+	((nes_ptr) context->session)->stop();
+
+exit:
+	return result;
+}
+
 neserr_t 
 nes_uninitialize(
 	__inout nes_context *context
@@ -162,6 +568,8 @@ nes_uninitialize(
 		if(inst->is_initialized()) {
 			inst->uninitialize();
 		}
+
+		delete inst;
 	} catch(nes_exception &exc) {
 		std::cerr << exc.to_string(true) << std::endl;
 		result = NES_ERR_FAILURE;
@@ -17,22 +17,39 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <random>
 #include "../include/nes.h"
+#include "../include/nes_checkpoint_type.h"
+#include "../include/nes_mapper_type.h"
+#include "../include/nes_rewind_type.h"
 #include "../include/nes_type.h"
 
 namespace NES {
 
 	nes_ptr nes::m_instance = NULL;
 
-	_nes::_nes(void) :
+	_nes::_nes(
+		__in nes_memory_ptr memory,
+		__in nes_ppu_ptr ppu,
+		__in nes_apu_ptr apu,
+		__in nes_cpu_ptr cpu,
+		__in nes_rom_ptr rom,
+		__in_opt bool owned
+		) :
+		m_battery_interval(NES_BATTERY_INTERVAL_DEFAULT),
 		m_initialized(false),
-		m_instance_cpu(nes_cpu::acquire()),
-		m_instance_memory(nes_memory::acquire()),
-		m_instance_ppu(nes_ppu::acquire()),
-		m_instance_rom(nes_rom::acquire())
+		m_instance_apu(apu),
+		m_instance_cpu(cpu),
+		m_instance_memory(memory),
+		m_instance_ppu(ppu),
+		m_instance_rom(rom),
+		m_mapper(NULL),
+		m_owned(owned),
+		m_running(false),
+		m_lock_depth(0)
 	{
-		std::atexit(nes::_delete);
+		return;
 	}
 
 	_nes::~_nes(void)
@@ -41,6 +58,14 @@ namespace NES {
 		if(m_initialized) {
 			uninitialize();
 		}
+
+		if(m_owned) {
+			delete m_instance_cpu;
+			delete m_instance_apu;
+			delete m_instance_ppu;
+			delete m_instance_rom;
+			delete m_instance_memory;
+		}
 	}
 
 	void 
@@ -59,47 +84,192 @@ namespace NES {
 
 		if(!nes::m_instance) {
 
-			nes::m_instance = new nes;
+			nes::m_instance = new nes(nes_memory::acquire(), nes_ppu::acquire(), 
+				nes_apu::acquire(), nes_cpu::acquire(), nes_rom::acquire());
 			if(!nes::m_instance) {
 				THROW_NES_EXCEPTION(NES_EXCEPTION_ALLOCATED);
 			}
+
+			std::atexit(nes::_delete);
 		}
 
 		return nes::m_instance;
 	}
 
+	nes_apu_ptr 
+	_nes::acquire_apu(void)
+	{
+		SESSION_CALL(*this);
+		return m_instance_apu;
+	}
+
 	nes_cpu_ptr 
 	_nes::acquire_cpu(void)
 	{
-		ATOMIC_CALL_RECUR(m_lock);
+		SESSION_CALL(*this);
 		return m_instance_cpu;
 	}
 
 	nes_memory_ptr 
 	_nes::acquire_memory(void)
 	{
-		ATOMIC_CALL_RECUR(m_lock);
+		SESSION_CALL(*this);
 		return m_instance_memory;
 	}
 
 	nes_ppu_ptr 
 	_nes::acquire_ppu(void)
 	{
-		ATOMIC_CALL_RECUR(m_lock);
+		SESSION_CALL(*this);
 		return m_instance_ppu;
 	}
 
 	nes_rom_ptr 
 	_nes::acquire_rom(void)
 	{
-		ATOMIC_CALL_RECUR(m_lock);
+		SESSION_CALL(*this);
 		return m_instance_rom;
 	}
 
+	uint64_t 
+	_nes::archive(
+		__in nes_archive &archive
+		)
+	{
+		SESSION_CALL(*this);
+
+		m_archive_snapshot.resize(snapshot_length());
+		snapshot(&m_archive_snapshot[0], m_archive_snapshot.size());
+
+		return archive.put(&m_archive_snapshot[0], m_archive_snapshot.size());
+	}
+
+	void 
+	_nes::capture(void)
+	{
+		uint64_t frame = m_instance_ppu->frame();
+
+		if(!m_rewind.is_initialized() || (frame % m_rewind.interval())
+				|| (!m_rewind.empty() && (frame == m_rewind.frame()))) {
+			return;
+		}
+
+		m_rewind_snapshot.resize(snapshot_length());
+		snapshot(&m_rewind_snapshot[0], m_rewind_snapshot.size());
+		m_rewind.push(frame, m_rewind_snapshot);
+	}
+
+	uint64_t 
+	_nes::checkpoint(void)
+	{
+		SESSION_CALL(*this);
+
+		m_checkpoint_snapshot.resize(snapshot_length());
+		snapshot(&m_checkpoint_snapshot[0], m_checkpoint_snapshot.size());
+
+		return m_checkpoint.commit(m_checkpoint_snapshot);
+	}
+
+	uint64_t 
+	_nes::checkpoint_retained(void)
+	{
+		SESSION_CALL(*this);
+
+		return m_checkpoint.retained();
+	}
+
+	_nes *
+	_nes::create(void)
+	{
+		_nes *result = NULL;
+		nes_apu_ptr apu = NULL;
+		nes_cpu_ptr cpu = NULL;
+		nes_ppu_ptr ppu = NULL;
+		nes_rom_ptr rom = NULL;
+		nes_memory_ptr memory = NULL;
+
+		try {
+			memory = nes_memory::create();
+			ppu = nes_ppu::create(memory);
+			apu = nes_apu::create(memory);
+			cpu = nes_cpu::create(memory, ppu, apu);
+			rom = nes_rom::create();
+
+			result = new nes(memory, ppu, apu, cpu, rom, true);
+			if(!result) {
+				THROW_NES_EXCEPTION(NES_EXCEPTION_ALLOCATED);
+			}
+		} catch(...) {
+			delete cpu;
+			delete apu;
+			delete ppu;
+			delete rom;
+			delete memory;
+			throw;
+		}
+
+		return result;
+	}
+
+	void 
+	_nes::dispatch(void)
+	{
+		nes_command command;
+
+		for(;;) {
+
+			{
+				std::lock_guard<std::mutex> lock(m_command_lock);
+
+				if(m_command.empty()) {
+					break;
+				}
+
+				command = m_command.front();
+				m_command.pop_front();
+			}
+
+			command(*this);
+		}
+	}
+
+	std::chrono::nanoseconds 
+	_nes::frame_period(void)
+	{
+		double rate = NES_FRAME_RATE_NTSC;
+
+		switch(m_instance_rom->descriptor().timing) {
+			case ROM_TIMING_PAL:
+			case ROM_TIMING_DENDY:
+				rate = NES_FRAME_RATE_PAL;
+				break;
+			default:
+				break;
+		}
+
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::duration<double>(1.0 / rate));
+	}
+
+	uint64_t 
+	_nes::hash(
+		__out uint64_t &frame,
+		__out uint64_t &ram
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		return m_instance_ppu->hash(frame, ram);
+	}
+
 	void 
 	_nes::initialize(void)
 	{
-		ATOMIC_CALL_RECUR(m_lock);
+		SESSION_CALL(*this);
 
 		if(m_initialized) {
 			THROW_NES_EXCEPTION(NES_EXCEPTION_INITIALIZED);
@@ -109,6 +279,7 @@ namespace NES {
 		m_instance_memory->initialize();
 		m_instance_cpu->initialize();
 		m_instance_ppu->initialize();
+		m_instance_apu->initialize();
 		m_instance_rom->initialize();
 
 		// TODO: initialize components
@@ -120,26 +291,451 @@ namespace NES {
 		return (nes::m_instance != NULL);
 	}
 
+	bool 
+	_nes::is_battery_open(void)
+	{
+		SESSION_CALL(*this);
+		return m_battery.is_open();
+	}
+
 	bool 
 	_nes::is_initialized(void)
 	{
-		ATOMIC_CALL_RECUR(m_lock);
+		SESSION_CALL(*this);
 		return m_initialized;
 	}
 
+	bool 
+	_nes::is_running(void)
+	{
+		return m_running.load(std::memory_order_acquire);
+	}
+
+	void 
+	_nes::load(
+		__in const std::string &path
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		unload();
+		m_instance_rom->load(path);
+
+		try {
+
+			if(m_instance_rom->descriptor().battery && !m_instance_rom->ram_program().empty()
+					&& !m_battery_path.empty()) {
+
+				try {
+					m_battery.open(m_battery_path, &m_instance_rom->ram_program()[0], 
+						m_instance_rom->ram_program().size());
+				} catch(nes_exception &) { }
+			}
+
+			m_mapper = nes_mapper::create(*m_instance_rom, 
+				&m_instance_memory->at(NES_MEM_PPU, MAPPER_NAMETABLE_BASE));
+		} catch(...) {
+
+			if(m_battery.is_open()) {
+				m_battery.close();
+			}
+
+			m_instance_rom->unload();
+			throw;
+		}
+
+		m_instance_ppu->set_mapper(m_mapper);
+		m_instance_apu->set_mapper(m_mapper);
+		m_instance_cpu->set_mapper(m_mapper);
+		m_instance_cpu->reset();
+		m_instance_ppu->start();
+		m_instance_apu->start();
+	}
+
+	void 
+	_nes::lock(void)
+	{
+		m_lock.lock();
+		++m_lock_depth;
+	}
+
+	void 
+	_nes::pace(
+		__inout std::chrono::steady_clock::time_point &deadline,
+		__in std::chrono::nanoseconds period
+		)
+	{
+		std::chrono::steady_clock::time_point now;
+
+		deadline += period;
+
+		now = std::chrono::steady_clock::now();
+		if(now >= (deadline + period)) {
+			deadline = now;
+			return;
+		}
+
+		if((deadline - now) > std::chrono::nanoseconds(NES_RUN_PACING_SPIN)) {
+			std::this_thread::sleep_until(deadline - std::chrono::nanoseconds(NES_RUN_PACING_SPIN));
+		}
+
+		while(std::chrono::steady_clock::now() < deadline) {
+			std::this_thread::yield();
+		}
+	}
+
 	void 
+	_nes::persist(void)
+	{
+
+		if(m_battery.is_open() && m_battery_interval 
+				&& !(m_instance_ppu->frame() % m_battery_interval)) {
+			m_battery.flush();
+		}
+	}
+
+	void 
+	_nes::post(
+		__in const nes_command &command
+		)
+	{
+
+		{
+			std::lock_guard<std::mutex> lock(m_command_lock);
+			m_command.push_back(command);
+		}
+
+		if(try_lock()) {
+			unlock();
+		}
+	}
+
+	void 
+	_nes::replay(
+		__in uint64_t frame
+		)
+	{
+		uint64_t current;
+
+		while(m_instance_ppu->frame() < frame) {
+			current = m_instance_ppu->frame();
+
+			while(m_instance_ppu->frame() == current) {
+				m_instance_cpu->step();
+			}
+		}
+	}
+
+	void 
+	_nes::reset(void)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(!m_mapper) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNLOADED);
+		}
+
+		m_instance_cpu->reset();
+	}
+
+	void 
+	_nes::restore(
+		__in const uint8_t *buffer,
+		__in size_t length
+		)
+	{
+		nes_apu_snapshot apu;
+		nes_cpu_snapshot cpu;
+		nes_snapshot_header header;
+		nes_mapper_snapshot mapper;
+		nes_ppu_snapshot ppu;
+		nes_snapshot_section section;
+		uint32_t found = 0, iter = 0, required = 0;
+		size_t layout[NES_SNAPSHOT_MAX + 1], offset = sizeof(nes_snapshot_header);
+		const uint8_t *payload[NES_SNAPSHOT_MAX + 1];
+
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(!m_mapper) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNLOADED);
+		}
+
+		if(!buffer || (length < sizeof(nes_snapshot_header))) {
+			THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_SNAPSHOT,
+				"ptr. 0x%p, length. %u", buffer, length);
+		}
+
+		std::memcpy(&header, buffer, sizeof(nes_snapshot_header));
+
+		if((header.magic != NES_SNAPSHOT_MAGIC) || (header.version != NES_SNAPSHOT_VERSION)) {
+			THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_SNAPSHOT,
+				"magic. 0x%x, version. %u", header.magic, header.version);
+		}
+
+		if((header.length < sizeof(nes_snapshot_header)) || (header.length > length)) {
+			THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_SNAPSHOT,
+				"length. %u (expecting <= %u)", header.length, length);
+		}
+
+		if((header.mapper != m_mapper->mapper()) 
+				|| (header.rom != m_instance_rom->hash().crc32)) {
+			THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_SNAPSHOT,
+				"mapper. %u, rom. 0x%08x", header.mapper, header.rom);
+		}
+
+		snapshot_layout(layout);
+
+		for(; iter <= NES_SNAPSHOT_MAX; ++iter) {
+			payload[iter] = NULL;
+
+			if(layout[iter]) {
+				required |= (1 << iter);
+			}
+		}
+
+		for(iter = 0; iter < header.sections; ++iter) {
+
+			if((offset + sizeof(nes_snapshot_section)) > header.length) {
+				THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_SNAPSHOT,
+					"section. %u, offset. %u", iter, offset);
+			}
+
+			std::memcpy(&section, buffer + offset, sizeof(nes_snapshot_section));
+			offset += sizeof(nes_snapshot_section);
+
+			if((offset + section.length) > header.length) {
+				THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_SNAPSHOT,
+					"section. %u, length. %u", iter, section.length);
+			}
+
+			if(section.tag <= NES_SNAPSHOT_MAX) {
+
+				if((section.length != layout[section.tag]) || (found & (1 << section.tag))) {
+					THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_SNAPSHOT,
+						"section. %u, tag. %u, length. %u", iter, section.tag, section.length);
+				}
+
+				found |= (1 << section.tag);
+				payload[section.tag] = (buffer + offset);
+			}
+
+			offset += NES_SNAPSHOT_ALIGN(section.length);
+		}
+
+		if(found != required) {
+			THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_SNAPSHOT,
+				"sections. 0x%x (expecting 0x%x)", found, required);
+		}
+
+		std::memcpy(&apu, payload[NES_SNAPSHOT_APU], sizeof(nes_apu_snapshot));
+		std::memcpy(&cpu, payload[NES_SNAPSHOT_CPU], sizeof(nes_cpu_snapshot));
+		std::memcpy(&mapper, payload[NES_SNAPSHOT_MAPPER], sizeof(nes_mapper_snapshot));
+		std::memcpy(&ppu, payload[NES_SNAPSHOT_PPU], sizeof(nes_ppu_snapshot));
+		m_mapper->restore(mapper);
+		m_instance_cpu->restore(cpu);
+		m_instance_ppu->restore(ppu, payload[NES_SNAPSHOT_FRAME]);
+		m_instance_apu->restore(apu);
+		std::memcpy(&m_instance_memory->at(NES_MEM_MMU, 0), payload[NES_SNAPSHOT_RAM], 
+			layout[NES_SNAPSHOT_RAM]);
+		std::memcpy(&m_instance_memory->at(NES_MEM_PPU, NES_SNAPSHOT_VRAM_BASE), 
+			payload[NES_SNAPSHOT_VRAM], layout[NES_SNAPSHOT_VRAM]);
+		std::memcpy(&m_instance_memory->at(NES_MEM_PPU_OAM, 0), payload[NES_SNAPSHOT_OAM], 
+			layout[NES_SNAPSHOT_OAM]);
+
+		if(payload[NES_SNAPSHOT_RAM_CHARACTER]) {
+			std::memcpy(&m_instance_rom->ram_character()[0], payload[NES_SNAPSHOT_RAM_CHARACTER], 
+				layout[NES_SNAPSHOT_RAM_CHARACTER]);
+		}
+
+		if(payload[NES_SNAPSHOT_RAM_PROGRAM]) {
+			std::memcpy(&m_instance_rom->ram_program()[0], payload[NES_SNAPSHOT_RAM_PROGRAM], 
+				layout[NES_SNAPSHOT_RAM_PROGRAM]);
+		}
+	}
+
+	void 
+	_nes::restore_archive(
+		__in nes_archive &archive,
+		__in uint64_t key
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(!m_mapper) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNLOADED);
+		}
+
+		archive.get(key, m_archive_snapshot);
+		restore(&m_archive_snapshot[0], m_archive_snapshot.size());
+	}
+
+	void 
+	_nes::restore_checkpoint(
+		__in uint64_t id
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(!m_mapper) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNLOADED);
+		}
+
+		m_checkpoint.reconstruct(id, m_checkpoint_snapshot);
+		restore(&m_checkpoint_snapshot[0], m_checkpoint_snapshot.size());
+	}
+
+	uint64_t 
+	_nes::rewind(
+		__in uint64_t frames
+		)
+	{
+		uint64_t frame, target;
+
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(!m_mapper) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNLOADED);
+		}
+
+		frame = m_instance_ppu->frame();
+
+		if(m_rewind.is_initialized() && !m_rewind.empty() && frames) {
+			target = ((frames < frame) ? (frame - frames) : 0);
+
+			while((m_rewind.frame() > target) && m_rewind.count()) {
+				m_rewind.pop();
+			}
+
+			restore(&m_rewind.snapshot()[0], m_rewind.snapshot().size());
+			replay(target);
+			frame = m_instance_ppu->frame();
+		}
+
+		return frame;
+	}
+
+	double 
 	_nes::run(
 		__in const std::string &input,
-		__in_opt bool debug
+		__in_opt bool debug,
+		__in_opt nes_pacing_t pacing,
+		__in_opt uint64_t frames
+		)
+	{
+		double elapsed, result = 0.0;
+		uint64_t count = 0;
+		std::chrono::nanoseconds period;
+		std::chrono::steady_clock::time_point begin, deadline;
+
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(pacing > NES_RUN_PACING_MAX) {
+			THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_INVALID_PACING,
+				"%u", pacing);
+		}
+
+		if(m_running.exchange(true, std::memory_order_acq_rel)) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_RUNNING);
+		}
+
+		try {
+			load(input);
+			period = frame_period();
+			begin = std::chrono::steady_clock::now();
+			deadline = begin;
+
+			while(m_running.load(std::memory_order_acquire) && (!frames || (count < frames))) {
+				step_frame();
+				++count;
+
+				if(pacing == NES_RUN_PACING_REALTIME) {
+					pace(deadline, period);
+				}
+			}
+		} catch(...) {
+			m_running.store(false, std::memory_order_release);
+			throw;
+		}
+
+		m_running.store(false, std::memory_order_release);
+
+		elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		if(elapsed > 0.0) {
+			result = (count / elapsed);
+		}
+
+		if(debug) {
+			std::cout << to_string(0, 0, true) << std::endl << "Frames: " << count 
+				<< " (" << std::fixed << std::setprecision(2) << result << " fps)" 
+				<< std::endl;
+		}
+
+		return result;
+	}
+
+	uint64_t 
+	_nes::run_cycles(
+		__in uint64_t cycles
 		)
 	{
-		ATOMIC_CALL_RECUR(m_lock);
+		uint64_t previous;
+		uint64_t frame, result = 0;
+
+		SESSION_CALL(*this);
 
 		if(!m_initialized) {
 			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
 		}
 
-		// TODO: run session
+		if(!m_mapper) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNLOADED);
+		}
+
+		frame = m_instance_ppu->frame();
+
+		while(result < cycles) {
+			previous = m_instance_cpu->cycles();
+			m_instance_cpu->step();
+			result += (m_instance_cpu->cycles() - previous);
+
+			if(m_instance_ppu->frame() != frame) {
+				frame = m_instance_ppu->frame();
+				capture();
+				persist();
+			}
+		}
+
+		dispatch();
+
+		return result;
 	}
 
 #ifndef NDEBUG
@@ -168,9 +764,30 @@ namespace NES {
 		nes_test_set test_set_ppu = nes_test_ppu::set_generate();
 		test_set_ppu.run_all(success, failure, inconclusive);
 		stream << test_set_ppu.to_string() << std::endl;
+		nes_test_set test_set_apu = nes_test_apu::set_generate();
+		test_set_apu.run_all(success, failure, inconclusive);
+		stream << test_set_apu.to_string() << std::endl;
 		nes_test_set test_set_rom = nes_test_rom::set_generate();
 		test_set_rom.run_all(success, failure, inconclusive);
 		stream << test_set_rom.to_string() << std::endl;
+		nes_test_set test_set_pool = nes_test_pool::set_generate();
+		test_set_pool.run_all(success, failure, inconclusive);
+		stream << test_set_pool.to_string() << std::endl;
+		nes_test_set test_set_session = nes_test_session::set_generate();
+		test_set_session.run_all(success, failure, inconclusive);
+		stream << test_set_session.to_string() << std::endl;
+		nes_test_set test_set_rewind = nes_test_rewind::set_generate();
+		test_set_rewind.run_all(success, failure, inconclusive);
+		stream << test_set_rewind.to_string() << std::endl;
+		nes_test_set test_set_checkpoint = nes_test_checkpoint::set_generate();
+		test_set_checkpoint.run_all(success, failure, inconclusive);
+		stream << test_set_checkpoint.to_string() << std::endl;
+		nes_test_set test_set_archive = nes_test_archive::set_generate();
+		test_set_archive.run_all(success, failure, inconclusive);
+		stream << test_set_archive.to_string() << std::endl;
+		nes_test_set test_set_battery = nes_test_battery::set_generate();
+		test_set_battery.run_all(success, failure, inconclusive);
+		stream << test_set_battery.to_string() << std::endl;
 
 		// TODO: run test sets
 
@@ -191,6 +808,293 @@ namespace NES {
 	}
 #endif // NDEBUG
 
+	void 
+	_nes::set_audio(
+		__in uint32_t type,
+		__in_opt const std::string &path,
+		__in_opt const nes_apu_output &output
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		m_instance_apu->set_sink((nes_apu_sink_t) type, path, output);
+	}
+
+	void 
+	_nes::set_battery(
+		__in uint32_t interval,
+		__in_opt const std::string &path
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		m_battery_interval = interval;
+		m_battery_path = path;
+	}
+
+	void 
+	_nes::set_checkpoint(
+		__in size_t chain
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(m_checkpoint.is_initialized()) {
+			m_checkpoint.uninitialize();
+		}
+
+		if(chain) {
+			m_checkpoint.initialize(chain);
+		}
+	}
+
+	void 
+	_nes::set_hash(
+		__in uint32_t flags,
+		__in_opt const std::string &path
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		m_instance_ppu->set_hash(flags, path);
+	}
+
+	void 
+	_nes::set_pipeline(
+		__in uint32_t type,
+		__in_opt size_t capacity,
+		__in_opt const nes_ppu_output &output
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		m_instance_ppu->set_pipeline((nes_ppu_pipeline_t) type, capacity, output);
+	}
+
+	void 
+	_nes::set_rewind(
+		__in size_t capacity,
+		__in_opt uint32_t interval
+		)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(m_rewind.is_initialized()) {
+			m_rewind.uninitialize();
+		}
+
+		if(capacity) {
+			m_rewind.initialize(capacity, interval);
+		}
+	}
+
+	size_t 
+	_nes::snapshot(
+		__out uint8_t *buffer,
+		__in size_t length
+		)
+	{
+		nes_apu_snapshot apu;
+		nes_cpu_snapshot cpu;
+		const void *data = NULL;
+		nes_snapshot_header header;
+		nes_mapper_snapshot mapper;
+		nes_ppu_snapshot ppu;
+		uint32_t iter = 0;
+		size_t layout[NES_SNAPSHOT_MAX + 1], offset = sizeof(nes_snapshot_header), result;
+
+		SESSION_CALL(*this);
+
+		result = snapshot_length();
+		if(!buffer || (length < result)) {
+			THROW_NES_EXCEPTION_MESSAGE(NES_EXCEPTION_SNAPSHOT_LENGTH,
+				"length. %u (expecting >= %u)", length, result);
+		}
+
+		snapshot_layout(layout);
+		m_instance_apu->snapshot(apu);
+		m_instance_cpu->snapshot(cpu);
+		m_mapper->snapshot(mapper);
+		m_instance_ppu->snapshot(ppu);
+		std::memset(&header, 0, sizeof(nes_snapshot_header));
+		header.length = result;
+		header.magic = NES_SNAPSHOT_MAGIC;
+		header.mapper = m_mapper->mapper();
+		header.rom = m_instance_rom->hash().crc32;
+		header.version = NES_SNAPSHOT_VERSION;
+
+		for(; iter <= NES_SNAPSHOT_MAX; ++iter) {
+
+			if(!layout[iter]) {
+				continue;
+			}
+
+			switch(iter) {
+				case NES_SNAPSHOT_APU:
+					data = &apu;
+					break;
+				case NES_SNAPSHOT_CPU:
+					data = &cpu;
+					break;
+				case NES_SNAPSHOT_FRAME:
+					data = &m_instance_ppu->frame_buffer()[0];
+					break;
+				case NES_SNAPSHOT_MAPPER:
+					data = &mapper;
+					break;
+				case NES_SNAPSHOT_OAM:
+					data = &m_instance_memory->at(NES_MEM_PPU_OAM, 0);
+					break;
+				case NES_SNAPSHOT_PPU:
+					data = &ppu;
+					break;
+				case NES_SNAPSHOT_RAM:
+					data = &m_instance_memory->at(NES_MEM_MMU, 0);
+					break;
+				case NES_SNAPSHOT_RAM_CHARACTER:
+					data = &m_instance_rom->ram_character()[0];
+					break;
+				case NES_SNAPSHOT_RAM_PROGRAM:
+					data = &m_instance_rom->ram_program()[0];
+					break;
+				case NES_SNAPSHOT_VRAM:
+					data = &m_instance_memory->at(NES_MEM_PPU, NES_SNAPSHOT_VRAM_BASE);
+					break;
+			}
+
+			snapshot_section(buffer, offset, iter, data, layout[iter]);
+			++header.sections;
+		}
+
+		std::memcpy(buffer, &header, sizeof(nes_snapshot_header));
+
+		return result;
+	}
+
+	void 
+	_nes::snapshot_layout(
+		__out size_t (&length)[NES_SNAPSHOT_MAX + 1]
+		)
+	{
+		length[NES_SNAPSHOT_APU] = sizeof(nes_apu_snapshot);
+		length[NES_SNAPSHOT_CPU] = sizeof(nes_cpu_snapshot);
+		length[NES_SNAPSHOT_FRAME] = m_instance_ppu->frame_buffer().size();
+		length[NES_SNAPSHOT_MAPPER] = sizeof(nes_mapper_snapshot);
+		length[NES_SNAPSHOT_OAM] = NES_SNAPSHOT_OAM_LENGTH;
+		length[NES_SNAPSHOT_PPU] = sizeof(nes_ppu_snapshot);
+		length[NES_SNAPSHOT_RAM] = NES_SNAPSHOT_RAM_LENGTH;
+		length[NES_SNAPSHOT_RAM_CHARACTER] = (m_instance_rom->descriptor().character_length ? 0
+			: m_instance_rom->ram_character().size());
+		length[NES_SNAPSHOT_RAM_PROGRAM] = m_instance_rom->ram_program().size();
+		length[NES_SNAPSHOT_VRAM] = NES_SNAPSHOT_VRAM_LENGTH;
+	}
+
+	size_t 
+	_nes::snapshot_length(void)
+	{
+		uint32_t iter = 0;
+		size_t layout[NES_SNAPSHOT_MAX + 1], result = sizeof(nes_snapshot_header);
+
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(!m_mapper) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNLOADED);
+		}
+
+		snapshot_layout(layout);
+
+		for(; iter <= NES_SNAPSHOT_MAX; ++iter) {
+
+			if(layout[iter]) {
+				result += (sizeof(nes_snapshot_section) + NES_SNAPSHOT_ALIGN(layout[iter]));
+			}
+		}
+
+		return result;
+	}
+
+	void 
+	_nes::snapshot_section(
+		__out uint8_t *buffer,
+		__inout size_t &offset,
+		__in uint32_t tag,
+		__in const void *data,
+		__in size_t length
+		)
+	{
+		nes_snapshot_section section;
+
+		section.length = length;
+		section.tag = tag;
+		std::memcpy(buffer + offset, &section, sizeof(nes_snapshot_section));
+		offset += sizeof(nes_snapshot_section);
+		std::memcpy(buffer + offset, data, length);
+		std::memset(buffer + offset + length, 0, NES_SNAPSHOT_ALIGN(length) - length);
+		offset += NES_SNAPSHOT_ALIGN(length);
+	}
+
+	uint64_t 
+	_nes::step_frame(void)
+	{
+		uint64_t result;
+
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(!m_mapper) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNLOADED);
+		}
+
+		result = m_instance_ppu->frame();
+
+		while(m_instance_ppu->frame() == result) {
+			m_instance_cpu->step();
+		}
+
+		capture();
+		persist();
+		dispatch();
+
+		return m_instance_ppu->frame();
+	}
+
+	void 
+	_nes::stop(void)
+	{
+		m_running.store(false, std::memory_order_release);
+	}
+
 	std::string 
 	_nes::to_string(
 		__in_opt uint16_t address,
@@ -200,7 +1104,7 @@ namespace NES {
 	{
 		std::stringstream result;
 
-		ATOMIC_CALL_RECUR(m_lock);
+		SESSION_CALL(*this);
 
 		result << "<" << NES_HEADER << "> (" 
 			<< (m_initialized ? INITIALIZED : UNINITIALIZED); 
@@ -214,23 +1118,51 @@ namespace NES {
 			address, offset, verbose)
 			<< std::endl << m_instance_cpu->to_string(verbose)
 			<< std::endl << m_instance_ppu->to_string(verbose)
-			<< std::endl << m_instance_rom->to_string(verbose);
+			<< std::endl << m_instance_apu->to_string(verbose)
+			<< std::endl << m_instance_rom->to_string(verbose)
+			<< std::endl << m_battery.to_string(verbose)
+			<< std::endl << m_checkpoint.to_string(verbose)
+			<< std::endl << m_rewind.to_string(verbose);
 
 		// TODO: print components
 
 		return result.str();
 	}
 
+	bool 
+	_nes::try_lock(void)
+	{
+		bool result;
+
+		result = m_lock.try_lock();
+		if(result) {
+			++m_lock_depth;
+		}
+
+		return result;
+	}
+
 	void 
 	_nes::uninitialize(void)
 	{
-		ATOMIC_CALL_RECUR(m_lock);
+		SESSION_CALL(*this);
 
 		if(!m_initialized) {
 			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
 		}
 
+		unload();
+
+		if(m_checkpoint.is_initialized()) {
+			m_checkpoint.uninitialize();
+		}
+
+		if(m_rewind.is_initialized()) {
+			m_rewind.uninitialize();
+		}
+
 		m_instance_rom->uninitialize();
+		m_instance_apu->uninitialize();
 		m_instance_ppu->uninitialize();
 		m_instance_cpu->uninitialize();
 		m_instance_memory->uninitialize();
@@ -240,6 +1172,79 @@ namespace NES {
 		m_initialized = false;
 	}
 
+	void 
+	_nes::unload(void)
+	{
+		SESSION_CALL(*this);
+
+		if(!m_initialized) {
+			THROW_NES_EXCEPTION(NES_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(m_instance_apu->is_started()) {
+			m_instance_apu->stop();
+		}
+
+		if(m_instance_ppu->is_started()) {
+			m_instance_ppu->stop();
+		}
+
+		if(m_mapper) {
+			m_instance_cpu->set_mapper(NULL);
+			m_instance_apu->set_mapper(NULL);
+			m_instance_ppu->set_mapper(NULL);
+			delete m_mapper;
+			m_mapper = NULL;
+		}
+
+		if(m_battery.is_open()) {
+			m_battery.close();
+		}
+
+		if(m_instance_rom->is_loaded()) {
+			m_instance_rom->unload();
+		}
+
+		m_checkpoint.clear();
+		m_rewind.clear();
+	}
+
+	void 
+	_nes::unlock(void)
+	{
+		bool outer;
+
+		for(;;) {
+
+			outer = (m_lock_depth == 1);
+			if(outer) {
+
+				try {
+					dispatch();
+				} catch(...) { }
+			}
+
+			--m_lock_depth;
+			m_lock.unlock();
+
+			if(!outer) {
+				break;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_command_lock);
+
+				if(m_command.empty()) {
+					break;
+				}
+			}
+
+			if(!try_lock()) {
+				break;
+			}
+		}
+	}
+
 	std::string 
 	_nes::version(void)
 	{
@@ -0,0 +1,1956 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../include/nes.h"
+#include "../include/nes_apu_type.h"
+
+namespace NES {
+
+	namespace COMP {
+
+		_nes_apu_buffer::_nes_apu_buffer(
+			__in size_t capacity
+			) :
+				m_buffer(capacity, 0),
+				m_head(0),
+				m_mask(capacity - 1),
+				m_overflow(0),
+				m_tail(0)
+		{
+			return;
+		}
+
+		_nes_apu_buffer::~_nes_apu_buffer(void)
+		{
+			return;
+		}
+
+		size_t 
+		_nes_apu_buffer::capacity(void)
+		{
+			return m_buffer.size();
+		}
+
+		void 
+		_nes_apu_buffer::clear(void)
+		{
+			m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+			m_overflow.store(0, std::memory_order_relaxed);
+		}
+
+		size_t 
+		_nes_apu_buffer::overflow(void)
+		{
+			return m_overflow.load(std::memory_order_relaxed);
+		}
+
+		size_t 
+		_nes_apu_buffer::pop(
+			__out int16_t *samples,
+			__in size_t count
+			)
+		{
+			size_t head, iter = 0, tail;
+
+			tail = m_tail.load(std::memory_order_relaxed);
+			head = m_head.load(std::memory_order_acquire);
+
+			if(count > (head - tail)) {
+				count = (head - tail);
+			}
+
+			for(; iter < count; ++iter) {
+				samples[iter] = m_buffer[(tail + iter) & m_mask];
+			}
+
+			m_tail.store(tail + count, std::memory_order_release);
+
+			return count;
+		}
+
+		bool 
+		_nes_apu_buffer::push(
+			__in int16_t sample
+			)
+		{
+			size_t head;
+
+			head = m_head.load(std::memory_order_relaxed);
+
+			if((head - m_tail.load(std::memory_order_acquire)) > m_mask) {
+				m_overflow.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			m_buffer[head & m_mask] = sample;
+			m_head.store(head + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		size_t 
+		_nes_apu_buffer::size(void)
+		{
+			return (m_head.load(std::memory_order_acquire) 
+				- m_tail.load(std::memory_order_acquire));
+		}
+
+		_nes_apu_blip::_nes_apu_blip(void) :
+			m_factor(0),
+			m_integrator(0),
+			m_kernel(APU_BLIP_PHASES * APU_BLIP_WIDTH, 0),
+			m_offset(0)
+		{
+			generate();
+			set_rates(APU_CPU_FREQUENCY, APU_SAMPLE_RATE_DEFAULT, APU_BLIP_FRAME_CYCLES);
+		}
+
+		_nes_apu_blip::~_nes_apu_blip(void)
+		{
+			return;
+		}
+
+		void 
+		_nes_apu_blip::add_delta(
+			__in uint32_t time,
+			__in int32_t delta
+			)
+		{
+			size_t index, iter = 0;
+			int32_t *kernel, *output;
+			uint64_t position = (m_offset + (time * m_factor));
+
+			index = (position >> APU_BLIP_TIME_BITS);
+			if((index + APU_BLIP_WIDTH) > m_buffer.size()) {
+				return;
+			}
+
+			kernel = &m_kernel[((position >> (APU_BLIP_TIME_BITS - APU_BLIP_PHASE_BITS)) 
+				& (APU_BLIP_PHASES - 1)) * APU_BLIP_WIDTH];
+			output = &m_buffer[index];
+
+			for(; iter < APU_BLIP_WIDTH; ++iter) {
+				output[iter] += (delta * kernel[iter]);
+			}
+		}
+
+		size_t 
+		_nes_apu_blip::available(void)
+		{
+			return (m_offset >> APU_BLIP_TIME_BITS);
+		}
+
+		void 
+		_nes_apu_blip::clear(void)
+		{
+			m_integrator = 0;
+			m_offset = 0;
+			std::fill(m_buffer.begin(), m_buffer.end(), 0);
+		}
+
+		void 
+		_nes_apu_blip::end_frame(
+			__in uint32_t time
+			)
+		{
+			m_offset += (time * m_factor);
+		}
+
+		void 
+		_nes_apu_blip::generate(void)
+		{
+			size_t peak;
+			int32_t total;
+			uint32_t iter, phase = 0;
+			double impulse[APU_BLIP_WIDTH], sum, window, x;
+
+			for(; phase < APU_BLIP_PHASES; ++phase) {
+				peak = 0;
+				sum = 0.0;
+				total = 0;
+
+				for(iter = 0; iter < APU_BLIP_WIDTH; ++iter) {
+					x = (((double) iter + 1.0 - (APU_BLIP_WIDTH / 2)) 
+						- ((double) phase / APU_BLIP_PHASES));
+					window = (0.42 + (0.5 * std::cos((2.0 * M_PI * x) / APU_BLIP_WIDTH))
+						+ (0.08 * std::cos((4.0 * M_PI * x) / APU_BLIP_WIDTH)));
+					impulse[iter] = (x ? (std::sin(M_PI * APU_BLIP_CUTOFF * x) / (M_PI * x)) 
+						: APU_BLIP_CUTOFF) * window;
+					sum += impulse[iter];
+				}
+
+				for(iter = 0; iter < APU_BLIP_WIDTH; ++iter) {
+					m_kernel[(phase * APU_BLIP_WIDTH) + iter] = (int32_t) std::floor(
+						((impulse[iter] * (1 << APU_BLIP_KERNEL_BITS)) / sum) + 0.5);
+					total += m_kernel[(phase * APU_BLIP_WIDTH) + iter];
+
+					if(impulse[iter] > impulse[peak]) {
+						peak = iter;
+					}
+				}
+
+				m_kernel[(phase * APU_BLIP_WIDTH) + peak] += ((1 << APU_BLIP_KERNEL_BITS) 
+					- total);
+			}
+		}
+
+		size_t 
+		_nes_apu_blip::read(
+			__inout nes_apu_buffer &buffer
+			)
+		{
+			int32_t sample;
+			size_t count, iter = 0;
+
+			count = available();
+
+			for(; iter < count; ++iter) {
+				m_integrator += m_buffer[iter];
+				sample = (m_integrator >> APU_BLIP_KERNEL_BITS);
+
+				if(sample > INT16_MAX) {
+					sample = INT16_MAX;
+				} else if(sample < INT16_MIN) {
+					sample = INT16_MIN;
+				}
+
+				buffer.push((int16_t) sample);
+				m_integrator -= (sample << (APU_BLIP_KERNEL_BITS - APU_BLIP_BASS_SHIFT));
+			}
+
+			std::copy(m_buffer.begin() + count, m_buffer.begin() + count + APU_BLIP_WIDTH, 
+				m_buffer.begin());
+			std::fill(m_buffer.begin() + APU_BLIP_WIDTH, m_buffer.begin() + count 
+				+ APU_BLIP_WIDTH, 0);
+			m_offset -= (((uint64_t) count) << APU_BLIP_TIME_BITS);
+
+			return count;
+		}
+
+		void 
+		_nes_apu_blip::set_rates(
+			__in uint32_t clock,
+			__in uint32_t sample,
+			__in uint32_t frame
+			)
+		{
+			m_factor = ((((uint64_t) sample) << APU_BLIP_TIME_BITS) / clock);
+			m_buffer.assign(((((uint64_t) frame) * sample) / clock) 
+				+ (APU_BLIP_WIDTH * 2) + 1, 0);
+			m_integrator = 0;
+			m_offset = 0;
+		}
+
+		_nes_apu *_nes_apu::m_instance = NULL;
+
+		_nes_apu_sink::_nes_apu_sink(void)
+		{
+			return;
+		}
+
+		_nes_apu_sink::~_nes_apu_sink(void)
+		{
+			return;
+		}
+
+		_nes_apu_sink_callback::_nes_apu_sink_callback(
+			__in const nes_apu_output &output
+			) :
+			m_output(output)
+		{
+			return;
+		}
+
+		_nes_apu_sink_callback::~_nes_apu_sink_callback(void)
+		{
+			return;
+		}
+
+		void 
+		_nes_apu_sink_callback::close(void)
+		{
+			return;
+		}
+
+		void 
+		_nes_apu_sink_callback::open(
+			__in const std::string &path,
+			__in uint32_t rate
+			)
+		{
+
+			if(!m_output) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_SINK_OPEN);
+			}
+		}
+
+		void 
+		_nes_apu_sink_callback::write(
+			__in const int16_t *samples,
+			__in size_t count
+			)
+		{
+			m_output(samples, count);
+		}
+
+		_nes_apu_sink_null::_nes_apu_sink_null(void)
+		{
+			return;
+		}
+
+		_nes_apu_sink_null::~_nes_apu_sink_null(void)
+		{
+			return;
+		}
+
+		void 
+		_nes_apu_sink_null::close(void)
+		{
+			return;
+		}
+
+		void 
+		_nes_apu_sink_null::open(
+			__in const std::string &path,
+			__in uint32_t rate
+			)
+		{
+			return;
+		}
+
+		void 
+		_nes_apu_sink_null::write(
+			__in const int16_t *samples,
+			__in size_t count
+			)
+		{
+			return;
+		}
+
+		_nes_apu_sink_raw::_nes_apu_sink_raw(void) :
+			m_file(-1),
+			m_length(0),
+			m_rate(0)
+		{
+			return;
+		}
+
+		_nes_apu_sink_raw::~_nes_apu_sink_raw(void)
+		{
+
+			if(m_file >= 0) {
+				::close(m_file);
+				m_file = -1;
+			}
+		}
+
+		void 
+		_nes_apu_sink_raw::close(void)
+		{
+
+			if(m_file >= 0) {
+				::close(m_file);
+				m_file = -1;
+			}
+		}
+
+		void 
+		_nes_apu_sink_raw::open(
+			__in const std::string &path,
+			__in uint32_t rate
+			)
+		{
+			close();
+
+			m_file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, APU_SINK_MODE);
+			if(m_file < 0) {
+				THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_SINK_OPEN,
+					"%s", CHECK_STR(path));
+			}
+
+			m_length = 0;
+			m_rate = rate;
+		}
+
+		void 
+		_nes_apu_sink_raw::write(
+			__in const int16_t *samples,
+			__in size_t count
+			)
+		{
+			write_data(samples, count * sizeof(int16_t));
+			m_length += (count * sizeof(int16_t));
+		}
+
+		void 
+		_nes_apu_sink_raw::write_data(
+			__in const void *data,
+			__in size_t length
+			)
+		{
+			ssize_t count;
+			const uint8_t *position = (const uint8_t *) data;
+
+			while(length) {
+
+				count = ::write(m_file, position, length);
+				if(count < 0) {
+
+					if(errno == EINTR) {
+						continue;
+					}
+
+					THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_SINK_WRITE,
+						"%s", std::strerror(errno));
+				}
+
+				length -= count;
+				position += count;
+			}
+		}
+
+		_nes_apu_sink_wav::_nes_apu_sink_wav(void)
+		{
+			return;
+		}
+
+		_nes_apu_sink_wav::~_nes_apu_sink_wav(void)
+		{
+
+			try {
+				close();
+			} catch(...) { }
+		}
+
+		void 
+		_nes_apu_sink_wav::close(void)
+		{
+			uint8_t data[APU_SINK_WAV_HEADER_LENGTH];
+
+			if(m_file >= 0) {
+				header(data, m_rate, m_length);
+
+				if(::pwrite(m_file, data, APU_SINK_WAV_HEADER_LENGTH, 0) 
+						!= APU_SINK_WAV_HEADER_LENGTH) {
+					_nes_apu_sink_raw::close();
+					THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_SINK_WRITE,
+						"%s", std::strerror(errno));
+				}
+			}
+
+			_nes_apu_sink_raw::close();
+		}
+
+		void 
+		_nes_apu_sink_wav::header(
+			__out uint8_t *data,
+			__in uint32_t rate,
+			__in uint64_t length
+			)
+		{
+			uint32_t block = (APU_SINK_WAV_CHANNELS * (APU_SINK_WAV_BITS / BITS_PER_BYTE));
+
+			if(length > (UINT32_MAX - APU_SINK_WAV_HEADER_LENGTH)) {
+				length = (UINT32_MAX - APU_SINK_WAV_HEADER_LENGTH);
+			}
+
+			std::memcpy(data, APU_SINK_WAV_RIFF, APU_SINK_WAV_TAG_LENGTH);
+			header_field(data + 4, length + APU_SINK_WAV_HEADER_LENGTH - 8, sizeof(uint32_t));
+			std::memcpy(data + 8, APU_SINK_WAV_WAVE, APU_SINK_WAV_TAG_LENGTH);
+			std::memcpy(data + 12, APU_SINK_WAV_FORMAT, APU_SINK_WAV_TAG_LENGTH);
+			header_field(data + 16, APU_SINK_WAV_FORMAT_LENGTH, sizeof(uint32_t));
+			header_field(data + 20, APU_SINK_WAV_FORMAT_PCM, sizeof(uint16_t));
+			header_field(data + 22, APU_SINK_WAV_CHANNELS, sizeof(uint16_t));
+			header_field(data + 24, rate, sizeof(uint32_t));
+			header_field(data + 28, rate * block, sizeof(uint32_t));
+			header_field(data + 32, block, sizeof(uint16_t));
+			header_field(data + 34, APU_SINK_WAV_BITS, sizeof(uint16_t));
+			std::memcpy(data + 36, APU_SINK_WAV_DATA, APU_SINK_WAV_TAG_LENGTH);
+			header_field(data + 40, length, sizeof(uint32_t));
+		}
+
+		void 
+		_nes_apu_sink_wav::header_field(
+			__out uint8_t *data,
+			__in uint32_t value,
+			__in size_t length
+			)
+		{
+			size_t iter = 0;
+
+			for(; iter < length; ++iter) {
+				data[iter] = ((value >> (iter * BITS_PER_BYTE)) & UINT8_MAX);
+			}
+		}
+
+		void 
+		_nes_apu_sink_wav::open(
+			__in const std::string &path,
+			__in uint32_t rate
+			)
+		{
+			uint8_t data[APU_SINK_WAV_HEADER_LENGTH];
+
+			_nes_apu_sink_raw::open(path, rate);
+			header(data, m_rate, m_length);
+			write_data(data, APU_SINK_WAV_HEADER_LENGTH);
+		}
+
+		_nes_apu_writer::_nes_apu_writer(void) :
+			m_active(false),
+			m_batch(APU_WRITER_BATCH, 0),
+			m_buffer(NULL),
+			m_failed(false),
+			m_sink(NULL),
+			m_written(0)
+		{
+			return;
+		}
+
+		_nes_apu_writer::~_nes_apu_writer(void)
+		{
+
+			try {
+				stop();
+			} catch(...) { }
+		}
+
+		void 
+		_nes_apu_writer::drain(void)
+		{
+			size_t count;
+
+			do {
+				count = m_buffer->pop(&m_batch[0], m_batch.size());
+				if(count) {
+					m_sink->write(&m_batch[0], count);
+					m_written.fetch_add(count, std::memory_order_relaxed);
+				}
+			} while(count == m_batch.size());
+		}
+
+		bool 
+		_nes_apu_writer::is_active(void)
+		{
+			return m_active.load(std::memory_order_acquire);
+		}
+
+		bool 
+		_nes_apu_writer::is_failed(void)
+		{
+			return m_failed.load(std::memory_order_acquire);
+		}
+
+		void 
+		_nes_apu_writer::notify(void)
+		{
+
+			if(m_active.load(std::memory_order_relaxed) 
+					&& (m_buffer->size() >= APU_WRITER_BATCH)) {
+				m_condition.notify_one();
+			}
+		}
+
+		void 
+		_nes_apu_writer::run(void)
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+
+			try {
+
+				while(m_active.load(std::memory_order_acquire)) {
+					m_condition.wait_for(lock, std::chrono::milliseconds(APU_WRITER_TIMEOUT), 
+						[this] { 
+							return (!m_active.load(std::memory_order_acquire)
+								|| (m_buffer->size() >= APU_WRITER_BATCH)); 
+						});
+					lock.unlock();
+					drain();
+					lock.lock();
+				}
+			} catch(...) {
+				m_failed.store(true, std::memory_order_release);
+			}
+		}
+
+		nes_apu_sink_ptr 
+		_nes_apu_writer::sink_create(
+			__in nes_apu_sink_t type,
+			__in const nes_apu_output &output
+			)
+		{
+			nes_apu_sink_ptr result = NULL;
+
+			switch(type) {
+				case NES_APU_SINK_CALLBACK:
+					result = new nes_apu_sink_callback(output);
+					break;
+				case NES_APU_SINK_NULL:
+					result = new nes_apu_sink_null;
+					break;
+				case NES_APU_SINK_RAW:
+					result = new nes_apu_sink_raw;
+					break;
+				case NES_APU_SINK_WAV:
+					result = new nes_apu_sink_wav;
+					break;
+				default:
+					THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_INVALID_SINK,
+						"type. %lu", type);
+			}
+
+			if(!result) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_ALLOCATED);
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_apu_writer::start(
+			__in nes_apu_buffer &buffer,
+			__in nes_apu_sink_t type,
+			__in const std::string &path,
+			__in uint32_t rate,
+			__in_opt const nes_apu_output &output
+			)
+		{
+			stop();
+			m_sink = sink_create(type, output);
+
+			try {
+				m_sink->open(path, rate);
+			} catch(...) {
+				delete m_sink;
+				m_sink = NULL;
+				throw;
+			}
+
+			m_buffer = &buffer;
+			m_failed.store(false, std::memory_order_relaxed);
+			m_written.store(0, std::memory_order_relaxed);
+			m_active.store(true, std::memory_order_release);
+			m_thread = std::thread(&_nes_apu_writer::run, this);
+		}
+
+		void 
+		_nes_apu_writer::stop(void)
+		{
+			nes_apu_sink_ptr sink = m_sink;
+
+			if(!sink) {
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				m_active.store(false, std::memory_order_release);
+			}
+
+			m_condition.notify_one();
+
+			if(m_thread.joinable()) {
+				m_thread.join();
+			}
+
+			try {
+
+				if(!m_failed.load(std::memory_order_acquire)) {
+					drain();
+				}
+
+				sink->close();
+			} catch(...) {
+				m_failed.store(true, std::memory_order_release);
+			}
+
+			m_sink = NULL;
+			delete sink;
+		}
+
+		uint64_t 
+		_nes_apu_writer::written(void)
+		{
+			return m_written.load(std::memory_order_relaxed);
+		}
+
+		_nes_apu::_nes_apu(
+			__in nes_memory_ptr memory
+			) :
+			m_amplitude(0),
+			m_blip_time(0),
+			m_buffer(APU_BUFFER_CAPACITY),
+			m_changed(false),
+			m_cycles(0),
+			m_initialized(false),
+			m_mapper(NULL),
+			m_master(0),
+			m_memory(memory),
+			m_mix_pulse(APU_MIX_PULSE_LENGTH, 0),
+			m_mix_tnd(APU_MIX_TND_LENGTH, 0),
+			m_sample_rate(APU_SAMPLE_RATE_DEFAULT),
+			m_sink(NES_APU_SINK_NONE),
+			m_stall(0),
+			m_started(false),
+			m_sync(NES_APU_SYNC_LAZY)
+		{
+			mix_generate();
+			std::memset(&m_state, 0, sizeof(nes_apu_state));
+		}
+
+		_nes_apu::~_nes_apu(void)
+		{
+
+			if(m_initialized) {
+				uninitialize();
+			}
+		}
+
+		void 
+		_nes_apu::_delete(void)
+		{
+
+			if(nes_apu::m_instance) {
+				delete nes_apu::m_instance;
+				nes_apu::m_instance = NULL;
+			}
+		}
+
+		_nes_apu *
+		_nes_apu::acquire(void)
+		{
+
+			if(!nes_apu::m_instance) {
+
+				nes_apu::m_instance = create(nes_memory::acquire());
+				std::atexit(nes_apu::_delete);
+			}
+
+			return nes_apu::m_instance;
+		}
+
+		void 
+		_nes_apu::advance(
+			__in uint64_t cycles
+			)
+		{
+			uint64_t idle;
+
+			while(cycles) {
+
+				if(m_sync == NES_APU_SYNC_LAZY) {
+
+					idle = cycles_idle();
+					if(idle > cycles) {
+						idle = cycles;
+					}
+
+					if(idle) {
+						skip(idle);
+						cycles -= idle;
+						continue;
+					}
+				}
+
+				advance_cycle();
+				--cycles;
+			}
+		}
+
+		void 
+		_nes_apu::advance_cycle(void)
+		{
+			int32_t amplitude;
+
+			clock_frame();
+			clock_timers();
+			++m_cycles;
+
+			if(m_changed) {
+				m_changed = false;
+
+				amplitude = mix();
+				if(amplitude != m_amplitude) {
+					m_blip.add_delta(m_blip_time, amplitude - m_amplitude);
+					m_amplitude = amplitude;
+				}
+			}
+
+			if(++m_blip_time >= APU_BLIP_FRAME_CYCLES) {
+				m_blip.end_frame(m_blip_time);
+				m_blip.read(m_buffer);
+				m_blip_time = 0;
+				m_writer.notify();
+			}
+		}
+
+		nes_apu_buffer &
+		_nes_apu::buffer(void)
+		{
+			return m_buffer;
+		}
+
+		void 
+		_nes_apu::clock_dmc(void)
+		{
+
+			if(!m_state.dmc.silence) {
+
+				if(m_state.dmc.shift & 1) {
+
+					if(m_state.dmc.level <= APU_DMC_LEVEL_MAX) {
+						m_state.dmc.level += APU_DMC_LEVEL_STEP;
+					}
+				} else if(m_state.dmc.level >= APU_DMC_LEVEL_MIN) {
+					m_state.dmc.level -= APU_DMC_LEVEL_STEP;
+				}
+			}
+
+			m_state.dmc.shift >>= 1;
+
+			if(!--m_state.dmc.bits) {
+				m_state.dmc.bits = BITS_PER_BYTE;
+				m_state.dmc.silence = m_state.dmc.buffer_empty;
+
+				if(!m_state.dmc.buffer_empty) {
+					m_state.dmc.shift = m_state.dmc.buffer;
+					m_state.dmc.buffer_empty = true;
+				}
+			}
+
+			if(m_state.dmc.buffer_empty && m_state.dmc.remaining) {
+				dmc_fetch();
+			}
+		}
+
+		void 
+		_nes_apu::clock_envelope(
+			__inout nes_apu_envelope &envelope,
+			__in uint8_t control
+			)
+		{
+
+			if(envelope.start) {
+				envelope.start = false;
+				envelope.decay = APU_ENVELOPE_MAX;
+				envelope.divider = (control & APU_ENVELOPE_VOLUME);
+			} else if(!envelope.divider) {
+				envelope.divider = (control & APU_ENVELOPE_VOLUME);
+
+				if(envelope.decay) {
+					--envelope.decay;
+				} else if(control & APU_ENVELOPE_LOOP) {
+					envelope.decay = APU_ENVELOPE_MAX;
+				}
+			} else {
+				--envelope.divider;
+			}
+		}
+
+		void 
+		_nes_apu::clock_frame(void)
+		{
+			++m_state.frame_cycle;
+
+			switch(m_state.frame_cycle) {
+				case APU_FRAME_STEP_QUARTER_1:
+				case APU_FRAME_STEP_QUARTER_3:
+					clock_frame_quarter(m_state);
+					m_changed = true;
+					break;
+				case APU_FRAME_STEP_HALF_1:
+					clock_frame_quarter(m_state);
+					clock_frame_half(m_state);
+					m_changed = true;
+					break;
+				case APU_FRAME_STEP_HALF_2:
+
+					if(!(m_state.frame_control & APU_FRAME_MODE)) {
+						clock_frame_quarter(m_state);
+						clock_frame_half(m_state);
+						m_changed = true;
+
+						if(!(m_state.frame_control & APU_FRAME_INHIBIT)) {
+							m_state.frame_irq = true;
+						}
+					}
+					break;
+				case APU_FRAME_STEP_4_LENGTH:
+
+					if(!(m_state.frame_control & APU_FRAME_MODE)) {
+						m_state.frame_cycle = 0;
+					}
+					break;
+				case APU_FRAME_STEP_5_HALF_2:
+					clock_frame_quarter(m_state);
+					clock_frame_half(m_state);
+					m_changed = true;
+					break;
+				case APU_FRAME_STEP_5_LENGTH:
+					m_state.frame_cycle = 0;
+					break;
+				default:
+					break;
+			}
+		}
+
+		void 
+		_nes_apu::clock_frame_half(
+			__inout nes_apu_state &state
+			)
+		{
+
+			if(state.pulse_1.length && !(state.pulse_1.control & APU_ENVELOPE_LOOP)) {
+				--state.pulse_1.length;
+			}
+
+			if(state.pulse_2.length && !(state.pulse_2.control & APU_ENVELOPE_LOOP)) {
+				--state.pulse_2.length;
+			}
+
+			if(state.triangle.length && !(state.triangle.control & APU_TRIANGLE_CONTROL)) {
+				--state.triangle.length;
+			}
+
+			if(state.noise.length && !(state.noise.control & APU_ENVELOPE_LOOP)) {
+				--state.noise.length;
+			}
+
+			clock_sweep(state.pulse_1, true);
+			clock_sweep(state.pulse_2, false);
+		}
+
+		void 
+		_nes_apu::clock_frame_quarter(
+			__inout nes_apu_state &state
+			)
+		{
+			clock_envelope(state.pulse_1.envelope, state.pulse_1.control);
+			clock_envelope(state.pulse_2.envelope, state.pulse_2.control);
+			clock_envelope(state.noise.envelope, state.noise.control);
+
+			if(state.triangle.linear_reload) {
+				state.triangle.linear = (state.triangle.control & APU_TRIANGLE_LINEAR);
+			} else if(state.triangle.linear) {
+				--state.triangle.linear;
+			}
+
+			if(!(state.triangle.control & APU_TRIANGLE_CONTROL)) {
+				state.triangle.linear_reload = false;
+			}
+		}
+
+		void 
+		_nes_apu::clock_noise(
+			__inout nes_apu_noise &noise
+			)
+		{
+			uint16_t feedback = ((noise.shift ^ (noise.shift >> (noise.mode 
+				? APU_NOISE_FEEDBACK_SHORT : APU_NOISE_FEEDBACK_LONG))) & 1);
+
+			noise.shift = ((noise.shift >> 1) | (feedback << APU_NOISE_SHIFT_TOP));
+		}
+
+		void 
+		_nes_apu::clock_sweep(
+			__inout nes_apu_pulse &pulse,
+			__in bool complement
+			)
+		{
+			uint16_t target = sweep_target(pulse, complement);
+
+			if(!pulse.sweep_divider && (pulse.sweep & APU_SWEEP_ENABLE) 
+					&& (pulse.sweep & APU_SWEEP_SHIFT) 
+					&& (pulse.period >= APU_PULSE_PERIOD_MIN)
+					&& (target <= APU_PULSE_PERIOD_MAX)) {
+				pulse.period = target;
+			}
+
+			if(!pulse.sweep_divider || pulse.sweep_reload) {
+				pulse.sweep_divider = ((pulse.sweep & APU_SWEEP_PERIOD) 
+					>> APU_SWEEP_PERIOD_SHIFT);
+				pulse.sweep_reload = false;
+			} else {
+				--pulse.sweep_divider;
+			}
+		}
+
+		void 
+		_nes_apu::clock_timers(void)
+		{
+
+			if(m_cycles & 1) {
+
+				if(!m_state.pulse_1.timer) {
+					m_state.pulse_1.timer = m_state.pulse_1.period;
+					m_changed = true;
+					m_state.pulse_1.sequence = ((m_state.pulse_1.sequence + 1) 
+						% APU_DUTY_LENGTH);
+				} else {
+					--m_state.pulse_1.timer;
+				}
+
+				if(!m_state.pulse_2.timer) {
+					m_state.pulse_2.timer = m_state.pulse_2.period;
+					m_changed = true;
+					m_state.pulse_2.sequence = ((m_state.pulse_2.sequence + 1) 
+						% APU_DUTY_LENGTH);
+				} else {
+					--m_state.pulse_2.timer;
+				}
+			}
+
+			if(!m_state.triangle.timer) {
+				m_state.triangle.timer = m_state.triangle.period;
+				m_changed = true;
+
+				if(m_state.triangle.length && m_state.triangle.linear
+						&& (m_state.triangle.period >= APU_TRIANGLE_PERIOD_MIN)) {
+					m_state.triangle.sequence = ((m_state.triangle.sequence + 1) 
+						% APU_TRIANGLE_SEQUENCE_LENGTH);
+				}
+			} else {
+				--m_state.triangle.timer;
+			}
+
+			if(!m_state.noise.timer) {
+				m_state.noise.timer = (m_state.noise.period - 1);
+				m_changed = true;
+				clock_noise(m_state.noise);
+			} else {
+				--m_state.noise.timer;
+			}
+
+			if(!m_state.dmc.timer) {
+				m_state.dmc.timer = (APU_DMC_RATE[m_state.dmc.control 
+					& APU_DMC_CONTROL_RATE] - 1);
+				m_changed = true;
+				clock_dmc();
+			} else {
+				--m_state.dmc.timer;
+			}
+		}
+
+		_nes_apu *
+		_nes_apu::create(
+			__in nes_memory_ptr memory
+			)
+		{
+			_nes_apu *result = NULL;
+
+			result = new nes_apu(memory);
+			if(!result) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_ALLOCATED);
+			}
+
+			return result;
+		}
+
+		uint64_t 
+		_nes_apu::cycles(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			return m_cycles;
+		}
+
+		uint32_t 
+		_nes_apu::cycles_idle(void)
+		{
+			uint32_t result, value;
+
+			if(m_changed) {
+				return 0;
+			}
+
+			result = (APU_BLIP_FRAME_CYCLES - m_blip_time - 1);
+
+			value = (frame_next(m_state) - m_state.frame_cycle - 1);
+			if(value < result) {
+				result = value;
+			}
+
+			if(m_state.pulse_1.length) {
+
+				value = ((m_state.pulse_1.timer * 2) + ((m_cycles & 1) ? 0 : 1));
+				if(value < result) {
+					result = value;
+				}
+			}
+
+			if(m_state.pulse_2.length) {
+
+				value = ((m_state.pulse_2.timer * 2) + ((m_cycles & 1) ? 0 : 1));
+				if(value < result) {
+					result = value;
+				}
+			}
+
+			if(m_state.triangle.length && m_state.triangle.linear 
+					&& (m_state.triangle.period >= APU_TRIANGLE_PERIOD_MIN)
+					&& (m_state.triangle.timer < result)) {
+				result = m_state.triangle.timer;
+			}
+
+			if(m_state.noise.length && (m_state.noise.timer < result)) {
+				result = m_state.noise.timer;
+			}
+
+			if((!m_state.dmc.silence || !m_state.dmc.buffer_empty || m_state.dmc.remaining)
+					&& (m_state.dmc.timer < result)) {
+				result = m_state.dmc.timer;
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_apu::dmc_fetch(void)
+		{
+			m_state.dmc.buffer = (m_mapper ? m_mapper->read_cpu(m_state.dmc.current) 
+				: m_memory->at(NES_MEM_MMU, m_state.dmc.current));
+			m_state.dmc.buffer_empty = false;
+			m_stall += APU_DMC_STALL_CYCLES;
+
+			if(m_state.dmc.current == APU_DMC_ADDRESS_MAX) {
+				m_state.dmc.current = APU_DMC_ADDRESS_MIN;
+			} else {
+				++m_state.dmc.current;
+			}
+
+			if(!--m_state.dmc.remaining) {
+
+				if(m_state.dmc.control & APU_DMC_CONTROL_LOOP) {
+					dmc_restart(m_state.dmc);
+				} else if(m_state.dmc.control & APU_DMC_CONTROL_IRQ) {
+					m_state.dmc.irq = true;
+				}
+			}
+		}
+
+		void 
+		_nes_apu::dmc_restart(
+			__inout nes_apu_dmc &dmc
+			)
+		{
+			dmc.current = dmc.address;
+			dmc.remaining = dmc.length;
+		}
+
+		uint8_t 
+		_nes_apu::envelope_volume(
+			__in const nes_apu_envelope &envelope,
+			__in uint8_t control
+			)
+		{
+			return ((control & APU_ENVELOPE_CONSTANT) ? (control & APU_ENVELOPE_VOLUME) 
+				: envelope.decay);
+		}
+
+		uint32_t 
+		_nes_apu::frame_next(
+			__in const nes_apu_state &state
+			)
+		{
+			uint32_t result;
+
+			if(state.frame_cycle < APU_FRAME_STEP_QUARTER_1) {
+				result = APU_FRAME_STEP_QUARTER_1;
+			} else if(state.frame_cycle < APU_FRAME_STEP_HALF_1) {
+				result = APU_FRAME_STEP_HALF_1;
+			} else if(state.frame_cycle < APU_FRAME_STEP_QUARTER_3) {
+				result = APU_FRAME_STEP_QUARTER_3;
+			} else if(state.frame_control & APU_FRAME_MODE) {
+				result = ((state.frame_cycle < APU_FRAME_STEP_5_HALF_2) 
+					? APU_FRAME_STEP_5_HALF_2 : APU_FRAME_STEP_5_LENGTH);
+			} else {
+				result = ((state.frame_cycle < APU_FRAME_STEP_HALF_2) 
+					? APU_FRAME_STEP_HALF_2 : APU_FRAME_STEP_4_LENGTH);
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_apu::initialize(void)
+		{
+
+			if(m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_INITIALIZED);
+			}
+
+			m_initialized = true;
+			reset();
+
+			if(m_started) {
+				stop();
+			}
+		}
+
+		bool 
+		_nes_apu::irq_pending(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			return (m_state.frame_irq || m_state.dmc.irq);
+		}
+
+		bool 
+		_nes_apu::is_allocated(void)
+		{
+			return (nes_apu::m_instance != NULL);
+		}
+
+		bool 
+		_nes_apu::is_initialized(void)
+		{
+			return m_initialized;
+		}
+
+		bool 
+		_nes_apu::is_sink_failed(void)
+		{
+			return m_writer.is_failed();
+		}
+
+		bool 
+		_nes_apu::is_started(void)
+		{
+			return (m_initialized && m_started);
+		}
+
+		uint64_t 
+		_nes_apu::master(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			return m_master;
+		}
+
+		int32_t 
+		_nes_apu::mix(void)
+		{
+			return (m_mix_pulse[output_pulse(m_state.pulse_1, true) 
+					+ output_pulse(m_state.pulse_2, false)]
+				+ m_mix_tnd[(APU_MIX_TND_TRIANGLE * output_triangle(m_state.triangle))
+					+ (APU_MIX_TND_NOISE * output_noise(m_state.noise)) 
+					+ m_state.dmc.level]);
+		}
+
+		void 
+		_nes_apu::mix_generate(void)
+		{
+			size_t iter = 1;
+
+			m_mix_pulse[0] = 0;
+			m_mix_tnd[0] = 0;
+
+			for(; iter < APU_MIX_PULSE_LENGTH; ++iter) {
+				m_mix_pulse[iter] = (int32_t) ((APU_MIX_PULSE_DIVIDEND 
+					/ ((APU_MIX_PULSE_DIVISOR / iter) + 100.0)) * APU_MIX_SCALE);
+			}
+
+			for(iter = 1; iter < APU_MIX_TND_LENGTH; ++iter) {
+				m_mix_tnd[iter] = (int32_t) ((APU_MIX_TND_DIVIDEND 
+					/ ((APU_MIX_TND_DIVISOR / iter) + 100.0)) * APU_MIX_SCALE);
+			}
+		}
+
+		uint64_t 
+		_nes_apu::next_event(void)
+		{
+			uint64_t result = APU_SYNC_HORIZON, value;
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(m_sync == NES_APU_SYNC_LOCKSTEP) {
+				return m_master;
+			}
+
+			if(!(m_state.frame_control & (APU_FRAME_MODE | APU_FRAME_INHIBIT)) 
+					&& !m_state.frame_irq) {
+
+				value = ((m_state.frame_cycle < APU_FRAME_STEP_HALF_2) 
+					? (APU_FRAME_STEP_HALF_2 - m_state.frame_cycle)
+					: ((APU_FRAME_STEP_4_LENGTH - m_state.frame_cycle) 
+						+ APU_FRAME_STEP_HALF_2));
+				if(value < result) {
+					result = value;
+				}
+			}
+
+			if(m_state.dmc.remaining) {
+
+				value = (m_state.dmc.timer + 1);
+				if(!m_state.dmc.buffer_empty) {
+					value += ((m_state.dmc.bits - 1) * APU_DMC_RATE[m_state.dmc.control 
+						& APU_DMC_CONTROL_RATE]);
+				}
+
+				if(value < result) {
+					result = value;
+				}
+			}
+
+			return (m_master + (result * APU_MASTER_DIVIDER));
+		}
+
+		uint8_t 
+		_nes_apu::output_noise(
+			__in const nes_apu_noise &noise
+			)
+		{
+			uint8_t result = 0;
+
+			if(noise.length && !(noise.shift & 1)) {
+				result = envelope_volume(noise.envelope, noise.control);
+			}
+
+			return result;
+		}
+
+		uint8_t 
+		_nes_apu::output_pulse(
+			__in const nes_apu_pulse &pulse,
+			__in bool complement
+			)
+		{
+			uint8_t result = 0;
+
+			if(pulse.length && (pulse.period >= APU_PULSE_PERIOD_MIN)
+					&& (sweep_target(pulse, complement) <= APU_PULSE_PERIOD_MAX)
+					&& APU_DUTY[pulse.control >> APU_PULSE_DUTY_SHIFT][pulse.sequence]) {
+				result = envelope_volume(pulse.envelope, pulse.control);
+			}
+
+			return result;
+		}
+
+		uint8_t 
+		_nes_apu::output_triangle(
+			__in const nes_apu_triangle &triangle
+			)
+		{
+			return APU_TRIANGLE_SEQUENCE[triangle.sequence];
+		}
+
+		uint32_t 
+		_nes_apu::poll_stall(void)
+		{
+			uint32_t result;
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			result = m_stall;
+			m_stall = 0;
+
+			return result;
+		}
+
+		uint8_t 
+		_nes_apu::read(
+			__in uint16_t address
+			)
+		{
+			uint8_t result = 0;
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(address == APU_REGISTER_STATUS) {
+
+				if(m_state.pulse_1.length) {
+					result |= APU_STATUS_PULSE_1;
+				}
+
+				if(m_state.pulse_2.length) {
+					result |= APU_STATUS_PULSE_2;
+				}
+
+				if(m_state.triangle.length) {
+					result |= APU_STATUS_TRIANGLE;
+				}
+
+				if(m_state.noise.length) {
+					result |= APU_STATUS_NOISE;
+				}
+
+				if(m_state.dmc.remaining) {
+					result |= APU_STATUS_DMC;
+				}
+
+				if(m_state.frame_irq) {
+					result |= APU_STATUS_FRAME_IRQ;
+				}
+
+				if(m_state.dmc.irq) {
+					result |= APU_STATUS_DMC_IRQ;
+				}
+
+				m_state.frame_irq = false;
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_apu::reset(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_amplitude = 0;
+			m_blip.clear();
+			m_blip_time = 0;
+			m_buffer.clear();
+			m_changed = false;
+			m_cycles = 0;
+			m_master = 0;
+			m_stall = 0;
+			std::memset(&m_state, 0, sizeof(nes_apu_state));
+			m_state.dmc.bits = BITS_PER_BYTE;
+			m_state.dmc.buffer_empty = true;
+			m_state.dmc.silence = true;
+			m_state.noise.period = APU_NOISE_PERIOD_TABLE[0];
+			m_state.noise.shift = APU_NOISE_SHIFT_INIT;
+		}
+
+		void 
+		_nes_apu::restore(
+			__in const nes_apu_snapshot &snapshot
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_amplitude = snapshot.amplitude;
+			m_blip.clear();
+			m_blip_time = snapshot.blip_time;
+			m_changed = snapshot.changed;
+			m_cycles = snapshot.cycles;
+			m_master = snapshot.master;
+			m_stall = snapshot.stall;
+			std::memcpy(&m_state, &snapshot.state, sizeof(nes_apu_state));
+		}
+
+		uint32_t 
+		_nes_apu::sample_rate(void)
+		{
+			return m_sample_rate;
+		}
+
+		void 
+		_nes_apu::set_sample_rate(
+			__in uint32_t rate
+			)
+		{
+
+			if(!rate || (rate > APU_SAMPLE_RATE_MAX)) {
+				THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_INVALID_SAMPLE_RATE,
+					"rate. %lu", rate);
+			}
+
+			if(m_writer.is_active()) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_STARTED);
+			}
+
+			m_amplitude = 0;
+			m_blip.set_rates(APU_CPU_FREQUENCY, rate, APU_BLIP_FRAME_CYCLES);
+			m_blip_time = 0;
+			m_changed = true;
+			m_sample_rate = rate;
+		}
+
+		void 
+		_nes_apu::set_mapper(
+			__in nes_mapper_ptr mapper
+			)
+		{
+			m_mapper = mapper;
+		}
+
+		void 
+		_nes_apu::set_master(
+			__in uint64_t master
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_master = (master - (master % APU_MASTER_DIVIDER));
+		}
+
+		void 
+		_nes_apu::set_sink(
+			__in nes_apu_sink_t type,
+			__in_opt const std::string &path,
+			__in_opt const nes_apu_output &output
+			)
+		{
+
+			if(type > NES_APU_SINK_MAX) {
+				THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_INVALID_SINK,
+					"type. %lu", type);
+			}
+
+			if(((type == NES_APU_SINK_RAW) || (type == NES_APU_SINK_WAV)) && path.empty()) {
+				THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_INVALID_SINK,
+					"type. %lu, path. %s", type, CHECK_STR(path));
+			}
+
+			if((type == NES_APU_SINK_CALLBACK) && !output) {
+				THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_INVALID_SINK,
+					"type. %lu", type);
+			}
+
+			m_writer.stop();
+			m_sink = type;
+			m_sink_output = output;
+			m_sink_path = path;
+
+			if(m_started && (m_sink != NES_APU_SINK_NONE)) {
+				m_writer.start(m_buffer, m_sink, m_sink_path, m_sample_rate, m_sink_output);
+			}
+		}
+
+		void 
+		_nes_apu::set_sync(
+			__in nes_apu_sync_t sync
+			)
+		{
+
+			if(sync > NES_APU_SYNC_MAX) {
+				THROW_NES_APU_EXCEPTION_MESSAGE(NES_APU_EXCEPTION_INVALID_SYNC,
+					"sync. %lu", sync);
+			}
+
+			m_sync = sync;
+		}
+
+		void 
+		_nes_apu::skip(
+			__in uint32_t cycles
+			)
+		{
+			uint32_t count, odd = ((cycles + (m_cycles & 1)) / 2);
+
+			count = skip_timer(m_state.pulse_1.timer, m_state.pulse_1.period, odd);
+			m_state.pulse_1.sequence = ((m_state.pulse_1.sequence + count) % APU_DUTY_LENGTH);
+			count = skip_timer(m_state.pulse_2.timer, m_state.pulse_2.period, odd);
+			m_state.pulse_2.sequence = ((m_state.pulse_2.sequence + count) % APU_DUTY_LENGTH);
+			skip_timer(m_state.triangle.timer, m_state.triangle.period, cycles);
+
+			count = skip_timer(m_state.noise.timer, m_state.noise.period - 1, cycles);
+			for(; count; --count) {
+				clock_noise(m_state.noise);
+			}
+
+			count = skip_timer(m_state.dmc.timer, APU_DMC_RATE[m_state.dmc.control 
+				& APU_DMC_CONTROL_RATE] - 1, cycles);
+			for(; count; --count) {
+				clock_dmc();
+			}
+
+			m_blip_time += cycles;
+			m_cycles += cycles;
+			m_state.frame_cycle += cycles;
+		}
+
+		uint32_t 
+		_nes_apu::skip_timer(
+			__inout uint16_t &timer,
+			__in uint16_t reload,
+			__in uint32_t cycles
+			)
+		{
+			uint32_t remaining, result = 0;
+
+			if(cycles <= timer) {
+				timer -= cycles;
+			} else {
+				remaining = (cycles - timer - 1);
+				result = ((remaining / (reload + 1)) + 1);
+				timer = (reload - (remaining % (reload + 1)));
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_apu::snapshot(
+			__out nes_apu_snapshot &snapshot
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			std::memset(&snapshot, 0, sizeof(nes_apu_snapshot));
+			snapshot.amplitude = m_amplitude;
+			snapshot.blip_time = m_blip_time;
+			snapshot.changed = m_changed;
+			snapshot.cycles = m_cycles;
+			snapshot.master = m_master;
+			snapshot.stall = m_stall;
+			std::memcpy(&snapshot.state, &m_state, sizeof(nes_apu_state));
+		}
+
+		void 
+		_nes_apu::start(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(m_started) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_STARTED);
+			}
+
+			if(m_sink != NES_APU_SINK_NONE) {
+				m_writer.start(m_buffer, m_sink, m_sink_path, m_sample_rate, m_sink_output);
+			}
+
+			m_started = true;
+		}
+
+		void 
+		_nes_apu::step(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_started) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_STOPPED);
+			}
+
+			advance_cycle();
+			m_master += APU_MASTER_DIVIDER;
+		}
+
+		void 
+		_nes_apu::stop(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_started) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_STOPPED);
+			}
+
+			m_started = false;
+			m_writer.stop();
+		}
+
+		uint16_t 
+		_nes_apu::sweep_target(
+			__in const nes_apu_pulse &pulse,
+			__in bool complement
+			)
+		{
+			uint16_t change = (pulse.period >> (pulse.sweep & APU_SWEEP_SHIFT));
+
+			if(pulse.sweep & APU_SWEEP_NEGATE) {
+				return (pulse.period - change - (complement ? 1 : 0));
+			}
+
+			return (pulse.period + change);
+		}
+
+		nes_apu_sink_t 
+		_nes_apu::sink(void)
+		{
+			return m_sink;
+		}
+
+		nes_apu_sync_t 
+		_nes_apu::sync(void)
+		{
+			return m_sync;
+		}
+
+		void 
+		_nes_apu::synchronize(
+			__in uint64_t master
+			)
+		{
+			uint64_t cycles;
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_started) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_STOPPED);
+			}
+
+			if(master < m_master) {
+				m_master = (master - (master % APU_MASTER_DIVIDER));
+				return;
+			}
+
+			cycles = ((master - m_master) / APU_MASTER_DIVIDER);
+			if(!cycles) {
+				return;
+			}
+
+			advance(cycles);
+			m_master += (cycles * APU_MASTER_DIVIDER);
+		}
+
+		std::string 
+		_nes_apu::to_string(
+			__in_opt bool verbose
+			)
+		{
+			std::stringstream result;
+
+			result << "<" << NES_APU_HEADER << "> ("
+				<< (m_initialized ? INITIALIZED : UNINITIALIZED);
+
+			if(verbose) {
+				result << ", ptr. 0x" << VALUE_AS_HEX(nes_apu_ptr, this);
+			}
+
+			result << ")";
+
+			if(m_initialized) {
+				result << ", CYC: " << m_cycles
+					<< ", RATE: " << m_sample_rate
+					<< ", BUF: " << m_buffer.size() << "/" << m_buffer.capacity();
+			}
+
+			return result.str();
+		}
+
+		void 
+		_nes_apu::uninitialize(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(m_started) {
+				stop();
+			}
+
+			m_cycles = 0;
+			m_mapper = NULL;
+			m_master = 0;
+			m_initialized = false;
+		}
+
+		void 
+		_nes_apu::write(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_changed = true;
+
+			switch(address) {
+				case APU_REGISTER_PULSE_1_CONTROL:
+				case APU_REGISTER_PULSE_1_SWEEP:
+				case APU_REGISTER_PULSE_1_LOW:
+				case APU_REGISTER_PULSE_1_HIGH:
+					write_pulse(m_state.pulse_1, address - APU_REGISTER_PULSE_1_CONTROL, 
+						value);
+					break;
+				case APU_REGISTER_PULSE_2_CONTROL:
+				case APU_REGISTER_PULSE_2_SWEEP:
+				case APU_REGISTER_PULSE_2_LOW:
+				case APU_REGISTER_PULSE_2_HIGH:
+					write_pulse(m_state.pulse_2, address - APU_REGISTER_PULSE_2_CONTROL, 
+						value);
+					break;
+				case APU_REGISTER_TRIANGLE_CONTROL:
+					m_state.triangle.control = value;
+					break;
+				case APU_REGISTER_TRIANGLE_LOW:
+					m_state.triangle.period = ((m_state.triangle.period & (APU_PERIOD_HIGH_MASK << BITS_PER_BYTE)) | value);
+					break;
+				case APU_REGISTER_TRIANGLE_HIGH:
+					m_state.triangle.period = ((m_state.triangle.period & UINT8_MAX) 
+						| ((value & APU_PERIOD_HIGH_MASK) << BITS_PER_BYTE));
+
+					if(m_state.triangle.enabled) {
+						m_state.triangle.length = APU_LENGTH[value >> APU_LENGTH_SHIFT];
+					}
+
+					m_state.triangle.linear_reload = true;
+					break;
+				case APU_REGISTER_NOISE_CONTROL:
+					m_state.noise.control = value;
+					break;
+				case APU_REGISTER_NOISE_PERIOD:
+					m_state.noise.mode = ((value & APU_NOISE_MODE) != 0);
+					m_state.noise.period = APU_NOISE_PERIOD_TABLE[value & APU_NOISE_PERIOD];
+					break;
+				case APU_REGISTER_NOISE_LENGTH:
+
+					if(m_state.noise.enabled) {
+						m_state.noise.length = APU_LENGTH[value >> APU_LENGTH_SHIFT];
+					}
+
+					m_state.noise.envelope.start = true;
+					break;
+				case APU_REGISTER_DMC_CONTROL:
+					m_state.dmc.control = value;
+
+					if(!(value & APU_DMC_CONTROL_IRQ)) {
+						m_state.dmc.irq = false;
+					}
+					break;
+				case APU_REGISTER_DMC_LOAD:
+					m_state.dmc.level = (value & APU_DMC_LEVEL_MASK);
+					break;
+				case APU_REGISTER_DMC_ADDRESS:
+					m_state.dmc.address = (APU_DMC_ADDRESS_BASE 
+						+ (value * APU_DMC_ADDRESS_SCALE));
+					break;
+				case APU_REGISTER_DMC_LENGTH:
+					m_state.dmc.length = ((value * APU_DMC_LENGTH_SCALE) + 1);
+					break;
+				case APU_REGISTER_STATUS:
+					m_state.pulse_1.enabled = ((value & APU_STATUS_PULSE_1) != 0);
+					if(!m_state.pulse_1.enabled) {
+						m_state.pulse_1.length = 0;
+					}
+
+					m_state.pulse_2.enabled = ((value & APU_STATUS_PULSE_2) != 0);
+					if(!m_state.pulse_2.enabled) {
+						m_state.pulse_2.length = 0;
+					}
+
+					m_state.triangle.enabled = ((value & APU_STATUS_TRIANGLE) != 0);
+					if(!m_state.triangle.enabled) {
+						m_state.triangle.length = 0;
+					}
+
+					m_state.noise.enabled = ((value & APU_STATUS_NOISE) != 0);
+					if(!m_state.noise.enabled) {
+						m_state.noise.length = 0;
+					}
+
+					m_state.dmc.irq = false;
+
+					if(value & APU_STATUS_DMC) {
+
+						if(!m_state.dmc.remaining) {
+							dmc_restart(m_state.dmc);
+						}
+
+						if(m_state.dmc.buffer_empty && m_state.dmc.remaining) {
+							dmc_fetch();
+						}
+					} else {
+						m_state.dmc.remaining = 0;
+					}
+					break;
+				case APU_REGISTER_FRAME:
+					m_state.frame_control = value;
+					m_state.frame_cycle = 0;
+
+					if(value & APU_FRAME_INHIBIT) {
+						m_state.frame_irq = false;
+					}
+
+					if(value & APU_FRAME_MODE) {
+						clock_frame_quarter(m_state);
+						clock_frame_half(m_state);
+					}
+					break;
+				default:
+					break;
+			}
+		}
+
+		void 
+		_nes_apu::write_pulse(
+			__inout nes_apu_pulse &pulse,
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+
+			switch(address) {
+				case APU_REGISTER_PULSE_1_CONTROL - APU_REGISTER_BASE:
+					pulse.control = value;
+					break;
+				case APU_REGISTER_PULSE_1_SWEEP - APU_REGISTER_BASE:
+					pulse.sweep = value;
+					pulse.sweep_reload = true;
+					break;
+				case APU_REGISTER_PULSE_1_LOW - APU_REGISTER_BASE:
+					pulse.period = ((pulse.period & (APU_PERIOD_HIGH_MASK << BITS_PER_BYTE)) | value);
+					break;
+				case APU_REGISTER_PULSE_1_HIGH - APU_REGISTER_BASE:
+					pulse.period = ((pulse.period & UINT8_MAX) 
+						| ((value & APU_PERIOD_HIGH_MASK) << BITS_PER_BYTE));
+
+					if(pulse.enabled) {
+						pulse.length = APU_LENGTH[value >> APU_LENGTH_SHIFT];
+					}
+
+					pulse.envelope.start = true;
+					pulse.sequence = 0;
+					break;
+				default:
+					break;
+			}
+		}
+	}
+}
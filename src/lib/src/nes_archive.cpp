@@ -0,0 +1,473 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../include/nes.h"
+#include "../include/nes_archive_type.h"
+
+namespace NES {
+
+	_nes_archive::_nes_archive(void) :
+		m_data(NULL),
+		m_data_file(-1),
+		m_data_length(0),
+		m_data_mapped(0),
+		m_header(NULL),
+		m_index_file(-1),
+		m_index_length(0),
+		m_slot(NULL)
+	{
+		return;
+	}
+
+	_nes_archive::~_nes_archive(void)
+	{
+		release();
+	}
+
+	uint64_t 
+	_nes_archive::append(
+		__in const uint8_t *data,
+		__in size_t length
+		)
+	{
+		ssize_t written;
+		size_t position = 0;
+		uint64_t result = m_data_length;
+
+		while(position < length) {
+
+			written = pwrite(m_data_file, data + position, length - position, 
+				m_data_length + position);
+			if(written <= 0) {
+				THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_FILE,
+					"%s", CHECK_STR(m_path));
+			}
+
+			position += written;
+		}
+
+		m_data_length += length;
+		if(m_data_length > m_data_mapped) {
+			map(m_data_length);
+		}
+
+		return result;
+	}
+
+	void 
+	_nes_archive::close(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		if(m_data_file < 0) {
+			THROW_NES_ARCHIVE_EXCEPTION(NES_ARCHIVE_EXCEPTION_CLOSED);
+		}
+
+		release();
+	}
+
+	bool 
+	_nes_archive::contains(
+		__in uint64_t key
+		)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		if(m_data_file < 0) {
+			THROW_NES_ARCHIVE_EXCEPTION(NES_ARCHIVE_EXCEPTION_CLOSED);
+		}
+
+		return (find(key)->raw != 0);
+	}
+
+	size_t 
+	_nes_archive::count(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		return (m_header ? m_header->count : 0);
+	}
+
+	nes_archive_slot *
+	_nes_archive::find(
+		__in uint64_t key
+		)
+	{
+		uint64_t index, mask = (m_header->capacity - 1);
+
+		for(index = (key & mask); m_slot[index].raw; index = ((index + 1) & mask)) {
+
+			if(m_slot[index].key == key) {
+				break;
+			}
+		}
+
+		return &m_slot[index];
+	}
+
+	size_t 
+	_nes_archive::get(
+		__in uint64_t key,
+		__out std::vector<uint8_t> &state
+		)
+	{
+		nes_archive_slot *slot = NULL;
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		if(m_data_file < 0) {
+			THROW_NES_ARCHIVE_EXCEPTION(NES_ARCHIVE_EXCEPTION_CLOSED);
+		}
+
+		slot = find(key);
+		if(!slot->raw) {
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_NOT_FOUND,
+				"key. %016lx", key);
+		}
+
+		if((slot->offset + slot->length) > m_data_length) {
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_MALFORMED,
+				"key. %016lx, offset. %lu, length. %u", key, slot->offset, slot->length);
+		}
+
+		state.resize(slot->raw);
+
+		if(slot->raw == m_header->reference_length) {
+			std::memcpy(&state[0], m_data + m_header->reference_offset, slot->raw);
+		} else {
+			std::memset(&state[0], 0, slot->raw);
+		}
+
+		nes_rewind::decode(m_data + slot->offset, slot->length, &state[0], slot->raw);
+
+		return slot->raw;
+	}
+
+	void 
+	_nes_archive::grow(void)
+	{
+		int file;
+		std::string path;
+		void *mapping = MAP_FAILED;
+		nes_archive_header *header = NULL;
+		nes_archive_slot *slot = NULL;
+		uint64_t capacity = (m_header->capacity * 2), index, iter = 0, mask = (capacity - 1);
+		size_t length = (sizeof(nes_archive_header) + (capacity * sizeof(nes_archive_slot)));
+
+		path = (m_path + NES_ARCHIVE_INDEX_EXTENSION + ARCHIVE_INDEX_TEMPORARY);
+
+		file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, ARCHIVE_FILE_MODE);
+		if(file < 0) {
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_FILE,
+				"%s", CHECK_STR(path));
+		}
+
+		if(!ftruncate(file, length)) {
+			mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		}
+
+		if(mapping == MAP_FAILED) {
+			::close(file);
+			unlink(path.c_str());
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_MAPPING,
+				"%s", CHECK_STR(path));
+		}
+
+		header = (nes_archive_header *) mapping;
+		*header = *m_header;
+		header->capacity = capacity;
+		slot = (nes_archive_slot *) (header + 1);
+
+		for(; iter < m_header->capacity; ++iter) {
+
+			if(m_slot[iter].raw) {
+
+				for(index = (m_slot[iter].key & mask); slot[index].raw; 
+						index = ((index + 1) & mask));
+
+				slot[index] = m_slot[iter];
+			}
+		}
+
+		if(std::rename(path.c_str(), (m_path + NES_ARCHIVE_INDEX_EXTENSION).c_str())) {
+			munmap(mapping, length);
+			::close(file);
+			unlink(path.c_str());
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_FILE,
+				"%s", CHECK_STR(path));
+		}
+
+		munmap(m_header, m_index_length);
+		::close(m_index_file);
+		m_header = header;
+		m_index_file = file;
+		m_index_length = length;
+		m_slot = slot;
+	}
+
+	bool 
+	_nes_archive::is_open(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		return (m_data_file >= 0);
+	}
+
+	void 
+	_nes_archive::map(
+		__in size_t length
+		)
+	{
+		void *mapping = MAP_FAILED;
+		size_t mapped = (m_data_mapped ? m_data_mapped : ARCHIVE_DATA_RESERVE);
+
+		while(mapped < length) {
+			mapped *= 2;
+		}
+
+		mapping = mmap(NULL, mapped, PROT_READ, MAP_SHARED, m_data_file, 0);
+		if(mapping == MAP_FAILED) {
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_MAPPING,
+				"%s", CHECK_STR(m_path));
+		}
+
+		madvise(mapping, mapped, MADV_RANDOM);
+
+		if(m_data) {
+			munmap(m_data, m_data_mapped);
+		}
+
+		m_data = (uint8_t *) mapping;
+		m_data_mapped = mapped;
+	}
+
+	void 
+	_nes_archive::open(
+		__in const std::string &path
+		)
+	{
+		struct stat status;
+		void *mapping = MAP_FAILED;
+		nes_archive_data_header data = { ARCHIVE_DATA_MAGIC, ARCHIVE_VERSION };
+		nes_archive_header index = { ARCHIVE_INDEX_CAPACITY, 0, ARCHIVE_INDEX_MAGIC, 0, 0, 
+			ARCHIVE_VERSION };
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		if(m_data_file >= 0) {
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_OPEN,
+				"%s", CHECK_STR(m_path));
+		}
+
+		m_path = path;
+
+		m_data_file = ::open(path.c_str(), O_RDWR | O_CREAT, ARCHIVE_FILE_MODE);
+		m_index_file = ::open((path + NES_ARCHIVE_INDEX_EXTENSION).c_str(), O_RDWR | O_CREAT, 
+			ARCHIVE_FILE_MODE);
+		if((m_data_file < 0) || (m_index_file < 0) || fstat(m_data_file, &status)) {
+			release();
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_FILE,
+				"%s", CHECK_STR(path));
+		}
+
+		if(!status.st_size) {
+			m_data_length = 0;
+			append((const uint8_t *) &data, sizeof(data));
+		} else if((status.st_size < (off_t) sizeof(data))
+				|| (pread(m_data_file, &data, sizeof(data), 0) != (ssize_t) sizeof(data))
+				|| (data.magic != ARCHIVE_DATA_MAGIC)
+				|| (data.version != ARCHIVE_VERSION)) {
+			release();
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_MALFORMED,
+				"%s", CHECK_STR(path));
+		} else {
+			m_data_length = status.st_size;
+			map(m_data_length);
+		}
+
+		if(fstat(m_index_file, &status)) {
+			release();
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_FILE,
+				"%s", CHECK_STR(path));
+		}
+
+		if(!status.st_size) {
+			status.st_size = (sizeof(nes_archive_header) 
+				+ (ARCHIVE_INDEX_CAPACITY * sizeof(nes_archive_slot)));
+
+			if(ftruncate(m_index_file, status.st_size)
+					|| (pwrite(m_index_file, &index, sizeof(index), 0) 
+						!= (ssize_t) sizeof(index))) {
+				release();
+				THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_FILE,
+					"%s", CHECK_STR(path));
+			}
+		} else if((status.st_size < (off_t) sizeof(index))
+				|| (pread(m_index_file, &index, sizeof(index), 0) != (ssize_t) sizeof(index))
+				|| (index.magic != ARCHIVE_INDEX_MAGIC)
+				|| (index.version != ARCHIVE_VERSION)
+				|| !index.capacity
+				|| (index.capacity & (index.capacity - 1))
+				|| ((index.count * ARCHIVE_INDEX_LOAD) > index.capacity)
+				|| (status.st_size != (off_t) (sizeof(nes_archive_header) 
+					+ (index.capacity * sizeof(nes_archive_slot))))
+				|| ((index.reference_offset + index.reference_length) > m_data_length)) {
+			release();
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_MALFORMED,
+				"%s", CHECK_STR(path));
+		}
+
+		mapping = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, 
+			m_index_file, 0);
+		if(mapping == MAP_FAILED) {
+			release();
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_MAPPING,
+				"%s", CHECK_STR(path));
+		}
+
+		m_header = (nes_archive_header *) mapping;
+		m_index_length = status.st_size;
+		m_slot = (nes_archive_slot *) (m_header + 1);
+	}
+
+	uint64_t 
+	_nes_archive::put(
+		__in const uint8_t *state,
+		__in size_t length
+		)
+	{
+		size_t encoded;
+		uint64_t offset, result;
+		const uint8_t *previous = NULL;
+		nes_archive_slot *slot = NULL;
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		if(!state || !length || (length > ARCHIVE_STATE_MAX)) {
+			THROW_NES_ARCHIVE_EXCEPTION_MESSAGE(NES_ARCHIVE_EXCEPTION_INVALID_STATE,
+				"ptr. 0x%p, length. %u", state, length);
+		}
+
+		if(m_data_file < 0) {
+			THROW_NES_ARCHIVE_EXCEPTION(NES_ARCHIVE_EXCEPTION_CLOSED);
+		}
+
+		result = nes_hash::generate(state, length);
+
+		slot = find(result);
+		if(slot->raw) {
+			return result;
+		}
+
+		if(!m_header->reference_length) {
+			m_header->reference_offset = append(state, length);
+			m_header->reference_length = length;
+		}
+
+		if(length == m_header->reference_length) {
+			previous = (m_data + m_header->reference_offset);
+		} else {
+
+			if(m_zero.size() < length) {
+				m_zero.resize(length, 0);
+			}
+
+			previous = &m_zero[0];
+		}
+
+		m_scratch.resize(nes_rewind::encode_bound(length));
+		encoded = nes_rewind::encode(previous, state, length, &m_scratch[0]);
+		offset = append(&m_scratch[0], encoded);
+
+		if(((m_header->count + 1) * ARCHIVE_INDEX_LOAD) > m_header->capacity) {
+			grow();
+			slot = find(result);
+		}
+
+		slot->key = result;
+		slot->length = encoded;
+		slot->offset = offset;
+		slot->raw = length;
+		++m_header->count;
+
+		return result;
+	}
+
+	void 
+	_nes_archive::release(void)
+	{
+
+		if(m_data) {
+			munmap(m_data, m_data_mapped);
+			m_data = NULL;
+		}
+
+		if(m_header) {
+			munmap(m_header, m_index_length);
+			m_header = NULL;
+		}
+
+		if(m_data_file >= 0) {
+			::close(m_data_file);
+			m_data_file = -1;
+		}
+
+		if(m_index_file >= 0) {
+			::close(m_index_file);
+			m_index_file = -1;
+		}
+
+		m_data_length = 0;
+		m_data_mapped = 0;
+		m_index_length = 0;
+		m_path.clear();
+		m_scratch.clear();
+		m_slot = NULL;
+		m_zero.clear();
+	}
+
+	std::string 
+	_nes_archive::to_string(
+		__in_opt bool verbose
+		)
+	{
+		std::stringstream result;
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		result << "<" << NES_ARCHIVE_HEADER << "> (" 
+			<< ((m_data_file >= 0) ? ARCHIVE_OPEN : ARCHIVE_CLOSED); 
+
+		if(verbose) {
+			result << ", ptr. 0x" << VALUE_AS_HEX(nes_archive_ptr, this);
+		}
+
+		result << ")";
+
+		if(m_header) {
+			result << std::endl << "PTH: " << m_path
+				<< ", CNT: " << m_header->count << "/" << m_header->capacity
+				<< ", SZ: " << (m_data_length / BYTES_PER_KBYTE) << " KB";
+		}
+
+		return result.str();
+	}
+}
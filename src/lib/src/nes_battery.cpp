@@ -0,0 +1,218 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../include/nes.h"
+#include "../include/nes_battery_type.h"
+
+namespace NES {
+
+	_nes_battery::_nes_battery(void) :
+		m_file(-1),
+		m_length(0),
+		m_mapping(NULL),
+		m_ram(NULL)
+	{
+		return;
+	}
+
+	_nes_battery::~_nes_battery(void)
+	{
+
+		if(m_mapping) {
+
+			try {
+				flush(true);
+			} catch(...) { }
+
+			release();
+		}
+	}
+
+	void 
+	_nes_battery::close(void)
+	{
+
+		if(!m_mapping) {
+			THROW_NES_BATTERY_EXCEPTION(NES_BATTERY_EXCEPTION_CLOSED);
+		}
+
+		flush(true);
+		release();
+	}
+
+	bool 
+	_nes_battery::flush(
+		__in_opt bool sync
+		)
+	{
+		bool result;
+
+		if(!m_mapping) {
+			THROW_NES_BATTERY_EXCEPTION(NES_BATTERY_EXCEPTION_CLOSED);
+		}
+
+		result = (std::memcmp(m_mapping, m_ram, m_length) != 0);
+		if(result) {
+			std::memcpy(m_mapping, m_ram, m_length);
+		}
+
+		if((result || sync) && msync(m_mapping, m_length, sync ? MS_SYNC : MS_ASYNC)) {
+			THROW_NES_BATTERY_EXCEPTION_MESSAGE(NES_BATTERY_EXCEPTION_FILE,
+				"%s", CHECK_STR(m_path));
+		}
+
+		return result;
+	}
+
+	bool 
+	_nes_battery::is_open(void)
+	{
+		return (m_mapping != NULL);
+	}
+
+	size_t 
+	_nes_battery::length(void)
+	{
+		return m_length;
+	}
+
+	void 
+	_nes_battery::open(
+		__in const std::string &path,
+		__inout uint8_t *ram,
+		__in size_t length
+		)
+	{
+		int file;
+		struct stat status;
+		void *mapping = MAP_FAILED;
+
+		if(m_mapping) {
+			THROW_NES_BATTERY_EXCEPTION_MESSAGE(NES_BATTERY_EXCEPTION_OPEN,
+				"%s", CHECK_STR(m_path));
+		}
+
+		if(!ram || !length) {
+			THROW_NES_BATTERY_EXCEPTION_MESSAGE(NES_BATTERY_EXCEPTION_INVALID_RAM,
+				"ptr. 0x%p, length. %u", ram, length);
+		}
+
+		file = ::open(path.c_str(), O_RDWR | O_CREAT, BATTERY_FILE_MODE);
+		if(file < 0) {
+			THROW_NES_BATTERY_EXCEPTION_MESSAGE(NES_BATTERY_EXCEPTION_FILE,
+				"%s", CHECK_STR(path));
+		}
+
+		if(flock(file, LOCK_EX | LOCK_NB)) {
+			::close(file);
+			THROW_NES_BATTERY_EXCEPTION_MESSAGE(NES_BATTERY_EXCEPTION_LOCKED,
+				"%s", CHECK_STR(path));
+		}
+
+		if(fstat(file, &status) || ((status.st_size != (off_t) length) 
+				&& ftruncate(file, length))) {
+			::close(file);
+			THROW_NES_BATTERY_EXCEPTION_MESSAGE(NES_BATTERY_EXCEPTION_FILE,
+				"%s", CHECK_STR(path));
+		}
+
+		mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		if(mapping == MAP_FAILED) {
+			::close(file);
+			THROW_NES_BATTERY_EXCEPTION_MESSAGE(NES_BATTERY_EXCEPTION_MAPPING,
+				"%s", CHECK_STR(path));
+		}
+
+		m_file = file;
+		m_length = length;
+		m_mapping = (uint8_t *) mapping;
+		m_path = path;
+		m_ram = ram;
+		std::memcpy(m_ram, m_mapping, m_length);
+	}
+
+	std::string 
+	_nes_battery::path(void)
+	{
+		return m_path;
+	}
+
+	void 
+	_nes_battery::release(void)
+	{
+
+		if(m_mapping) {
+			munmap(m_mapping, m_length);
+		}
+
+		if(m_file >= 0) {
+			::close(m_file);
+		}
+
+		m_file = -1;
+		m_length = 0;
+		m_mapping = NULL;
+		m_path.clear();
+		m_ram = NULL;
+	}
+
+	std::string 
+	_nes_battery::save_path(
+		__in const std::string &image
+		)
+	{
+		size_t position = image.find_last_of(BATTERY_PATH_DELIMITER);
+
+		if((position == std::string::npos) || (image.at(position) != '.')) {
+			position = image.size();
+		}
+
+		return (image.substr(0, position) + NES_BATTERY_EXTENSION);
+	}
+
+	std::string 
+	_nes_battery::to_string(
+		__in_opt bool verbose
+		)
+	{
+		std::stringstream result;
+
+		result << "<" << NES_BATTERY_HEADER << "> (" 
+			<< (m_mapping ? BATTERY_OPEN : BATTERY_CLOSED); 
+
+		if(verbose) {
+			result << ", ptr. 0x" << VALUE_AS_HEX(nes_battery_ptr, this);
+		}
+
+		result << ")";
+
+		if(m_mapping) {
+			result << std::endl << "PTH: " << m_path
+				<< ", SZ: " << (m_length / BYTES_PER_KBYTE) << " KB";
+		}
+
+		return result.str();
+	}
+}
@@ -0,0 +1,424 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cstring>
+#include "../include/nes.h"
+#include "../include/nes_checkpoint_type.h"
+
+namespace NES {
+
+	std::condition_variable nes_checkpoint::m_compactor_condition;
+
+	std::mutex nes_checkpoint::m_compactor_lock;
+
+	std::deque<nes_checkpoint_ptr> nes_checkpoint::m_compactor_queue;
+
+	std::mutex nes_checkpoint::m_compactor_state_lock;
+
+	bool nes_checkpoint::m_compactor_stop = false;
+
+	std::thread nes_checkpoint::m_compactor_thread;
+
+	size_t nes_checkpoint::m_compactor_users = 0;
+
+	_nes_checkpoint::_nes_checkpoint(void) :
+		m_base_id(0),
+		m_chain(NES_CHECKPOINT_CHAIN_DEFAULT),
+		m_generation(0),
+		m_initialized(false),
+		m_next(0),
+		m_scheduled(false)
+	{
+		return;
+	}
+
+	_nes_checkpoint::~_nes_checkpoint(void)
+	{
+
+		if(m_initialized) {
+			uninitialize();
+		}
+	}
+
+	void 
+	_nes_checkpoint::apply(
+		__inout std::vector<uint8_t> &snapshot,
+		__in const nes_checkpoint_delta &delta
+		)
+	{
+		size_t iter = 0, length, offset, position = 0;
+
+		for(; iter < delta.page.size(); ++iter) {
+			offset = (delta.page.at(iter) * NES_CHECKPOINT_PAGE_LENGTH);
+
+			if(offset >= snapshot.size()) {
+				THROW_NES_CHECKPOINT_EXCEPTION_MESSAGE(NES_CHECKPOINT_EXCEPTION_INVALID_SNAPSHOT,
+					"page. %u, length. %u", delta.page.at(iter), snapshot.size());
+			}
+
+			length = std::min((size_t) NES_CHECKPOINT_PAGE_LENGTH, snapshot.size() - offset);
+			std::memcpy(&snapshot[offset], &delta.data[position], length);
+			position += length;
+		}
+	}
+
+	uint64_t 
+	_nes_checkpoint::base(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		return m_base_id;
+	}
+
+	size_t 
+	_nes_checkpoint::chain(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		return m_delta.size();
+	}
+
+	void 
+	_nes_checkpoint::clear(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		++m_generation;
+		m_base.reset();
+		m_base_id = 0;
+		m_current.clear();
+		m_delta.clear();
+		m_next = 0;
+	}
+
+	uint64_t 
+	_nes_checkpoint::commit(
+		__inout std::vector<uint8_t> &snapshot
+		)
+	{
+		uint64_t result;
+		bool compact = false;
+		size_t length, offset = 0;
+		std::shared_ptr<nes_checkpoint_delta> delta;
+
+		if(!m_initialized) {
+			THROW_NES_CHECKPOINT_EXCEPTION(NES_CHECKPOINT_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(snapshot.empty()) {
+			THROW_NES_CHECKPOINT_EXCEPTION_MESSAGE(NES_CHECKPOINT_EXCEPTION_INVALID_SNAPSHOT,
+				"length. %u", snapshot.size());
+		}
+
+		if(m_current.size() != snapshot.size()) {
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			++m_generation;
+			result = m_next++;
+			m_base = std::make_shared<const std::vector<uint8_t>>(snapshot);
+			m_base_id = result;
+			m_current = snapshot;
+			m_delta.clear();
+
+			return result;
+		}
+
+		delta = std::make_shared<nes_checkpoint_delta>();
+
+		for(; offset < snapshot.size(); offset += NES_CHECKPOINT_PAGE_LENGTH) {
+			length = std::min((size_t) NES_CHECKPOINT_PAGE_LENGTH, snapshot.size() - offset);
+
+			if(std::memcmp(&snapshot[offset], &m_current[offset], length)) {
+				delta->page.push_back(offset / NES_CHECKPOINT_PAGE_LENGTH);
+				delta->data.insert(delta->data.end(), snapshot.begin() + offset,
+					snapshot.begin() + offset + length);
+			}
+		}
+
+		m_current.swap(snapshot);
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			result = m_next++;
+			delta->id = result;
+			m_delta.push_back(delta);
+			compact = (m_delta.size() > m_chain);
+		}
+
+		if(compact) {
+			schedule();
+		}
+
+		return result;
+	}
+
+	bool 
+	_nes_checkpoint::compact(void)
+	{
+		uint64_t generation;
+		size_t count, iter = 0;
+		nes_checkpoint_base_ref base;
+		std::vector<nes_checkpoint_delta_ref> fold;
+		std::shared_ptr<std::vector<uint8_t>> next;
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			if(!m_base || (m_delta.size() <= m_chain)) {
+				return false;
+			}
+
+			count = (m_delta.size() - (m_chain / 2));
+			base = m_base;
+			generation = m_generation;
+			fold.assign(m_delta.begin(), m_delta.begin() + count);
+		}
+
+		next = std::make_shared<std::vector<uint8_t>>(*base);
+
+		for(; iter < fold.size(); ++iter) {
+			apply(*next, *fold.at(iter));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			if((generation != m_generation) || (base != m_base)) {
+				return false;
+			}
+
+			m_base = next;
+			m_base_id = fold.back()->id;
+			m_delta.erase(m_delta.begin(), m_delta.begin() + count);
+		}
+
+		return true;
+	}
+
+	void 
+	_nes_checkpoint::compactor(void)
+	{
+		nes_checkpoint_ptr entry = NULL;
+
+		for(;;) {
+
+			{
+				std::unique_lock<std::mutex> lock(m_compactor_lock);
+
+				m_compactor_condition.wait(lock, [] { 
+					return (m_compactor_stop || !m_compactor_queue.empty()); 
+					});
+
+				if(m_compactor_stop) {
+					break;
+				}
+
+				entry = m_compactor_queue.front();
+				m_compactor_queue.pop_front();
+			}
+
+			try {
+				while(entry->compact());
+			} catch(...) { }
+
+			{
+				std::lock_guard<std::mutex> lock(m_compactor_lock);
+				entry->m_scheduled = false;
+			}
+
+			m_compactor_condition.notify_all();
+		}
+	}
+
+	bool 
+	_nes_checkpoint::empty(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		return !m_base;
+	}
+
+	void 
+	_nes_checkpoint::initialize(
+		__in_opt size_t chain
+		)
+	{
+		std::lock_guard<std::mutex> state(m_compactor_state_lock);
+
+		if(m_initialized) {
+			THROW_NES_CHECKPOINT_EXCEPTION(NES_CHECKPOINT_EXCEPTION_INITIALIZED);
+		}
+
+		if(!chain) {
+			THROW_NES_CHECKPOINT_EXCEPTION_MESSAGE(NES_CHECKPOINT_EXCEPTION_INVALID_CHAIN,
+				"chain. %u", chain);
+		}
+
+		clear();
+		m_chain = chain;
+
+		if(!m_compactor_users) {
+			m_compactor_stop = false;
+			m_compactor_thread = std::thread(&_nes_checkpoint::compactor);
+		}
+
+		++m_compactor_users;
+		m_initialized = true;
+	}
+
+	bool 
+	_nes_checkpoint::is_initialized(void)
+	{
+		return m_initialized;
+	}
+
+	uint64_t 
+	_nes_checkpoint::last(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		return (m_next ? (m_next - 1) : 0);
+	}
+
+	void 
+	_nes_checkpoint::reconstruct(
+		__in uint64_t id,
+		__out std::vector<uint8_t> &snapshot
+		)
+	{
+		size_t iter = 0;
+		nes_checkpoint_base_ref base;
+		std::vector<nes_checkpoint_delta_ref> chain;
+
+		if(!m_initialized) {
+			THROW_NES_CHECKPOINT_EXCEPTION(NES_CHECKPOINT_EXCEPTION_UNINITIALIZED);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			if(!m_base || (id < m_base_id) || (id >= m_next)) {
+				THROW_NES_CHECKPOINT_EXCEPTION_MESSAGE(NES_CHECKPOINT_EXCEPTION_INVALID_ID,
+					"id. %lu (expecting %lu-%lu)", id, m_base_id, m_next);
+			}
+
+			base = m_base;
+			chain.assign(m_delta.begin(), m_delta.begin() + (id - m_base_id));
+		}
+
+		snapshot.assign(base->begin(), base->end());
+
+		for(; iter < chain.size(); ++iter) {
+			apply(snapshot, *chain.at(iter));
+		}
+	}
+
+	uint64_t 
+	_nes_checkpoint::retained(void)
+	{
+		uint64_t last;
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		last = (m_next ? (m_next - 1) : 0);
+
+		return std::max(m_base_id, last - std::min(last, (uint64_t) (m_chain / 2)));
+	}
+
+	void 
+	_nes_checkpoint::schedule(void)
+	{
+
+		{
+			std::lock_guard<std::mutex> lock(m_compactor_lock);
+
+			if(m_scheduled) {
+				return;
+			}
+
+			m_scheduled = true;
+			m_compactor_queue.push_back(this);
+		}
+
+		m_compactor_condition.notify_all();
+	}
+
+	std::string 
+	_nes_checkpoint::to_string(
+		__in_opt bool verbose
+		)
+	{
+		std::stringstream result;
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		result << "<" << NES_CHECKPOINT_HEADER << "> (" 
+			<< (m_initialized ? INITIALIZED : UNINITIALIZED); 
+
+		if(verbose) {
+			result << ", ptr. 0x" << VALUE_AS_HEX(nes_checkpoint_ptr, this);
+		}
+
+		result << ")";
+
+		if(m_initialized) {
+			result << std::endl << "CHN: " << m_delta.size() << "/" << m_chain
+				<< ", BAS: " << m_base_id
+				<< ", NXT: " << m_next;
+		}
+
+		return result.str();
+	}
+
+	void 
+	_nes_checkpoint::uninitialize(void)
+	{
+		std::deque<nes_checkpoint_ptr>::iterator entry;
+		std::lock_guard<std::mutex> state(m_compactor_state_lock);
+
+		if(!m_initialized) {
+			THROW_NES_CHECKPOINT_EXCEPTION(NES_CHECKPOINT_EXCEPTION_UNINITIALIZED);
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_compactor_lock);
+
+			entry = std::find(m_compactor_queue.begin(), m_compactor_queue.end(), this);
+			if(entry != m_compactor_queue.end()) {
+				m_compactor_queue.erase(entry);
+				m_scheduled = false;
+			}
+
+			m_compactor_condition.wait(lock, [this] { return !m_scheduled; });
+
+			if(!--m_compactor_users) {
+				m_compactor_stop = true;
+			}
+		}
+
+		if(m_compactor_stop) {
+			m_compactor_condition.notify_all();
+			m_compactor_thread.join();
+		}
+
+		clear();
+		m_initialized = false;
+	}
+}
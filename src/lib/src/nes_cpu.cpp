@@ -17,8 +17,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include "../include/nes.h"
+#include "../include/nes_apu_type.h"
 #include "../include/nes_cpu_type.h"
+#include "../include/nes_mapper_type.h"
+#include "../include/nes_ppu_type.h"
 
 namespace NES {
 
@@ -26,10 +30,24 @@ namespace NES {
 
 		_nes_cpu *_nes_cpu::m_instance = NULL;
 
-		_nes_cpu::_nes_cpu(void) :
+		_nes_cpu::_nes_cpu(
+			__in nes_memory_ptr memory,
+			__in nes_ppu_ptr ppu,
+			__in nes_apu_ptr apu
+			) :
+			m_apu(apu),
+			m_apu_event(0),
+			m_apu_irq(false),
+			m_apu_sync(false),
 			m_cycles(CPU_CYCLES_INIT),
 			m_initialized(false),
-			m_memory(nes_memory::acquire()),
+			m_mapper(NULL),
+			m_mapper_irq(false),
+			m_memory(memory),
+			m_ppu(ppu),
+			m_ppu_event(0),
+			m_ppu_poll(false),
+			m_ram(NULL),
 			m_register_a(CPU_REGISTER_A_INIT),
 			m_register_p(CPU_REGISTER_P_INIT),
 			m_register_sp(CPU_REGISTER_SP_INIT),
@@ -37,7 +55,7 @@ namespace NES {
 			m_register_y(CPU_REGISTER_Y_INIT),
 			m_register_pc(CPU_REGISTER_PC_INIT)
 		{
-			std::atexit(nes_cpu::_delete);
+			return;
 		}
 
 		_nes_cpu::~_nes_cpu(void)
@@ -64,10 +82,9 @@ namespace NES {
 
 			if(!nes_cpu::m_instance) {
 
-				nes_cpu::m_instance = new nes_cpu;
-				if(!nes_cpu::m_instance) {
-					THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_ALLOCATED);
-				}
+				nes_cpu::m_instance = create(nes_memory::acquire(), nes_ppu::acquire(), 
+					nes_apu::acquire());
+				std::atexit(nes_cpu::_delete);
 			}
 
 			return nes_cpu::m_instance;
@@ -81,8 +98,6 @@ namespace NES {
 		{
 			uint8_t high, low;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			high = (value / 10);
 			low = (value % 10);
 
@@ -94,7 +109,6 @@ namespace NES {
 			__in uint8_t value
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return ((((value & 0xf0) >> 4) * 10) + (value & 0xf));
 		}
 #endif // CPU_RPA203
@@ -102,25 +116,50 @@ namespace NES {
 		void 
 		_nes_cpu::clear(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
 			}
 
+			m_apu_event = 0;
+			m_apu_irq = false;
+			m_apu_sync = false;
 			m_cycles = CPU_CYCLES_INIT;
+			m_mapper_irq = false;
+			m_ppu_event = 0;
+			m_ppu_poll = false;
 			m_register_a = CPU_REGISTER_A_INIT;
 			m_register_p = CPU_REGISTER_P_INIT;
 			m_register_pc = CPU_REGISTER_PC_INIT;
 			m_register_sp = CPU_REGISTER_SP_INIT;
 			m_register_x = CPU_REGISTER_X_INIT;
 			m_register_y = CPU_REGISTER_Y_INIT;
+
+			if(m_ppu->is_initialized()) {
+				m_ppu->rebase(master());
+			}
+		}
+
+		_nes_cpu *
+		_nes_cpu::create(
+			__in nes_memory_ptr memory,
+			__in nes_ppu_ptr ppu,
+			__in nes_apu_ptr apu
+			)
+		{
+			_nes_cpu *result = NULL;
+
+			result = new nes_cpu(memory, ppu, apu);
+			if(!result) {
+				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_ALLOCATED);
+			}
+
+			return result;
 		}
 
-		uint32_t 
+		uint64_t 
 		_nes_cpu::cycles(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
@@ -137,8 +176,6 @@ namespace NES {
 			bool boundary = false;
 			uint8_t orig = 0, value = 0;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_ADC_ABSOLUTE:
 					orig = load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -224,8 +261,6 @@ namespace NES {
 		{
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_AND_ABSOLUTE:
 					m_register_a &= load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -293,8 +328,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_ASL_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -369,8 +402,6 @@ namespace NES {
 			int8_t offset;
 			bool boundary = false, branch = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_BCC_RELATIVE:
 					branch = !CPU_FLAG_CHECK(m_register_p, CPU_FLAG_CARRY);
@@ -424,8 +455,6 @@ namespace NES {
 			uint8_t value = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_BIT_ABSOLUTE:
 					value = (m_register_a & load(operand(CPU_MODE_ABSOLUTE, boundary)));
@@ -452,7 +481,6 @@ namespace NES {
 			__in uint8_t code
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(code != CPU_CODE_BRK_IMPLIED) {
 				THROW_NES_CPU_EXCEPTION_MESSAGE(NES_CPU_EXCEPTION_EXPECTING_BRK_CODE,
@@ -468,7 +496,6 @@ namespace NES {
 			__in uint8_t code
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			switch(code) {
 				case CPU_CODE_CLC_IMPLIED:
@@ -512,8 +539,6 @@ namespace NES {
 			uint8_t value = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_CMP_ABSOLUTE:
 					value = load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -582,8 +607,6 @@ namespace NES {
 			uint8_t value = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_CPX_ABSOLUTE:
 					value = load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -617,8 +640,6 @@ namespace NES {
 			uint8_t value = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_CPY_ABSOLUTE:
 					value = load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -653,8 +674,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_DEC_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -691,8 +710,6 @@ namespace NES {
 		{
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_EOR_ABSOLUTE:
 					m_register_a ^= load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -760,8 +777,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_INC_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -798,8 +813,6 @@ namespace NES {
 		{
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_JMP_ABSOLUTE:
 					m_register_pc = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -822,8 +835,6 @@ namespace NES {
 		{
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			if(code != CPU_CODE_JSR_ABSOLUTE) {
 				THROW_NES_CPU_EXCEPTION_MESSAGE(NES_CPU_EXCEPTION_EXPECTING_JSR_CODE,
 					"0x%x", code);
@@ -840,8 +851,6 @@ namespace NES {
 		{
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_LDA_ABSOLUTE:
 					m_register_a = load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -907,8 +916,6 @@ namespace NES {
 		{
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_LDX_ABSOLUTE:
 					m_register_x = load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -952,8 +959,6 @@ namespace NES {
 		{
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_LDY_ABSOLUTE:
 					m_register_y = load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -999,8 +1004,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_LSR_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -1064,7 +1067,6 @@ namespace NES {
 			__in uint8_t code
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(code != CPU_CODE_NOP_IMPLIED) {
 				THROW_NES_CPU_EXCEPTION_MESSAGE(NES_CPU_EXCEPTION_EXPECTING_NOP_CODE,
@@ -1081,8 +1083,6 @@ namespace NES {
 		{
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_ORA_ABSOLUTE:
 					m_register_a |= load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -1147,7 +1147,6 @@ namespace NES {
 			)
 		{
 			uint8_t value = 0;
-			ATOMIC_CALL_RECUR(m_lock);
 
 			switch(code) {
 				case CPU_CODE_DEX_IMPLIED:
@@ -1193,8 +1192,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false, carry = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_ROL_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -1265,8 +1262,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false, carry = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_ROR_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -1333,7 +1328,6 @@ namespace NES {
 			__in uint8_t code
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(code != CPU_CODE_RTI_IMPLIED) {
 				THROW_NES_CPU_EXCEPTION_MESSAGE(NES_CPU_EXCEPTION_EXPECTING_RTI_CODE,
@@ -1349,7 +1343,6 @@ namespace NES {
 			__in uint8_t code
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(code != CPU_CODE_RTS_IMPLIED) {
 				THROW_NES_CPU_EXCEPTION_MESSAGE(NES_CPU_EXCEPTION_EXPECTING_RTS_CODE,
@@ -1368,8 +1361,6 @@ namespace NES {
 			uint8_t value = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_SBC_ABSOLUTE:
 					value = load(operand(CPU_MODE_ABSOLUTE, boundary));
@@ -1452,8 +1443,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_STA_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -1498,8 +1487,6 @@ namespace NES {
 		{
 			size_t cycles = 0;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_PHA_IMPLIED:
 					push(m_register_a);
@@ -1547,8 +1534,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_STX_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -1578,8 +1563,6 @@ namespace NES {
 			uint16_t address = 0;
 			bool boundary = false;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(code) {
 				case CPU_CODE_STY_ABSOLUTE:
 					address = operand(CPU_MODE_ABSOLUTE, boundary);
@@ -1604,7 +1587,6 @@ namespace NES {
 		void 
 		_nes_cpu::initialize(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(m_initialized) {
 				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_INITIALIZED);
@@ -1620,7 +1602,6 @@ namespace NES {
 			__in_opt bool breakpoint
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(breakpoint) {
 				push_word(m_register_pc + 1);
@@ -1637,7 +1618,6 @@ namespace NES {
 		void 
 		_nes_cpu::interrupt_return(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			m_register_p = pop();
 			m_register_pc = pop_word();
 		}
@@ -1645,7 +1625,6 @@ namespace NES {
 		void 
 		_nes_cpu::irq(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
@@ -1666,7 +1645,6 @@ namespace NES {
 		bool 
 		_nes_cpu::is_initialized(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return m_initialized;
 		}
 
@@ -1675,7 +1653,25 @@ namespace NES {
 			__in uint16_t address
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
+			uint8_t result;
+
+			if((address >= PPU_REGISTER_BASE) && (address <= PPU_REGISTER_MAX)
+					&& m_ppu->is_started()) {
+				synchronize();
+
+				return m_ppu->read(address);
+			} else if((address == APU_REGISTER_STATUS) && m_apu->is_started()) {
+				synchronize_apu();
+				result = m_apu->read(address);
+				synchronize_apu();
+
+				return result;
+			} else if(m_mapper && (address >= MAPPER_CPU_BASE)) {
+				return m_mapper->read_cpu(address);
+			} else if(m_ram && (address < CPU_RAM_LENGTH)) {
+				return m_ram[address];
+			}
+
 			return m_memory->at(NES_MEM_MMU, address);
 		}
 
@@ -1684,14 +1680,24 @@ namespace NES {
 			__in uint16_t address
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return (load(address) | (load(address + 1) << BITS_PER_BYTE));
 		}
 
+		nes_mapper_ptr 
+		_nes_cpu::mapper(void)
+		{
+			return m_mapper;
+		}
+
+		uint64_t 
+		_nes_cpu::master(void)
+		{
+			return (m_cycles * CPU_MASTER_DIVIDER);
+		}
+
 		void 
 		_nes_cpu::nmi(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
@@ -1709,8 +1715,6 @@ namespace NES {
 		{
 			uint16_t result = 0;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			boundary = false;
 
 			switch(mode) {
@@ -1783,7 +1787,6 @@ namespace NES {
 		uint8_t 
 		_nes_cpu::pop(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			++m_register_sp;
 			return load(m_register_sp + CPU_REGISTER_SP_OFFSET);
 		}
@@ -1791,7 +1794,6 @@ namespace NES {
 		uint16_t 
 		_nes_cpu::pop_word(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return (pop() | (pop() << BITS_PER_BYTE));
 		}
 
@@ -1800,7 +1802,6 @@ namespace NES {
 			__in uint8_t value
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			store(m_register_sp + CPU_REGISTER_SP_OFFSET, value);
 			--m_register_sp;
 		}
@@ -1810,7 +1811,6 @@ namespace NES {
 			__in uint16_t value
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			push((value >> BITS_PER_BYTE) & UINT8_MAX);
 			push(value & UINT8_MAX);
 		}
@@ -1818,7 +1818,6 @@ namespace NES {
 		void 
 		_nes_cpu::reset(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
@@ -1828,13 +1827,71 @@ namespace NES {
 			m_register_pc = load_word(CPU_INTERRUPT_RESET_ADDRESS);
 		}
 
+		void 
+		_nes_cpu::restore(
+			__in const nes_cpu_snapshot &snapshot
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_apu_event = snapshot.apu_event;
+			m_apu_irq = snapshot.apu_irq;
+			m_apu_sync = snapshot.apu_sync;
+			m_cycles = snapshot.cycles;
+			m_mapper_irq = snapshot.mapper_irq;
+			m_ppu_event = snapshot.ppu_event;
+			m_ppu_poll = snapshot.ppu_poll;
+			m_register_a = snapshot.register_a;
+			m_register_p = snapshot.register_p;
+			m_register_pc = snapshot.register_pc;
+			m_register_sp = snapshot.register_sp;
+			m_register_x = snapshot.register_x;
+			m_register_y = snapshot.register_y;
+		}
+
+		void 
+		_nes_cpu::set_mapper(
+			__in nes_mapper_ptr mapper
+			)
+		{
+			m_mapper = mapper;
+			m_mapper_irq = false;
+		}
+
+		void 
+		_nes_cpu::snapshot(
+			__out nes_cpu_snapshot &snapshot
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			std::memset(&snapshot, 0, sizeof(nes_cpu_snapshot));
+			snapshot.apu_event = m_apu_event;
+			snapshot.apu_irq = m_apu_irq;
+			snapshot.apu_sync = m_apu_sync;
+			snapshot.cycles = m_cycles;
+			snapshot.mapper_irq = m_mapper_irq;
+			snapshot.ppu_event = m_ppu_event;
+			snapshot.ppu_poll = m_ppu_poll;
+			snapshot.register_a = m_register_a;
+			snapshot.register_p = m_register_p;
+			snapshot.register_pc = m_register_pc;
+			snapshot.register_sp = m_register_sp;
+			snapshot.register_x = m_register_x;
+			snapshot.register_y = m_register_y;
+		}
+
 		void 
 		_nes_cpu::step(void)
 		{
 			uint8_t code;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			if(!m_initialized) {
 				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
 			}
@@ -2063,6 +2120,36 @@ namespace NES {
 					THROW_NES_CPU_EXCEPTION_MESSAGE(NES_CPU_EXCEPTION_UNSUPPORTED_CODE,
 						"0x%x", code);
 			}
+
+			if(master() >= m_ppu_event) {
+				synchronize();
+			}
+
+			if(m_ppu_poll) {
+				m_ppu_poll = false;
+
+				if(m_ppu->poll_nmi()) {
+					nmi();
+				}
+			}
+
+			if(m_mapper_irq) {
+				irq();
+			}
+
+			if(m_apu->is_started()) {
+
+				if(!m_apu_sync || (master() >= m_apu_event)) {
+					synchronize_apu();
+				}
+
+				if(m_apu_irq) {
+					irq();
+				}
+			} else {
+				m_apu_irq = false;
+				m_apu_sync = false;
+			}
 		}
 
 		void 
@@ -2071,8 +2158,41 @@ namespace NES {
 			__in uint8_t value
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
-			m_memory->at(NES_MEM_MMU, address) = value;
+			uint16_t iter = 0;
+
+			if((address >= PPU_REGISTER_BASE) && (address <= PPU_REGISTER_MAX)
+					&& m_ppu->is_started()) {
+				synchronize();
+				m_ppu->write(address, value);
+				m_ppu_event = m_ppu->next_event();
+				m_ppu_poll = true;
+			} else if((address == PPU_REGISTER_OAM_DMA) && m_ppu->is_started()) {
+				synchronize();
+				address = (value << BITS_PER_BYTE);
+
+				for(; iter <= UINT8_MAX; ++iter) {
+					m_ppu->write(PPU_REGISTER_BASE + PPU_REGISTER_OAM_DATA, 
+						load(address + iter));
+				}
+
+				m_cycles += (PPU_OAM_DMA_CYCLES + (m_cycles & 1));
+			} else if((address >= APU_REGISTER_BASE) && (address <= APU_REGISTER_MAX)
+					&& (address != PPU_REGISTER_OAM_DMA) && (address != APU_REGISTER_JOYPAD)
+					&& m_apu->is_started()) {
+				synchronize_apu();
+				m_apu->write(address, value);
+				synchronize_apu();
+			} else if(m_mapper && (address >= MAPPER_PROGRAM_BASE)) {
+				synchronize();
+				m_mapper->write_cpu(address, value);
+				synchronize();
+			} else if(m_mapper && (address >= MAPPER_CPU_BASE)) {
+				m_mapper->write_cpu(address, value);
+			} else if(m_ram && (address < CPU_RAM_LENGTH)) {
+				m_ram[address] = value;
+			} else {
+				m_memory->at(NES_MEM_MMU, address) = value;
+			}
 		}
 
 		void 
@@ -2081,7 +2201,6 @@ namespace NES {
 			__in uint16_t value
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			store(address, value & UINT8_MAX);
 			store(address + 1, (value >> BITS_PER_BYTE) & UINT8_MAX);
 		}
@@ -2091,7 +2210,6 @@ namespace NES {
 			__in uint16_t address
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			push_word(m_register_pc);
 			m_register_pc = address;
 		}
@@ -2099,10 +2217,42 @@ namespace NES {
 		void 
 		_nes_cpu::subroutine_return(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			m_register_pc = (pop_word() + 1);
 		}
 
+		void 
+		_nes_cpu::synchronize(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(m_ppu->is_started()) {
+				m_ppu->synchronize(master());
+				m_ppu_event = m_ppu->next_event();
+				m_ppu_poll = true;
+			}
+
+			m_mapper_irq = (m_mapper && m_mapper->irq_pending());
+		}
+
+		void 
+		_nes_cpu::synchronize_apu(void)
+		{
+
+			if(m_apu_sync) {
+				m_apu->synchronize(master());
+			} else {
+				m_apu->set_master(master());
+				m_apu_sync = true;
+			}
+
+			m_cycles += m_apu->poll_stall();
+			m_apu_event = m_apu->next_event();
+			m_apu_irq = m_apu->irq_pending();
+		}
+
 		std::string 
 		_nes_cpu::to_string(
 			__in_opt bool verbose
@@ -2111,8 +2261,6 @@ namespace NES {
 			std::stringstream result;
 			uint8_t p = m_register_p, iter = BITS_PER_BYTE;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			result << "<" << NES_CPU_HEADER << "> (" 
 				<< (m_initialized ? INITIALIZED : UNINITIALIZED); 
 
@@ -2147,13 +2295,13 @@ namespace NES {
 		void 
 		_nes_cpu::uninitialize(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_CPU_EXCEPTION(NES_CPU_EXCEPTION_UNINITIALIZED);
 			}
 
 			clear();
+			m_mapper = NULL;
 			m_initialized = false;
 		}
 	}
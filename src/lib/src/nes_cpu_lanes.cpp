@@ -0,0 +1,916 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../include/nes.h"
+#include "../include/nes_cpu_lanes_type.h"
+#include "../include/nes_cpu_type.h"
+#include "../include/nes_mapper_type.h"
+
+namespace NES {
+
+	namespace COMP {
+
+		_nes_cpu_lanes::_nes_cpu_lanes(
+			__in nes_rom &rom,
+			__in size_t count
+			) :
+				m_apu(NULL),
+				m_count(count),
+				m_cpu(NULL),
+				m_cycles(count, CPU_CYCLES_INIT),
+				m_groups(0),
+				m_initialized(false),
+				m_mapper(NULL),
+				m_mask(count, 0),
+				m_memory(NULL),
+				m_pending(count, 0),
+				m_ppu(NULL),
+				m_ram(count * CPU_LANES_RAM_LENGTH, 0),
+				m_register_a(count, CPU_REGISTER_A_INIT),
+				m_register_p(count, CPU_REGISTER_P_INIT),
+				m_register_sp(count, CPU_REGISTER_SP_INIT),
+				m_register_x(count, CPU_REGISTER_X_INIT),
+				m_register_y(count, CPU_REGISTER_Y_INIT),
+				m_register_pc(count, CPU_REGISTER_PC_INIT),
+				m_rom(rom),
+				m_scalar(0),
+				m_vector(0)
+		{
+			return;
+		}
+
+		_nes_cpu_lanes::~_nes_cpu_lanes(void)
+		{
+
+			if(m_initialized) {
+				uninitialize();
+			}
+		}
+
+		void 
+		_nes_cpu_lanes::advance(
+			__in size_t first,
+			__in uint16_t length,
+			__in uint32_t cycles
+			)
+		{
+			size_t iter = first, last = m_count;
+			const uint8_t *mask = &m_mask[0];
+			uint16_t *pc = &m_register_pc[0];
+			uint64_t *elapsed = &m_cycles[0];
+
+			for(; iter < last; ++iter) {
+				pc[iter] += ((mask[iter] & 1) * length);
+				elapsed[iter] += ((mask[iter] & 1) * cycles);
+			}
+		}
+
+		size_t 
+		_nes_cpu_lanes::count(void)
+		{
+			return m_count;
+		}
+
+		_nes_cpu_lanes *
+		_nes_cpu_lanes::create(
+			__in nes_rom &rom,
+			__in size_t count
+			)
+		{
+			_nes_cpu_lanes *result = NULL;
+
+			if(!count || (count > CPU_LANES_MAX)) {
+				THROW_NES_CPU_LANES_EXCEPTION_MESSAGE(NES_CPU_LANES_EXCEPTION_INVALID_COUNT,
+					"count. %lu (max. %u)", count, CPU_LANES_MAX);
+			}
+
+			result = new nes_cpu_lanes(rom, count);
+			if(!result) {
+				THROW_NES_CPU_LANES_EXCEPTION(NES_CPU_LANES_EXCEPTION_ALLOCATED);
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_cpu_lanes::execute(
+			__in size_t index
+			)
+		{
+			m_cpu->m_cycles = m_cycles[index];
+			m_cpu->m_register_a = m_register_a[index];
+			m_cpu->m_register_p = m_register_p[index];
+			m_cpu->m_ram = &m_ram[index * CPU_LANES_RAM_LENGTH];
+			m_cpu->m_register_pc = m_register_pc[index];
+			m_cpu->m_register_sp = m_register_sp[index];
+			m_cpu->m_register_x = m_register_x[index];
+			m_cpu->m_register_y = m_register_y[index];
+
+			if(m_ppu->is_started()) {
+				m_ppu->rebase(m_cpu->master());
+			}
+
+			m_cpu->step();
+			m_cycles[index] = m_cpu->m_cycles;
+			m_register_a[index] = m_cpu->m_register_a;
+			m_register_p[index] = m_cpu->m_register_p;
+			m_register_pc[index] = m_cpu->m_register_pc;
+			m_register_sp[index] = m_cpu->m_register_sp;
+			m_register_x[index] = m_cpu->m_register_x;
+			m_register_y[index] = m_cpu->m_register_y;
+		}
+
+		bool 
+		_nes_cpu_lanes::execute_vector(
+			__in uint16_t pc,
+			__in size_t first
+			)
+		{
+			uint8_t value;
+			bool result = true;
+
+			if(pc < MAPPER_PROGRAM_BASE) {
+				return false;
+			}
+
+			switch(fetch(pc)) {
+				case CPU_CODE_ADC_IMMEDIATE:
+					vector_add(fetch(pc + 1), first);
+					advance(first, CPU_LANES_LENGTH_IMMEDIATE, CPU_CODE_ADC_IMMEDIATE_CYCLES);
+					break;
+				case CPU_CODE_AND_IMMEDIATE:
+					vector_bitwise(fetch(pc + 1), 0, 0, first);
+					advance(first, CPU_LANES_LENGTH_IMMEDIATE, CPU_CODE_AND_IMMEDIATE_CYCLES);
+					break;
+				case CPU_CODE_BCC_RELATIVE:
+					vector_branch(CPU_FLAG_CARRY, false, pc, first);
+					break;
+				case CPU_CODE_BCS_RELATIVE:
+					vector_branch(CPU_FLAG_CARRY, true, pc, first);
+					break;
+				case CPU_CODE_BEQ_RELATIVE:
+					vector_branch(CPU_FLAG_ZERO, true, pc, first);
+					break;
+				case CPU_CODE_BMI_RELATIVE:
+					vector_branch(CPU_FLAG_NEGATIVE, true, pc, first);
+					break;
+				case CPU_CODE_BNE_RELATIVE:
+					vector_branch(CPU_FLAG_ZERO, false, pc, first);
+					break;
+				case CPU_CODE_BPL_RELATIVE:
+					vector_branch(CPU_FLAG_NEGATIVE, false, pc, first);
+					break;
+				case CPU_CODE_BVC_RELATIVE:
+					vector_branch(CPU_FLAG_OVERFLOW, false, pc, first);
+					break;
+				case CPU_CODE_BVS_RELATIVE:
+					vector_branch(CPU_FLAG_OVERFLOW, true, pc, first);
+					break;
+				case CPU_CODE_CLC_IMPLIED:
+					vector_flag(CPU_FLAG_CARRY, false, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_FLAG_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_CLI_IMPLIED:
+					vector_flag(CPU_FLAG_INTERRUPT_DISABLED, false, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_FLAG_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_CLV_IMPLIED:
+					vector_flag(CPU_FLAG_OVERFLOW, false, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_FLAG_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_CMP_IMMEDIATE:
+					vector_compare(m_register_a, fetch(pc + 1), first);
+					advance(first, CPU_LANES_LENGTH_IMMEDIATE, CPU_CODE_CMP_IMMEDIATE_CYCLES);
+					break;
+				case CPU_CODE_CPX_IMMEDIATE:
+					vector_compare(m_register_x, fetch(pc + 1), first);
+					advance(first, CPU_LANES_LENGTH_IMMEDIATE, CPU_CODE_CPX_IMMEDIATE_CYCLES);
+					break;
+				case CPU_CODE_CPY_IMMEDIATE:
+					vector_compare(m_register_y, fetch(pc + 1), first);
+					advance(first, CPU_LANES_LENGTH_IMMEDIATE, CPU_CODE_CPY_IMMEDIATE_CYCLES);
+					break;
+				case CPU_CODE_DEX_IMPLIED:
+					vector_increment(m_register_x, UINT8_MAX, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_REGISTER_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_DEY_IMPLIED:
+					vector_increment(m_register_y, UINT8_MAX, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_REGISTER_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_EOR_IMMEDIATE:
+					vector_bitwise(UINT8_MAX, 0, fetch(pc + 1), first);
+					advance(first, CPU_LANES_LENGTH_IMMEDIATE, CPU_CODE_EOR_IMMEDIATE_CYCLES);
+					break;
+				case CPU_CODE_INX_IMPLIED:
+					vector_increment(m_register_x, 1, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_REGISTER_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_INY_IMPLIED:
+					vector_increment(m_register_y, 1, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_REGISTER_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_JMP_ABSOLUTE:
+					value = fetch(pc + 1);
+					advance(first, ((value | (fetch(pc + CPU_LANES_LENGTH_IMMEDIATE) << BITS_PER_BYTE)) 
+						- pc), CPU_CODE_JMP_ABSOLUTE_CYCLES);
+					break;
+				case CPU_CODE_LDA_ABSOLUTE:
+					result = vector_load(m_register_a, CPU_MODE_ABSOLUTE, pc, 
+						CPU_CODE_LDA_ABSOLUTE_CYCLES, first);
+					break;
+				case CPU_CODE_LDA_IMMEDIATE:
+					result = vector_load(m_register_a, CPU_MODE_IMMEDIATE, pc, 
+						CPU_CODE_LDA_IMMEDIATE_CYCLES, first);
+					break;
+				case CPU_CODE_LDA_ZERO_PAGE:
+					result = vector_load(m_register_a, CPU_MODE_ZERO_PAGE, pc, 
+						CPU_CODE_LDA_ZERO_PAGE_CYCLES, first);
+					break;
+				case CPU_CODE_LDA_ZERO_PAGE_X:
+					result = vector_load(m_register_a, CPU_MODE_ZERO_PAGE_X, pc, 
+						CPU_CODE_LDA_ZERO_PAGE_X_CYCLES, first);
+					break;
+				case CPU_CODE_LDX_ABSOLUTE:
+					result = vector_load(m_register_x, CPU_MODE_ABSOLUTE, pc, 
+						CPU_CODE_LDX_ABSOLUTE_CYCLES, first);
+					break;
+				case CPU_CODE_LDX_IMMEDIATE:
+					result = vector_load(m_register_x, CPU_MODE_IMMEDIATE, pc, 
+						CPU_CODE_LDX_IMMEDIATE_CYCLES, first);
+					break;
+				case CPU_CODE_LDX_ZERO_PAGE:
+					result = vector_load(m_register_x, CPU_MODE_ZERO_PAGE, pc, 
+						CPU_CODE_LDX_ZERO_PAGE_CYCLES, first);
+					break;
+				case CPU_CODE_LDX_ZERO_PAGE_Y:
+					result = vector_load(m_register_x, CPU_MODE_ZERO_PAGE_Y, pc, 
+						CPU_CODE_LDX_ZERO_PAGE_Y_CYCLES, first);
+					break;
+				case CPU_CODE_LDY_ABSOLUTE:
+					result = vector_load(m_register_y, CPU_MODE_ABSOLUTE, pc, 
+						CPU_CODE_LDY_ABSOLUTE_CYCLES, first);
+					break;
+				case CPU_CODE_LDY_IMMEDIATE:
+					result = vector_load(m_register_y, CPU_MODE_IMMEDIATE, pc, 
+						CPU_CODE_LDY_IMMEDIATE_CYCLES, first);
+					break;
+				case CPU_CODE_LDY_ZERO_PAGE:
+					result = vector_load(m_register_y, CPU_MODE_ZERO_PAGE, pc, 
+						CPU_CODE_LDY_ZERO_PAGE_CYCLES, first);
+					break;
+				case CPU_CODE_LDY_ZERO_PAGE_X:
+					result = vector_load(m_register_y, CPU_MODE_ZERO_PAGE_X, pc, 
+						CPU_CODE_LDY_ZERO_PAGE_X_CYCLES, first);
+					break;
+				case CPU_CODE_NOP_IMPLIED:
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_NOP_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_ORA_IMMEDIATE:
+					vector_bitwise(UINT8_MAX, fetch(pc + 1), 0, first);
+					advance(first, CPU_LANES_LENGTH_IMMEDIATE, CPU_CODE_ORA_IMMEDIATE_CYCLES);
+					break;
+				case CPU_CODE_SEC_IMPLIED:
+					vector_flag(CPU_FLAG_CARRY, true, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_FLAG_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_SEI_IMPLIED:
+					vector_flag(CPU_FLAG_INTERRUPT_DISABLED, true, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_FLAG_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_STA_ABSOLUTE:
+					result = vector_store(m_register_a, CPU_MODE_ABSOLUTE, pc, 
+						CPU_CODE_STA_ABSOLUTE_CYCLES, first);
+					break;
+				case CPU_CODE_STA_ZERO_PAGE:
+					result = vector_store(m_register_a, CPU_MODE_ZERO_PAGE, pc, 
+						CPU_CODE_STA_ZERO_PAGE_CYCLES, first);
+					break;
+				case CPU_CODE_STA_ZERO_PAGE_X:
+					result = vector_store(m_register_a, CPU_MODE_ZERO_PAGE_X, pc, 
+						CPU_CODE_STA_ZERO_PAGE_X_CYCLES, first);
+					break;
+				case CPU_CODE_STX_ABSOLUTE:
+					result = vector_store(m_register_x, CPU_MODE_ABSOLUTE, pc, 
+						CPU_CODE_STX_ABSOLUTE_CYCLES, first);
+					break;
+				case CPU_CODE_STX_ZERO_PAGE:
+					result = vector_store(m_register_x, CPU_MODE_ZERO_PAGE, pc, 
+						CPU_CODE_STX_ZERO_PAGE_CYCLES, first);
+					break;
+				case CPU_CODE_STX_ZERO_PAGE_Y:
+					result = vector_store(m_register_x, CPU_MODE_ZERO_PAGE_Y, pc, 
+						CPU_CODE_STX_ZERO_PAGE_Y_CYCLES, first);
+					break;
+				case CPU_CODE_STY_ABSOLUTE:
+					result = vector_store(m_register_y, CPU_MODE_ABSOLUTE, pc, 
+						CPU_CODE_STY_ABSOLUTE_CYCLES, first);
+					break;
+				case CPU_CODE_STY_ZERO_PAGE:
+					result = vector_store(m_register_y, CPU_MODE_ZERO_PAGE, pc, 
+						CPU_CODE_STY_ZERO_PAGE_CYCLES, first);
+					break;
+				case CPU_CODE_STY_ZERO_PAGE_X:
+					result = vector_store(m_register_y, CPU_MODE_ZERO_PAGE_X, pc, 
+						CPU_CODE_STY_ZERO_PAGE_X_CYCLES, first);
+					break;
+				case CPU_CODE_TAX_IMPLIED:
+					vector_assign(m_register_x, m_register_a, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_REGISTER_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_TAY_IMPLIED:
+					vector_assign(m_register_y, m_register_a, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_REGISTER_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_TXA_IMPLIED:
+					vector_assign(m_register_a, m_register_x, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_REGISTER_IMPLIED_CYCLES);
+					break;
+				case CPU_CODE_TYA_IMPLIED:
+					vector_assign(m_register_a, m_register_y, first);
+					advance(first, CPU_LANES_LENGTH_IMPLIED, CPU_CODE_REGISTER_IMPLIED_CYCLES);
+					break;
+				default:
+					result = false;
+					break;
+			}
+
+			return result;
+		}
+
+		uint8_t 
+		_nes_cpu_lanes::fetch(
+			__in uint16_t address
+			)
+		{
+			return m_mapper->read_cpu(address);
+		}
+
+		size_t 
+		_nes_cpu_lanes::groups(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_CPU_LANES_EXCEPTION(NES_CPU_LANES_EXCEPTION_UNINITIALIZED);
+			}
+
+			return m_groups;
+		}
+
+		void 
+		_nes_cpu_lanes::initialize(void)
+		{
+
+			if(m_initialized) {
+				THROW_NES_CPU_LANES_EXCEPTION(NES_CPU_LANES_EXCEPTION_INITIALIZED);
+			}
+
+			if(!m_rom.is_loaded() || (m_rom.descriptor().mapper != NES_MAPPER_NROM)) {
+				THROW_NES_CPU_LANES_EXCEPTION_MESSAGE(NES_CPU_LANES_EXCEPTION_UNSUPPORTED_MAPPER,
+					"mapper. %u", m_rom.is_loaded() ? m_rom.descriptor().mapper : 0);
+			}
+
+			m_initialized = true;
+
+			try {
+				m_memory = nes_memory::create();
+				m_memory->initialize();
+				m_ppu = nes_ppu::create(m_memory);
+				m_ppu->initialize();
+				m_apu = nes_apu::create(m_memory);
+				m_apu->initialize();
+				m_cpu = nes_cpu::create(m_memory, m_ppu, m_apu);
+				m_cpu->initialize();
+				m_mapper = nes_mapper::create(m_rom, 
+					&m_memory->at(NES_MEM_PPU, MAPPER_NAMETABLE_BASE));
+				m_cpu->set_mapper(m_mapper);
+				m_apu->set_mapper(m_mapper);
+				reset();
+			} catch(...) {
+				uninitialize();
+				throw;
+			}
+		}
+
+		bool 
+		_nes_cpu_lanes::is_initialized(void)
+		{
+			return m_initialized;
+		}
+
+		nes_cpu_lane 
+		_nes_cpu_lanes::lane(
+			__in size_t index
+			)
+		{
+			nes_cpu_lane result;
+
+			if(index >= m_count) {
+				THROW_NES_CPU_LANES_EXCEPTION_MESSAGE(NES_CPU_LANES_EXCEPTION_INVALID_LANE,
+					"lane. %lu (max. %lu)", index, m_count - 1);
+			}
+
+			result.a = m_register_a[index];
+			result.cycles = m_cycles[index];
+			result.p = m_register_p[index];
+			result.pc = m_register_pc[index];
+			result.sp = m_register_sp[index];
+			result.x = m_register_x[index];
+			result.y = m_register_y[index];
+
+			return result;
+		}
+
+		uint8_t *
+		_nes_cpu_lanes::ram(
+			__in size_t index
+			)
+		{
+
+			if(index >= m_count) {
+				THROW_NES_CPU_LANES_EXCEPTION_MESSAGE(NES_CPU_LANES_EXCEPTION_INVALID_LANE,
+					"lane. %lu (max. %lu)", index, m_count - 1);
+			}
+
+			return &m_ram[index * CPU_LANES_RAM_LENGTH];
+		}
+
+		void 
+		_nes_cpu_lanes::reset(void)
+		{
+			uint16_t pc;
+
+			if(!m_initialized) {
+				THROW_NES_CPU_LANES_EXCEPTION(NES_CPU_LANES_EXCEPTION_UNINITIALIZED);
+			}
+
+			pc = (fetch(CPU_INTERRUPT_RESET_ADDRESS) 
+				| (fetch(CPU_INTERRUPT_RESET_ADDRESS + 1) << BITS_PER_BYTE));
+			std::fill(m_cycles.begin(), m_cycles.end(), CPU_CYCLES_INIT);
+			std::fill(m_ram.begin(), m_ram.end(), 0);
+			std::fill(m_register_a.begin(), m_register_a.end(), CPU_REGISTER_A_INIT);
+			std::fill(m_register_p.begin(), m_register_p.end(), CPU_REGISTER_P_INIT);
+			std::fill(m_register_pc.begin(), m_register_pc.end(), pc);
+			std::fill(m_register_sp.begin(), m_register_sp.end(), CPU_REGISTER_SP_INIT);
+			std::fill(m_register_x.begin(), m_register_x.end(), CPU_REGISTER_X_INIT);
+			std::fill(m_register_y.begin(), m_register_y.end(), CPU_REGISTER_Y_INIT);
+			m_cpu->clear();
+			m_groups = 0;
+			m_scalar = 0;
+			m_vector = 0;
+		}
+
+		uint64_t 
+		_nes_cpu_lanes::scalar(void)
+		{
+			return m_scalar;
+		}
+
+		void 
+		_nes_cpu_lanes::step(
+			__in_opt size_t count
+			)
+		{
+			uint16_t pc, *counter;
+			size_t first, iter, last, members;
+			uint8_t *mask = NULL, *pending = NULL;
+
+			if(!m_initialized) {
+				THROW_NES_CPU_LANES_EXCEPTION(NES_CPU_LANES_EXCEPTION_UNINITIALIZED);
+			}
+
+			counter = &m_register_pc[0];
+			last = m_count;
+			mask = &m_mask[0];
+			pending = &m_pending[0];
+
+			for(; count; --count) {
+				std::fill(m_pending.begin(), m_pending.end(), UINT8_MAX);
+				m_groups = 0;
+
+				for(first = 0; first < last; ++first) {
+
+					if(!pending[first]) {
+						continue;
+					}
+
+					members = 0;
+					pc = counter[first];
+
+					for(iter = first; iter < last; ++iter) {
+						mask[iter] = (pending[iter] & ((counter[iter] == pc) ? UINT8_MAX : 0));
+						pending[iter] &= ~mask[iter];
+					}
+
+					for(iter = first; iter < last; ++iter) {
+						members += (mask[iter] & 1);
+					}
+
+					++m_groups;
+
+					if(execute_vector(pc, first)) {
+						m_vector += members;
+					} else {
+
+						for(iter = first; iter < last; ++iter) {
+
+							if(mask[iter]) {
+								execute(iter);
+							}
+						}
+
+						m_scalar += members;
+					}
+				}
+			}
+		}
+
+		std::string 
+		_nes_cpu_lanes::to_string(
+			__in_opt bool verbose
+			)
+		{
+			std::stringstream result;
+
+			result << "<" << NES_CPU_LANES_HEADER << "> (" 
+				<< (m_initialized ? INITIALIZED : UNINITIALIZED); 
+
+			if(verbose) {
+				result << ", ptr. 0x" << VALUE_AS_HEX(nes_cpu_lanes_ptr, this);
+			}
+
+			result << ")";
+
+			if(m_initialized) {
+				result << std::endl << "LAN: " << m_count
+					<< ", GRP: " << m_groups
+					<< ", VEC: " << m_vector
+					<< ", SCL: " << m_scalar;
+			}
+
+			return result.str();
+		}
+
+		void 
+		_nes_cpu_lanes::uninitialize(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_CPU_LANES_EXCEPTION(NES_CPU_LANES_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(m_cpu) {
+				delete m_cpu;
+				m_cpu = NULL;
+			}
+
+			if(m_mapper) {
+				delete m_mapper;
+				m_mapper = NULL;
+			}
+
+			if(m_apu) {
+				delete m_apu;
+				m_apu = NULL;
+			}
+
+			if(m_ppu) {
+				delete m_ppu;
+				m_ppu = NULL;
+			}
+
+			if(m_memory) {
+				delete m_memory;
+				m_memory = NULL;
+			}
+
+			m_initialized = false;
+		}
+
+		uint64_t 
+		_nes_cpu_lanes::vector(void)
+		{
+			return m_vector;
+		}
+
+		void 
+		_nes_cpu_lanes::vector_add(
+			__in uint8_t value,
+			__in size_t first
+			)
+		{
+			size_t iter = first, last = m_count;
+			uint8_t affected, carry, flags, sum;
+			const uint8_t *mask = &m_mask[0];
+			uint8_t *a = &m_register_a[0], *p = &m_register_p[0];
+
+			affected = (CPU_FLAG_CARRY | CPU_FLAG_NEGATIVE | CPU_FLAG_OVERFLOW | CPU_FLAG_ZERO);
+
+			for(; iter < last; ++iter) {
+				carry = (p[iter] & CPU_FLAG_CARRY);
+				sum = (value + a[iter] + carry);
+				flags = (((a[iter] ^ sum) & CPU_FLAG_NEGATIVE) ? CPU_FLAG_OVERFLOW : 0);
+				flags |= (a[iter] & CPU_FLAG_NEGATIVE);
+				flags |= (sum ? 0 : CPU_FLAG_ZERO);
+				p[iter] = ((p[iter] & ~(mask[iter] & affected)) | (mask[iter] & flags));
+				a[iter] = ((a[iter] & ~mask[iter]) | (sum & mask[iter]));
+			}
+		}
+
+		void 
+		_nes_cpu_lanes::vector_assign(
+			__inout std::vector<uint8_t> &target,
+			__in const std::vector<uint8_t> &source,
+			__in size_t first
+			)
+		{
+			size_t iter = first, last = m_count;
+			uint8_t *value = &target[0];
+			const uint8_t *mask = &m_mask[0], *input = &source[0];
+
+			for(; iter < last; ++iter) {
+				value[iter] = ((value[iter] & ~mask[iter]) | (input[iter] & mask[iter]));
+			}
+
+			vector_flags(target, first);
+		}
+
+		void 
+		_nes_cpu_lanes::vector_assign(
+			__inout std::vector<uint8_t> &target,
+			__in uint8_t value,
+			__in size_t first
+			)
+		{
+			size_t iter = first, last = m_count;
+			uint8_t *output = &target[0];
+			const uint8_t *mask = &m_mask[0];
+
+			for(; iter < last; ++iter) {
+				output[iter] = ((output[iter] & ~mask[iter]) | (value & mask[iter]));
+			}
+
+			vector_flags(target, first);
+		}
+
+		void 
+		_nes_cpu_lanes::vector_bitwise(
+			__in uint8_t mask,
+			__in uint8_t set,
+			__in uint8_t toggle,
+			__in size_t first
+			)
+		{
+			uint8_t value;
+			size_t iter = first, last = m_count;
+			uint8_t *a = &m_register_a[0];
+			const uint8_t *lane = &m_mask[0];
+
+			for(; iter < last; ++iter) {
+				value = (((a[iter] & mask) | set) ^ toggle);
+				a[iter] = ((a[iter] & ~lane[iter]) | (value & lane[iter]));
+			}
+
+			vector_flags(m_register_a, first);
+		}
+
+		void 
+		_nes_cpu_lanes::vector_branch(
+			__in uint8_t flag,
+			__in bool set,
+			__in uint16_t pc,
+			__in size_t first
+			)
+		{
+			uint8_t offset, taken;
+			size_t iter = first, last = m_count;
+			uint32_t boundary;
+			uint64_t *elapsed = &m_cycles[0];
+			uint16_t displacement, *counter = &m_register_pc[0];
+			const uint8_t *mask = &m_mask[0], *p = &m_register_p[0];
+
+			offset = fetch(pc + 1);
+			boundary = ((((pc + CPU_LANES_LENGTH_IMMEDIATE) & UINT8_MAX) + offset) >= UINT8_MAX) ? 1 : 0;
+			displacement = (uint16_t) (int16_t) (int8_t) offset;
+
+			for(; iter < last; ++iter) {
+				taken = (mask[iter] & (((p[iter] & flag) ? 1 : 0) ^ (set ? 0 : 1)));
+				counter[iter] += (((mask[iter] & 1) * CPU_LANES_LENGTH_IMMEDIATE) + (taken * displacement));
+				elapsed[iter] += (((mask[iter] & 1) * CPU_CODE_BRANCH_RELATIVE_CYCLES) 
+					+ (taken * (1 + boundary)));
+			}
+		}
+
+		void 
+		_nes_cpu_lanes::vector_compare(
+			__in const std::vector<uint8_t> &source,
+			__in uint8_t value,
+			__in size_t first
+			)
+		{
+			size_t iter = first, last = m_count;
+			uint8_t affected, difference, flags;
+			uint8_t *p = &m_register_p[0];
+			const uint8_t *input = &source[0], *mask = &m_mask[0];
+
+			affected = (CPU_FLAG_CARRY | CPU_FLAG_NEGATIVE | CPU_FLAG_ZERO);
+
+			for(; iter < last; ++iter) {
+				difference = (input[iter] - value);
+				flags = ((input[iter] >= value) ? CPU_FLAG_CARRY : 0);
+				flags |= (difference & CPU_FLAG_NEGATIVE);
+				flags |= (difference ? 0 : CPU_FLAG_ZERO);
+				p[iter] = ((p[iter] & ~(mask[iter] & affected)) | (mask[iter] & flags));
+			}
+		}
+
+		void 
+		_nes_cpu_lanes::vector_flag(
+			__in uint8_t flag,
+			__in bool set,
+			__in size_t first
+			)
+		{
+			size_t iter = first, last = m_count;
+			uint8_t *p = &m_register_p[0];
+			const uint8_t *mask = &m_mask[0];
+
+			for(; iter < last; ++iter) {
+				p[iter] = ((p[iter] & ~(mask[iter] & flag)) | (set ? (mask[iter] & flag) : 0));
+			}
+		}
+
+		void 
+		_nes_cpu_lanes::vector_flags(
+			__in const std::vector<uint8_t> &source,
+			__in size_t first
+			)
+		{
+			uint8_t affected, flags;
+			size_t iter = first, last = m_count;
+			uint8_t *p = &m_register_p[0];
+			const uint8_t *input = &source[0], *mask = &m_mask[0];
+
+			affected = (CPU_FLAG_NEGATIVE | CPU_FLAG_ZERO);
+
+			for(; iter < last; ++iter) {
+				flags = ((input[iter] & CPU_FLAG_NEGATIVE) | (input[iter] ? 0 : CPU_FLAG_ZERO));
+				p[iter] = ((p[iter] & ~(mask[iter] & affected)) | (mask[iter] & flags));
+			}
+		}
+
+		void 
+		_nes_cpu_lanes::vector_increment(
+			__inout std::vector<uint8_t> &target,
+			__in uint8_t delta,
+			__in size_t first
+			)
+		{
+			size_t iter = first, last = m_count;
+			uint8_t *value = &target[0];
+			const uint8_t *mask = &m_mask[0];
+
+			for(; iter < last; ++iter) {
+				value[iter] += (mask[iter] & delta);
+			}
+
+			vector_flags(target, first);
+		}
+
+		bool 
+		_nes_cpu_lanes::vector_load(
+			__inout std::vector<uint8_t> &target,
+			__in cpu_mode_t mode,
+			__in uint16_t pc,
+			__in uint32_t cycles,
+			__in size_t first
+			)
+		{
+			uint16_t address;
+			size_t iter = first, last = m_count;
+			uint16_t length = CPU_LANES_LENGTH_IMMEDIATE;
+			uint8_t *output = &target[0];
+			const uint8_t *index = NULL, *mask = &m_mask[0], *ram = &m_ram[0];
+
+			address = fetch(pc + 1);
+
+			switch(mode) {
+				case CPU_MODE_ABSOLUTE:
+					address |= (fetch(pc + CPU_LANES_LENGTH_IMMEDIATE) << BITS_PER_BYTE);
+					length = CPU_LANES_LENGTH_ABSOLUTE;
+
+					if(address >= MAPPER_PROGRAM_BASE) {
+						vector_assign(target, fetch(address), first);
+						advance(first, length, cycles);
+
+						return true;
+					} else if(address >= CPU_LANES_RAM_LENGTH) {
+						return false;
+					}
+					break;
+				case CPU_MODE_IMMEDIATE:
+					vector_assign(target, (uint8_t) address, first);
+					advance(first, length, cycles);
+
+					return true;
+				case CPU_MODE_ZERO_PAGE:
+					break;
+				case CPU_MODE_ZERO_PAGE_X:
+					index = &m_register_x[0];
+					break;
+				case CPU_MODE_ZERO_PAGE_Y:
+					index = &m_register_y[0];
+					break;
+				default:
+					return false;
+			}
+
+			if(index) {
+
+				for(; iter < last; ++iter) {
+					output[iter] = ((output[iter] & ~mask[iter]) 
+						| (ram[(iter * CPU_LANES_RAM_LENGTH) 
+						+ ((address + index[iter]) & UINT8_MAX)] & mask[iter]));
+				}
+			} else {
+
+				for(; iter < last; ++iter) {
+					output[iter] = ((output[iter] & ~mask[iter]) 
+						| (ram[(iter * CPU_LANES_RAM_LENGTH) + address] & mask[iter]));
+				}
+			}
+
+			vector_flags(target, first);
+			advance(first, length, cycles);
+
+			return true;
+		}
+
+		bool 
+		_nes_cpu_lanes::vector_store(
+			__in const std::vector<uint8_t> &source,
+			__in cpu_mode_t mode,
+			__in uint16_t pc,
+			__in uint32_t cycles,
+			__in size_t first
+			)
+		{
+			uint16_t address;
+			size_t iter = first, last = m_count;
+			uint16_t length = CPU_LANES_LENGTH_IMMEDIATE;
+			uint8_t *ram = &m_ram[0];
+			const uint8_t *index = NULL, *input = &source[0], *mask = &m_mask[0];
+
+			address = fetch(pc + 1);
+
+			switch(mode) {
+				case CPU_MODE_ABSOLUTE:
+					address |= (fetch(pc + CPU_LANES_LENGTH_IMMEDIATE) << BITS_PER_BYTE);
+					length = CPU_LANES_LENGTH_ABSOLUTE;
+
+					if(address >= CPU_LANES_RAM_LENGTH) {
+						return false;
+					}
+					break;
+				case CPU_MODE_ZERO_PAGE:
+					break;
+				case CPU_MODE_ZERO_PAGE_X:
+					index = &m_register_x[0];
+					break;
+				case CPU_MODE_ZERO_PAGE_Y:
+					index = &m_register_y[0];
+					break;
+				default:
+					return false;
+			}
+
+			for(; iter < last; ++iter) {
+
+				if(mask[iter]) {
+					ram[(iter * CPU_LANES_RAM_LENGTH) + (index ? ((address + index[iter]) 
+						& UINT8_MAX) : address)] = input[iter];
+				}
+			}
+
+			advance(first, length, cycles);
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,404 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include "../include/nes.h"
+#if defined(__AVX2__) || (defined(__SHA__) && defined(__SSE4_1__))
+#include <immintrin.h>
+#endif // __AVX2__ || (__SHA__ && __SSE4_1__)
+
+namespace NES {
+
+	#define HASH_BLOCK_STRIPES 8
+	#define HASH_CRC32_ENTRIES 0x100
+	#define HASH_CRC32_POLYNOMIAL 0xedb88320
+	#define HASH_CRC32_SLICES 8
+	#define HASH_PRIME32_1 0x9e3779b1ULL
+	#define HASH_PRIME32_2 0x85ebca77ULL
+	#define HASH_PRIME32_3 0xc2b2ae3dULL
+	#define HASH_PRIME64_1 0x9e3779b185ebca87ULL
+	#define HASH_PRIME64_2 0xc2b2ae3d27d4eb4fULL
+	#define HASH_PRIME64_3 0x165667b19e3779f9ULL
+	#define HASH_PRIME64_4 0x85ebca77c2b2ae63ULL
+	#define HASH_PRIME64_5 0x27d4eb2f165667c5ULL
+	#define HASH_SHA1_BLOCK_LEN 0x40
+	#define HASH_SHA1_LENGTH_LEN 8
+	#define HASH_SHA1_PAD 0x80
+	#define HASH_SHA1_ROUNDS 80
+	#define HASH_SHA1_WORDS 5
+	#define HASH_STRIPE_LEN (HASH_LANES * sizeof(uint64_t))
+
+	static const uint32_t HASH_SHA1_INIT[] = {
+		0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0,
+		};
+
+	static const uint32_t HASH_SHA1_ROUND[] = {
+		0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6,
+		};
+
+	static const uint64_t HASH_KEY[] = {
+		0x5a71945be5317d5fULL, 0x724f437b7fac2148ULL,
+		0x54177af26b6f5cc4ULL, 0x4af0880d3d605e30ULL,
+		0x335005d4f969455aULL, 0x12131bfb2ebaaa4dULL,
+		0x6c6cef021c84be30ULL, 0x27e4b52cdd9759e0ULL,
+		0x990d8b2c71515795ULL, 0xe81ed03685aad9a7ULL,
+		0xcfc6cf554cc9b997ULL, 0x8040685a1a5f785fULL,
+		0x25ebb1016974428bULL, 0x50f2cdc69eb02885ULL,
+		0xf7c9bfe5331b0148ULL, 0x8ce568e4594d35a8ULL,
+		};
+
+	#define HASH_KEY_SCRAMBLE (HASH_KEY + HASH_BLOCK_STRIPES)
+	#define HASH_KEY_STRIPE(_STRIPE_) \
+		(HASH_KEY + ((_STRIPE_) % HASH_BLOCK_STRIPES))
+
+	void 
+	_nes_hash::accumulate(
+		__inout uint64_t *accumulator,
+		__in const uint8_t *data,
+		__in const uint8_t *key
+		)
+	{
+#ifdef __AVX2__
+		size_t iter = 0;
+		__m256i acc, dat, dat_key, product, swap;
+
+		for(; iter < HASH_LANES; iter += (sizeof(__m256i) / sizeof(uint64_t))) {
+			acc = _mm256_loadu_si256((const __m256i *) (accumulator + iter));
+			dat = _mm256_loadu_si256((const __m256i *) (data + (iter * sizeof(uint64_t))));
+			dat_key = _mm256_xor_si256(dat, _mm256_loadu_si256(
+				(const __m256i *) (key + (iter * sizeof(uint64_t)))));
+			product = _mm256_mul_epu32(dat_key, _mm256_srli_epi64(dat_key, 32));
+			swap = _mm256_shuffle_epi32(dat, _MM_SHUFFLE(1, 0, 3, 2));
+			acc = _mm256_add_epi64(acc, _mm256_add_epi64(product, swap));
+			_mm256_storeu_si256((__m256i *) (accumulator + iter), acc);
+		}
+#else
+		size_t iter = 0;
+		uint64_t dat, dat_key, value;
+
+		for(; iter < HASH_LANES; ++iter) {
+			std::memcpy(&dat, data + (iter * sizeof(uint64_t)), sizeof(uint64_t));
+			std::memcpy(&value, key + (iter * sizeof(uint64_t)), sizeof(uint64_t));
+			dat_key = (dat ^ value);
+			accumulator[iter ^ 1] += dat;
+			accumulator[iter] += ((dat_key & UINT32_MAX) * (dat_key >> 32));
+		}
+#endif // __AVX2__
+	}
+
+	uint64_t 
+	_nes_hash::avalanche(
+		__in uint64_t value
+		)
+	{
+		value ^= (value >> 37);
+		value *= 0x165667919e3779f9ULL;
+		value ^= (value >> 32);
+
+		return value;
+	}
+
+	uint32_t 
+	_nes_hash::crc32(
+		__in const void *data,
+		__in size_t length,
+		__in_opt uint32_t seed
+		)
+	{
+		uint32_t high, low, result = ~seed;
+		const uint32_t *table = crc32_table();
+		const uint8_t *dat = (const uint8_t *) data;
+
+		for(; length >= HASH_CRC32_SLICES; dat += HASH_CRC32_SLICES, length -= HASH_CRC32_SLICES) {
+			std::memcpy(&low, dat, sizeof(uint32_t));
+			std::memcpy(&high, dat + sizeof(uint32_t), sizeof(uint32_t));
+			low ^= result;
+			result = (table[(7 * HASH_CRC32_ENTRIES) + (low & UINT8_MAX)]
+				^ table[(6 * HASH_CRC32_ENTRIES) + ((low >> 8) & UINT8_MAX)]
+				^ table[(5 * HASH_CRC32_ENTRIES) + ((low >> 16) & UINT8_MAX)]
+				^ table[(4 * HASH_CRC32_ENTRIES) + (low >> 24)]
+				^ table[(3 * HASH_CRC32_ENTRIES) + (high & UINT8_MAX)]
+				^ table[(2 * HASH_CRC32_ENTRIES) + ((high >> 8) & UINT8_MAX)]
+				^ table[HASH_CRC32_ENTRIES + ((high >> 16) & UINT8_MAX)]
+				^ table[high >> 24]);
+		}
+
+		for(; length; ++dat, --length) {
+			result = ((result >> 8) ^ table[(result ^ *dat) & UINT8_MAX]);
+		}
+
+		return ~result;
+	}
+
+	void 
+	_nes_hash::crc32_generate(
+		__out uint32_t *table
+		)
+	{
+		size_t bit, entry, slice;
+
+		for(entry = 0; entry < HASH_CRC32_ENTRIES; ++entry) {
+			table[entry] = entry;
+
+			for(bit = 0; bit < BITS_PER_BYTE; ++bit) {
+				table[entry] = ((table[entry] >> 1) 
+					^ ((table[entry] & 1) ? HASH_CRC32_POLYNOMIAL : 0));
+			}
+		}
+
+		for(slice = 1; slice < HASH_CRC32_SLICES; ++slice) {
+
+			for(entry = 0; entry < HASH_CRC32_ENTRIES; ++entry) {
+				table[(slice * HASH_CRC32_ENTRIES) + entry] = 
+					((table[((slice - 1) * HASH_CRC32_ENTRIES) + entry] >> 8)
+					^ table[table[((slice - 1) * HASH_CRC32_ENTRIES) + entry] & UINT8_MAX]);
+			}
+		}
+	}
+
+	const uint32_t *
+	_nes_hash::crc32_table(void)
+	{
+		static std::once_flag generated;
+		static uint32_t table[HASH_CRC32_SLICES * HASH_CRC32_ENTRIES] = { 0 };
+
+		std::call_once(generated, nes_hash::crc32_generate, table);
+
+		return table;
+	}
+
+	uint64_t 
+	_nes_hash::generate(
+		__in const void *data,
+		__in size_t length,
+		__in_opt uint64_t seed
+		)
+	{
+		size_t iter = 0, stripes;
+		uint8_t tail[HASH_STRIPE_LEN];
+		const uint8_t *dat = (const uint8_t *) data;
+		uint64_t accumulator[HASH_LANES] = { 
+			HASH_PRIME32_3, HASH_PRIME64_1, HASH_PRIME64_2, HASH_PRIME64_3,
+			HASH_PRIME64_4, HASH_PRIME32_2, HASH_PRIME64_5, HASH_PRIME32_1,
+			}, result;
+
+		for(; iter < HASH_LANES; ++iter) {
+			accumulator[iter] += ((iter & 1) ? -seed : seed);
+		}
+
+		stripes = (length / HASH_STRIPE_LEN);
+
+		for(iter = 0; iter < stripes; ++iter) {
+			accumulate(accumulator, dat + (iter * HASH_STRIPE_LEN), 
+				(const uint8_t *) HASH_KEY_STRIPE(iter));
+
+			if((iter % HASH_BLOCK_STRIPES) == (HASH_BLOCK_STRIPES - 1)) {
+				scramble(accumulator, (const uint8_t *) HASH_KEY_SCRAMBLE);
+			}
+		}
+
+		if(length % HASH_STRIPE_LEN) {
+			std::memset(tail, 0, HASH_STRIPE_LEN);
+			std::memcpy(tail, dat + (stripes * HASH_STRIPE_LEN), length % HASH_STRIPE_LEN);
+			accumulate(accumulator, tail, (const uint8_t *) HASH_KEY_STRIPE(stripes));
+		}
+
+		result = (length * HASH_PRIME64_1);
+
+		for(iter = 0; iter < HASH_LANES; iter += 2) {
+			result += mix(accumulator[iter] ^ HASH_KEY[iter], 
+				accumulator[iter + 1] ^ HASH_KEY[iter + 1]);
+		}
+
+		return avalanche(result);
+	}
+
+	uint64_t 
+	_nes_hash::mix(
+		__in uint64_t value,
+		__in uint64_t other
+		)
+	{
+		unsigned __int128 product = (((unsigned __int128) value) * other);
+
+		return (((uint64_t) product) ^ ((uint64_t) (product >> 64)));
+	}
+
+	void 
+	_nes_hash::scramble(
+		__inout uint64_t *accumulator,
+		__in const uint8_t *key
+		)
+	{
+		size_t iter = 0;
+		uint64_t value;
+
+		for(; iter < HASH_LANES; ++iter) {
+			std::memcpy(&value, key + (iter * sizeof(uint64_t)), sizeof(uint64_t));
+			accumulator[iter] ^= (accumulator[iter] >> 47);
+			accumulator[iter] ^= value;
+			accumulator[iter] *= HASH_PRIME32_1;
+		}
+	}
+
+	void 
+	_nes_hash::sha1(
+		__in const void *data,
+		__in size_t length,
+		__out uint8_t *digest
+		)
+	{
+		size_t blocks, iter = 0, remaining;
+		const uint8_t *dat = (const uint8_t *) data;
+		uint8_t tail[HASH_SHA1_BLOCK_LEN * 2] = { 0 };
+		uint32_t state[HASH_SHA1_WORDS] = { HASH_SHA1_INIT[0], HASH_SHA1_INIT[1], 
+			HASH_SHA1_INIT[2], HASH_SHA1_INIT[3], HASH_SHA1_INIT[4] };
+		uint64_t bits = (((uint64_t) length) * BITS_PER_BYTE);
+
+		blocks = (length / HASH_SHA1_BLOCK_LEN);
+		sha1_blocks(state, dat, blocks);
+		remaining = (length % HASH_SHA1_BLOCK_LEN);
+		std::memcpy(tail, dat + (blocks * HASH_SHA1_BLOCK_LEN), remaining);
+		tail[remaining] = HASH_SHA1_PAD;
+		blocks = (((remaining + 1 + HASH_SHA1_LENGTH_LEN) > HASH_SHA1_BLOCK_LEN) ? 2 : 1);
+
+		for(; iter < HASH_SHA1_LENGTH_LEN; ++iter) {
+			tail[(blocks * HASH_SHA1_BLOCK_LEN) - (iter + 1)] = 
+				((bits >> (iter * BITS_PER_BYTE)) & UINT8_MAX);
+		}
+
+		sha1_blocks(state, tail, blocks);
+
+		for(iter = 0; iter < HASH_SHA1_LEN; ++iter) {
+			digest[iter] = ((state[iter / sizeof(uint32_t)] 
+				>> ((3 - (iter % sizeof(uint32_t))) * BITS_PER_BYTE)) & UINT8_MAX);
+		}
+	}
+
+	void 
+	_nes_hash::sha1_blocks(
+		__inout uint32_t *state,
+		__in const uint8_t *data,
+		__in size_t blocks
+		)
+	{
+#if defined(__SHA__) && defined(__SSE4_1__)
+		size_t iter;
+		__m128i abcd, abcd_save, e, e_save, message[4], previous;
+		const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+		abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) state), 0x1b);
+		e_save = _mm_set_epi32(state[4], 0, 0, 0);
+
+		for(; blocks; --blocks, data += HASH_SHA1_BLOCK_LEN) {
+			abcd_save = abcd;
+
+			for(iter = 0; iter < 4; ++iter) {
+				message[iter] = _mm_shuffle_epi8(_mm_loadu_si128(
+					(const __m128i *) (data + (iter * sizeof(__m128i)))), mask);
+			}
+
+			e = _mm_add_epi32(e_save, message[0]);
+			previous = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+
+			for(iter = 1; iter < (HASH_SHA1_ROUNDS / 4); ++iter) {
+
+				if(iter >= 4) {
+					message[iter % 4] = _mm_sha1msg2_epu32(_mm_xor_si128(
+						_mm_sha1msg1_epu32(message[iter % 4], message[(iter + 1) % 4]), 
+						message[(iter + 2) % 4]), message[(iter + 3) % 4]);
+				}
+
+				e = _mm_sha1nexte_epu32(previous, message[iter % 4]);
+				previous = abcd;
+
+				switch(iter / 5) {
+					case 0:
+						abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+						break;
+					case 1:
+						abcd = _mm_sha1rnds4_epu32(abcd, e, 1);
+						break;
+					case 2:
+						abcd = _mm_sha1rnds4_epu32(abcd, e, 2);
+						break;
+					default:
+						abcd = _mm_sha1rnds4_epu32(abcd, e, 3);
+						break;
+				}
+			}
+
+			e_save = _mm_sha1nexte_epu32(previous, e_save);
+			abcd = _mm_add_epi32(abcd, abcd_save);
+		}
+
+		_mm_storeu_si128((__m128i *) state, _mm_shuffle_epi32(abcd, 0x1b));
+		state[4] = _mm_extract_epi32(e_save, 3);
+#else
+		size_t iter;
+		uint32_t round[HASH_SHA1_WORDS], value, word[HASH_SHA1_ROUNDS];
+
+		for(; blocks; --blocks, data += HASH_SHA1_BLOCK_LEN) {
+
+			for(iter = 0; iter < (HASH_SHA1_BLOCK_LEN / sizeof(uint32_t)); ++iter) {
+				word[iter] = ((data[iter * sizeof(uint32_t)] << 24)
+					| (data[(iter * sizeof(uint32_t)) + 1] << 16)
+					| (data[(iter * sizeof(uint32_t)) + 2] << 8)
+					| data[(iter * sizeof(uint32_t)) + 3]);
+			}
+
+			for(; iter < HASH_SHA1_ROUNDS; ++iter) {
+				value = (word[iter - 3] ^ word[iter - 8] ^ word[iter - 14] ^ word[iter - 16]);
+				word[iter] = ((value << 1) | (value >> 31));
+			}
+
+			std::memcpy(round, state, sizeof(round));
+
+			for(iter = 0; iter < HASH_SHA1_ROUNDS; ++iter) {
+
+				switch(iter / 20) {
+					case 0:
+						value = ((round[1] & round[2]) | (~round[1] & round[3]));
+						break;
+					case 2:
+						value = ((round[1] & round[2]) | (round[1] & round[3]) 
+							| (round[2] & round[3]));
+						break;
+					default:
+						value = (round[1] ^ round[2] ^ round[3]);
+						break;
+				}
+
+				value += (((round[0] << 5) | (round[0] >> 27)) + round[4] 
+					+ HASH_SHA1_ROUND[iter / 20] + word[iter]);
+				round[4] = round[3];
+				round[3] = round[2];
+				round[2] = ((round[1] << 30) | (round[1] >> 2));
+				round[1] = round[0];
+				round[0] = value;
+			}
+
+			for(iter = 0; iter < HASH_SHA1_WORDS; ++iter) {
+				state[iter] += round[iter];
+			}
+		}
+#endif // __SHA__ && __SSE4_1__
+	}
+}
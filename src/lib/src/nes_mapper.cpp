@@ -0,0 +1,860 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstring>
+#include "../include/nes.h"
+#include "../include/nes_mapper_type.h"
+
+namespace NES {
+
+	namespace COMP {
+
+		_nes_mapper::_nes_mapper(
+			__in nes_rom &rom,
+			__in uint8_t *nametable
+			) :
+				m_character_data(NULL),
+				m_character_length(0),
+				m_character_writable(false),
+				m_descriptor(rom.descriptor()),
+				m_image(rom.image()),
+				m_irq(false),
+				m_mirroring((nes_mapper_mirroring_t) m_descriptor.mirroring),
+				m_nametable_base(nametable),
+				m_program_data(rom.data_program()),
+				m_program_length(m_descriptor.program_length),
+				m_ram(NULL),
+				m_ram_enabled(true),
+				m_ram_length(rom.ram_program().size())
+		{
+
+			if(!m_nametable_base) {
+				THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_ADDRESS,
+					"nametable. 0x%p", nametable);
+			}
+
+			if(m_descriptor.character_length) {
+				m_character_data = (uint8_t *) rom.data_character();
+				m_character_length = m_descriptor.character_length;
+			} else if(!rom.ram_character().empty()) {
+				m_character_data = &rom.ram_character()[0];
+				m_character_length = rom.ram_character().size();
+				m_character_writable = true;
+			}
+
+			if((m_program_length % MAPPER_PROGRAM_PAGE_LEN) 
+					|| (m_character_length % MAPPER_CHARACTER_PAGE_LEN)) {
+				THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_UNSUPPORTED,
+					"prg. %u, chr. %u", m_program_length, m_character_length);
+			}
+
+			if(m_ram_length) {
+				m_ram = &rom.ram_program()[0];
+			}
+
+			std::memset(m_character, 0, sizeof(m_character));
+			std::memset(m_nametable, 0, sizeof(m_nametable));
+			std::memset(m_program, 0, sizeof(m_program));
+		}
+
+		_nes_mapper::~_nes_mapper(void)
+		{
+			return;
+		}
+
+		_nes_mapper *
+		_nes_mapper::create(
+			__in nes_rom &rom,
+			__in uint8_t *nametable
+			)
+		{
+			nes_mapper_ptr result = NULL;
+
+			switch(rom.descriptor().mapper) {
+				case NES_MAPPER_NROM:
+					result = new nes_mapper_nrom(rom, nametable);
+					break;
+				case NES_MAPPER_MMC1:
+					result = new nes_mapper_mmc1(rom, nametable);
+					break;
+				case NES_MAPPER_UXROM:
+					result = new nes_mapper_uxrom(rom, nametable);
+					break;
+				case NES_MAPPER_CNROM:
+					result = new nes_mapper_cnrom(rom, nametable);
+					break;
+				case NES_MAPPER_MMC3:
+					result = new nes_mapper_mmc3(rom, nametable);
+					break;
+				case NES_MAPPER_AXROM:
+					result = new nes_mapper_axrom(rom, nametable);
+					break;
+				default:
+					THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_UNSUPPORTED,
+						"mapper. %u", rom.descriptor().mapper);
+			}
+
+			if(!result) {
+				THROW_NES_MAPPER_EXCEPTION(NES_MAPPER_EXCEPTION_ALLOCATED);
+			}
+
+			result->reset();
+
+			return result;
+		}
+
+		bool 
+		_nes_mapper::irq_pending(void)
+		{
+			return m_irq;
+		}
+
+		uint32_t 
+		_nes_mapper::irq_scanlines(void)
+		{
+			return 0;
+		}
+
+		void 
+		_nes_mapper::map_character(
+			__in uint8_t page,
+			__in uint8_t count,
+			__in int32_t bank
+			)
+		{
+			uint8_t iter = 0, *data = m_character_data;
+			size_t banks, length = (count * MAPPER_CHARACTER_PAGE_LEN), wrap = m_character_length;
+
+			if(((page + count) > NES_MAPPER_CHARACTER_PAGES) || !count) {
+				THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_ADDRESS,
+					"page. %u, count. %u", page, count);
+			}
+
+			banks = (m_character_length / length);
+			if(banks) {
+
+				if(bank < 0) {
+					bank += banks;
+				}
+
+				data += ((bank % banks) * length);
+				wrap = length;
+			}
+
+			for(; iter < count; ++iter) {
+				m_character[page + iter] = (data ? (data + ((iter * MAPPER_CHARACTER_PAGE_LEN) 
+					% wrap)) : NULL);
+			}
+		}
+
+		void 
+		_nes_mapper::map_mirroring(
+			__in nes_mapper_mirroring_t mirroring
+			)
+		{
+			uint8_t iter = 0, page[NES_MAPPER_NAMETABLE_PAGES];
+
+			switch(mirroring) {
+				case NES_MAPPER_MIRRORING_HORZ:
+					page[0] = 0;
+					page[1] = 0;
+					page[2] = 1;
+					page[3] = 1;
+					break;
+				case NES_MAPPER_MIRRORING_VERT:
+					page[0] = 0;
+					page[1] = 1;
+					page[2] = 0;
+					page[3] = 1;
+					break;
+				case NES_MAPPER_MIRRORING_FOUR_SCREEN:
+					page[0] = 0;
+					page[1] = 1;
+					page[2] = 2;
+					page[3] = 3;
+					break;
+				case NES_MAPPER_MIRRORING_SINGLE_LOW:
+					std::memset(page, 0, sizeof(page));
+					break;
+				case NES_MAPPER_MIRRORING_SINGLE_HIGH:
+					std::memset(page, 1, sizeof(page));
+					break;
+				default:
+					THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_MIRRORING,
+						"mirroring. %u", mirroring);
+			}
+
+			for(; iter < NES_MAPPER_NAMETABLE_PAGES; ++iter) {
+				m_nametable[iter] = (m_nametable_base + (page[iter] * MAPPER_NAMETABLE_LEN));
+			}
+
+			m_mirroring = mirroring;
+		}
+
+		void 
+		_nes_mapper::map_program(
+			__in uint8_t page,
+			__in uint8_t count,
+			__in int32_t bank
+			)
+		{
+			uint8_t iter = 0;
+			const uint8_t *data = m_program_data;
+			size_t banks, length = (count * MAPPER_PROGRAM_PAGE_LEN), wrap = m_program_length;
+
+			if(((page + count) > NES_MAPPER_PROGRAM_PAGES) || !count) {
+				THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_ADDRESS,
+					"page. %u, count. %u", page, count);
+			}
+
+			banks = (m_program_length / length);
+			if(banks) {
+
+				if(bank < 0) {
+					bank += banks;
+				}
+
+				data += ((bank % banks) * length);
+				wrap = length;
+			}
+
+			for(; iter < count; ++iter) {
+				m_program[page + iter] = (data ? (data + ((iter * MAPPER_PROGRAM_PAGE_LEN) 
+					% wrap)) : NULL);
+			}
+		}
+
+		uint16_t 
+		_nes_mapper::mapper(void)
+		{
+			return m_descriptor.mapper;
+		}
+
+		nes_mapper_mirroring_t 
+		_nes_mapper::mirroring(void)
+		{
+			return m_mirroring;
+		}
+
+		uint32_t 
+		_nes_mapper::page_offset(
+			__in const uint8_t *base,
+			__in const uint8_t *page
+			)
+		{
+			return (page ? (page - base) : MAPPER_SNAPSHOT_UNMAPPED);
+		}
+
+		const uint8_t *
+		_nes_mapper::page_pointer(
+			__in const uint8_t *base,
+			__in size_t length,
+			__in size_t page_length,
+			__in uint32_t offset
+			)
+		{
+
+			if(offset == MAPPER_SNAPSHOT_UNMAPPED) {
+				return NULL;
+			}
+
+			if(!base || (offset % page_length) || ((offset + page_length) > length)) {
+				THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_SNAPSHOT,
+					"offset. 0x%x, length. 0x%x", offset, length);
+			}
+
+			return (base + offset);
+		}
+
+		uint8_t 
+		_nes_mapper::read_cpu(
+			__in uint16_t address
+			)
+		{
+			const uint8_t *page;
+
+			if(address >= MAPPER_PROGRAM_BASE) {
+				page = m_program[(address - MAPPER_PROGRAM_BASE) >> MAPPER_PROGRAM_PAGE_SHIFT];
+
+				return (page ? page[address & (MAPPER_PROGRAM_PAGE_LEN - 1)] : 0);
+			} else if((address >= MAPPER_RAM_BASE) && m_ram_enabled && m_ram) {
+				return m_ram[(address - MAPPER_RAM_BASE) % m_ram_length];
+			}
+
+			return (address >> BITS_PER_BYTE);
+		}
+
+		uint8_t 
+		_nes_mapper::read_ppu(
+			__in uint16_t address
+			)
+		{
+			uint8_t *page, result = 0;
+
+			if(address <= MAPPER_CHARACTER_MAX) {
+
+				page = m_character[address >> MAPPER_CHARACTER_PAGE_SHIFT];
+				if(page) {
+					result = page[address & (MAPPER_CHARACTER_PAGE_LEN - 1)];
+				}
+			} else if(address < MAPPER_NAMETABLE_END) {
+				result = m_nametable[(address >> MAPPER_NAMETABLE_SHIFT) % NES_MAPPER_NAMETABLE_PAGES]
+					[address & (MAPPER_NAMETABLE_LEN - 1)];
+			} else {
+				THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_ADDRESS,
+					"addr. 0x%x", address);
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_mapper::reset(void)
+		{
+			m_irq = false;
+			m_ram_enabled = true;
+			map_mirroring((nes_mapper_mirroring_t) m_descriptor.mirroring);
+		}
+
+		void 
+		_nes_mapper::restore(
+			__in const nes_mapper_snapshot &snapshot
+			)
+		{
+			uint8_t iter = 0, *character[NES_MAPPER_CHARACTER_PAGES],
+				*nametable[NES_MAPPER_NAMETABLE_PAGES];
+			const uint8_t *program[NES_MAPPER_PROGRAM_PAGES];
+
+			if(snapshot.mirroring > NES_MAPPER_MIRRORING_MAX) {
+				THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_MIRRORING,
+					"mirroring. %u", snapshot.mirroring);
+			}
+
+			for(; iter < NES_MAPPER_CHARACTER_PAGES; ++iter) {
+				character[iter] = (uint8_t *) page_pointer(m_character_data, m_character_length,
+					MAPPER_CHARACTER_PAGE_LEN, snapshot.character[iter]);
+			}
+
+			for(iter = 0; iter < NES_MAPPER_NAMETABLE_PAGES; ++iter) {
+				nametable[iter] = (uint8_t *) page_pointer(m_nametable_base,
+					NES_MAPPER_NAMETABLE_PAGES * MAPPER_NAMETABLE_LEN, MAPPER_NAMETABLE_LEN,
+					snapshot.nametable[iter]);
+
+				if(!nametable[iter]) {
+					THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_SNAPSHOT,
+						"nametable. %u", iter);
+				}
+			}
+
+			for(iter = 0; iter < NES_MAPPER_PROGRAM_PAGES; ++iter) {
+				program[iter] = page_pointer(m_program_data, m_program_length,
+					MAPPER_PROGRAM_PAGE_LEN, snapshot.program[iter]);
+			}
+
+			std::memcpy(m_character, character, sizeof(m_character));
+			std::memcpy(m_nametable, nametable, sizeof(m_nametable));
+			std::memcpy(m_program, program, sizeof(m_program));
+			m_irq = snapshot.irq;
+			m_mirroring = (nes_mapper_mirroring_t) snapshot.mirroring;
+			m_ram_enabled = snapshot.ram_enabled;
+		}
+
+		void 
+		_nes_mapper::scanline(
+			__in uint32_t count
+			)
+		{
+			return;
+		}
+
+		void 
+		_nes_mapper::snapshot(
+			__out nes_mapper_snapshot &snapshot
+			)
+		{
+			uint8_t iter = 0;
+
+			std::memset(&snapshot, 0, sizeof(nes_mapper_snapshot));
+
+			for(; iter < NES_MAPPER_CHARACTER_PAGES; ++iter) {
+				snapshot.character[iter] = page_offset(m_character_data, m_character[iter]);
+			}
+
+			for(iter = 0; iter < NES_MAPPER_NAMETABLE_PAGES; ++iter) {
+				snapshot.nametable[iter] = page_offset(m_nametable_base, m_nametable[iter]);
+			}
+
+			for(iter = 0; iter < NES_MAPPER_PROGRAM_PAGES; ++iter) {
+				snapshot.program[iter] = page_offset(m_program_data, m_program[iter]);
+			}
+
+			snapshot.irq = m_irq;
+			snapshot.mirroring = m_mirroring;
+			snapshot.ram_enabled = m_ram_enabled;
+		}
+
+		std::string 
+		_nes_mapper::to_string(
+			__in_opt bool verbose
+			)
+		{
+			std::stringstream result;
+
+			result << "<" << NES_MAPPER_HEADER << "> (";
+
+			if(verbose) {
+				result << "ptr. 0x" << VALUE_AS_HEX(nes_mapper_ptr, this);
+			}
+
+			result << ")" << ", MAP: " << m_descriptor.mapper
+				<< ", MIR: " << m_mirroring
+				<< ", IRQ: " << m_irq;
+
+			return result.str();
+		}
+
+		void 
+		_nes_mapper::write_cpu(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+
+			if(address >= MAPPER_PROGRAM_BASE) {
+				write_register(address, value);
+			} else if((address >= MAPPER_RAM_BASE) && m_ram_enabled && m_ram) {
+				m_ram[(address - MAPPER_RAM_BASE) % m_ram_length] = value;
+			}
+		}
+
+		void 
+		_nes_mapper::write_ppu(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+			uint8_t *page;
+
+			if(address <= MAPPER_CHARACTER_MAX) {
+
+				page = m_character[address >> MAPPER_CHARACTER_PAGE_SHIFT];
+				if(page && m_character_writable) {
+					page[address & (MAPPER_CHARACTER_PAGE_LEN - 1)] = value;
+				}
+			} else if(address < MAPPER_NAMETABLE_END) {
+				m_nametable[(address >> MAPPER_NAMETABLE_SHIFT) % NES_MAPPER_NAMETABLE_PAGES]
+					[address & (MAPPER_NAMETABLE_LEN - 1)] = value;
+			} else {
+				THROW_NES_MAPPER_EXCEPTION_MESSAGE(NES_MAPPER_EXCEPTION_INVALID_ADDRESS,
+					"addr. 0x%x", address);
+			}
+		}
+
+		_nes_mapper_axrom::_nes_mapper_axrom(
+			__in nes_rom &rom,
+			__in uint8_t *nametable
+			) :
+				_nes_mapper(rom, nametable)
+		{
+			return;
+		}
+
+		void 
+		_nes_mapper_axrom::reset(void)
+		{
+			nes_mapper::reset();
+			write_register(MAPPER_PROGRAM_BASE, 0);
+			map_character(0, NES_MAPPER_CHARACTER_PAGES, 0);
+		}
+
+		void 
+		_nes_mapper_axrom::write_register(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+			map_program(0, NES_MAPPER_PROGRAM_PAGES, value & MAPPER_AXROM_BANK);
+			map_mirroring((value & MAPPER_AXROM_MIRRORING) ? NES_MAPPER_MIRRORING_SINGLE_HIGH
+				: NES_MAPPER_MIRRORING_SINGLE_LOW);
+		}
+
+		_nes_mapper_cnrom::_nes_mapper_cnrom(
+			__in nes_rom &rom,
+			__in uint8_t *nametable
+			) :
+				_nes_mapper(rom, nametable)
+		{
+			return;
+		}
+
+		void 
+		_nes_mapper_cnrom::reset(void)
+		{
+			nes_mapper::reset();
+			map_program(0, MAPPER_PROGRAM_BANK_16KB, 0);
+			map_program(MAPPER_PROGRAM_BANK_16KB, MAPPER_PROGRAM_BANK_16KB, -1);
+			write_register(MAPPER_PROGRAM_BASE, 0);
+		}
+
+		void 
+		_nes_mapper_cnrom::write_register(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+			map_character(0, NES_MAPPER_CHARACTER_PAGES, value);
+		}
+
+		_nes_mapper_mmc1::_nes_mapper_mmc1(
+			__in nes_rom &rom,
+			__in uint8_t *nametable
+			) :
+				_nes_mapper(rom, nametable),
+				m_shift(MAPPER_MMC1_SHIFT)
+		{
+			std::memset(m_register, 0, sizeof(m_register));
+		}
+
+		void 
+		_nes_mapper_mmc1::reset(void)
+		{
+			nes_mapper::reset();
+			std::memset(m_register, 0, sizeof(m_register));
+			m_register[MAPPER_MMC1_REGISTER_CONTROL] = MAPPER_MMC1_CONTROL_PROGRAM;
+			m_shift = MAPPER_MMC1_SHIFT;
+			update();
+		}
+
+		void 
+		_nes_mapper_mmc1::restore(
+			__in const nes_mapper_snapshot &snapshot
+			)
+		{
+			nes_mapper::restore(snapshot);
+			std::memcpy(m_register, snapshot.registers, sizeof(m_register));
+			m_shift = snapshot.registers[NES_MAPPER_MMC1_REGISTERS];
+		}
+
+		void 
+		_nes_mapper_mmc1::snapshot(
+			__out nes_mapper_snapshot &snapshot
+			)
+		{
+			nes_mapper::snapshot(snapshot);
+			std::memcpy(snapshot.registers, m_register, sizeof(m_register));
+			snapshot.registers[NES_MAPPER_MMC1_REGISTERS] = m_shift;
+		}
+
+		void 
+		_nes_mapper_mmc1::update(void)
+		{
+			uint8_t bank, control = m_register[MAPPER_MMC1_REGISTER_CONTROL];
+
+			switch(control & MAPPER_MMC1_CONTROL_MIRRORING) {
+				case MAPPER_MMC1_MIRRORING_SINGLE_LOW:
+					map_mirroring(NES_MAPPER_MIRRORING_SINGLE_LOW);
+					break;
+				case MAPPER_MMC1_MIRRORING_SINGLE_HIGH:
+					map_mirroring(NES_MAPPER_MIRRORING_SINGLE_HIGH);
+					break;
+				case MAPPER_MMC1_MIRRORING_VERT:
+					map_mirroring(NES_MAPPER_MIRRORING_VERT);
+					break;
+				default:
+					map_mirroring(NES_MAPPER_MIRRORING_HORZ);
+					break;
+			}
+
+			bank = (m_register[MAPPER_MMC1_REGISTER_PROGRAM] & MAPPER_MMC1_PROGRAM_BANK);
+
+			switch((control & MAPPER_MMC1_CONTROL_PROGRAM) >> MAPPER_MMC1_CONTROL_PROGRAM_SHIFT) {
+				case MAPPER_MMC1_PROGRAM_FIX_FIRST:
+					map_program(0, MAPPER_PROGRAM_BANK_16KB, 0);
+					map_program(MAPPER_PROGRAM_BANK_16KB, MAPPER_PROGRAM_BANK_16KB, bank);
+					break;
+				case MAPPER_MMC1_PROGRAM_FIX_LAST:
+					map_program(0, MAPPER_PROGRAM_BANK_16KB, bank);
+					map_program(MAPPER_PROGRAM_BANK_16KB, MAPPER_PROGRAM_BANK_16KB, -1);
+					break;
+				default:
+					map_program(0, NES_MAPPER_PROGRAM_PAGES, bank >> 1);
+					break;
+			}
+
+			if(control & MAPPER_MMC1_CONTROL_CHARACTER) {
+				map_character(0, MAPPER_CHARACTER_BANK_4KB, 
+					m_register[MAPPER_MMC1_REGISTER_CHARACTER_0]);
+				map_character(MAPPER_CHARACTER_BANK_4KB, MAPPER_CHARACTER_BANK_4KB, 
+					m_register[MAPPER_MMC1_REGISTER_CHARACTER_1]);
+			} else {
+				map_character(0, NES_MAPPER_CHARACTER_PAGES, 
+					m_register[MAPPER_MMC1_REGISTER_CHARACTER_0] >> 1);
+			}
+
+			m_ram_enabled = !(m_register[MAPPER_MMC1_REGISTER_PROGRAM] 
+				& MAPPER_MMC1_PROGRAM_RAM_DISABLE);
+		}
+
+		void 
+		_nes_mapper_mmc1::write_register(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+			bool complete;
+
+			if(value & MAPPER_MMC1_RESET) {
+				m_register[MAPPER_MMC1_REGISTER_CONTROL] |= MAPPER_MMC1_CONTROL_PROGRAM;
+				m_shift = MAPPER_MMC1_SHIFT;
+				update();
+			} else {
+				complete = (m_shift & 1);
+				m_shift = ((m_shift >> 1) | ((value & 1) << MAPPER_MMC1_SHIFT_LENGTH));
+
+				if(complete) {
+					m_register[(address >> MAPPER_MMC1_REGISTER_SHIFT) 
+						% NES_MAPPER_MMC1_REGISTERS] = m_shift;
+					m_shift = MAPPER_MMC1_SHIFT;
+					update();
+				}
+			}
+		}
+
+		_nes_mapper_mmc3::_nes_mapper_mmc3(
+			__in nes_rom &rom,
+			__in uint8_t *nametable
+			) :
+				_nes_mapper(rom, nametable),
+				m_bank_select(0),
+				m_irq_counter(0),
+				m_irq_enabled(false),
+				m_irq_latch(0),
+				m_irq_reload(false)
+		{
+			std::memset(m_register, 0, sizeof(m_register));
+		}
+
+		uint32_t 
+		_nes_mapper_mmc3::irq_scanlines(void)
+		{
+
+			if(!m_irq_enabled || m_irq) {
+				return 0;
+			}
+
+			if(!m_irq_counter || m_irq_reload) {
+				return (m_irq_latch + 1);
+			}
+
+			return m_irq_counter;
+		}
+
+		void 
+		_nes_mapper_mmc3::reset(void)
+		{
+			nes_mapper::reset();
+			m_bank_select = 0;
+			m_irq_counter = 0;
+			m_irq_enabled = false;
+			m_irq_latch = 0;
+			m_irq_reload = false;
+			std::memset(m_register, 0, sizeof(m_register));
+			update();
+		}
+
+		void 
+		_nes_mapper_mmc3::restore(
+			__in const nes_mapper_snapshot &snapshot
+			)
+		{
+			nes_mapper::restore(snapshot);
+			std::memcpy(m_register, snapshot.registers, sizeof(m_register));
+			m_bank_select = snapshot.registers[NES_MAPPER_MMC3_REGISTERS];
+			m_irq_counter = snapshot.registers[NES_MAPPER_MMC3_REGISTERS + 1];
+			m_irq_enabled = snapshot.registers[NES_MAPPER_MMC3_REGISTERS + 2];
+			m_irq_latch = snapshot.registers[NES_MAPPER_MMC3_REGISTERS + 3];
+			m_irq_reload = snapshot.registers[NES_MAPPER_MMC3_REGISTERS + 4];
+		}
+
+		void 
+		_nes_mapper_mmc3::scanline(
+			__in uint32_t count
+			)
+		{
+
+			for(; count; --count) {
+
+				if(!m_irq_counter || m_irq_reload) {
+					m_irq_counter = m_irq_latch;
+					m_irq_reload = false;
+				} else {
+					--m_irq_counter;
+				}
+
+				if(!m_irq_counter && m_irq_enabled) {
+					m_irq = true;
+				}
+			}
+		}
+
+		void 
+		_nes_mapper_mmc3::snapshot(
+			__out nes_mapper_snapshot &snapshot
+			)
+		{
+			nes_mapper::snapshot(snapshot);
+			std::memcpy(snapshot.registers, m_register, sizeof(m_register));
+			snapshot.registers[NES_MAPPER_MMC3_REGISTERS] = m_bank_select;
+			snapshot.registers[NES_MAPPER_MMC3_REGISTERS + 1] = m_irq_counter;
+			snapshot.registers[NES_MAPPER_MMC3_REGISTERS + 2] = m_irq_enabled;
+			snapshot.registers[NES_MAPPER_MMC3_REGISTERS + 3] = m_irq_latch;
+			snapshot.registers[NES_MAPPER_MMC3_REGISTERS + 4] = m_irq_reload;
+		}
+
+		void 
+		_nes_mapper_mmc3::update(void)
+		{
+			uint8_t high = 0, low = MAPPER_CHARACTER_BANK_4KB;
+
+			if(m_bank_select & MAPPER_MMC3_BANK_CHARACTER_INVERT) {
+				high = MAPPER_CHARACTER_BANK_4KB;
+				low = 0;
+			}
+
+			map_character(high, MAPPER_CHARACTER_BANK_2KB, m_register[0] >> 1);
+			map_character(high + MAPPER_CHARACTER_BANK_2KB, MAPPER_CHARACTER_BANK_2KB, 
+				m_register[1] >> 1);
+			map_character(low, 1, m_register[2]);
+			map_character(low + 1, 1, m_register[3]);
+			map_character(low + 2, 1, m_register[4]);
+			map_character(low + 3, 1, m_register[5]);
+
+			if(m_bank_select & MAPPER_MMC3_BANK_PROGRAM_SWAP) {
+				map_program(0, 1, -2);
+				map_program(2, 1, m_register[6] & MAPPER_MMC3_BANK_PROGRAM);
+			} else {
+				map_program(0, 1, m_register[6] & MAPPER_MMC3_BANK_PROGRAM);
+				map_program(2, 1, -2);
+			}
+
+			map_program(1, 1, m_register[7] & MAPPER_MMC3_BANK_PROGRAM);
+			map_program(3, 1, -1);
+		}
+
+		void 
+		_nes_mapper_mmc3::write_register(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+
+			switch(address & MAPPER_MMC3_REGISTER_MASK) {
+				case MAPPER_MMC3_REGISTER_BANK_SELECT:
+					m_bank_select = value;
+					update();
+					break;
+				case MAPPER_MMC3_REGISTER_BANK_DATA:
+					m_register[m_bank_select & MAPPER_MMC3_BANK_SELECT] = value;
+					update();
+					break;
+				case MAPPER_MMC3_REGISTER_MIRRORING:
+
+					if(m_descriptor.mirroring != ROM_MIRRORING_FOUR_SCREEN) {
+						map_mirroring((value & MAPPER_MMC3_MIRRORING_HORZ) 
+							? NES_MAPPER_MIRRORING_HORZ : NES_MAPPER_MIRRORING_VERT);
+					}
+					break;
+				case MAPPER_MMC3_REGISTER_PROGRAM_RAM:
+					m_ram_enabled = (value & MAPPER_MMC3_PROGRAM_RAM_ENABLE);
+					break;
+				case MAPPER_MMC3_REGISTER_IRQ_LATCH:
+					m_irq_latch = value;
+					break;
+				case MAPPER_MMC3_REGISTER_IRQ_RELOAD:
+					m_irq_counter = 0;
+					m_irq_reload = true;
+					break;
+				case MAPPER_MMC3_REGISTER_IRQ_DISABLE:
+					m_irq_enabled = false;
+					m_irq = false;
+					break;
+				case MAPPER_MMC3_REGISTER_IRQ_ENABLE:
+					m_irq_enabled = true;
+					break;
+				default:
+					break;
+			}
+		}
+
+		_nes_mapper_nrom::_nes_mapper_nrom(
+			__in nes_rom &rom,
+			__in uint8_t *nametable
+			) :
+				_nes_mapper(rom, nametable)
+		{
+			return;
+		}
+
+		void 
+		_nes_mapper_nrom::reset(void)
+		{
+			nes_mapper::reset();
+			map_program(0, MAPPER_PROGRAM_BANK_16KB, 0);
+			map_program(MAPPER_PROGRAM_BANK_16KB, MAPPER_PROGRAM_BANK_16KB, 1);
+			map_character(0, NES_MAPPER_CHARACTER_PAGES, 0);
+		}
+
+		void 
+		_nes_mapper_nrom::write_register(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+			return;
+		}
+
+		_nes_mapper_uxrom::_nes_mapper_uxrom(
+			__in nes_rom &rom,
+			__in uint8_t *nametable
+			) :
+				_nes_mapper(rom, nametable)
+		{
+			return;
+		}
+
+		void 
+		_nes_mapper_uxrom::reset(void)
+		{
+			nes_mapper::reset();
+			write_register(MAPPER_PROGRAM_BASE, 0);
+			map_program(MAPPER_PROGRAM_BANK_16KB, MAPPER_PROGRAM_BANK_16KB, -1);
+			map_character(0, NES_MAPPER_CHARACTER_PAGES, 0);
+		}
+
+		void 
+		_nes_mapper_uxrom::write_register(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+			map_program(0, MAPPER_PROGRAM_BANK_16KB, value);
+		}
+	}
+}
@@ -29,7 +29,7 @@ namespace NES {
 		_nes_memory::_nes_memory(void) :
 			m_initialized(false)
 		{
-			std::atexit(nes_memory::_delete);
+			return;
 		}
 
 		_nes_memory::~_nes_memory(void)
@@ -56,10 +56,8 @@ namespace NES {
 
 			if(!nes_memory::m_instance) {
 
-				nes_memory::m_instance = new nes_memory;
-				if(!nes_memory::m_instance) {
-					THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_ALLOCATED);
-				}
+				nes_memory::m_instance = create();
+				std::atexit(nes_memory::_delete);
 			}
 
 			return nes_memory::m_instance;
@@ -74,8 +72,6 @@ namespace NES {
 		{
 			nes_memory_block *blk = NULL;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(type) {
 				case NES_MEM_MMU:
 					blk = &m_mmu;
@@ -135,8 +131,6 @@ namespace NES {
 		{
 			nes_memory_block *blk = NULL;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			if(!m_initialized) {
 				THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_UNINITIALIZED);
 			}
@@ -231,7 +225,6 @@ namespace NES {
 		void 
 		_nes_memory::clear(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_UNINITIALIZED);
@@ -247,7 +240,6 @@ namespace NES {
 			__in nes_memory_t type
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_UNINITIALIZED);
@@ -272,6 +264,19 @@ namespace NES {
 			}
 		}
 
+		_nes_memory *
+		_nes_memory::create(void)
+		{
+			_nes_memory *result = NULL;
+
+			result = new nes_memory;
+			if(!result) {
+				THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_ALLOCATED);
+			}
+
+			return result;
+		}
+
 		std::string 
 		_nes_memory::flag_as_string(
 			__in uint8_t flag,
@@ -304,7 +309,6 @@ namespace NES {
 			__in uint8_t flag
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return (at(type, address) & flag);
 		}
 
@@ -315,7 +319,6 @@ namespace NES {
 			__in uint8_t flag
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			at(type, address) &= ~flag;
 		}
 
@@ -326,14 +329,12 @@ namespace NES {
 			__in uint8_t flag
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			at(type, address) |= flag;
 		}
 
 		void 
 		_nes_memory::initialize(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(m_initialized) {
 				THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_INITIALIZED);
@@ -352,7 +353,6 @@ namespace NES {
 		bool 
 		_nes_memory::is_initialized(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return m_initialized;
 		}
 
@@ -368,8 +368,6 @@ namespace NES {
 			nes_memory_block *blk = NULL;
 			nes_memory_block::iterator end;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			if(!m_initialized) {
 				THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_UNINITIALIZED);
 			}
@@ -417,8 +415,6 @@ namespace NES {
 			std::stringstream result;
 			nes_memory_block *blk = NULL;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			switch(type) {
 				case NES_MEM_MMU:
 					blk = &m_mmu;
@@ -455,7 +451,6 @@ namespace NES {
 		void 
 		_nes_memory::uninitialize(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_UNINITIALIZED);
@@ -477,8 +472,6 @@ namespace NES {
 			nes_memory_block *blk = NULL;
 			uint16_t iter = 0, result = block.size();
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			if(!m_initialized) {
 				THROW_NES_MEMORY_EXCEPTION(NES_MEMORY_EXCEPTION_UNINITIALIZED);
 			}
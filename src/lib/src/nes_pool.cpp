@@ -0,0 +1,569 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <pthread.h>
+#include "../include/nes.h"
+#include "../include/nes_pool_type.h"
+
+namespace NES {
+
+	_nes_pool_queue::_nes_pool_queue(
+		__in size_t capacity
+		) :
+			m_completion(capacity),
+			m_head(0),
+			m_mask(capacity - 1),
+			m_sequence(capacity),
+			m_tail(0)
+	{
+		size_t iter = 0;
+
+		for(; iter < capacity; ++iter) {
+			m_sequence[iter].store(iter, std::memory_order_relaxed);
+		}
+	}
+
+	_nes_pool_queue::~_nes_pool_queue(void)
+	{
+		return;
+	}
+
+	size_t 
+	_nes_pool_queue::capacity(void)
+	{
+		return m_completion.size();
+	}
+
+	bool 
+	_nes_pool_queue::pop(
+		__out nes_pool_completion &completion
+		)
+	{
+		intptr_t distance;
+		size_t position, sequence;
+
+		position = m_tail.load(std::memory_order_relaxed);
+
+		for(;;) {
+			sequence = m_sequence[position & m_mask].load(std::memory_order_acquire);
+			distance = ((intptr_t) sequence - (intptr_t) (position + 1));
+
+			if(!distance) {
+
+				if(m_tail.compare_exchange_weak(position, position + 1, 
+						std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(distance < 0) {
+				return false;
+			} else {
+				position = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		completion = m_completion[position & m_mask];
+		m_sequence[position & m_mask].store(position + m_mask + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	bool 
+	_nes_pool_queue::push(
+		__in const nes_pool_completion &completion
+		)
+	{
+		intptr_t distance;
+		size_t position, sequence;
+
+		position = m_head.load(std::memory_order_relaxed);
+
+		for(;;) {
+			sequence = m_sequence[position & m_mask].load(std::memory_order_acquire);
+			distance = ((intptr_t) sequence - (intptr_t) position);
+
+			if(!distance) {
+
+				if(m_head.compare_exchange_weak(position, position + 1, 
+						std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(distance < 0) {
+				return false;
+			} else {
+				position = m_head.load(std::memory_order_relaxed);
+			}
+		}
+
+		m_completion[position & m_mask] = completion;
+		m_sequence[position & m_mask].store(position + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	size_t 
+	_nes_pool_queue::size(void)
+	{
+		return (m_head.load(std::memory_order_acquire) 
+			- m_tail.load(std::memory_order_acquire));
+	}
+
+	_nes_pool::_nes_pool(void) :
+		m_active(0),
+		m_affinity(false),
+		m_completion(NULL),
+		m_dropped(0),
+		m_initialized(false),
+		m_next(0),
+		m_queued(0),
+		m_stop(false)
+	{
+		return;
+	}
+
+	_nes_pool::~_nes_pool(void)
+	{
+
+		if(m_initialized) {
+			uninitialize();
+		}
+	}
+
+	size_t 
+	_nes_pool::add(
+		__in nes_ptr session
+		)
+	{
+		nes_pool_session *entry = NULL;
+
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		if(!m_initialized) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(!session || !session->is_initialized()) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_INVALID_SESSION);
+		}
+
+		entry = new nes_pool_session;
+		if(!entry) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_ALLOCATED);
+		}
+
+		entry->budget.store(0, std::memory_order_relaxed);
+		entry->handle = m_sessions.size();
+		entry->scheduled.store(false, std::memory_order_relaxed);
+		entry->session = session;
+		m_sessions.push_back(entry);
+
+		return entry->handle;
+	}
+
+	uint32_t 
+	_nes_pool::budget(
+		__in size_t handle
+		)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		if(!m_initialized) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(handle >= m_sessions.size()) {
+			THROW_NES_POOL_EXCEPTION_MESSAGE(NES_POOL_EXCEPTION_INVALID_HANDLE,
+				"handle. %lu (max. %lu)", handle, m_sessions.size());
+		}
+
+		return m_sessions.at(handle)->budget.load(std::memory_order_acquire);
+	}
+
+	bool 
+	_nes_pool::dequeue(
+		__in size_t worker,
+		__out nes_pool_session *&session
+		)
+	{
+		bool result = false;
+		size_t iter = 0, count;
+		nes_pool_worker *entry = NULL;
+
+		count = m_workers.size();
+
+		for(; !result && (iter < count); ++iter) {
+			entry = m_workers.at((worker + iter) % count);
+			std::lock_guard<std::mutex> lock(entry->lock);
+
+			if(!entry->queue.empty()) {
+
+				if(!iter) {
+					session = entry->queue.back();
+					entry->queue.pop_back();
+				} else {
+					session = entry->queue.front();
+					entry->queue.pop_front();
+				}
+
+				m_queued.fetch_sub(1, std::memory_order_acq_rel);
+				result = true;
+			}
+		}
+
+		return result;
+	}
+
+	size_t 
+	_nes_pool::dropped(void)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		if(!m_initialized) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_UNINITIALIZED);
+		}
+
+		return m_dropped.load(std::memory_order_acquire);
+	}
+
+	void 
+	_nes_pool::enqueue(
+		__in size_t worker,
+		__in nes_pool_session *session
+		)
+	{
+		nes_pool_worker *entry = m_workers.at(worker % m_workers.size());
+
+		{
+			std::lock_guard<std::mutex> lock(entry->lock);
+			entry->queue.push_back(session);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_signal_lock);
+			m_queued.fetch_add(1, std::memory_order_acq_rel);
+		}
+
+		m_signal.notify_one();
+	}
+
+	void 
+	_nes_pool::execute(
+		__in size_t worker,
+		__in nes_pool_session *session
+		)
+	{
+		nes_pool_completion completion;
+
+		completion.frame = 0;
+		completion.handle = session->handle;
+		completion.status = NES_POOL_STATUS_FRAME;
+		completion.worker = worker;
+
+		try {
+			completion.frame = session->session->step_frame();
+			completion.remaining = (session->budget.fetch_sub(1, std::memory_order_acq_rel) - 1);
+		} catch(...) {
+			session->budget.store(0, std::memory_order_release);
+			completion.remaining = 0;
+			completion.status = NES_POOL_STATUS_ERROR;
+		}
+
+		if(!completion.remaining && (completion.status == NES_POOL_STATUS_FRAME)) {
+			completion.status = NES_POOL_STATUS_DONE;
+		}
+
+		if(!m_completion->push(completion)) {
+
+			if(completion.status == NES_POOL_STATUS_FRAME) {
+				m_dropped.fetch_add(1, std::memory_order_acq_rel);
+			} else {
+				std::lock_guard<std::mutex> lock(m_overflow_lock);
+				m_overflow.push_back(completion);
+			}
+		}
+
+		if(!completion.remaining) {
+			session->scheduled.store(false, std::memory_order_release);
+
+			if(!session->budget.load(std::memory_order_acquire)
+					|| session->scheduled.exchange(true, std::memory_order_acq_rel)) {
+
+				{
+					std::lock_guard<std::mutex> lock(m_signal_lock);
+					m_active.fetch_sub(1, std::memory_order_acq_rel);
+				}
+
+				m_idle.notify_all();
+				return;
+			}
+		}
+
+		enqueue(worker, session);
+	}
+
+	void 
+	_nes_pool::initialize(
+		__in_opt size_t workers,
+		__in_opt bool affinity,
+		__in_opt size_t capacity
+		)
+	{
+		size_t iter = 0, length = POOL_QUEUE_CAPACITY_MIN;
+
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		if(m_initialized) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_INITIALIZED);
+		}
+
+		if(!workers) {
+
+			workers = std::thread::hardware_concurrency();
+			if(!workers) {
+				workers = POOL_WORKERS_DEFAULT;
+			}
+		}
+
+		while(length < capacity) {
+			length <<= 1;
+		}
+
+		m_completion = new nes_pool_queue(length);
+		if(!m_completion) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_ALLOCATED);
+		}
+
+		m_active.store(0, std::memory_order_relaxed);
+		m_affinity = affinity;
+		m_dropped.store(0, std::memory_order_relaxed);
+		m_next.store(0, std::memory_order_relaxed);
+		m_queued.store(0, std::memory_order_relaxed);
+		m_stop.store(false, std::memory_order_release);
+		m_initialized = true;
+
+		for(; iter < workers; ++iter) {
+			m_workers.push_back(new nes_pool_worker);
+		}
+
+		for(iter = 0; iter < workers; ++iter) {
+			m_workers.at(iter)->thread = std::thread(&_nes_pool::work, this, iter);
+		}
+	}
+
+	bool 
+	_nes_pool::is_initialized(void)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+		return m_initialized;
+	}
+
+	bool 
+	_nes_pool::poll(
+		__out nes_pool_completion &completion
+		)
+	{
+
+		if(!m_completion) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(m_completion->pop(completion)) {
+			return true;
+		}
+
+		std::lock_guard<std::mutex> lock(m_overflow_lock);
+
+		if(m_overflow.empty()) {
+			return false;
+		}
+
+		completion = m_overflow.front();
+		m_overflow.pop_front();
+
+		return true;
+	}
+
+	void 
+	_nes_pool::run(
+		__in size_t handle,
+		__in uint32_t frames
+		)
+	{
+		nes_pool_session *entry = NULL;
+
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		if(!m_initialized) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(handle >= m_sessions.size()) {
+			THROW_NES_POOL_EXCEPTION_MESSAGE(NES_POOL_EXCEPTION_INVALID_HANDLE,
+				"handle. %lu (max. %lu)", handle, m_sessions.size());
+		}
+
+		if(!frames) {
+			return;
+		}
+
+		entry = m_sessions.at(handle);
+		entry->budget.fetch_add(frames, std::memory_order_acq_rel);
+
+		if(!entry->scheduled.exchange(true, std::memory_order_acq_rel)) {
+
+			{
+				std::lock_guard<std::mutex> lock(m_signal_lock);
+				m_active.fetch_add(1, std::memory_order_acq_rel);
+			}
+
+			enqueue(m_next.fetch_add(1, std::memory_order_relaxed), entry);
+		}
+	}
+
+	size_t 
+	_nes_pool::sessions(void)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+		return m_sessions.size();
+	}
+
+	std::string 
+	_nes_pool::to_string(
+		__in_opt bool verbose
+		)
+	{
+		std::stringstream result;
+
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		result << "<" << NES_POOL_HEADER << "> (" 
+			<< (m_initialized ? INITIALIZED : UNINITIALIZED); 
+
+		if(verbose) {
+			result << ", ptr. 0x" << VALUE_AS_HEX(nes_pool_ptr, this);
+		}
+
+		result << ")";
+
+		if(m_initialized) {
+			result << std::endl << "WRK: " << m_workers.size()
+				<< (m_affinity ? " (affinity)" : "")
+				<< ", SES: " << m_sessions.size()
+				<< ", ACT: " << m_active.load(std::memory_order_acquire)
+				<< ", QUE: " << m_queued.load(std::memory_order_acquire)
+				<< ", CMP: " << m_completion->size() << "/" << m_completion->capacity()
+				<< ", DRP: " << m_dropped.load(std::memory_order_acquire);
+
+			std::lock_guard<std::mutex> lock(m_overflow_lock);
+			result << ", OVF: " << m_overflow.size();
+		}
+
+		return result.str();
+	}
+
+	void 
+	_nes_pool::uninitialize(void)
+	{
+		size_t iter = 0;
+
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+
+		if(!m_initialized) {
+			THROW_NES_POOL_EXCEPTION(NES_POOL_EXCEPTION_UNINITIALIZED);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_signal_lock);
+			m_stop.store(true, std::memory_order_release);
+		}
+
+		m_signal.notify_all();
+		m_idle.notify_all();
+
+		for(; iter < m_workers.size(); ++iter) {
+
+			if(m_workers.at(iter)->thread.joinable()) {
+				m_workers.at(iter)->thread.join();
+			}
+
+			delete m_workers.at(iter);
+		}
+
+		for(iter = 0; iter < m_sessions.size(); ++iter) {
+			delete m_sessions.at(iter);
+		}
+
+		m_overflow.clear();
+		m_sessions.clear();
+		m_workers.clear();
+		delete m_completion;
+		m_completion = NULL;
+		m_initialized = false;
+	}
+
+	void 
+	_nes_pool::wait(void)
+	{
+		std::unique_lock<std::mutex> lock(m_signal_lock);
+
+		m_idle.wait(lock, [this] { 
+			return (m_stop.load(std::memory_order_acquire)
+				|| !m_active.load(std::memory_order_acquire)); 
+			});
+	}
+
+	void 
+	_nes_pool::work(
+		__in size_t index
+		)
+	{
+		nes_pool_session *session = NULL;
+#ifdef __linux__
+		cpu_set_t set;
+		size_t cores = std::thread::hardware_concurrency();
+
+		if(m_affinity && cores) {
+			CPU_ZERO(&set);
+			CPU_SET(index % cores, &set);
+			pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+		}
+#endif // __linux__
+
+		while(!m_stop.load(std::memory_order_acquire)) {
+
+			if(dequeue(index, session)) {
+				execute(index, session);
+			} else {
+				std::unique_lock<std::mutex> lock(m_signal_lock);
+
+				m_signal.wait(lock, [this] { 
+					return (m_stop.load(std::memory_order_acquire)
+						|| m_queued.load(std::memory_order_acquire)); 
+					});
+			}
+		}
+	}
+
+	size_t 
+	_nes_pool::workers(void)
+	{
+		std::lock_guard<std::recursive_mutex> lock(m_lock);
+		return m_workers.size();
+	}
+}
@@ -17,22 +17,260 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cstring>
 #include "../include/nes.h"
+#include "../include/nes_memory_type.h"
 #include "../include/nes_ppu_type.h"
 
 namespace NES {
 
 	namespace COMP {
 
+		_nes_ppu_pipeline::_nes_ppu_pipeline(void) :
+			m_active(false),
+			m_dropped(0),
+			m_failed(false),
+			m_head(0),
+			m_idle(false),
+			m_mask(0),
+			m_tail(0),
+			m_type(NES_PPU_PIPELINE_NONE),
+			m_waiting(0)
+		{
+			return;
+		}
+
+		_nes_ppu_pipeline::~_nes_ppu_pipeline(void)
+		{
+
+			try {
+				stop();
+			} catch(...) { }
+		}
+
+		size_t 
+		_nes_ppu_pipeline::capacity(void)
+		{
+			return m_slot.size();
+		}
+
+		void 
+		_nes_ppu_pipeline::commit(void)
+		{
+			m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+
+			if(m_idle.load(std::memory_order_seq_cst)) {
+				std::lock_guard<std::mutex> lock(m_lock);
+				m_condition.notify_all();
+			}
+		}
+
+		uint64_t 
+		_nes_ppu_pipeline::consumed(void)
+		{
+			return m_tail.load(std::memory_order_acquire);
+		}
+
+		uint64_t 
+		_nes_ppu_pipeline::dropped(void)
+		{
+			return m_dropped.load(std::memory_order_relaxed);
+		}
+
+		void 
+		_nes_ppu_pipeline::flush(void)
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+
+			m_waiting.fetch_add(1, std::memory_order_seq_cst);
+			m_condition.wait(lock, [this] { 
+					return (m_failed.load(std::memory_order_acquire)
+						|| (m_tail.load(std::memory_order_seq_cst) 
+							== m_head.load(std::memory_order_relaxed))); 
+				});
+			m_waiting.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		bool 
+		_nes_ppu_pipeline::is_active(void)
+		{
+			return m_active.load(std::memory_order_acquire);
+		}
+
+		bool 
+		_nes_ppu_pipeline::is_failed(void)
+		{
+			return m_failed.load(std::memory_order_acquire);
+		}
+
+		nes_ppu_frame *
+		_nes_ppu_pipeline::reserve(void)
+		{
+			size_t head;
+			nes_ppu_frame *result = NULL;
+
+			head = m_head.load(std::memory_order_relaxed);
+
+			if((head - m_tail.load(std::memory_order_acquire)) > m_mask) {
+
+				if(m_type == NES_PPU_PIPELINE_DROP) {
+					m_dropped.fetch_add(1, std::memory_order_relaxed);
+					return NULL;
+				}
+
+				std::unique_lock<std::mutex> lock(m_lock);
+
+				m_waiting.fetch_add(1, std::memory_order_seq_cst);
+				m_condition.wait(lock, [this, head] { 
+						return (m_failed.load(std::memory_order_acquire)
+							|| ((head - m_tail.load(std::memory_order_seq_cst)) <= m_mask)); 
+					});
+				m_waiting.fetch_sub(1, std::memory_order_relaxed);
+
+				if(m_failed.load(std::memory_order_acquire)) {
+					m_dropped.fetch_add(1, std::memory_order_relaxed);
+					return NULL;
+				}
+			}
+
+			result = &m_slot[head & m_mask];
+
+			return result;
+		}
+
+		void 
+		_nes_ppu_pipeline::run(void)
+		{
+			size_t tail;
+
+			try {
+
+				for(;;) {
+					tail = m_tail.load(std::memory_order_relaxed);
+
+					if(m_head.load(std::memory_order_acquire) == tail) {
+						std::unique_lock<std::mutex> lock(m_lock);
+
+						m_idle.store(true, std::memory_order_seq_cst);
+						m_condition.wait(lock, [this, tail] { 
+								return (!m_active.load(std::memory_order_acquire)
+									|| (m_head.load(std::memory_order_seq_cst) != tail)); 
+							});
+						m_idle.store(false, std::memory_order_relaxed);
+
+						if(m_head.load(std::memory_order_acquire) == tail) {
+							break;
+						}
+					}
+
+					m_consumer(m_slot[tail & m_mask]);
+					m_tail.store(tail + 1, std::memory_order_seq_cst);
+
+					if(m_waiting.load(std::memory_order_seq_cst)) {
+						std::lock_guard<std::mutex> lock(m_lock);
+						m_condition.notify_all();
+					}
+				}
+			} catch(...) {
+
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					m_failed.store(true, std::memory_order_release);
+				}
+
+				m_condition.notify_all();
+			}
+		}
+
+		size_t 
+		_nes_ppu_pipeline::size(void)
+		{
+			return (m_head.load(std::memory_order_acquire) 
+				- m_tail.load(std::memory_order_acquire));
+		}
+
+		void 
+		_nes_ppu_pipeline::start(
+			__in nes_ppu_pipeline_t type,
+			__in size_t capacity,
+			__in const nes_ppu_output &consumer
+			)
+		{
+			size_t iter = 0, length = PPU_PIPELINE_CAPACITY_MIN;
+
+			if((type == NES_PPU_PIPELINE_NONE) || (type > NES_PPU_PIPELINE_MAX)) {
+				THROW_NES_PPU_EXCEPTION_MESSAGE(NES_PPU_EXCEPTION_INVALID_PIPELINE,
+					"type. %lu", type);
+			}
+
+			stop();
+
+			while(length < capacity) {
+				length <<= 1;
+			}
+
+			m_slot.resize(length);
+
+			for(; iter < length; ++iter) {
+				m_slot.at(iter).pixels.resize(PPU_FRAME_WIDTH * PPU_FRAME_HEIGHT, 0);
+				m_slot.at(iter).ram.resize(PPU_HASH_RAM_LENGTH, 0);
+			}
+
+			m_consumer = consumer;
+			m_dropped.store(0, std::memory_order_relaxed);
+			m_failed.store(false, std::memory_order_relaxed);
+			m_head.store(0, std::memory_order_relaxed);
+			m_idle.store(false, std::memory_order_relaxed);
+			m_mask = (length - 1);
+			m_tail.store(0, std::memory_order_relaxed);
+			m_type = type;
+			m_active.store(true, std::memory_order_release);
+			m_thread = std::thread(&_nes_ppu_pipeline::run, this);
+		}
+
+		void 
+		_nes_ppu_pipeline::stop(void)
+		{
+
+			if(!m_active.load(std::memory_order_acquire)) {
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				m_active.store(false, std::memory_order_release);
+			}
+
+			m_condition.notify_all();
+
+			if(m_thread.joinable()) {
+				m_thread.join();
+			}
+
+			m_consumer = nes_ppu_output();
+			m_type = NES_PPU_PIPELINE_NONE;
+		}
+
 		_nes_ppu *_nes_ppu::m_instance = NULL;
 
-		_nes_ppu::_nes_ppu(void) :
+		_nes_ppu::_nes_ppu(
+			__in nes_memory_ptr memory
+			) :
 			m_cycles(0),
+			m_frame_buffer(PPU_FRAME_WIDTH * PPU_FRAME_HEIGHT, 0),
+			m_hash(NES_PPU_HASH_NONE),
+			m_hash_frame(0),
+			m_hash_index(0),
+			m_hash_ram(0),
 			m_initialized(false),
-			m_memory(nes_memory::acquire()),
-			m_started(false)
+			m_mapper(NULL),
+			m_master(0),
+			m_memory(memory),
+			m_started(false),
+			m_sync(NES_PPU_SYNC_LAZY)
 		{
-			std::atexit(nes_ppu::_delete);
+			std::memset(&m_state, 0, sizeof(nes_ppu_state));
 		}
 
 		_nes_ppu::~_nes_ppu(void)
@@ -59,19 +297,100 @@ namespace NES {
 
 			if(!nes_ppu::m_instance) {
 
-				nes_ppu::m_instance = new nes_ppu;
-				if(!nes_ppu::m_instance) {
-					THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_ALLOCATED);
-				}
+				nes_ppu::m_instance = create(nes_memory::acquire());
+				std::atexit(nes_ppu::_delete);
 			}
 
 			return nes_ppu::m_instance;
 		}
 
+		uint32_t 
+		_nes_ppu::advance(
+			__inout nes_ppu_state &state,
+			__in uint64_t dots
+			)
+		{
+			uint32_t end, next, position, result = 0;
+
+			while(dots) {
+				end = frame_length(state);
+				position = PPU_POSITION(state.scanline, state.dot);
+
+				if(position <= PPU_POSITION_VBLANK_SET) {
+					next = PPU_POSITION_VBLANK_SET;
+				} else if(position <= PPU_POSITION_VBLANK_CLEAR) {
+					next = PPU_POSITION_VBLANK_CLEAR;
+				} else if(position < end) {
+					next = end;
+				} else {
+					next = (position + 1);
+				}
+
+				if((next - position) > dots) {
+					position += dots;
+					dots = 0;
+				} else {
+					dots -= (next - position);
+					position = next;
+
+					if(dots && (position < end)) {
+						state.dot = (position % PPU_DOTS_PER_SCANLINE);
+						state.scanline = (position / PPU_DOTS_PER_SCANLINE);
+						result += advance_dot(state);
+						--dots;
+						continue;
+					}
+				}
+
+				if(position >= end) {
+					++state.frame;
+					state.odd = !state.odd;
+					position = 0;
+					++result;
+				}
+
+				state.dot = (position % PPU_DOTS_PER_SCANLINE);
+				state.scanline = (position / PPU_DOTS_PER_SCANLINE);
+			}
+
+			return result;
+		}
+
+		uint32_t 
+		_nes_ppu::advance_dot(
+			__inout nes_ppu_state &state
+			)
+		{
+			uint32_t position, result = 0;
+
+			position = PPU_POSITION(state.scanline, state.dot);
+
+			if(position == PPU_POSITION_VBLANK_SET) {
+				state.status |= PPU_STATUS_VBLANK;
+
+				if(state.control & PPU_CONTROL_NMI) {
+					state.nmi = true;
+				}
+			} else if(position == PPU_POSITION_VBLANK_CLEAR) {
+				state.status &= ~PPU_STATUS_VBLANK;
+			}
+
+			if(++position >= frame_length(state)) {
+				++state.frame;
+				state.odd = !state.odd;
+				position = 0;
+				++result;
+			}
+
+			state.dot = (position % PPU_DOTS_PER_SCANLINE);
+			state.scanline = (position / PPU_DOTS_PER_SCANLINE);
+
+			return result;
+		}
+
 		void 
 		_nes_ppu::clear(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
@@ -86,7 +405,6 @@ namespace NES {
 			__in nes_memory_t type
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
@@ -105,10 +423,66 @@ namespace NES {
 			}
 		}
 
-		uint32_t 
+		void 
+		_nes_ppu::clock_mapper(
+			__in uint64_t frame,
+			__in uint32_t position
+			)
+		{
+			uint64_t clocks;
+
+			if(m_mapper && (m_state.mask & PPU_MASK_RENDER)) {
+				clocks = (((m_state.frame - frame) * PPU_MAPPER_CLOCKS) 
+					+ scanline_clocks(PPU_POSITION(m_state.scanline, m_state.dot))) 
+					- scanline_clocks(position);
+
+				if(clocks) {
+					m_mapper->scanline(clocks);
+				}
+			}
+		}
+
+		bool 
+		_nes_ppu::compare(
+			__in const nes_ppu_state &state,
+			__in const nes_ppu_state &other
+			)
+		{
+			return ((state.address == other.address)
+				&& (state.address_temp == other.address_temp)
+				&& (state.buffer == other.buffer)
+				&& (state.bus == other.bus)
+				&& (state.control == other.control)
+				&& (state.dot == other.dot)
+				&& (state.fine_x == other.fine_x)
+				&& (state.frame == other.frame)
+				&& (state.latch == other.latch)
+				&& (state.mask == other.mask)
+				&& (state.nmi == other.nmi)
+				&& (state.oam_address == other.oam_address)
+				&& (state.odd == other.odd)
+				&& (state.scanline == other.scanline)
+				&& (state.status == other.status));
+		}
+
+		_nes_ppu *
+		_nes_ppu::create(
+			__in nes_memory_ptr memory
+			)
+		{
+			_nes_ppu *result = NULL;
+
+			result = new nes_ppu(memory);
+			if(!result) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_ALLOCATED);
+			}
+
+			return result;
+		}
+
+		uint64_t 
 		_nes_ppu::cycles(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
@@ -117,17 +491,142 @@ namespace NES {
 			return m_cycles;
 		}
 
+		uint64_t 
+		_nes_ppu::frame(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			return m_state.frame;
+		}
+
+		const std::vector<uint8_t> &
+		_nes_ppu::frame_buffer(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			return m_frame_buffer;
+		}
+
+		uint32_t 
+		_nes_ppu::frame_length(
+			__in const nes_ppu_state &state
+			)
+		{
+			uint32_t result = PPU_POSITION_FRAME;
+
+			if(state.odd && (state.mask & PPU_MASK_RENDER)) {
+				--result;
+			}
+
+			return result;
+		}
+
+		uint64_t 
+		_nes_ppu::hash(
+			__out uint64_t &frame,
+			__out uint64_t &ram
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(m_pipeline.is_active()) {
+				m_pipeline.flush();
+			}
+
+			frame = m_hash_frame;
+			ram = m_hash_ram;
+
+			return m_hash_index;
+		}
+
+		uint32_t 
+		_nes_ppu::hash_flags(void)
+		{
+			return m_hash;
+		}
+
+		void 
+		_nes_ppu::hash_record(
+			__in uint32_t flags,
+			__in const uint8_t *pixels,
+			__in const uint8_t *ram,
+			__in uint64_t frame,
+			__in uint32_t frames
+			)
+		{
+			uint64_t record[PPU_HASH_RECORD_LENGTH];
+
+			if(flags & NES_PPU_HASH_FRAME) {
+				m_hash_frame = nes_hash::generate(pixels, PPU_FRAME_WIDTH * PPU_FRAME_HEIGHT);
+			}
+
+			if(flags & NES_PPU_HASH_RAM) {
+				m_hash_ram = nes_hash::generate(ram, PPU_HASH_RAM_LENGTH);
+			}
+
+			m_hash_index = (frame - 1);
+
+			if(m_hash_stream.is_open()) {
+				record[0] = m_hash_index;
+				record[1] = frames;
+				record[2] = m_hash_frame;
+				record[3] = m_hash_ram;
+				m_hash_stream.write((const char *) record, sizeof(record));
+			}
+		}
+
+		void 
+		_nes_ppu::hash_update(
+			__in uint32_t frames
+			)
+		{
+			nes_ppu_frame *slot = NULL;
+
+			if(!frames) {
+				return;
+			}
+
+			if(m_pipeline.is_active()) {
+
+				slot = m_pipeline.reserve();
+				if(slot) {
+					slot->frame = m_state.frame;
+					slot->frames = frames;
+					slot->hash = m_hash;
+					std::memcpy(&slot->pixels[0], &m_frame_buffer[0], m_frame_buffer.size());
+
+					if(m_hash & NES_PPU_HASH_RAM) {
+						std::memcpy(&slot->ram[0], &m_memory->at(NES_MEM_MMU, 0), 
+							PPU_HASH_RAM_LENGTH);
+					}
+
+					m_pipeline.commit();
+				}
+			} else if(m_hash) {
+				hash_record(m_hash, &m_frame_buffer[0], &m_memory->at(NES_MEM_MMU, 0), 
+					m_state.frame, frames);
+			}
+		}
+
 		void 
 		_nes_ppu::initialize(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_INITIALIZED);
 			}
 
 			m_initialized = true;
-			m_cycles = 0;
+			reset();
 
 			if(m_started) {
 				stop();
@@ -143,14 +642,12 @@ namespace NES {
 		bool 
 		_nes_ppu::is_initialized(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return m_initialized;
 		}
 
 		bool 
 		_nes_ppu::is_started(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return (m_initialized && m_started);
 		}
 
@@ -160,7 +657,11 @@ namespace NES {
 			__in uint16_t address
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
+
+			if(m_mapper && (type == NES_MEM_PPU) && (address < PPU_PALETTE_BASE)) {
+				return m_mapper->read_ppu(address);
+			}
+
 			return m_memory->at(type, address);
 		}
 
@@ -170,26 +671,361 @@ namespace NES {
 			__in uint16_t address
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return (load(type, address) | (load(type, address + 1) << BITS_PER_BYTE));
 		}
 
+		nes_mapper_ptr 
+		_nes_ppu::mapper(void)
+		{
+			return m_mapper;
+		}
+
+		uint64_t 
+		_nes_ppu::master(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			return m_master;
+		}
+
+		uint16_t 
+		_nes_ppu::mirror(
+			__in uint16_t address
+			)
+		{
+			address &= NES_PPU_MAX;
+
+			if(address >= PPU_PALETTE_BASE) {
+				address = (PPU_PALETTE_BASE | (address & PPU_PALETTE_MASK));
+
+				if(!(address & 0x3)) {
+					address &= ~0x10;
+				}
+			} else if(address >= 0x3000) {
+				address -= 0x1000;
+			}
+
+			return address;
+		}
+
+		uint64_t 
+		_nes_ppu::next_event(void)
+		{
+			uint64_t result;
+			uint32_t clocks, position;
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(m_sync == NES_PPU_SYNC_LOCKSTEP) {
+				return m_master;
+			}
+
+			position = PPU_POSITION(m_state.scanline, m_state.dot);
+
+			if((m_state.control & PPU_CONTROL_NMI) 
+					&& (position <= PPU_POSITION_VBLANK_SET)) {
+				result = ((PPU_POSITION_VBLANK_SET - position) + 1);
+			} else {
+				result = (frame_length(m_state) - position);
+			}
+
+			if(m_mapper && (m_state.mask & PPU_MASK_RENDER)) {
+
+				clocks = m_mapper->irq_scanlines();
+				if(clocks) {
+					result = std::min(result, scanline_distance(position, clocks));
+				}
+			}
+
+			return (m_master + (result * PPU_MASTER_DIVIDER));
+		}
+
+		nes_ppu_pipeline &
+		_nes_ppu::pipeline(void)
+		{
+			return m_pipeline;
+		}
+
+		void 
+		_nes_ppu::pipeline_consume(
+			__in const nes_ppu_frame &frame
+			)
+		{
+
+			if(frame.hash) {
+				hash_record(frame.hash, &frame.pixels[0], &frame.ram[0], frame.frame, 
+					frame.frames);
+			}
+
+			if(m_output) {
+				m_output(frame);
+			}
+		}
+
+		bool 
+		_nes_ppu::poll_nmi(void)
+		{
+			bool result;
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			result = m_state.nmi;
+			m_state.nmi = false;
+
+			return result;
+		}
+
+		uint8_t 
+		_nes_ppu::read(
+			__in uint16_t address
+			)
+		{
+			uint8_t result;
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			switch(address & PPU_REGISTER_SELECT) {
+				case PPU_REGISTER_STATUS:
+					result = ((m_state.status & 0xe0) | (m_state.bus & 0x1f));
+					m_state.status &= ~PPU_STATUS_VBLANK;
+					m_state.latch = false;
+					break;
+				case PPU_REGISTER_OAM_DATA:
+					result = load(NES_MEM_PPU_OAM, m_state.oam_address);
+					break;
+				case PPU_REGISTER_DATA:
+					address = mirror(m_state.address);
+
+					if(address >= PPU_PALETTE_BASE) {
+						result = load(NES_MEM_PPU, address);
+						m_state.buffer = load(NES_MEM_PPU, mirror(address - 0x1000));
+					} else {
+						result = m_state.buffer;
+						m_state.buffer = load(NES_MEM_PPU, address);
+					}
+
+					m_state.address += ((m_state.control & PPU_CONTROL_INCREMENT) 
+						? PPU_INCREMENT_DOWN : PPU_INCREMENT_ACROSS);
+					break;
+				default:
+					result = m_state.bus;
+					break;
+			}
+
+			m_state.bus = result;
+
+			return result;
+		}
+
+		void 
+		_nes_ppu::rebase(
+			__in uint64_t master
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_master = (master - (master % PPU_MASTER_DIVIDER));
+		}
+
 		void 
 		_nes_ppu::reset(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
 			}
 
+			if(m_pipeline.is_active()) {
+				m_pipeline.flush();
+			}
+
 			m_cycles = 0;
+			m_hash_frame = 0;
+			m_hash_index = 0;
+			m_hash_ram = 0;
+			m_master = 0;
+			std::fill(m_frame_buffer.begin(), m_frame_buffer.end(), 0);
+			std::memset(&m_state, 0, sizeof(nes_ppu_state));
+		}
+
+		uint32_t 
+		_nes_ppu::scanline_clocks(
+			__in uint32_t position
+			)
+		{
+			uint32_t scanline = (position / PPU_DOTS_PER_SCANLINE);
+
+			if(scanline < PPU_FRAME_HEIGHT) {
+				return (scanline + (((position % PPU_DOTS_PER_SCANLINE) > PPU_DOT_MAPPER) ? 1 : 0));
+			}
+
+			return (PPU_FRAME_HEIGHT + ((position > PPU_POSITION_MAPPER_PRERENDER) ? 1 : 0));
+		}
+
+		uint64_t 
+		_nes_ppu::scanline_distance(
+			__in uint32_t position,
+			__in uint32_t clocks
+			)
+		{
+			uint64_t result = 0;
+			uint32_t index, remaining;
+
+			index = scanline_clocks(position);
+			remaining = (PPU_MAPPER_CLOCKS - index);
+
+			if(clocks > remaining) {
+				result = (frame_length(m_state) - position);
+				clocks -= remaining;
+				index = 0;
+				position = 0;
+
+				while(clocks > PPU_MAPPER_CLOCKS) {
+					result += (PPU_POSITION_FRAME - 1);
+					clocks -= PPU_MAPPER_CLOCKS;
+				}
+			}
+
+			index += (clocks - 1);
+			result += (((index < PPU_FRAME_HEIGHT) ? PPU_POSITION(index, PPU_DOT_MAPPER) 
+				: PPU_POSITION_MAPPER_PRERENDER) + 1 - position);
+
+			return result;
+		}
+
+		void 
+		_nes_ppu::restore(
+			__in const nes_ppu_snapshot &snapshot,
+			__in_opt const uint8_t *frame
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_cycles = snapshot.cycles;
+			m_master = snapshot.master;
+			std::memcpy(&m_state, &snapshot.state, sizeof(nes_ppu_state));
+
+			if(frame) {
+				std::memcpy(&m_frame_buffer[0], frame, m_frame_buffer.size());
+			}
+		}
+
+		void 
+		_nes_ppu::set_hash(
+			__in uint32_t flags,
+			__in_opt const std::string &path
+			)
+		{
+
+			if(flags & ~NES_PPU_HASH_MASK) {
+				THROW_NES_PPU_EXCEPTION_MESSAGE(NES_PPU_EXCEPTION_INVALID_HASH,
+					"flags. 0x%x", flags);
+			}
+
+			if(m_pipeline.is_active()) {
+				m_pipeline.flush();
+			}
+
+			if(m_hash_stream.is_open()) {
+				m_hash_stream.close();
+			}
+
+			if(flags && !path.empty()) {
+
+				m_hash_stream.open(path.c_str(), std::ios::out | std::ios::binary 
+					| std::ios::trunc);
+				if(!m_hash_stream.is_open()) {
+					THROW_NES_PPU_EXCEPTION_MESSAGE(NES_PPU_EXCEPTION_HASH_STREAM,
+						"%s", CHECK_STR(path));
+				}
+			}
+
+			m_hash = flags;
+		}
+
+		void 
+		_nes_ppu::set_mapper(
+			__in nes_mapper_ptr mapper
+			)
+		{
+			m_mapper = mapper;
+		}
+
+		void 
+		_nes_ppu::set_pipeline(
+			__in nes_ppu_pipeline_t type,
+			__in_opt size_t capacity,
+			__in_opt const nes_ppu_output &output
+			)
+		{
+
+			if(type > NES_PPU_PIPELINE_MAX) {
+				THROW_NES_PPU_EXCEPTION_MESSAGE(NES_PPU_EXCEPTION_INVALID_PIPELINE,
+					"type. %lu", type);
+			}
+
+			m_pipeline.stop();
+			m_output = output;
+
+			if(type != NES_PPU_PIPELINE_NONE) {
+				m_pipeline.start(type, capacity, std::bind(&_nes_ppu::pipeline_consume, 
+					this, std::placeholders::_1));
+			}
+		}
+
+		void 
+		_nes_ppu::set_sync(
+			__in nes_ppu_sync_t sync
+			)
+		{
+
+			if(sync > NES_PPU_SYNC_MAX) {
+				THROW_NES_PPU_EXCEPTION_MESSAGE(NES_PPU_EXCEPTION_INVALID_SYNC,
+					"sync. %lu", sync);
+			}
+
+			m_sync = sync;
+		}
+
+		void 
+		_nes_ppu::snapshot(
+			__out nes_ppu_snapshot &snapshot,
+			__out_opt uint8_t *frame
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			std::memset(&snapshot, 0, sizeof(nes_ppu_snapshot));
+			snapshot.cycles = m_cycles;
+			snapshot.master = m_master;
+			std::memcpy(&snapshot.state, &m_state, sizeof(nes_ppu_state));
+
+			if(frame) {
+				std::memcpy(frame, &m_frame_buffer[0], m_frame_buffer.size());
+			}
 		}
 
 		void 
 		_nes_ppu::start(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
@@ -205,7 +1041,8 @@ namespace NES {
 		void 
 		_nes_ppu::step(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
+			uint64_t frame;
+			uint32_t frames, position;
 
 			if(!m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
@@ -215,15 +1052,18 @@ namespace NES {
 				THROW_NES_PPU_EXCEPTION(NES_PUU_EXCEPTION_STOPPED);
 			}
 
-			// TODO
-
+			frame = m_state.frame;
+			position = PPU_POSITION(m_state.scanline, m_state.dot);
+			frames = advance_dot(m_state);
+			clock_mapper(frame, position);
+			m_master += PPU_MASTER_DIVIDER;
 			++m_cycles;
+			hash_update(frames);
 		}
 
 		void 
 		_nes_ppu::stop(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
@@ -243,8 +1083,12 @@ namespace NES {
 			__in uint8_t value
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
-			m_memory->at(type, address) = value;
+
+			if(m_mapper && (type == NES_MEM_PPU) && (address < PPU_PALETTE_BASE)) {
+				m_mapper->write_ppu(address, value);
+			} else {
+				m_memory->at(type, address) = value;
+			}
 		}
 
 		void 
@@ -254,11 +1098,83 @@ namespace NES {
 			__in uint16_t value
 			)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			store(type, address, value & UINT8_MAX);
 			store(type, address + 1, (value >> BITS_PER_BYTE) & UINT8_MAX);
 		}
 
+		nes_ppu_sync_t 
+		_nes_ppu::sync(void)
+		{
+			return m_sync;
+		}
+
+		void 
+		_nes_ppu::synchronize(
+			__in uint64_t master
+			)
+		{
+			nes_ppu_state shadow;
+			uint64_t dots, frame, iter;
+			uint32_t frames = 0, position;
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_started) {
+				THROW_NES_PPU_EXCEPTION(NES_PUU_EXCEPTION_STOPPED);
+			}
+
+			if(master < m_master) {
+				THROW_NES_PPU_EXCEPTION_MESSAGE(NES_PPU_EXCEPTION_REGRESSED,
+					"master. %llu (expecting >= %llu)", (unsigned long long) master, 
+					(unsigned long long) m_master);
+			}
+
+			dots = ((master - m_master) / PPU_MASTER_DIVIDER);
+			if(!dots) {
+				return;
+			}
+
+			frame = m_state.frame;
+			position = PPU_POSITION(m_state.scanline, m_state.dot);
+
+			switch(m_sync) {
+				case NES_PPU_SYNC_LAZY:
+					frames = advance(m_state, dots);
+					break;
+				case NES_PPU_SYNC_LOCKSTEP:
+
+					for(iter = 0; iter < dots; ++iter) {
+						frames += advance_dot(m_state);
+					}
+					break;
+				case NES_PPU_SYNC_VALIDATE:
+					shadow = m_state;
+
+					for(iter = 0; iter < dots; ++iter) {
+						advance_dot(shadow);
+					}
+
+					frames = advance(m_state, dots);
+
+					if(!compare(m_state, shadow)) {
+						THROW_NES_PPU_EXCEPTION_MESSAGE(NES_PPU_EXCEPTION_DIVERGED,
+							"master. %llu, dots. %llu", (unsigned long long) master, 
+							(unsigned long long) dots);
+					}
+					break;
+				default:
+					THROW_NES_PPU_EXCEPTION_MESSAGE(NES_PPU_EXCEPTION_INVALID_SYNC,
+						"sync. %lu", m_sync);
+			}
+
+			clock_mapper(frame, position);
+			m_cycles += dots;
+			m_master += (dots * PPU_MASTER_DIVIDER);
+			hash_update(frames);
+		}
+
 		std::string 
 		_nes_ppu::to_string(
 			__in_opt bool verbose
@@ -266,8 +1182,6 @@ namespace NES {
 		{
 			std::stringstream result;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			result << "<" << NES_PPU_HEADER << "> ("
 				<< (m_initialized ? INITIALIZED : UNINITIALIZED);
 
@@ -278,7 +1192,10 @@ namespace NES {
 			result << ")";
 
 			if(m_initialized) {
-				result << ", CYC: " << m_cycles;
+				result << ", CYC: " << m_cycles
+					<< ", FRM: " << m_state.frame
+					<< ", SL: " << m_state.scanline
+					<< ", DOT: " << m_state.dot;
 			}
 
 			return result.str();
@@ -287,7 +1204,6 @@ namespace NES {
 		void 
 		_nes_ppu::uninitialize(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
@@ -297,8 +1213,87 @@ namespace NES {
 				stop();
 			}
 
+			m_pipeline.stop();
+			m_output = nes_ppu_output();
+
+			if(m_hash_stream.is_open()) {
+				m_hash_stream.close();
+			}
+
 			m_cycles = 0;
+			m_hash = NES_PPU_HASH_NONE;
+			m_mapper = NULL;
+			m_master = 0;
 			m_initialized = false;
 		}
+
+		void 
+		_nes_ppu::write(
+			__in uint16_t address,
+			__in uint8_t value
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_state.bus = value;
+
+			switch(address & PPU_REGISTER_SELECT) {
+				case PPU_REGISTER_CONTROL:
+
+					if(!(m_state.control & PPU_CONTROL_NMI) && (value & PPU_CONTROL_NMI)
+							&& (m_state.status & PPU_STATUS_VBLANK)) {
+						m_state.nmi = true;
+					}
+
+					m_state.control = value;
+					m_state.address_temp = ((m_state.address_temp & 0xf3ff) 
+						| ((value & 0x3) << 10));
+					break;
+				case PPU_REGISTER_MASK:
+					m_state.mask = value;
+					break;
+				case PPU_REGISTER_OAM_ADDRESS:
+					m_state.oam_address = value;
+					break;
+				case PPU_REGISTER_OAM_DATA:
+					store(NES_MEM_PPU_OAM, m_state.oam_address++, value);
+					break;
+				case PPU_REGISTER_SCROLL:
+
+					if(!m_state.latch) {
+						m_state.address_temp = ((m_state.address_temp & 0xffe0) 
+							| (value >> 3));
+						m_state.fine_x = (value & 0x7);
+					} else {
+						m_state.address_temp = ((m_state.address_temp & 0x8c1f) 
+							| ((value & 0xf8) << 2) | ((value & 0x7) << 12));
+					}
+
+					m_state.latch = !m_state.latch;
+					break;
+				case PPU_REGISTER_ADDRESS:
+
+					if(!m_state.latch) {
+						m_state.address_temp = ((m_state.address_temp & 0xff) 
+							| ((value & 0x3f) << BITS_PER_BYTE));
+					} else {
+						m_state.address_temp = ((m_state.address_temp & 0xff00) | value);
+						m_state.address = m_state.address_temp;
+					}
+
+					m_state.latch = !m_state.latch;
+					break;
+				case PPU_REGISTER_DATA:
+					store(NES_MEM_PPU, mirror(m_state.address), value);
+					m_state.address += ((m_state.control & PPU_CONTROL_INCREMENT) 
+						? PPU_INCREMENT_DOWN : PPU_INCREMENT_ACROSS);
+					break;
+				default:
+					break;
+			}
+		}
 	}
 }
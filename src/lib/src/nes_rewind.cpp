@@ -0,0 +1,390 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstring>
+#include "../include/nes.h"
+#include "../include/nes_rewind_type.h"
+
+namespace NES {
+
+	_nes_rewind::_nes_rewind(void) :
+		m_frame(0),
+		m_head(0),
+		m_initialized(false),
+		m_interval(NES_REWIND_INTERVAL_DEFAULT),
+		m_size(0)
+	{
+		return;
+	}
+
+	_nes_rewind::~_nes_rewind(void)
+	{
+
+		if(m_initialized) {
+			uninitialize();
+		}
+	}
+
+	size_t 
+	_nes_rewind::capacity(void)
+	{
+		return m_buffer.size();
+	}
+
+	void 
+	_nes_rewind::clear(void)
+	{
+		m_entry.clear();
+		m_frame = 0;
+		m_head = 0;
+		m_size = 0;
+		m_snapshot.clear();
+	}
+
+	size_t 
+	_nes_rewind::count(void)
+	{
+		return m_entry.size();
+	}
+
+	void 
+	_nes_rewind::decode(
+		__in const uint8_t *delta,
+		__in size_t length,
+		__inout uint8_t *state,
+		__in size_t state_length
+		)
+	{
+		uint8_t token;
+		uint32_t shift;
+		size_t iter = 0, offset = 0, run;
+
+		while(iter < length) {
+			token = delta[iter++];
+
+			if(token < REWIND_TOKEN_RUN) {
+				run = (token + 1);
+
+				if(((iter + run) > length) || ((offset + run) > state_length)) {
+					THROW_NES_REWIND_EXCEPTION_MESSAGE(NES_REWIND_EXCEPTION_INVALID_DELTA,
+						"literal. %u, offset. %u", run, offset);
+				}
+
+				for(; run; --run) {
+					state[offset++] ^= delta[iter++];
+				}
+			} else if(token < REWIND_TOKEN_RUN_LONG) {
+				offset += (token - (REWIND_TOKEN_RUN - 1));
+			} else {
+				run = 0;
+				shift = 0;
+
+				do {
+
+					if((iter >= length) || (shift >= (sizeof(size_t) * BITS_PER_BYTE))) {
+						THROW_NES_REWIND_EXCEPTION_MESSAGE(NES_REWIND_EXCEPTION_INVALID_DELTA,
+							"run. %u, offset. %u", iter, offset);
+					}
+
+					token = delta[iter++];
+					run |= ((size_t) (token & REWIND_LEB_MASK) << shift);
+					shift += REWIND_LEB_SHIFT;
+				} while(token & REWIND_LEB_MORE);
+
+				offset += run;
+			}
+
+			if(offset > state_length) {
+				THROW_NES_REWIND_EXCEPTION_MESSAGE(NES_REWIND_EXCEPTION_INVALID_DELTA,
+					"offset. %u (expecting <= %u)", offset, state_length);
+			}
+		}
+
+		if(offset != state_length) {
+			THROW_NES_REWIND_EXCEPTION_MESSAGE(NES_REWIND_EXCEPTION_INVALID_DELTA,
+				"offset. %u (expecting %u)", offset, state_length);
+		}
+	}
+
+	size_t 
+	_nes_rewind::encode(
+		__in const uint8_t *previous,
+		__in const uint8_t *current,
+		__in size_t length,
+		__out uint8_t *delta
+		)
+	{
+		uint64_t left, right;
+		size_t iter = 0, result = 0, run, start;
+
+		while(iter < length) {
+			run = iter;
+
+			while((run + sizeof(uint64_t)) <= length) {
+				std::memcpy(&left, previous + run, sizeof(uint64_t));
+				std::memcpy(&right, current + run, sizeof(uint64_t));
+
+				if(left != right) {
+					break;
+				}
+
+				run += sizeof(uint64_t);
+			}
+
+			while((run < length) && (previous[run] == current[run])) {
+				++run;
+			}
+
+			if(run > iter) {
+				start = (run - iter);
+				iter = run;
+
+				if(start <= REWIND_TOKEN_RUN_MAX) {
+					delta[result++] = (start + (REWIND_TOKEN_RUN - 1));
+				} else {
+					delta[result++] = REWIND_TOKEN_RUN_LONG;
+
+					for(; start > REWIND_LEB_MASK; start >>= REWIND_LEB_SHIFT) {
+						delta[result++] = ((start & REWIND_LEB_MASK) | REWIND_LEB_MORE);
+					}
+
+					delta[result++] = start;
+				}
+
+				continue;
+			}
+
+			start = iter++;
+
+			while((iter < length) && ((iter - start) < REWIND_LITERAL_MAX)
+					&& ((previous[iter] != current[iter]) || (((iter + 1) < length)
+					&& (previous[iter + 1] != current[iter + 1])))) {
+				++iter;
+			}
+
+			delta[result++] = ((iter - start) - 1);
+
+			for(; start < iter; ++start) {
+				delta[result++] = (previous[start] ^ current[start]);
+			}
+		}
+
+		return result;
+	}
+
+	size_t 
+	_nes_rewind::encode_bound(
+		__in size_t length
+		)
+	{
+		return (length + (length / REWIND_LITERAL_MAX) + (sizeof(size_t) * 2));
+	}
+
+	bool 
+	_nes_rewind::empty(void)
+	{
+		return m_snapshot.empty();
+	}
+
+	uint64_t 
+	_nes_rewind::frame(void)
+	{
+		return m_frame;
+	}
+
+	void 
+	_nes_rewind::initialize(
+		__in_opt size_t capacity,
+		__in_opt uint32_t interval
+		)
+	{
+
+		if(m_initialized) {
+			THROW_NES_REWIND_EXCEPTION(NES_REWIND_EXCEPTION_INITIALIZED);
+		}
+
+		if(!capacity) {
+			THROW_NES_REWIND_EXCEPTION_MESSAGE(NES_REWIND_EXCEPTION_INVALID_CAPACITY,
+				"capacity. %u", capacity);
+		}
+
+		if(!interval) {
+			THROW_NES_REWIND_EXCEPTION_MESSAGE(NES_REWIND_EXCEPTION_INVALID_INTERVAL,
+				"interval. %u", interval);
+		}
+
+		clear();
+		m_buffer.resize(capacity);
+		m_interval = interval;
+		m_initialized = true;
+	}
+
+	uint32_t 
+	_nes_rewind::interval(void)
+	{
+		return m_interval;
+	}
+
+	bool 
+	_nes_rewind::is_initialized(void)
+	{
+		return m_initialized;
+	}
+
+	bool 
+	_nes_rewind::pop(void)
+	{
+		nes_rewind_entry entry;
+
+		if(!m_initialized) {
+			THROW_NES_REWIND_EXCEPTION(NES_REWIND_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(m_entry.empty()) {
+			return false;
+		}
+
+		entry = m_entry.back();
+		decode(&m_buffer[entry.offset], entry.length, &m_snapshot[0], m_snapshot.size());
+		m_entry.pop_back();
+		m_frame = entry.frame;
+		m_head = entry.offset;
+		m_size -= entry.length;
+
+		return true;
+	}
+
+	void 
+	_nes_rewind::push(
+		__in uint64_t frame,
+		__inout std::vector<uint8_t> &snapshot
+		)
+	{
+		nes_rewind_entry entry;
+
+		if(!m_initialized) {
+			THROW_NES_REWIND_EXCEPTION(NES_REWIND_EXCEPTION_UNINITIALIZED);
+		}
+
+		if(m_snapshot.empty() || (m_snapshot.size() != snapshot.size()) || (frame <= m_frame)) {
+			clear();
+		} else {
+
+			if(m_scratch.size() < encode_bound(snapshot.size())) {
+				m_scratch.resize(encode_bound(snapshot.size()));
+			}
+
+			entry.frame = m_frame;
+			entry.length = encode(&m_snapshot[0], &snapshot[0], snapshot.size(), &m_scratch[0]);
+
+			if(entry.length > m_buffer.size()) {
+				clear();
+			} else {
+				entry.offset = reserve(entry.length);
+				std::memcpy(&m_buffer[entry.offset], &m_scratch[0], entry.length);
+				m_entry.push_back(entry);
+				m_head = (entry.offset + entry.length);
+				m_size += entry.length;
+			}
+		}
+
+		m_snapshot.swap(snapshot);
+		m_frame = frame;
+	}
+
+	size_t 
+	_nes_rewind::reserve(
+		__in size_t length
+		)
+	{
+		size_t result = m_head;
+
+		if((result + length) > m_buffer.size()) {
+
+			while(!m_entry.empty() && (m_entry.front().offset >= m_head)) {
+				m_size -= m_entry.front().length;
+				m_entry.pop_front();
+			}
+
+			result = 0;
+		}
+
+		while(!m_entry.empty() && (m_entry.front().offset < (result + length))
+				&& (result < (m_entry.front().offset + m_entry.front().length))) {
+			m_size -= m_entry.front().length;
+			m_entry.pop_front();
+		}
+
+		return result;
+	}
+
+	size_t 
+	_nes_rewind::size(void)
+	{
+		return m_size;
+	}
+
+	const std::vector<uint8_t> &
+	_nes_rewind::snapshot(void)
+	{
+		return m_snapshot;
+	}
+
+	std::string 
+	_nes_rewind::to_string(
+		__in_opt bool verbose
+		)
+	{
+		std::stringstream result;
+
+		result << "<" << NES_REWIND_HEADER << "> (" 
+			<< (m_initialized ? INITIALIZED : UNINITIALIZED); 
+
+		if(verbose) {
+			result << ", ptr. 0x" << VALUE_AS_HEX(nes_rewind_ptr, this);
+		}
+
+		result << ")";
+
+		if(m_initialized) {
+			result << std::endl << "INT: " << m_interval
+				<< ", ENT: " << m_entry.size()
+				<< ", LEN: " << m_size << "/" << m_buffer.size()
+				<< ", FRM: " << m_frame;
+		}
+
+		return result.str();
+	}
+
+	void 
+	_nes_rewind::uninitialize(void)
+	{
+
+		if(!m_initialized) {
+			THROW_NES_REWIND_EXCEPTION(NES_REWIND_EXCEPTION_UNINITIALIZED);
+		}
+
+		clear();
+		std::vector<uint8_t>().swap(m_buffer);
+		std::vector<uint8_t>().swap(m_scratch);
+		std::vector<uint8_t>().swap(m_snapshot);
+		m_initialized = false;
+	}
+}
@@ -17,9 +17,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cctype>
 #include <cstring>
-#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "../include/nes.h"
 #include "../include/nes_rom_type.h"
 
@@ -62,13 +66,115 @@ namespace NES {
 			((_TYPE_) > FLAG_12_2_TV_MODE_MAX ? TV_MODE_DUAL : \
 			CHECK_STR(FLAG_12_2_TV_MODE_STR[_TYPE_]))
 
+		_nes_rom_image::_nes_rom_image(void) :
+			m_data(NULL),
+			m_mapping(MAP_FAILED),
+			m_size(0)
+		{
+			return;
+		}
+
+		_nes_rom_image::_nes_rom_image(
+			__in const nes_memory_block &block
+			) :
+				m_block(block),
+				m_data(m_block.empty() ? NULL : &m_block[0]),
+				m_mapping(MAP_FAILED),
+				m_size(m_block.size())
+		{
+			return;
+		}
+
+		_nes_rom_image::_nes_rom_image(
+			__inout nes_memory_block &&block
+			) :
+				m_block(std::move(block)),
+				m_data(m_block.empty() ? NULL : &m_block[0]),
+				m_mapping(MAP_FAILED),
+				m_size(m_block.size())
+		{
+			return;
+		}
+
+		_nes_rom_image::~_nes_rom_image(void)
+		{
+
+			if(m_mapping != MAP_FAILED) {
+				munmap(m_mapping, m_size);
+				m_mapping = MAP_FAILED;
+			}
+		}
+
+		const uint8_t *
+		_nes_rom_image::data(void) const
+		{
+			return m_data;
+		}
+
+		bool 
+		_nes_rom_image::is_mapped(void) const
+		{
+			return (m_mapping != MAP_FAILED);
+		}
+
+		nes_rom_image_ref 
+		_nes_rom_image::map(
+			__in const std::string &input
+			)
+		{
+			int file;
+			struct stat status;
+			void *mapping = MAP_FAILED;
+			nes_rom_image_ptr result = NULL;
+
+			file = open(input.c_str(), O_RDONLY);
+			if(file < 0) {
+				THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_FILE_NOT_FOUND,
+					"%s", CHECK_STR(input));
+			}
+
+			if(fstat(file, &status) 
+					|| (status.st_size < (off_t) sizeof(nes_rom_header)) 
+					|| (status.st_size > ROM_SIZE_MAX)) {
+				close(file);
+				THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_MALFORMED,
+					"%s", CHECK_STR(input));
+			}
+
+			mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			close(file);
+
+			if(mapping == MAP_FAILED) {
+				THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_MAPPING,
+					"%s", CHECK_STR(input));
+			}
+
+			result = new nes_rom_image;
+			if(!result) {
+				munmap(mapping, status.st_size);
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_ALLOCATED);
+			}
+
+			result->m_data = (const uint8_t *) mapping;
+			result->m_mapping = mapping;
+			result->m_size = status.st_size;
+
+			return nes_rom_image_ref(result);
+		}
+
+		size_t 
+		_nes_rom_image::size(void) const
+		{
+			return m_size;
+		}
+
 		_nes_rom *_nes_rom::m_instance = NULL;
 
 		_nes_rom::_nes_rom(void) :
 			m_initialized(false),
 			m_loaded(false)
 		{
-			std::atexit(nes_rom::_delete);
+			std::memset(&m_hash, 0, sizeof(nes_rom_hash));
 		}
 
 		_nes_rom::~_nes_rom(void)
@@ -95,25 +201,42 @@ namespace NES {
 
 			if(!nes_rom::m_instance) {
 
-				nes_rom::m_instance = new nes_rom;
-				if(!nes_rom::m_instance) {
-					THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_ALLOCATED);
-				}
+				nes_rom::m_instance = create();
+				std::atexit(nes_rom::_delete);
 			}
 
 			return nes_rom::m_instance;
 		}
 
+		void 
+		_nes_rom::attach(
+			__in const nes_rom_image_ref &image
+			)
+		{
+			m_image = image;
+			m_loaded = true;
+			std::memcpy((uint8_t *) &m_header, m_image->data(), sizeof(nes_rom_header));
+
+			if(!validate(m_header)) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
+			}
+
+			descriptor_parse(m_header, m_descriptor);
+			scan(m_image->data(), m_image->size(), m_descriptor, m_hash);
+			database_apply(m_descriptor, m_hash);
+			m_ram_character.assign(m_descriptor.character_ram_length 
+				+ m_descriptor.character_nvram_length, 0);
+			m_ram_program.assign(m_descriptor.program_ram_length 
+				+ m_descriptor.program_nvram_length, 0);
+		}
+
 		size_t 
 		_nes_rom::block_character(
 			__out nes_memory_block &block,
 			__in size_t index
 			)
 		{
-			nes_rom_header head;
-			size_t blocks, offset = sizeof(nes_rom_header);
-
-			ATOMIC_CALL_RECUR(m_lock);
+			size_t blocks, offset;
 
 			if(!m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
@@ -123,29 +246,19 @@ namespace NES {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
 			}
 
-			header(head);
-			blocks = head.rom_character;
-
+			blocks = (m_descriptor.character_length / ROM_CHARACTER_LEN);
 			if(index >= blocks) {
 				THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_INVALID_INDEX,
 					"idx. %lu (max. %lu)", index, blocks - 1);
 			}
 
-			if(head.flag_6.trainer) {
-				offset += ROM_TRAINER_LEN;
-			}
-
-			offset += ((head.rom_program * ROM_PROGRAM_LEN) 
-				+ (index * ROM_CHARACTER_LEN));
-
-			if(offset >= m_block.size() 
-					|| ((offset + ROM_CHARACTER_LEN) > m_block.size())) {
+			offset = (m_descriptor.character_offset + (index * ROM_CHARACTER_LEN));
+			if((offset + ROM_CHARACTER_LEN) > m_image->size()) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
 			}
 
-			block.clear();
-			block.insert(block.begin(), m_block.begin() + offset, 
-				m_block.begin() + offset + ROM_CHARACTER_LEN);
+			block.assign(m_image->data() + offset, 
+				m_image->data() + offset + ROM_CHARACTER_LEN);
 
 			return block.size();
 		}
@@ -156,10 +269,7 @@ namespace NES {
 			__in size_t index
 			)
 		{
-			nes_rom_header head;
-			size_t blocks, offset = sizeof(nes_rom_header);
-
-			ATOMIC_CALL_RECUR(m_lock);
+			size_t blocks, offset;
 
 			if(!m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
@@ -169,30 +279,365 @@ namespace NES {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
 			}
 
-			header(head);
-			blocks = head.rom_program;
-
+			blocks = (m_descriptor.program_length / ROM_PROGRAM_LEN);
 			if(index >= blocks) {
 				THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_INVALID_INDEX,
 					"idx. %lu (max. %lu)", index, blocks - 1);
 			}
 
-			if(head.flag_6.trainer) {
-				offset += ROM_TRAINER_LEN;
+			offset = (m_descriptor.program_offset + (index * ROM_PROGRAM_LEN));
+			if((offset + ROM_PROGRAM_LEN) > m_image->size()) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
 			}
 
-			offset += (index * ROM_PROGRAM_LEN);
+			block.assign(m_image->data() + offset, 
+				m_image->data() + offset + ROM_PROGRAM_LEN);
+
+			return block.size();
+		}
+
+		_nes_rom *
+		_nes_rom::create(void)
+		{
+			_nes_rom *result = NULL;
+
+			result = new nes_rom;
+			if(!result) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_ALLOCATED);
+			}
 
-			if(offset >= m_block.size() 
-					|| ((offset + ROM_PROGRAM_LEN) > m_block.size())) {
+			return result;
+		}
+
+		const uint8_t *
+		_nes_rom::data_character(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_loaded) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
+			}
+
+			if((m_descriptor.character_offset + m_descriptor.character_length) 
+					> m_image->size()) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
 			}
 
-			block.clear();
-			block.insert(block.begin(), m_block.begin() + offset, 
-				m_block.begin() + offset + ROM_PROGRAM_LEN);
+			return (m_descriptor.character_length ? (m_image->data() 
+				+ m_descriptor.character_offset) : NULL);
+		}
 
-			return block.size();
+		const uint8_t *
+		_nes_rom::data_program(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_loaded) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
+			}
+
+			if((m_descriptor.program_offset + m_descriptor.program_length) 
+					> m_image->size()) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
+			}
+
+			return (m_descriptor.program_length ? (m_image->data() 
+				+ m_descriptor.program_offset) : NULL);
+		}
+
+		bool 
+		_nes_rom::database_apply(
+			__inout nes_rom_descriptor &descriptor,
+			__in const nes_rom_hash &hash
+			)
+		{
+			nes_rom_database::iterator iter;
+
+			for(iter = m_database.lower_bound(hash.crc32); 
+					(iter != m_database.end()) && (iter->first == hash.crc32); ++iter) {
+				const nes_rom_database_entry &entry = iter->second;
+
+				if((entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_SHA1))
+						&& std::memcmp(entry.hash.sha1, hash.sha1, HASH_SHA1_LEN)) {
+					continue;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_BATTERY)) {
+					descriptor.battery = entry.descriptor.battery;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_CHARACTER_NVRAM)) {
+					descriptor.character_nvram_length = entry.descriptor.character_nvram_length;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_CHARACTER_RAM)) {
+					descriptor.character_ram_length = entry.descriptor.character_ram_length;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_MAPPER)) {
+					descriptor.mapper = entry.descriptor.mapper;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_MAPPER_SUB)) {
+					descriptor.mapper_sub = entry.descriptor.mapper_sub;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_MIRRORING)) {
+					descriptor.mirroring = entry.descriptor.mirroring;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_PROGRAM_NVRAM)) {
+					descriptor.program_nvram_length = entry.descriptor.program_nvram_length;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_PROGRAM_RAM)) {
+					descriptor.program_ram_length = entry.descriptor.program_ram_length;
+				}
+
+				if(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_TIMING)) {
+					descriptor.timing = entry.descriptor.timing;
+				}
+
+				descriptor.corrected = true;
+
+				return true;
+			}
+
+			return false;
+		}
+
+		bool 
+		_nes_rom::database_parse(
+			__inout nes_rom_database_entry &entry,
+			__in const std::string &token
+			)
+		{
+			uint32_t key = 0, value;
+			std::string name, field;
+			size_t iter = 0, separator;
+
+			separator = token.find(ROM_DATABASE_SEPARATOR);
+			if(separator == std::string::npos) {
+				return false;
+			}
+
+			name = token.substr(0, separator);
+			field = token.substr(separator + 1);
+
+			for(; key <= ROM_DATABASE_KEY_MAX; ++key) {
+
+				if(name == ROM_DATABASE_KEY_STR[key]) {
+					break;
+				}
+			}
+
+			if(field.empty() || (key > ROM_DATABASE_KEY_MAX)) {
+				return false;
+			}
+
+			try {
+
+				switch(key) {
+					case ROM_DATABASE_KEY_CRC32:
+
+						if(field.size() > ROM_DATABASE_CRC32_LEN) {
+							return false;
+						}
+
+						entry.hash.crc32 = std::stoul(field, &separator, 16);
+						break;
+					case ROM_DATABASE_KEY_MIRRORING:
+
+						if(!database_value(field, ROM_MIRRORING_STR, ROM_MIRRORING_MAX + 1, value)
+								|| (value > ROM_MIRRORING_MAX)) {
+							return false;
+						}
+
+						entry.descriptor.mirroring = value;
+						separator = field.size();
+						break;
+					case ROM_DATABASE_KEY_SHA1:
+
+						if(field.size() != (HASH_SHA1_LEN * 2)) {
+							return false;
+						}
+
+						for(; iter < HASH_SHA1_LEN; ++iter) {
+							entry.hash.sha1[iter] = std::stoul(field.substr(iter * 2, 2), 
+								&separator, 16);
+
+							if(separator != 2) {
+								return false;
+							}
+						}
+
+						separator = field.size();
+						break;
+					case ROM_DATABASE_KEY_TIMING:
+
+						if(!database_value(field, ROM_TIMING_STR, ROM_TIMING_MAX + 1, value)
+								|| (value > ROM_TIMING_MAX)) {
+							return false;
+						}
+
+						entry.descriptor.timing = value;
+						separator = field.size();
+						break;
+					default:
+						value = std::stoul(field, &separator, 0);
+
+						switch(key) {
+							case ROM_DATABASE_KEY_BATTERY:
+								entry.descriptor.battery = (value != 0);
+								break;
+							case ROM_DATABASE_KEY_CHARACTER_NVRAM:
+								entry.descriptor.character_nvram_length = value;
+								break;
+							case ROM_DATABASE_KEY_CHARACTER_RAM:
+								entry.descriptor.character_ram_length = value;
+								break;
+							case ROM_DATABASE_KEY_MAPPER:
+								entry.descriptor.mapper = value;
+								break;
+							case ROM_DATABASE_KEY_MAPPER_SUB:
+								entry.descriptor.mapper_sub = value;
+								break;
+							case ROM_DATABASE_KEY_PROGRAM_NVRAM:
+								entry.descriptor.program_nvram_length = value;
+								break;
+							case ROM_DATABASE_KEY_PROGRAM_RAM:
+								entry.descriptor.program_ram_length = value;
+								break;
+							default:
+								return false;
+						}
+						break;
+				}
+			} catch(...) {
+				return false;
+			}
+
+			if(separator != field.size()) {
+				return false;
+			}
+
+			entry.fields |= ROM_DATABASE_FIELD(key);
+
+			return true;
+		}
+
+		bool 
+		_nes_rom::database_value(
+			__in const std::string &value,
+			__in const std::string *names,
+			__in size_t count,
+			__out uint32_t &result
+			)
+		{
+			size_t iter = 0, position;
+
+			for(; iter < count; ++iter) {
+
+				if(value == names[iter]) {
+					result = iter;
+					return true;
+				}
+			}
+
+			try {
+				result = std::stoul(value, &position, 0);
+			} catch(...) {
+				return false;
+			}
+
+			return (position == value.size());
+		}
+
+		const nes_rom_descriptor &
+		_nes_rom::descriptor(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_loaded) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
+			}
+
+			return m_descriptor;
+		}
+
+		void 
+		_nes_rom::descriptor_parse(
+			__in const nes_rom_header &header,
+			__out nes_rom_descriptor &descriptor
+			)
+		{
+			std::memset(&descriptor, 0, sizeof(nes_rom_descriptor));
+			descriptor.battery = header.flag_6.sram;
+			descriptor.format = ((header.flag_7.format == ROM_INES_2) ? ROM_INES_2 : 1);
+			descriptor.mapper = (((header.flag_7.mapper_high << BITS_PER_NIBBLE) & 0xf0)
+				| (header.flag_6.mapper_low & 0xf));
+			descriptor.mirroring = (header.flag_6.four_screen_mode ? ROM_MIRRORING_FOUR_SCREEN
+				: ((header.flag_6.mirroring == FLAG_6_MIRRORING_VERT) ? ROM_MIRRORING_VERT 
+					: ROM_MIRRORING_HORZ));
+			descriptor.trainer = header.flag_6.trainer;
+			descriptor.trainer_offset = sizeof(nes_rom_header);
+			descriptor.program_offset = (descriptor.trainer_offset 
+				+ (descriptor.trainer ? ROM_TRAINER_LEN : 0));
+
+			if(descriptor.format == ROM_INES_2) {
+				descriptor.character_length = length_rom(header.rom_character, 
+					header.extension.ines_2.flag_9.rom_character_high, ROM_CHARACTER_LEN);
+				descriptor.character_nvram_length = length_ram(
+					header.extension.ines_2.flag_11.rom_character_sram);
+				descriptor.character_ram_length = length_ram(
+					header.extension.ines_2.flag_11.rom_character_non_sram);
+				descriptor.mapper |= ((header.extension.ines_2.flag_8.mapper_high 
+					<< BITS_PER_BYTE) & 0xf00);
+				descriptor.mapper_sub = header.extension.ines_2.flag_8.mapper_sub;
+				descriptor.program_length = length_rom(header.rom_program, 
+					header.extension.ines_2.flag_9.rom_program_high, ROM_PROGRAM_LEN);
+				descriptor.program_nvram_length = length_ram(
+					header.extension.ines_2.flag_10.rom_program_sram);
+				descriptor.program_ram_length = length_ram(
+					header.extension.ines_2.flag_10.rom_program_non_sram);
+				descriptor.timing = header.extension.ines_2.flag_12.mode;
+			} else {
+				descriptor.character_length = (header.rom_character * ROM_CHARACTER_LEN);
+				descriptor.character_ram_length = (descriptor.character_length ? 0 
+					: ROM_CHARACTER_LEN);
+				descriptor.program_length = (header.rom_program * ROM_PROGRAM_LEN);
+				descriptor.program_ram_length = ((header.extension.ines_1.block_program_ram 
+					? header.extension.ines_1.block_program_ram : 1) * RAM_PROGRAM_LEN);
+				descriptor.timing = ((header.extension.ines_1.flag_9.mode == FLAG_9_1_TV_MODE_PAL) 
+					? ROM_TIMING_PAL : ROM_TIMING_NTSC);
+			}
+
+			descriptor.character_offset = (descriptor.program_offset 
+				+ descriptor.program_length);
+		}
+
+		const nes_rom_hash &
+		_nes_rom::hash(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_loaded) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
+			}
+
+			return m_hash;
 		}
 
 		size_t 
@@ -202,8 +647,6 @@ namespace NES {
 		{
 			size_t result;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			if(!m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
 			}
@@ -212,13 +655,8 @@ namespace NES {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
 			}
 
-			if(m_block.size() < sizeof(nes_rom_header)) {
-				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
-			}
-
 			result = sizeof(nes_rom_header);
-			std::memcpy((uint8_t *) &head, (uint8_t *) &m_block[0], 
-				result);
+			head = m_header;
 
 			return result;
 		}
@@ -230,6 +668,7 @@ namespace NES {
 			)
 		{
 			size_t iter = 0;
+			nes_rom_descriptor descriptor;
 			uint32_t mapper = 0, rom_character = 0, rom_program = 0;
 			std::stringstream result;
 
@@ -249,8 +688,8 @@ namespace NES {
 				<< std::endl << "character rom: " << rom_character << " (x" << ROM_CHARACTER_LEN << ")";
 
 			if(verbose) {
-				mapper = (((header.flag_7.mapper_high << BITS_PER_NIBBLE) & 0xf0)
-					| (header.flag_6.mapper_low & 0xf));
+				descriptor_parse(header, descriptor);
+				mapper = descriptor.mapper;
 
 				result << std::endl << "format: " << ((header.flag_7.format == ROM_INES_2) ? 2 : 1) 
 					<< std::endl << "mapper: " << mapper
@@ -265,12 +704,8 @@ namespace NES {
 					<< std::endl << "--- playchoice-10: " << (int) header.flag_7.pc;
 
 				if(header.flag_7.format == ROM_INES_2) {
-					mapper |= ((header.extension.ines_2.flag_8.mapper_high << BITS_PER_BYTE) 
-						& 0xf00);
-					rom_character |= ((header.extension.ines_2.flag_9.rom_character_high << BITS_PER_BYTE)
-						& 0xf00);
-					rom_program |= ((header.extension.ines_2.flag_9.rom_program_high << BITS_PER_BYTE)
-						& 0xf00);
+					rom_character = (descriptor.character_length / ROM_CHARACTER_LEN);
+					rom_program = (descriptor.program_length / ROM_PROGRAM_LEN);
 
 					result << std::endl << "[flag_8]" 
 						<< std::endl << "--- mapper (ext): " << mapper
@@ -321,10 +756,24 @@ namespace NES {
 			return result.str();
 		}
 
+		nes_rom_image_ref 
+		_nes_rom::image(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_loaded) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
+			}
+
+			return m_image;
+		}
+
 		void 
 		_nes_rom::initialize(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_INITIALIZED);
@@ -346,25 +795,41 @@ namespace NES {
 		bool 
 		_nes_rom::is_initialized(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return m_initialized;
 		}
 
 		bool 
 		_nes_rom::is_loaded(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 			return (m_initialized && m_loaded);
 		}
 
+		std::string 
+		_nes_rom::key(void)
+		{
+			size_t iter = 0;
+			std::stringstream result;
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_loaded) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
+			}
+
+			for(; iter < HASH_SHA1_LEN; ++iter) {
+				result << std::setw(2) << std::setfill('0') << std::hex << (int) m_hash.sha1[iter];
+			}
+
+			return result.str();
+		}
+
 		void 
 		_nes_rom::load(
 			__in const nes_memory_block &block
 			)
 		{
-			nes_rom_header head;
-
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
@@ -374,17 +839,41 @@ namespace NES {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
 			}
 
-			m_block = block;
-			m_loaded = true;
-			header(head);
+			attach(nes_rom_image_ref(new nes_rom_image(block)));
+		}
 
-			if(!validate(head)) {
+		void 
+		_nes_rom::load(
+			__inout nes_memory_block &&block
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(block.size() < sizeof(nes_rom_header)) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
 			}
 
-			if(head.flag_7.format == ROM_INES_2) {
-				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNSUPPORTED);
+			attach(nes_rom_image_ref(new nes_rom_image(std::move(block))));
+		}
+
+		void 
+		_nes_rom::load(
+			__in const nes_rom_image_ref &image
+			)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!image || (image->size() < sizeof(nes_rom_header))) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_MALFORMED);
 			}
+
+			attach(image);
 		}
 
 		void 
@@ -392,46 +881,152 @@ namespace NES {
 			__in const std::string &input
 			)
 		{
-			size_t len;
-			nes_memory_block block;
 
-			ATOMIC_CALL_RECUR(m_lock);
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			attach(nes_rom_image::map(input));
+		}
+
+		nes_memory_block &
+		_nes_rom::ram_character(void)
+		{
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			if(!m_loaded) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
+			}
+
+			return m_ram_character;
+		}
+
+		nes_memory_block &
+		_nes_rom::ram_program(void)
+		{
 
 			if(!m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
 			}
 
-			std::fstream file(input.c_str(), std::ios::in | std::ios::binary);
+			if(!m_loaded) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
+			}
+
+			return m_ram_program;
+		}
+
+		bool 
+		_nes_rom::scan(
+			__in const uint8_t *data,
+			__in size_t length,
+			__out nes_rom_descriptor &descriptor,
+			__out nes_rom_hash &hash
+			)
+		{
+			size_t begin, end;
+			bool result = false;
+			nes_rom_header header;
+
+			std::memset(&descriptor, 0, sizeof(nes_rom_descriptor));
+			std::memset(&hash, 0, sizeof(nes_rom_hash));
+
+			if(data && (length >= sizeof(nes_rom_header))) {
+				std::memcpy((uint8_t *) &header, data, sizeof(nes_rom_header));
+
+				if(validate(header)) {
+
+					try {
+						descriptor_parse(header, descriptor);
+						begin = std::min(descriptor.program_offset, length);
+						end = std::min(descriptor.character_offset + descriptor.character_length, 
+							length);
+						hash.crc32 = nes_hash::crc32(data + begin, end - begin);
+						nes_hash::sha1(data + begin, end - begin, hash.sha1);
+						result = ((descriptor.character_offset + descriptor.character_length) 
+							<= length);
+					} catch(nes_exception &) { }
+				}
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_rom::set_database(
+			__in_opt const std::string &path
+			)
+		{
+			std::ifstream file;
+			std::string line, token;
+			std::stringstream stream;
+			nes_rom_database_entry entry;
+			size_t comment, number = 0;
+
+			if(!m_initialized) {
+				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
+			}
+
+			m_database.clear();
+
+			if(path.empty()) {
+				return;
+			}
+
+			file.open(path.c_str(), std::ios::in);
 			if(!file) {
 				THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_FILE_NOT_FOUND,
-					"%s", CHECK_STR(input));
+					"%s", CHECK_STR(path));
 			}
 
-			file.seekg(0, std::ios::end);
+			while(std::getline(file, line)) {
+				++number;
 
-			len = file.tellg();
-			if((len < sizeof(nes_rom_header)) || (len > ROM_SIZE_MAX)) {
-				THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_MALFORMED,
-					"%s", CHECK_STR(input));
-			}
+				comment = line.find(ROM_DATABASE_COMMENT);
+				if(comment != std::string::npos) {
+					line.erase(comment);
+				}
+
+				stream.clear();
+				stream.str(line);
+				std::memset(&entry, 0, sizeof(nes_rom_database_entry));
+
+				while(stream >> token) {
 
-			block.resize(len);
-			file.seekg(0, std::ios::beg);
-			file.read((char *) &block[0], len);
-			file.close();
-			load(block);
+					if(!database_parse(entry, token)) {
+						m_database.clear();
+						THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_DATABASE,
+							"%s:%lu, \'%s\'", CHECK_STR(path), number, 
+							CHECK_STR(token));
+					}
+				}
+
+				if(!entry.fields) {
+					continue;
+				}
+
+				if(!(entry.fields & ROM_DATABASE_FIELD(ROM_DATABASE_KEY_CRC32))) {
+					m_database.clear();
+					THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_DATABASE,
+						"%s:%lu", CHECK_STR(path), number);
+				}
+
+				m_database.insert(std::make_pair(entry.hash.crc32, entry));
+			}
 		}
 
 		size_t 
 		_nes_rom::size(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
 			}
 
-			return m_block.size();
+			return (m_image ? m_image->size() : 0);
 		}
 
 		std::string 
@@ -439,11 +1034,8 @@ namespace NES {
 			__in_opt bool verbose
 			)
 		{
-			nes_rom_header head;
 			std::stringstream result;
 
-			ATOMIC_CALL_RECUR(m_lock);
-
 			result << "<" << NES_ROM_HEADER << "> ("
 				<< (m_initialized ? INITIALIZED : UNINITIALIZED) << ", "
 				<< (m_loaded ? "LOADED" : "UNLOADED");
@@ -455,10 +1047,10 @@ namespace NES {
 			result << ")";
 
 			if(m_initialized && m_loaded) {
-				header(head);
-				result << ", SZ: " << (m_block.size() / BYTES_PER_KBYTE) << " KB (" 
-					<< m_block.size() << " BTYES)" << std::endl 
-					<< nes_rom::header_as_string(head, verbose);
+				result << ", SZ: " << (m_image->size() / BYTES_PER_KBYTE) << " KB (" 
+					<< m_image->size() << " BTYES), CRC32: " << std::setw(8) << std::setfill('0') 
+					<< std::hex << m_hash.crc32 << ", SHA1: " << key() << std::dec << std::endl 
+					<< nes_rom::header_as_string(m_header, verbose);
 			}
 
 			return result.str();
@@ -467,7 +1059,6 @@ namespace NES {
 		void 
 		_nes_rom::uninitialize(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
@@ -477,13 +1068,13 @@ namespace NES {
 				unload();
 			}
 
+			m_database.clear();
 			m_initialized = false;
 		}
 
 		void 
 		_nes_rom::unload(void)
 		{
-			ATOMIC_CALL_RECUR(m_lock);
 
 			if(!m_initialized) {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNINITIALIZED);
@@ -493,8 +1084,43 @@ namespace NES {
 				THROW_NES_ROM_EXCEPTION(NES_ROM_EXCEPTION_UNLOADED);
 			}
 
-			m_block.clear();
+			m_image.reset();
 			m_loaded = false;
+			m_ram_character.clear();
+			m_ram_program.clear();
+		}
+
+		size_t 
+		_nes_rom::length_ram(
+			__in uint8_t shift
+			)
+		{
+			return (shift ? (ROM_INES_2_RAM_LEN << shift) : 0);
+		}
+
+		size_t 
+		_nes_rom::length_rom(
+			__in uint8_t low,
+			__in uint8_t high,
+			__in size_t unit
+			)
+		{
+			size_t exponent, result;
+
+			if(high == ROM_INES_2_EXPONENT) {
+
+				exponent = (low >> 2);
+				if(exponent > ROM_INES_2_EXPONENT_MAX) {
+					THROW_NES_ROM_EXCEPTION_MESSAGE(NES_ROM_EXCEPTION_MALFORMED,
+						"exp. %lu (max. %lu)", exponent, ROM_INES_2_EXPONENT_MAX);
+				}
+
+				result = (((size_t) 1 << exponent) * (((low & 3) * 2) + 1));
+			} else {
+				result = ((((size_t) high << BITS_PER_BYTE) | low) * unit);
+			}
+
+			return result;
 		}
 
 		bool 
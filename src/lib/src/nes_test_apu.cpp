@@ -0,0 +1,1420 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include "../include/nes.h"
+#include "../include/nes_apu_type.h"
+
+#ifndef NDEBUG
+
+namespace NES {
+
+	namespace TEST {
+
+		#define NES_TEST_APU_BLIP_DELTA 0x1000
+		#define NES_TEST_APU_BUFFER_CAPACITY 0x10
+		#define NES_TEST_APU_SINK_PATH_RAW "/tmp/nes_test_apu_sink.raw"
+		#define NES_TEST_APU_SINK_PATH_WAV "/tmp/nes_test_apu_sink.wav"
+		#define NES_TEST_APU_STEP_CYCLES (APU_BLIP_FRAME_CYCLES * 4)
+		#define NES_TEST_APU_DMC_BANKS 2
+		#define NES_TEST_APU_DMC_LEVEL 0x40
+		#define NES_TEST_APU_DMC_NAMETABLE_LEN 0x1000
+		#define NES_TEST_APU_PULSE_CONTROL 0xbf
+		#define NES_TEST_APU_PULSE_PERIOD 0xfd
+		#define NES_TEST_APU_SYNCHRONIZE_FRAMES 3
+		#define NES_TEST_APU_SYNCHRONIZE_STEP_MAX 0x4000
+		#define NES_TEST_APU_TRIANGLE_CONTROL 0xff
+
+		enum {
+			NES_TEST_APU_ACQUIRE = 0,
+			NES_TEST_APU_BLIP,
+			NES_TEST_APU_BUFFER,
+			NES_TEST_APU_CYCLES,
+			NES_TEST_APU_DMC,
+			NES_TEST_APU_FRAME,
+			NES_TEST_APU_INITIALIZE,
+			NES_TEST_APU_IS_ALLOCATED,
+			NES_TEST_APU_IS_INITIALIZED,
+			NES_TEST_APU_MIX,
+			NES_TEST_APU_RESET,
+			NES_TEST_APU_SINK,
+			NES_TEST_APU_START,
+			NES_TEST_APU_STEP,
+			NES_TEST_APU_STOP,
+			NES_TEST_APU_SYNCHRONIZE,
+			NES_TEST_APU_UNINITIALIZE,
+		};
+
+		#define NES_TEST_APU_MAX NES_TEST_APU_UNINITIALIZE
+
+		static const std::string NES_TEST_APU_STR[] = {
+			NES_APU_HEADER "::ACQUIRE",
+			NES_APU_HEADER "::BLIP",
+			NES_APU_HEADER "::BUFFER",
+			NES_APU_HEADER "::CYCLES",
+			NES_APU_HEADER "::DMC",
+			NES_APU_HEADER "::FRAME",
+			NES_APU_HEADER "::INITIALIZE",
+			NES_APU_HEADER "::IS_ALLOCATED",
+			NES_APU_HEADER "::IS_INITIALIZED",
+			NES_APU_HEADER "::MIX",
+			NES_APU_HEADER "::RESET",
+			NES_APU_HEADER "::SINK",
+			NES_APU_HEADER "::START",
+			NES_APU_HEADER "::STEP",
+			NES_APU_HEADER "::STOP",
+			NES_APU_HEADER "::SYNCHRONIZE",
+			NES_APU_HEADER "::UNINITIALIZE",
+			};
+
+		#define NES_TEST_APU_STRING(_TYPE_) \
+			((_TYPE_) > NES_TEST_APU_MAX ? UNKNOWN : \
+			CHECK_STR(NES_TEST_APU_STR[_TYPE_]))
+
+		static nes_test_cb NES_TEST_APU_CB[] = {
+			nes_test_apu::acquire,
+			nes_test_apu::blip,
+			nes_test_apu::buffer,
+			nes_test_apu::cycles,
+			nes_test_apu::dmc,
+			nes_test_apu::frame,
+			nes_test_apu::initialize,
+			nes_test_apu::is_allocated,
+			nes_test_apu::is_initialized,
+			nes_test_apu::mix,
+			nes_test_apu::reset,
+			nes_test_apu::sink,
+			nes_test_apu::start,
+			nes_test_apu::step,
+			nes_test_apu::stop,
+			nes_test_apu::synchronize,
+			nes_test_apu::uninitialize,
+			};
+
+		#define NES_TEST_APU_CALLBACK(_TYPE_) \
+			((_TYPE_) > NES_TEST_APU_MAX ? NULL : \
+			NES_TEST_APU_CB[_TYPE_])
+
+		nes_test_t 
+		_nes_test_apu::acquire(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(nes_apu::acquire() != inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::blip(
+			__in void *context
+			)
+		{
+			size_t count, iter = 0;
+			nes_apu_blip blip;
+			int16_t peak = 0;
+			nes_apu_ptr inst = NULL;
+			nes_apu_buffer buffer(APU_BUFFER_CAPACITY);
+			std::vector<int16_t> samples(APU_BUFFER_CAPACITY, 0);
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+				blip.set_rates(APU_CPU_FREQUENCY, APU_SAMPLE_RATE_DEFAULT, 
+					APU_BLIP_FRAME_CYCLES);
+				blip.add_delta(0, NES_TEST_APU_BLIP_DELTA);
+				blip.end_frame(APU_BLIP_FRAME_CYCLES);
+
+				count = blip.available();
+				if(!count || (blip.read(buffer) != count) || blip.available()
+						|| (buffer.pop(&samples[0], samples.size()) != count)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(; iter < count; ++iter) {
+
+					if(samples.at(iter) > peak) {
+						peak = samples.at(iter);
+					}
+				}
+
+				if((samples.front() > (NES_TEST_APU_BLIP_DELTA / APU_BLIP_WIDTH))
+						|| (peak < (NES_TEST_APU_BLIP_DELTA - (NES_TEST_APU_BLIP_DELTA / 8)))
+						|| (peak > (NES_TEST_APU_BLIP_DELTA + (NES_TEST_APU_BLIP_DELTA / 8)))
+						|| (samples.at(count - 1) <= 0) || (samples.at(count - 1) >= peak)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				blip.clear();
+				blip.end_frame(APU_BLIP_FRAME_CYCLES);
+				blip.read(buffer);
+
+				if(buffer.pop(&samples[0], samples.size()) != count) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < count; ++iter) {
+
+					if(samples.at(iter)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::buffer(
+			__in void *context
+			)
+		{
+			size_t iter;
+			nes_apu_buffer buffer(NES_TEST_APU_BUFFER_CAPACITY);
+			int16_t samples[NES_TEST_APU_BUFFER_CAPACITY * 2];
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				for(iter = 0; iter < buffer.capacity(); ++iter) {
+
+					if(!buffer.push((int16_t) iter)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				if(buffer.push(0) || (buffer.overflow() != 1)
+						|| (buffer.size() != buffer.capacity())) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(buffer.pop(samples, NES_TEST_APU_BUFFER_CAPACITY / 2) 
+						!= (NES_TEST_APU_BUFFER_CAPACITY / 2)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < (NES_TEST_APU_BUFFER_CAPACITY / 2); ++iter) {
+					buffer.push((int16_t) (iter + NES_TEST_APU_BUFFER_CAPACITY));
+				}
+
+				if(buffer.pop(samples, NES_TEST_APU_BUFFER_CAPACITY * 2) 
+						!= NES_TEST_APU_BUFFER_CAPACITY) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < NES_TEST_APU_BUFFER_CAPACITY; ++iter) {
+
+					if(samples[iter] != (int16_t) (iter + (NES_TEST_APU_BUFFER_CAPACITY / 2))) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				buffer.push(0);
+				buffer.clear();
+
+				if(buffer.size() || buffer.overflow()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::cycles(
+			__in void *context
+			)
+		{
+			uint32_t iter = 0;
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->cycles();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				inst->start();
+
+				for(; iter < NES_TEST_APU_STEP_CYCLES; ++iter) {
+					inst->step();
+				}
+
+				if(inst->cycles() != NES_TEST_APU_STEP_CYCLES) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->reset();
+
+				if(inst->cycles()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::dmc(
+			__in void *context
+			)
+		{
+			uint32_t iter = 0;
+			nes_apu_ptr inst = NULL;
+			nes_rom_ptr rom = NULL;
+			nes_memory_block block;
+			nes_mapper_ptr map = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_memory_block nametable(NES_TEST_APU_DMC_NAMETABLE_LEN, 0);
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->poll_stall();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				inst->start();
+				inst->m_memory->at(NES_MEM_MMU, APU_DMC_ADDRESS_BASE) = UINT8_MAX;
+				inst->write(APU_REGISTER_DMC_LOAD, NES_TEST_APU_DMC_LEVEL);
+				inst->write(APU_REGISTER_DMC_ADDRESS, 0);
+				inst->write(APU_REGISTER_DMC_LENGTH, 0);
+				inst->write(APU_REGISTER_DMC_CONTROL, APU_DMC_CONTROL_IRQ 
+					| APU_DMC_CONTROL_RATE);
+				inst->write(APU_REGISTER_STATUS, APU_STATUS_DMC);
+
+				if((inst->poll_stall() != APU_DMC_STALL_CYCLES) || inst->poll_stall()
+						|| !inst->irq_pending()
+						|| (inst->read(APU_REGISTER_STATUS) 
+							!= APU_STATUS_DMC_IRQ)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(; iter < (APU_DMC_RATE[APU_DMC_CONTROL_RATE] * BITS_PER_BYTE * 2); 
+						++iter) {
+					inst->step();
+				}
+
+				if((inst->m_state.dmc.level != (NES_TEST_APU_DMC_LEVEL 
+						+ (APU_DMC_LEVEL_STEP * BITS_PER_BYTE)))
+						|| inst->poll_stall()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->write(APU_REGISTER_STATUS, 0);
+
+				if(inst->irq_pending()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				nes_test_rom::mapper_image(block, NES_MAPPER_NROM, NES_TEST_APU_DMC_BANKS, 1);
+				block.at(sizeof(nes_rom_header) + (APU_DMC_ADDRESS_BASE - APU_DMC_ADDRESS_MIN)) 
+					= UINT8_MAX;
+				rom = nes_rom::create();
+				rom->initialize();
+				rom->load(block);
+				map = nes_mapper::create(*rom, &nametable[0]);
+				inst->set_mapper(map);
+				inst->m_memory->at(NES_MEM_MMU, APU_DMC_ADDRESS_BASE) = 0;
+				inst->write(APU_REGISTER_DMC_LOAD, NES_TEST_APU_DMC_LEVEL);
+				inst->write(APU_REGISTER_DMC_ADDRESS, 0);
+				inst->write(APU_REGISTER_DMC_LENGTH, 0);
+				inst->write(APU_REGISTER_DMC_CONTROL, APU_DMC_CONTROL_RATE);
+				inst->write(APU_REGISTER_STATUS, APU_STATUS_DMC);
+
+				for(iter = 0; iter < (APU_DMC_RATE[APU_DMC_CONTROL_RATE] * BITS_PER_BYTE * 2); 
+						++iter) {
+					inst->step();
+				}
+
+				if(inst->m_state.dmc.level != (NES_TEST_APU_DMC_LEVEL 
+						+ (APU_DMC_LEVEL_STEP * BITS_PER_BYTE))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->write(APU_REGISTER_STATUS, 0);
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+
+			if(inst) {
+				inst->set_mapper(NULL);
+			}
+
+			if(map) {
+				delete map;
+			}
+
+			if(rom) {
+				delete rom;
+			}
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::frame(
+			__in void *context
+			)
+		{
+			uint32_t iter = 0;
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->irq_pending();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				inst->start();
+				inst->write(APU_REGISTER_FRAME, 0);
+
+				for(; iter < (APU_FRAME_STEP_HALF_2 - 1); ++iter) {
+					inst->step();
+				}
+
+				if(inst->irq_pending()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->step();
+
+				if(!inst->irq_pending() 
+						|| (inst->read(APU_REGISTER_STATUS) != APU_STATUS_FRAME_IRQ)
+						|| inst->irq_pending()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->write(APU_REGISTER_FRAME, APU_FRAME_INHIBIT);
+				inst->write(APU_REGISTER_STATUS, APU_STATUS_PULSE_1);
+				inst->write(APU_REGISTER_PULSE_1_HIGH, 1 << APU_LENGTH_SHIFT);
+
+				for(iter = 0; iter < APU_FRAME_STEP_4_LENGTH; ++iter) {
+					inst->step();
+				}
+
+				if(inst->irq_pending() || (inst->m_state.pulse_1.length != (APU_LENGTH[1] - 2))
+						|| (inst->read(APU_REGISTER_STATUS) != APU_STATUS_PULSE_1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->write(APU_REGISTER_FRAME, APU_FRAME_MODE | APU_FRAME_INHIBIT);
+
+				if(inst->m_state.pulse_1.length != (APU_LENGTH[1] - 3)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < APU_FRAME_STEP_5_LENGTH; ++iter) {
+					inst->step();
+				}
+
+				if(inst->irq_pending() || (inst->m_state.pulse_1.length != (APU_LENGTH[1] - 5))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->write(APU_REGISTER_STATUS, 0);
+
+				if(inst->read(APU_REGISTER_STATUS)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::initialize(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				try {
+					inst->initialize();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->uninitialize();
+				inst->initialize();
+
+				if(!inst->is_initialized() || inst->is_started()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::is_allocated(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(!nes_apu::is_allocated()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::is_initialized(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(!inst->is_initialized()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->uninitialize();
+
+				if(inst->is_initialized()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->initialize();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::mix(
+			__in void *context
+			)
+		{
+			size_t iter = 1;
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->m_mix_pulse.front() || inst->m_mix_tnd.front()
+						|| (inst->m_mix_pulse.size() != APU_MIX_PULSE_LENGTH)
+						|| (inst->m_mix_tnd.size() != APU_MIX_TND_LENGTH)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(; iter < inst->m_mix_pulse.size(); ++iter) {
+
+					if(inst->m_mix_pulse.at(iter) <= inst->m_mix_pulse.at(iter - 1)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				for(iter = 1; iter < inst->m_mix_tnd.size(); ++iter) {
+
+					if(inst->m_mix_tnd.at(iter) <= inst->m_mix_tnd.at(iter - 1)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				if((inst->m_mix_pulse.back() + inst->m_mix_tnd.back()) > APU_MIX_SCALE) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::reset(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->reset();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->set_sample_rate(0);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->start();
+				inst->write(APU_REGISTER_STATUS, APU_STATUS_PULSE_1);
+				inst->write(APU_REGISTER_PULSE_1_HIGH, 0);
+				inst->step();
+				inst->reset();
+
+				if(inst->cycles() || inst->read(APU_REGISTER_STATUS) 
+						|| inst->buffer().size()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_set 
+		_nes_test_apu::set_generate(void)
+		{
+			size_t iter = 0;
+			nes_test_set result(NES_APU_HEADER);
+
+			for(; iter <= NES_TEST_APU_MAX; ++iter) {
+				result.insert(nes_test(NES_TEST_APU_STRING(iter),
+					NES_TEST_APU_CALLBACK(iter),
+					nes_apu::acquire(), nes_test_apu::test_initialize,
+					nes_test_apu::test_uninitialize));
+			}
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::sink(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			std::vector<char> data;
+			nes_apu_output failure, output;
+			uint64_t received = 0, written;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_apu_sink_t type = NES_APU_SINK_NULL;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->set_sink((nes_apu_sink_t) (NES_APU_SINK_MAX + 1));
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				try {
+					inst->set_sink(NES_APU_SINK_RAW);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				try {
+					inst->set_sink(NES_APU_SINK_CALLBACK);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				output = [&received](const int16_t *samples, size_t count) {
+						received += count;
+					};
+
+				failure = [](const int16_t *samples, size_t count) {
+						THROW_NES_APU_EXCEPTION(NES_APU_EXCEPTION_SINK_WRITE);
+					};
+
+				for(; type <= NES_APU_SINK_MAX; type = (nes_apu_sink_t) (type + 1)) {
+					inst->reset();
+					inst->set_sample_rate(APU_SAMPLE_RATE_DEFAULT);
+					inst->set_sink(type, (type == NES_APU_SINK_WAV) ? NES_TEST_APU_SINK_PATH_WAV 
+						: NES_TEST_APU_SINK_PATH_RAW, output);
+					inst->start();
+
+					if((inst->sink() != type) || !inst->m_writer.is_active()) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					try {
+						inst->set_sample_rate(APU_SAMPLE_RATE_DEFAULT);
+						result = NES_TEST_FAILURE;
+						goto exit;
+					} catch(...) { }
+
+					inst->write(APU_REGISTER_STATUS, APU_STATUS_PULSE_1);
+					inst->write(APU_REGISTER_PULSE_1_CONTROL, NES_TEST_APU_PULSE_CONTROL);
+					inst->write(APU_REGISTER_PULSE_1_LOW, NES_TEST_APU_PULSE_PERIOD);
+					inst->write(APU_REGISTER_PULSE_1_HIGH, 0);
+					inst->synchronize(NES_TEST_APU_STEP_CYCLES * APU_MASTER_DIVIDER);
+					inst->stop();
+
+					written = inst->m_writer.written();
+					if(inst->m_writer.is_active() || inst->m_writer.is_failed()
+							|| inst->buffer().size() || (written < (((uint64_t) 
+								NES_TEST_APU_STEP_CYCLES * APU_SAMPLE_RATE_DEFAULT) 
+								/ APU_CPU_FREQUENCY))) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					if(type == NES_APU_SINK_NULL) {
+						continue;
+					}
+
+					if(type == NES_APU_SINK_CALLBACK) {
+
+						if(received != written) {
+							result = NES_TEST_FAILURE;
+							goto exit;
+						}
+
+						continue;
+					}
+
+					std::ifstream file((type == NES_APU_SINK_WAV) ? NES_TEST_APU_SINK_PATH_WAV 
+						: NES_TEST_APU_SINK_PATH_RAW, std::ios::in | std::ios::binary);
+					data.assign(std::istreambuf_iterator<char>(file), 
+						std::istreambuf_iterator<char>());
+					file.close();
+					std::remove((type == NES_APU_SINK_WAV) ? NES_TEST_APU_SINK_PATH_WAV 
+						: NES_TEST_APU_SINK_PATH_RAW);
+
+					if(type == NES_APU_SINK_RAW) {
+
+						if(data.size() != (written * sizeof(int16_t))) {
+							result = NES_TEST_FAILURE;
+							goto exit;
+						}
+					} else if((data.size() != (APU_SINK_WAV_HEADER_LENGTH 
+								+ (written * sizeof(int16_t))))
+							|| std::memcmp(&data[0], APU_SINK_WAV_RIFF, APU_SINK_WAV_TAG_LENGTH)
+							|| std::memcmp(&data[36], APU_SINK_WAV_DATA, APU_SINK_WAV_TAG_LENGTH)
+							|| (*((uint32_t *) &data[40]) != (written * sizeof(int16_t)))
+							|| (*((uint32_t *) &data[24]) != APU_SAMPLE_RATE_DEFAULT)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				inst->reset();
+				inst->set_sink(NES_APU_SINK_CALLBACK, std::string(), failure);
+				inst->start();
+				inst->synchronize(NES_TEST_APU_STEP_CYCLES * APU_MASTER_DIVIDER);
+				inst->uninitialize();
+
+				if(inst->is_initialized() || inst->m_writer.is_active() || !inst->is_sink_failed()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->initialize();
+				inst->set_sink(NES_APU_SINK_NONE);
+				inst->start();
+
+				if(inst->m_writer.is_active()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::start(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->start();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				inst->start();
+
+				try {
+					inst->start();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_started()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::step(
+			__in void *context
+			)
+		{
+			size_t count;
+			uint32_t iter = 0;
+			int16_t maximum = 0, minimum = 0;
+			std::vector<int16_t> samples(APU_BUFFER_CAPACITY, 0);
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->step();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->step();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				try {
+					inst->set_sample_rate(APU_SAMPLE_RATE_MAX + 1);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->set_sample_rate(APU_SAMPLE_RATE_DEFAULT);
+				inst->start();
+				inst->write(APU_REGISTER_STATUS, APU_STATUS_PULSE_1);
+				inst->write(APU_REGISTER_PULSE_1_CONTROL, NES_TEST_APU_PULSE_CONTROL);
+				inst->write(APU_REGISTER_PULSE_1_LOW, NES_TEST_APU_PULSE_PERIOD);
+				inst->write(APU_REGISTER_PULSE_1_HIGH, 0);
+
+				for(; iter < NES_TEST_APU_STEP_CYCLES; ++iter) {
+					inst->step();
+				}
+
+				count = (((uint64_t) NES_TEST_APU_STEP_CYCLES * APU_SAMPLE_RATE_DEFAULT) 
+					/ APU_CPU_FREQUENCY);
+				if((inst->buffer().size() + 1) < count) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				count = inst->buffer().pop(&samples[0], samples.size());
+
+				for(iter = 0; iter < count; ++iter) {
+
+					if(samples.at(iter) < minimum) {
+						minimum = samples.at(iter);
+					} else if(samples.at(iter) > maximum) {
+						maximum = samples.at(iter);
+					}
+				}
+
+				if((minimum >= 0) || (maximum <= 0)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::stop(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->stop();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->stop();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->start();
+				inst->stop();
+
+				if(inst->is_started()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::synchronize(
+			__in void *context
+			)
+		{
+			nes_apu_state state;
+			nes_apu_ptr inst = NULL;
+			uint32_t cycles = 0, stall = 0, stall_lazy = 0;
+			uint64_t event, frame, iter, master = 0;
+			std::vector<int16_t> samples, samples_lazy;
+			std::vector<uint64_t> steps;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_apu_sync_t sync = NES_APU_SYNC_LAZY;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->synchronize(0);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->synchronize(0);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				try {
+					inst->set_sync((nes_apu_sync_t) (NES_APU_SYNC_MAX + 1));
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				frame = (APU_FRAME_STEP_4_LENGTH * APU_MASTER_DIVIDER 
+					* NES_TEST_APU_SYNCHRONIZE_FRAMES);
+
+				while(master < frame) {
+					master += ((std::rand() % NES_TEST_APU_SYNCHRONIZE_STEP_MAX) + 1);
+					steps.push_back(master);
+				}
+
+				inst->start();
+
+				for(; sync <= NES_APU_SYNC_MAX; sync = (nes_apu_sync_t) (sync + 1)) {
+					inst->reset();
+					inst->set_sync(sync);
+					inst->m_memory->at(NES_MEM_MMU, APU_DMC_ADDRESS_BASE) = UINT8_MAX;
+					inst->write(APU_REGISTER_STATUS, APU_STATUS_PULSE_1 | APU_STATUS_PULSE_2
+						| APU_STATUS_TRIANGLE | APU_STATUS_NOISE);
+					inst->write(APU_REGISTER_PULSE_1_CONTROL, NES_TEST_APU_PULSE_CONTROL);
+					inst->write(APU_REGISTER_PULSE_1_LOW, NES_TEST_APU_PULSE_PERIOD);
+					inst->write(APU_REGISTER_PULSE_1_HIGH, 0);
+					inst->write(APU_REGISTER_PULSE_2_CONTROL, NES_TEST_APU_PULSE_CONTROL);
+					inst->write(APU_REGISTER_PULSE_2_LOW, NES_TEST_APU_PULSE_PERIOD / 2);
+					inst->write(APU_REGISTER_PULSE_2_HIGH, 1);
+					inst->write(APU_REGISTER_TRIANGLE_CONTROL, NES_TEST_APU_TRIANGLE_CONTROL);
+					inst->write(APU_REGISTER_TRIANGLE_LOW, NES_TEST_APU_PULSE_PERIOD);
+					inst->write(APU_REGISTER_TRIANGLE_HIGH, 0);
+					inst->write(APU_REGISTER_NOISE_CONTROL, NES_TEST_APU_PULSE_CONTROL);
+					inst->write(APU_REGISTER_NOISE_PERIOD, APU_NOISE_PERIOD);
+					inst->write(APU_REGISTER_NOISE_LENGTH, 0);
+					inst->write(APU_REGISTER_DMC_ADDRESS, 0);
+					inst->write(APU_REGISTER_DMC_LENGTH, 0);
+					inst->write(APU_REGISTER_DMC_CONTROL, APU_DMC_CONTROL_LOOP);
+					inst->write(APU_REGISTER_STATUS, APU_STATUS_PULSE_1 | APU_STATUS_PULSE_2
+						| APU_STATUS_TRIANGLE | APU_STATUS_NOISE | APU_STATUS_DMC);
+					inst->write(APU_REGISTER_FRAME, 0);
+					stall = inst->poll_stall();
+
+					for(iter = 0; iter < steps.size(); ++iter) {
+						inst->synchronize(steps.at(iter));
+						stall += inst->poll_stall();
+
+						if(inst->master() != (steps.at(iter) 
+								- (steps.at(iter) % APU_MASTER_DIVIDER))) {
+							result = NES_TEST_FAILURE;
+							goto exit;
+						}
+					}
+
+					samples.resize(inst->buffer().size());
+					samples.resize(inst->buffer().pop(&samples[0], samples.size()));
+
+					if(sync == NES_APU_SYNC_LAZY) {
+						cycles = inst->cycles();
+						samples_lazy = samples;
+						state = inst->m_state;
+						stall_lazy = stall;
+					} else if((cycles != inst->cycles()) || (stall != stall_lazy)
+							|| (samples != samples_lazy)
+							|| std::memcmp(&state, &inst->m_state, sizeof(nes_apu_state))) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				inst->reset();
+				inst->set_sync(NES_APU_SYNC_LAZY);
+				inst->write(APU_REGISTER_FRAME, 0);
+				event = inst->next_event();
+
+				if(event != (APU_FRAME_STEP_HALF_2 * APU_MASTER_DIVIDER)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->synchronize(event - APU_MASTER_DIVIDER);
+
+				if(inst->irq_pending()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->synchronize(event);
+
+				if(!inst->irq_pending() || (inst->next_event() 
+						!= (event + (APU_SYNC_HORIZON * APU_MASTER_DIVIDER)))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->set_sync(NES_APU_SYNC_LOCKSTEP);
+
+				if(inst->next_event() != inst->master()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->set_sync(NES_APU_SYNC_LAZY);
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::test_initialize(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_apu_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::test_uninitialize(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_apu_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_apu::uninitialize(
+			__in void *context
+			)
+		{
+			nes_apu_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_apu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->uninitialize();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+	}
+}
+
+#endif // NDEBUG
@@ -0,0 +1,191 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdio>
+#include <cstring>
+#include "../include/nes.h"
+#include "../include/nes_archive_type.h"
+
+#ifndef NDEBUG
+
+namespace NES {
+
+	namespace TEST {
+
+		#define NES_TEST_ARCHIVE_FRAMES 8
+		#define NES_TEST_ARCHIVE_GROWTH 0x9000
+		#define NES_TEST_ARCHIVE_PATH "/tmp/nes_test_archive.nar"
+		#define NES_TEST_ARCHIVE_RESTORE 5
+		#define NES_TEST_ARCHIVE_STATE_LENGTH 0x10
+
+		enum {
+			NES_TEST_ARCHIVE_STORE = 0,
+		};
+
+		#define NES_TEST_ARCHIVE_MAX NES_TEST_ARCHIVE_STORE
+
+		static const std::string NES_TEST_ARCHIVE_STR[] = {
+			NES_ARCHIVE_HEADER "::STORE",
+			};
+
+		#define NES_TEST_ARCHIVE_STRING(_TYPE_) \
+			((_TYPE_) > NES_TEST_ARCHIVE_MAX ? UNKNOWN : \
+			CHECK_STR(NES_TEST_ARCHIVE_STR[_TYPE_]))
+
+		static const nes_test_cb NES_TEST_ARCHIVE_CB[] = {
+			nes_test_archive::store,
+			};
+
+		#define NES_TEST_ARCHIVE_CALLBACK(_TYPE_) \
+			((_TYPE_) > NES_TEST_ARCHIVE_MAX ? NULL : \
+			NES_TEST_ARCHIVE_CB[_TYPE_])
+
+		nes_test_set 
+		_nes_test_archive::set_generate(void)
+		{
+			size_t iter = 0;
+			nes_test_set result(NES_ARCHIVE_HEADER);
+
+			for(; iter <= NES_TEST_ARCHIVE_MAX; ++iter) {
+				result.insert(nes_test(NES_TEST_ARCHIVE_STRING(iter),
+					NES_TEST_ARCHIVE_CALLBACK(iter)));
+			}
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_archive::store(
+			__in void *context
+			)
+		{
+			nes_archive store;
+			size_t iter = 0, length;
+			std::vector<nes_ptr> sessions;
+			std::vector<uint64_t> key, synthetic;
+			std::vector<uint8_t> current, state;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			std::vector<std::vector<uint8_t>> expected;
+
+			std::remove(NES_TEST_ARCHIVE_PATH);
+			std::remove(NES_TEST_ARCHIVE_PATH NES_ARCHIVE_INDEX_EXTENSION);
+
+			try {
+
+				if(!nes_test_session::session_create(sessions, 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					sessions.front()->archive(store);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				store.open(NES_TEST_ARCHIVE_PATH);
+				length = sessions.front()->snapshot_length();
+
+				for(; iter < NES_TEST_ARCHIVE_FRAMES; ++iter) {
+					sessions.front()->step_frame();
+					key.push_back(sessions.front()->archive(store));
+					expected.push_back(std::vector<uint8_t>(length));
+					sessions.front()->snapshot(&expected.back()[0], length);
+				}
+
+				if((sessions.front()->archive(store) != key.back()) 
+						|| (store.count() != NES_TEST_ARCHIVE_FRAMES)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->restore_archive(store, key.at(NES_TEST_ARCHIVE_RESTORE));
+				state.resize(length);
+				sessions.front()->snapshot(&state[0], length);
+
+				if(state != expected.at(NES_TEST_ARCHIVE_RESTORE)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				current.resize(NES_TEST_ARCHIVE_STATE_LENGTH);
+
+				for(iter = 0; iter < NES_TEST_ARCHIVE_GROWTH; ++iter) {
+					std::memcpy(&current[0], &iter, sizeof(iter));
+					synthetic.push_back(store.put(&current[0], current.size()));
+				}
+
+				store.close();
+				store.open(NES_TEST_ARCHIVE_PATH);
+
+				if(store.count() != (NES_TEST_ARCHIVE_FRAMES + NES_TEST_ARCHIVE_GROWTH)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < key.size(); ++iter) {
+
+					if((store.get(key.at(iter), state) != length) 
+							|| (state != expected.at(iter))) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				for(iter = 0; iter < synthetic.size(); ++iter) {
+					std::memcpy(&current[0], &iter, sizeof(iter));
+
+					if((store.get(synthetic.at(iter), state) != current.size()) 
+							|| (state != current)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				if(store.contains(~key.front())) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					store.get(~key.front(), state);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				store.close();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			nes_test_session::session_destroy(sessions);
+			std::remove(NES_TEST_ARCHIVE_PATH);
+			std::remove(NES_TEST_ARCHIVE_PATH NES_ARCHIVE_INDEX_EXTENSION);
+
+			return result;
+		}
+	}
+}
+
+#endif // NDEBUG
@@ -0,0 +1,217 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdio>
+#include <fstream>
+#include "../include/nes.h"
+#include "../include/nes_battery_type.h"
+
+#ifndef NDEBUG
+
+namespace NES {
+
+	namespace TEST {
+
+		#define NES_TEST_BATTERY_BANKS_CHARACTER 1
+		#define NES_TEST_BATTERY_BANKS_PROGRAM 2
+		#define NES_TEST_BATTERY_IMAGE_PATH "/tmp/nes_test_battery.nes"
+		#define NES_TEST_BATTERY_INTERVAL 2
+		#define NES_TEST_BATTERY_SAVE_PATH "/tmp/nes_test_battery.sav"
+		#define NES_TEST_BATTERY_SAVE_PATH_INVALID "/tmp/nes_test_battery/missing.sav"
+
+		enum {
+			NES_TEST_BATTERY_PERSIST = 0,
+		};
+
+		#define NES_TEST_BATTERY_MAX NES_TEST_BATTERY_PERSIST
+
+		static const std::string NES_TEST_BATTERY_STR[] = {
+			NES_BATTERY_HEADER "::PERSIST",
+			};
+
+		#define NES_TEST_BATTERY_STRING(_TYPE_) \
+			((_TYPE_) > NES_TEST_BATTERY_MAX ? UNKNOWN : \
+			CHECK_STR(NES_TEST_BATTERY_STR[_TYPE_]))
+
+		static const nes_test_cb NES_TEST_BATTERY_CB[] = {
+			nes_test_battery::persist,
+			};
+
+		#define NES_TEST_BATTERY_CALLBACK(_TYPE_) \
+			((_TYPE_) > NES_TEST_BATTERY_MAX ? NULL : \
+			NES_TEST_BATTERY_CB[_TYPE_])
+
+		nes_test_t 
+		_nes_test_battery::persist(
+			__in void *context
+			)
+		{
+			size_t iter = 0;
+			std::ifstream input;
+			std::ofstream output;
+			std::vector<nes_ptr> sessions;
+			std::vector<uint8_t> block, expected, saved;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			std::remove(NES_TEST_BATTERY_SAVE_PATH);
+
+			try {
+
+				nes_test_rom::mapper_image(block, NES_MAPPER_NROM, 
+					NES_TEST_BATTERY_BANKS_PROGRAM, NES_TEST_BATTERY_BANKS_CHARACTER);
+				((nes_rom_header *) &block[0])->flag_6.sram = 1;
+				output.open(NES_TEST_BATTERY_IMAGE_PATH, std::ios::out | std::ios::binary 
+					| std::ios::trunc);
+				output.write((char *) &block[0], block.size());
+				output.close();
+
+				if(!nes_test_session::session_create(sessions, 2, false)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->set_battery(NES_TEST_BATTERY_INTERVAL);
+				sessions.front()->load(NES_TEST_BATTERY_IMAGE_PATH);
+				input.open(NES_TEST_BATTERY_SAVE_PATH, std::ios::in | std::ios::binary);
+
+				if(input.is_open() || sessions.front()->is_battery_open()
+						|| sessions.front()->acquire_rom()->ram_program().empty()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->set_battery(NES_TEST_BATTERY_INTERVAL, 
+					NES_TEST_BATTERY_SAVE_PATH_INVALID);
+				sessions.front()->load(NES_TEST_BATTERY_IMAGE_PATH);
+
+				if(sessions.front()->is_battery_open() 
+						|| sessions.front()->acquire_rom()->ram_program().empty()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->set_battery(NES_TEST_BATTERY_INTERVAL, NES_TEST_BATTERY_SAVE_PATH);
+				sessions.front()->load(NES_TEST_BATTERY_IMAGE_PATH);
+
+				if(!sessions.front()->is_battery_open()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				expected.resize(sessions.front()->acquire_rom()->ram_program().size());
+
+				for(; iter < expected.size(); ++iter) {
+					expected.at(iter) = (iter ^ BLOCK_WIDTH);
+				}
+
+				sessions.front()->acquire_rom()->ram_program() = expected;
+
+				for(iter = 0; iter < NES_TEST_BATTERY_INTERVAL; ++iter) {
+					sessions.front()->step_frame();
+				}
+
+				input.open(NES_TEST_BATTERY_SAVE_PATH, std::ios::in | std::ios::binary);
+				saved.assign(std::istreambuf_iterator<char>(input), 
+					std::istreambuf_iterator<char>());
+				input.close();
+
+				if(expected.empty() || (saved != expected)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.back()->set_battery(0, NES_TEST_BATTERY_SAVE_PATH);
+				sessions.back()->load(NES_TEST_BATTERY_IMAGE_PATH);
+
+				if(sessions.back()->is_battery_open()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.back()->acquire_rom()->ram_program().assign(expected.size(), 0);
+				sessions.back()->unload();
+
+				expected.assign(expected.size(), BLOCK_WIDTH);
+				sessions.front()->acquire_rom()->ram_program() = expected;
+				sessions.front()->unload();
+				sessions.back()->load(NES_TEST_BATTERY_IMAGE_PATH);
+
+				if(!sessions.back()->is_battery_open() 
+						|| (sessions.back()->acquire_rom()->ram_program() != expected)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.back()->acquire_rom()->ram_program().assign(expected.size(), 0);
+
+				for(iter = 0; iter < NES_TEST_BATTERY_INTERVAL; ++iter) {
+					sessions.back()->step_frame();
+				}
+
+				input.open(NES_TEST_BATTERY_SAVE_PATH, std::ios::in | std::ios::binary);
+				saved.assign(std::istreambuf_iterator<char>(input), 
+					std::istreambuf_iterator<char>());
+				input.close();
+
+				if(saved != expected) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.back()->unload();
+				sessions.front()->load(NES_TEST_BATTERY_IMAGE_PATH);
+				expected.assign(expected.size(), 0);
+
+				if(sessions.front()->acquire_rom()->ram_program() != expected) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			nes_test_session::session_destroy(sessions);
+			std::remove(NES_TEST_BATTERY_IMAGE_PATH);
+			std::remove(NES_TEST_BATTERY_SAVE_PATH);
+
+			return result;
+		}
+
+		nes_test_set 
+		_nes_test_battery::set_generate(void)
+		{
+			size_t iter = 0;
+			nes_test_set result(NES_BATTERY_HEADER);
+
+			for(; iter <= NES_TEST_BATTERY_MAX; ++iter) {
+				result.insert(nes_test(NES_TEST_BATTERY_STRING(iter),
+					NES_TEST_BATTERY_CALLBACK(iter)));
+			}
+
+			return result;
+		}
+	}
+}
+
+#endif // NDEBUG
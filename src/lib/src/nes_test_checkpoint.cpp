@@ -0,0 +1,193 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "../include/nes.h"
+#include "../include/nes_checkpoint_type.h"
+
+#ifndef NDEBUG
+
+namespace NES {
+
+	namespace TEST {
+
+		#define NES_TEST_CHECKPOINT_CHAIN 4
+		#define NES_TEST_CHECKPOINT_COUNT 12
+		#define NES_TEST_CHECKPOINT_RESTORE 3
+
+		enum {
+			NES_TEST_CHECKPOINT_COMMIT = 0,
+		};
+
+		#define NES_TEST_CHECKPOINT_MAX NES_TEST_CHECKPOINT_COMMIT
+
+		static const std::string NES_TEST_CHECKPOINT_STR[] = {
+			NES_CHECKPOINT_HEADER "::COMMIT",
+			};
+
+		#define NES_TEST_CHECKPOINT_STRING(_TYPE_) \
+			((_TYPE_) > NES_TEST_CHECKPOINT_MAX ? UNKNOWN : \
+			CHECK_STR(NES_TEST_CHECKPOINT_STR[_TYPE_]))
+
+		static const nes_test_cb NES_TEST_CHECKPOINT_CB[] = {
+			nes_test_checkpoint::commit,
+			};
+
+		#define NES_TEST_CHECKPOINT_CALLBACK(_TYPE_) \
+			((_TYPE_) > NES_TEST_CHECKPOINT_MAX ? NULL : \
+			NES_TEST_CHECKPOINT_CB[_TYPE_])
+
+		nes_test_t 
+		_nes_test_checkpoint::commit(
+			__in void *context
+			)
+		{
+			uint64_t id;
+			size_t iter = 0, length;
+			nes_checkpoint store;
+			std::vector<nes_ptr> sessions;
+			std::vector<uint8_t> current, state;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			std::vector<std::vector<uint8_t>> expected;
+
+			try {
+
+				if(!nes_test_session::session_create(sessions, 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					sessions.front()->checkpoint();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				sessions.front()->set_checkpoint(NES_CHECKPOINT_CHAIN_DEFAULT);
+				length = sessions.front()->snapshot_length();
+
+				for(; iter < NES_TEST_CHECKPOINT_COUNT; ++iter) {
+					sessions.front()->step_frame();
+
+					if(sessions.front()->checkpoint() != iter) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					expected.push_back(std::vector<uint8_t>(length));
+					sessions.front()->snapshot(&expected.back()[0], length);
+				}
+
+				if(sessions.front()->checkpoint_retained() > NES_TEST_CHECKPOINT_RESTORE) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->restore_checkpoint(NES_TEST_CHECKPOINT_RESTORE);
+				state.resize(length);
+				sessions.front()->snapshot(&state[0], length);
+
+				if(state != expected.at(NES_TEST_CHECKPOINT_RESTORE)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					sessions.front()->restore_checkpoint(NES_TEST_CHECKPOINT_COUNT);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				store.initialize(NES_TEST_CHECKPOINT_CHAIN);
+
+				for(iter = 0; iter < NES_TEST_CHECKPOINT_COUNT; ++iter) {
+					current = expected.at(iter);
+
+					if(store.commit(current) != iter) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					for(id = store.retained(); id <= iter; ++id) {
+						store.reconstruct(id, state);
+
+						if(state != expected.at(id)) {
+							result = NES_TEST_FAILURE;
+							goto exit;
+						}
+					}
+				}
+
+				while(store.chain() > NES_TEST_CHECKPOINT_CHAIN) {
+					store.compact();
+				}
+
+				if(!store.base() || (store.base() > store.retained())
+						|| (store.retained() != (NES_TEST_CHECKPOINT_COUNT - 1 
+							- (NES_TEST_CHECKPOINT_CHAIN / 2)))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(id = store.base(); id < NES_TEST_CHECKPOINT_COUNT; ++id) {
+					store.reconstruct(id, state);
+
+					if(state != expected.at(id)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				try {
+					store.reconstruct(store.base() - 1, state);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				store.uninitialize();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			nes_test_session::session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_set 
+		_nes_test_checkpoint::set_generate(void)
+		{
+			size_t iter = 0;
+			nes_test_set result(NES_CHECKPOINT_HEADER);
+
+			for(; iter <= NES_TEST_CHECKPOINT_MAX; ++iter) {
+				result.insert(nes_test(NES_TEST_CHECKPOINT_STRING(iter),
+					NES_TEST_CHECKPOINT_CALLBACK(iter)));
+			}
+
+			return result;
+		}
+	}
+}
+
+#endif // NDEBUG
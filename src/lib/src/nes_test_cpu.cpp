@@ -17,10 +17,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <random>
 #include "../include/nes.h"
 #include "../include/nes_cpu_code.h"
+#include "../include/nes_cpu_lanes_type.h"
 #include "../include/nes_cpu_type.h"
+#include "../include/nes_mapper_type.h"
 
 #ifndef NDEBUG
 
@@ -35,18 +38,53 @@ namespace NES {
 		#define TEST_CPU_ADDRESS_ZERO_PAGE 0x10
 		#define TEST_CPU_CODE_INVALID 0x3a
 		#define TEST_CPU_INTERRUPT_VECTOR 0xabcd
+		#define TEST_CPU_LANES_COUNT 16
+		#define TEST_CPU_LANES_STEPS 2000
+		#define TEST_CPU_LANES_ZERO_PAGE 0x10
+		#define TEST_CPU_LANES_ZERO_PAGE_LENGTH 8
 		#define TEST_CPU_REGISTER_INIT 0x3d
 		#define TEST_CPU_REGISTER_INIT_HIGH 0x7f
 		#define TEST_CPU_REGISTER_INIT_MAX 0xff
 		#define TEST_CPU_REGISTER_INDEX_OFFSET 3
 		#define TEST_CPU_REGISTER_INIT_ONE 1
 		#define TEST_CPU_REGISTER_INIT_ZERO 0
+		#define TEST_CPU_CREATE_ADDRESS 0x0200
+		#define TEST_CPU_CREATE_VALUE 0x42
 		#define TEST_CPU_SP_INTERRUPT_OFFSET 3
 		#define TEST_CPU_SP_SUBROUTINE_OFFSET 2
 
+		static const uint8_t TEST_CPU_LANES_PROGRAM[] = {
+			CPU_CODE_LDX_IMMEDIATE, 0x00,
+			CPU_CODE_LDA_ZERO_PAGE_X, TEST_CPU_LANES_ZERO_PAGE,
+			CPU_CODE_ADC_IMMEDIATE, 0x03,
+			CPU_CODE_STA_ZERO_PAGE_X, TEST_CPU_LANES_ZERO_PAGE,
+			CPU_CODE_CMP_IMMEDIATE, 0x80,
+			CPU_CODE_BCS_RELATIVE, 0x02,
+			CPU_CODE_EOR_IMMEDIATE, 0x5a,
+			CPU_CODE_INX_IMPLIED,
+			CPU_CODE_CPX_IMMEDIATE, TEST_CPU_LANES_ZERO_PAGE_LENGTH,
+			CPU_CODE_BNE_RELATIVE, 0xef,
+			CPU_CODE_TXA_IMPLIED,
+			CPU_CODE_TAY_IMPLIED,
+			CPU_CODE_DEY_IMPLIED,
+			CPU_CODE_STY_ABSOLUTE, 0x00, 0x03,
+			CPU_CODE_JSR_ABSOLUTE, 0x21, 0x80,
+			CPU_CODE_NOP_IMPLIED,
+			CPU_CODE_JMP_ABSOLUTE, 0x00, 0x80,
+			CPU_CODE_NOP_IMPLIED,
+			CPU_CODE_LDA_ABSOLUTE, 0x00, 0x03,
+			CPU_CODE_AND_IMMEDIATE, 0x0f,
+			CPU_CODE_ORA_IMMEDIATE, 0x40,
+			CPU_CODE_LDX_ABSOLUTE, 0x00, 0xc0,
+			CPU_CODE_SEC_IMPLIED,
+			CPU_CODE_CLC_IMPLIED,
+			CPU_CODE_RTS_IMPLIED,
+			};
+
 		enum {
 			NES_TEST_CPU_ACQUIRE = 0,
 			NES_TEST_CPU_CLEAR,
+			NES_TEST_CPU_CREATE,
 			NES_TEST_CPU_CYCLES,
 			NES_TEST_CPU_EXECUTE_ADC,
 			NES_TEST_CPU_EXECUTE_AND,
@@ -112,6 +150,7 @@ namespace NES {
 			NES_TEST_CPU_IRQ,
 			NES_TEST_CPU_IS_ALLOCATED,
 			NES_TEST_CPU_IS_INITIALIZED,
+			NES_TEST_CPU_LANES,
 			NES_TEST_CPU_NMI,
 			NES_TEST_CPU_RESET,
 			NES_TEST_CPU_STEP,
@@ -123,6 +162,7 @@ namespace NES {
 		static const std::string NES_TEST_CPU_STR[] = {
 			NES_CPU_HEADER "::ACQUIRE",
 			NES_CPU_HEADER "::CLEAR",
+			NES_CPU_HEADER "::CREATE",
 			NES_CPU_HEADER "::CYCLES",
 			NES_CPU_HEADER "::ADC",
 			NES_CPU_HEADER "::AND",
@@ -188,6 +228,7 @@ namespace NES {
 			NES_CPU_HEADER "::IRQ",
 			NES_CPU_HEADER "::IS_ALLOCATED",
 			NES_CPU_HEADER "::IS_INITIALIZED",
+			NES_CPU_HEADER "::LANES",
 			NES_CPU_HEADER "::NMI",
 			NES_CPU_HEADER "::RESET",
 			NES_CPU_HEADER "::STEP",
@@ -201,6 +242,7 @@ namespace NES {
 		static const nes_test_cb NES_TEST_CPU_CB[] = {
 			nes_test_cpu::acquire,
 			nes_test_cpu::clear,
+			nes_test_cpu::create,
 			nes_test_cpu::cycles,
 			nes_test_cpu::execute_adc,
 			nes_test_cpu::execute_and,
@@ -266,6 +308,7 @@ namespace NES {
 			nes_test_cpu::irq,
 			nes_test_cpu::is_allocated,
 			nes_test_cpu::is_initialized,
+			nes_test_cpu::lanes,
 			nes_test_cpu::nmi,
 			nes_test_cpu::reset,
 			nes_test_cpu::step,
@@ -449,6 +492,76 @@ exit:
 			return result;
 		}
 
+		nes_test_t 
+		_nes_test_cpu::create(
+			__in void *context
+			)
+		{
+			uint8_t a, value;
+			nes_cpu_ptr inst = NULL;
+			nes_apu_ptr apu_inst = NULL;
+			nes_cpu_ptr cpu_inst = NULL;
+			nes_ppu_ptr ppu_inst = NULL;
+			nes_memory_ptr mem_inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			if(!context) {
+				goto exit;
+			}
+
+			inst = (nes_cpu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+				mem_inst = nes_memory::create();
+				ppu_inst = nes_ppu::create(mem_inst);
+				apu_inst = nes_apu::create(mem_inst);
+				cpu_inst = nes_cpu::create(mem_inst, ppu_inst, apu_inst);
+
+				if((cpu_inst == inst) || (mem_inst == nes_memory::acquire())
+						|| (cpu_inst->m_memory != mem_inst)
+						|| (cpu_inst->m_ppu != ppu_inst)
+						|| (cpu_inst->m_apu != apu_inst)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				mem_inst->initialize();
+				ppu_inst->initialize();
+				apu_inst->initialize();
+				cpu_inst->initialize();
+				a = inst->m_register_a;
+				value = nes_memory::acquire()->at(NES_MEM_MMU, TEST_CPU_CREATE_ADDRESS + 1);
+				cpu_inst->m_register_pc = TEST_CPU_CREATE_ADDRESS;
+				mem_inst->at(NES_MEM_MMU, TEST_CPU_CREATE_ADDRESS) = CPU_CODE_LDA_IMMEDIATE;
+				mem_inst->at(NES_MEM_MMU, TEST_CPU_CREATE_ADDRESS + 1) = TEST_CPU_CREATE_VALUE;
+				cpu_inst->step();
+
+				if((cpu_inst->m_register_a != TEST_CPU_CREATE_VALUE)
+						|| (inst->m_register_a != a)
+						|| (nes_memory::acquire()->at(NES_MEM_MMU, TEST_CPU_CREATE_ADDRESS + 1) 
+							!= value)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			delete cpu_inst;
+			delete apu_inst;
+			delete ppu_inst;
+			delete mem_inst;
+
+			return result;
+		}
+
 		nes_test_t 
 		_nes_test_cpu::cycles(
 			__in void *context
@@ -10420,6 +10533,134 @@ exit:
 			return result;
 		}
 
+		nes_test_t 
+		_nes_test_cpu::lanes(
+			__in void *context
+			)
+		{
+			nes_cpu_lane lane;
+			size_t iter, step;
+			nes_rom_ptr rom = NULL;
+			nes_apu_ptr apu_inst = NULL;
+			nes_cpu_ptr cpu_inst = NULL;
+			nes_mapper_ptr map = NULL;
+			nes_ppu_ptr ppu_inst = NULL;
+			nes_memory_ptr mem_inst = NULL;
+			nes_cpu_lanes_ptr inst = NULL;
+			std::vector<uint8_t> block, ram;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+				nes_test_rom::mapper_image(block, NES_MAPPER_NROM, 1, 1);
+				std::memcpy(&block[sizeof(nes_rom_header)], TEST_CPU_LANES_PROGRAM, 
+					sizeof(TEST_CPU_LANES_PROGRAM));
+				block[sizeof(nes_rom_header) + ROM_PROGRAM_LEN - 4] = 0x00;
+				block[sizeof(nes_rom_header) + ROM_PROGRAM_LEN - 3] = 0x80;
+				rom = nes_rom::create();
+				rom->initialize();
+				rom->load(block);
+
+				try {
+					inst = nes_cpu_lanes::create(*rom, 0);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst = nes_cpu_lanes::create(*rom, TEST_CPU_LANES_COUNT);
+				inst->initialize();
+				ram.resize(TEST_CPU_LANES_COUNT * CPU_LANES_RAM_LENGTH, 0);
+
+				for(iter = 0; iter < TEST_CPU_LANES_COUNT; ++iter) {
+
+					for(step = 0; step < TEST_CPU_LANES_ZERO_PAGE_LENGTH; ++step) {
+						ram[(iter * CPU_LANES_RAM_LENGTH) + TEST_CPU_LANES_ZERO_PAGE + step] = 
+							(iter ? (rand() % UINT8_MAX) : 0);
+					}
+
+					std::memcpy(inst->ram(iter), &ram[iter * CPU_LANES_RAM_LENGTH], 
+						CPU_LANES_RAM_LENGTH);
+				}
+
+				inst->step(TEST_CPU_LANES_STEPS);
+
+				if(!inst->vector() || !inst->scalar() || !inst->groups()
+						|| ((inst->vector() + inst->scalar()) 
+							!= (TEST_CPU_LANES_COUNT * TEST_CPU_LANES_STEPS))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				mem_inst = nes_memory::create();
+				mem_inst->initialize();
+				ppu_inst = nes_ppu::create(mem_inst);
+				ppu_inst->initialize();
+				apu_inst = nes_apu::create(mem_inst);
+				apu_inst->initialize();
+				cpu_inst = nes_cpu::create(mem_inst, ppu_inst, apu_inst);
+				cpu_inst->initialize();
+				map = nes_mapper::create(*rom, &mem_inst->at(NES_MEM_PPU, MAPPER_NAMETABLE_BASE));
+				cpu_inst->set_mapper(map);
+
+				for(iter = 0; iter < TEST_CPU_LANES_COUNT; ++iter) {
+					cpu_inst->reset();
+					std::memcpy(&mem_inst->at(NES_MEM_MMU, 0), &ram[iter * CPU_LANES_RAM_LENGTH], 
+						CPU_LANES_RAM_LENGTH);
+
+					for(step = 0; step < TEST_CPU_LANES_STEPS; ++step) {
+						cpu_inst->step();
+					}
+
+					lane = inst->lane(iter);
+
+					if((lane.a != cpu_inst->m_register_a)
+							|| (lane.cycles != cpu_inst->m_cycles)
+							|| (lane.p != cpu_inst->m_register_p)
+							|| (lane.pc != cpu_inst->m_register_pc)
+							|| (lane.sp != cpu_inst->m_register_sp)
+							|| (lane.x != cpu_inst->m_register_x)
+							|| (lane.y != cpu_inst->m_register_y)
+							|| std::memcmp(inst->ram(iter), &mem_inst->at(NES_MEM_MMU, 0), 
+								CPU_LANES_RAM_LENGTH)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				inst->reset();
+				lane = inst->lane(0);
+
+				if((lane.pc != MAPPER_PROGRAM_BASE) || lane.cycles || inst->vector() 
+						|| inst->scalar()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->uninitialize();
+
+				try {
+					inst->step();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			delete inst;
+			delete cpu_inst;
+			delete map;
+			delete apu_inst;
+			delete ppu_inst;
+			delete mem_inst;
+			delete rom;
+
+			return result;
+		}
+
 		nes_test_t 
 		_nes_test_cpu::nmi(
 			__in void *context
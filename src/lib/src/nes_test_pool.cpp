@@ -0,0 +1,682 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include "../include/nes.h"
+#include "../include/nes_pool_type.h"
+
+#ifndef NDEBUG
+
+namespace NES {
+
+	namespace TEST {
+
+		#define NES_TEST_POOL_CAPACITY 3
+		#define NES_TEST_POOL_CAPACITY_ROUNDED 4
+		#define NES_TEST_POOL_INVALID_HANDLE 0xffff
+		#define NES_TEST_POOL_OVERFLOW_FRAMES 20
+		#define NES_TEST_POOL_PRODUCERS 4
+		#define NES_TEST_POOL_QUEUE_CAPACITY 0x40
+		#define NES_TEST_POOL_QUEUE_ITEMS 0x2000
+		#define NES_TEST_POOL_RUN_SESSIONS 3
+		#define NES_TEST_POOL_STEAL_FRAMES 4
+		#define NES_TEST_POOL_STEAL_SESSIONS 8
+		#define NES_TEST_POOL_WORKERS 4
+
+		enum {
+			NES_TEST_POOL_INITIALIZE = 0,
+			NES_TEST_POOL_OVERFLOW,
+			NES_TEST_POOL_OWNERSHIP,
+			NES_TEST_POOL_QUEUE,
+			NES_TEST_POOL_RUN,
+			NES_TEST_POOL_STEAL,
+			NES_TEST_POOL_UNINITIALIZE,
+		};
+
+		#define NES_TEST_POOL_MAX NES_TEST_POOL_UNINITIALIZE
+
+		static const std::string NES_TEST_POOL_STR[] = {
+			NES_POOL_HEADER "::INITIALIZE",
+			NES_POOL_HEADER "::OVERFLOW",
+			NES_POOL_HEADER "::OWNERSHIP",
+			NES_POOL_HEADER "::QUEUE",
+			NES_POOL_HEADER "::RUN",
+			NES_POOL_HEADER "::STEAL",
+			NES_POOL_HEADER "::UNINITIALIZE",
+			};
+
+		#define NES_TEST_POOL_STRING(_TYPE_) \
+			((_TYPE_) > NES_TEST_POOL_MAX ? UNKNOWN : \
+			CHECK_STR(NES_TEST_POOL_STR[_TYPE_]))
+
+		static const nes_test_cb NES_TEST_POOL_CB[] = {
+			nes_test_pool::initialize,
+			nes_test_pool::overflow,
+			nes_test_pool::ownership,
+			nes_test_pool::queue,
+			nes_test_pool::run,
+			nes_test_pool::steal,
+			nes_test_pool::uninitialize,
+			};
+
+		#define NES_TEST_POOL_CALLBACK(_TYPE_) \
+			((_TYPE_) > NES_TEST_POOL_MAX ? NULL : \
+			NES_TEST_POOL_CB[_TYPE_])
+
+		static const uint32_t NES_TEST_POOL_RUN_FRAMES[NES_TEST_POOL_RUN_SESSIONS] = {
+			1, 3, 5,
+			};
+
+		static nes_pool NES_TEST_POOL_CONTEXT;
+
+		nes_test_t 
+		_nes_test_pool::initialize(
+			__in void *context
+			)
+		{
+			nes_pool_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_pool_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					inst->initialize();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized() 
+						|| (inst->workers() != NES_TEST_POOL_WORKERS)
+						|| (inst->m_completion->capacity() != NES_POOL_QUEUE_CAPACITY_DEFAULT)
+						|| inst->m_affinity || inst->sessions()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->uninitialize();
+				inst->initialize(1, true, NES_TEST_POOL_CAPACITY);
+
+				if(!inst->is_initialized() || (inst->workers() != 1)
+						|| (inst->m_completion->capacity() != NES_TEST_POOL_CAPACITY_ROUNDED)
+						|| !inst->m_affinity) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_pool::overflow(
+			__in void *context
+			)
+		{
+			size_t count = 0, handle;
+			nes_pool_ptr inst = NULL;
+			std::vector<nes_ptr> sessions;
+			nes_pool_completion completion;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_pool_ptr) context;
+				if(!inst || !nes_test_session::session_create(sessions, 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->uninitialize();
+				inst->initialize(NES_TEST_POOL_WORKERS, false, NES_TEST_POOL_CAPACITY);
+				handle = inst->add(sessions.front());
+				inst->run(handle, NES_TEST_POOL_OVERFLOW_FRAMES);
+				inst->wait();
+
+				if(inst->budget(handle) || (inst->dropped() 
+						!= (NES_TEST_POOL_OVERFLOW_FRAMES - NES_TEST_POOL_CAPACITY_ROUNDED - 1))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				while(inst->poll(completion)) {
+
+					if((completion.handle != handle) 
+							|| (completion.status == NES_POOL_STATUS_ERROR)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					++count;
+				}
+
+				if((count != (NES_TEST_POOL_CAPACITY_ROUNDED + 1)) 
+						|| (completion.status != NES_POOL_STATUS_DONE)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->run(handle, 1);
+				inst->wait();
+
+				if(!inst->poll(completion) || (completion.status != NES_POOL_STATUS_DONE)
+						|| (inst->dropped() 
+							!= (NES_TEST_POOL_OVERFLOW_FRAMES - NES_TEST_POOL_CAPACITY_ROUNDED - 1))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			nes_test_session::session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_pool::ownership(
+			__in void *context
+			)
+		{
+			bool owned = true;
+			nes_ptr session = NULL;
+			std::thread contender;
+			std::vector<nes_ptr> sessions;
+			std::atomic<size_t> count(0);
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_command command = [&count](nes &) { ++count; };
+
+			UNREF_PARAM(context);
+
+			try {
+
+				if(!nes_test_session::session_create(sessions, 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				session = sessions.front();
+				session->post(command);
+
+				if(count != 1) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				session->lock();
+				contender = std::thread([&]() {
+						owned = !session->try_lock();
+						session->post(command);
+					});
+				contender.join();
+
+				if(!owned || (count != 1)) {
+					session->unlock();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				session->step_frame();
+
+				if(count != 2) {
+					session->unlock();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				contender = std::thread([&]() {
+						session->post(command);
+					});
+				contender.join();
+				session->unlock();
+
+				if(count != 3) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			nes_test_session::session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_pool::queue(
+			__in void *context
+			)
+		{
+			size_t count = 0, iter = 0, sum = 0;
+			nes_pool_completion completion = { 0 };
+			std::vector<std::thread> producers;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_pool_queue bounded(NES_TEST_POOL_CAPACITY_ROUNDED), 
+				shared(NES_TEST_POOL_QUEUE_CAPACITY);
+
+			try {
+
+				for(; iter < NES_TEST_POOL_CAPACITY_ROUNDED; ++iter) {
+					completion.handle = iter;
+
+					if(!bounded.push(completion)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				if(bounded.push(completion) 
+						|| (bounded.size() != NES_TEST_POOL_CAPACITY_ROUNDED)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < NES_TEST_POOL_CAPACITY_ROUNDED; ++iter) {
+
+					if(!bounded.pop(completion) || (completion.handle != iter)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				if(bounded.pop(completion) || bounded.size()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < NES_TEST_POOL_PRODUCERS; ++iter) {
+					producers.push_back(std::thread([&shared, iter] {
+						size_t item = 0;
+						nes_pool_completion entry = { 0 };
+
+						for(; item < NES_TEST_POOL_QUEUE_ITEMS; ++item) {
+							entry.handle = ((iter * NES_TEST_POOL_QUEUE_ITEMS) + item);
+
+							while(!shared.push(entry)) {
+								std::this_thread::yield();
+							}
+						}
+					}));
+				}
+
+				while(count < (NES_TEST_POOL_PRODUCERS * NES_TEST_POOL_QUEUE_ITEMS)) {
+
+					if(shared.pop(completion)) {
+						sum += completion.handle;
+						++count;
+					} else {
+						std::this_thread::yield();
+					}
+				}
+
+				for(iter = 0; iter < producers.size(); ++iter) {
+					producers.at(iter).join();
+				}
+
+				count = (NES_TEST_POOL_PRODUCERS * NES_TEST_POOL_QUEUE_ITEMS);
+				if((sum != ((count * (count - 1)) / 2)) || shared.pop(completion)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			for(iter = 0; iter < producers.size(); ++iter) {
+
+				if(producers.at(iter).joinable()) {
+					producers.at(iter).join();
+				}
+			}
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_pool::run(
+			__in void *context
+			)
+		{
+			size_t iter = 0, handle;
+			nes_pool_ptr inst = NULL;
+			std::vector<nes_ptr> sessions;
+			nes_pool_completion completion;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			std::vector<size_t> count(NES_TEST_POOL_RUN_SESSIONS, 0);
+			std::vector<uint64_t> frame(NES_TEST_POOL_RUN_SESSIONS, 0);
+
+			try {
+
+				inst = (nes_pool_ptr) context;
+				if(!inst || !nes_test_session::session_create(sessions, NES_TEST_POOL_RUN_SESSIONS)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					inst->add(NULL);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				try {
+					inst->run(NES_TEST_POOL_INVALID_HANDLE, 1);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				for(; iter < NES_TEST_POOL_RUN_SESSIONS; ++iter) {
+
+					if(inst->add(sessions.at(iter)) != iter) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					frame.at(iter) = sessions.at(iter)->acquire_ppu()->frame();
+				}
+
+				for(iter = 0; iter < NES_TEST_POOL_RUN_SESSIONS; ++iter) {
+					inst->run(iter, NES_TEST_POOL_RUN_FRAMES[iter]);
+				}
+
+				inst->wait();
+
+				while(inst->poll(completion)) {
+
+					if((completion.handle >= NES_TEST_POOL_RUN_SESSIONS)
+							|| (completion.frame <= frame.at(completion.handle))
+							|| (completion.status == NES_POOL_STATUS_ERROR)
+							|| (completion.worker >= NES_TEST_POOL_WORKERS)
+							|| ((completion.status == NES_POOL_STATUS_DONE) 
+								!= !completion.remaining)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					frame.at(completion.handle) = completion.frame;
+					++count.at(completion.handle);
+				}
+
+				for(iter = 0; iter < NES_TEST_POOL_RUN_SESSIONS; ++iter) {
+
+					if((count.at(iter) != NES_TEST_POOL_RUN_FRAMES[iter])
+							|| inst->budget(iter)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				if(!nes_test_session::session_create(sessions, 1, false)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				handle = inst->add(sessions.back());
+				inst->run(handle, NES_TEST_POOL_RUN_FRAMES[NES_TEST_POOL_RUN_SESSIONS - 1]);
+				inst->wait();
+
+				if(!inst->poll(completion) || (completion.handle != handle)
+						|| (completion.status != NES_POOL_STATUS_ERROR)
+						|| completion.remaining || inst->budget(handle)
+						|| inst->poll(completion)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			nes_test_session::session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_set 
+		_nes_test_pool::set_generate(void)
+		{
+			size_t iter = 0;
+			nes_test_set result(NES_POOL_HEADER);
+
+			for(; iter <= NES_TEST_POOL_MAX; ++iter) {
+				result.insert(nes_test(NES_TEST_POOL_STRING(iter),
+					NES_TEST_POOL_CALLBACK(iter),
+					&NES_TEST_POOL_CONTEXT, nes_test_pool::test_initialize,
+					nes_test_pool::test_uninitialize));
+			}
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_pool::steal(
+			__in void *context
+			)
+		{
+			size_t iter = 0;
+			nes_pool_ptr inst = NULL;
+			std::set<size_t> workers;
+			std::vector<nes_ptr> sessions;
+			nes_pool_completion completion;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			std::vector<size_t> count(NES_TEST_POOL_STEAL_SESSIONS, 0);
+
+			try {
+
+				inst = (nes_pool_ptr) context;
+				if(!inst || !nes_test_session::session_create(sessions, NES_TEST_POOL_STEAL_SESSIONS)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(; iter < NES_TEST_POOL_STEAL_SESSIONS; ++iter) {
+					inst->add(sessions.at(iter));
+				}
+
+				for(iter = 0; iter < NES_TEST_POOL_STEAL_SESSIONS; ++iter) {
+					inst->m_next.store(0);
+					inst->run(iter, NES_TEST_POOL_STEAL_FRAMES);
+				}
+
+				inst->wait();
+
+				while(inst->poll(completion)) {
+
+					if((completion.handle >= NES_TEST_POOL_STEAL_SESSIONS)
+							|| (completion.status == NES_POOL_STATUS_ERROR)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					workers.insert(completion.worker);
+					++count.at(completion.handle);
+				}
+
+				for(iter = 0; iter < NES_TEST_POOL_STEAL_SESSIONS; ++iter) {
+
+					if(count.at(iter) != NES_TEST_POOL_STEAL_FRAMES) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				if(workers.size() < 2) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			nes_test_session::session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_pool::test_initialize(
+			__in void *context
+			)
+		{
+			nes_pool_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_pool_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				inst->initialize(NES_TEST_POOL_WORKERS);
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_pool::test_uninitialize(
+			__in void *context
+			)
+		{
+			nes_pool_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_pool_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_pool::uninitialize(
+			__in void *context
+			)
+		{
+			nes_pool_ptr inst = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_pool_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->uninitialize();
+
+				if(inst->is_initialized()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					inst->uninitialize();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				try {
+					inst->run(0, 1);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				try {
+					inst->add(NULL);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+	}
+}
+
+#endif // NDEBUG
@@ -17,6 +17,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdio>
+#include <fstream>
+#include <set>
 #include "../include/nes.h"
 #include "../include/nes_ppu_type.h"
 
@@ -26,17 +29,28 @@ namespace NES {
 
 	namespace TEST {
 
+		#define NES_TEST_PPU_HASH_FRAMES 3
+		#define NES_TEST_PPU_HASH_LENGTH_MAX 0x100
+		#define NES_TEST_PPU_HASH_PATH "/tmp/nes_test_ppu.hash"
+		#define NES_TEST_PPU_PIPELINE_CAPACITY 2
+		#define NES_TEST_PPU_PIPELINE_FRAMES 8
+		#define NES_TEST_PPU_SYNCHRONIZE_FRAMES 3
+		#define NES_TEST_PPU_SYNCHRONIZE_STEP_MAX 0x1000
+
 		enum {
 			NES_TEST_PPU_ACQUIRE = 0,
 			NES_TEST_PPU_CLEAR,
 			NES_TEST_PPU_CYCLES,
+			NES_TEST_PPU_HASH,
 			NES_TEST_PPU_INITIALIZE,
 			NES_TEST_PPU_IS_ALLOCATED,
 			NES_TEST_PPU_IS_INITIALIZED,
+			NES_TEST_PPU_PIPELINE,
 			NES_TEST_PPU_RESET,
 			NES_TEST_PPU_START,
 			NES_TEST_PPU_STEP,
 			NES_TEST_PPU_STOP,
+			NES_TEST_PPU_SYNCHRONIZE,
 			NES_TEST_PPU_UNINITIALIZE,
 		};
 
@@ -46,13 +60,16 @@ namespace NES {
 			NES_PPU_HEADER "::ACQUIRE",
 			NES_PPU_HEADER "::CLEAR",
 			NES_PPU_HEADER "::CYCLES",
+			NES_PPU_HEADER "::HASH",
 			NES_PPU_HEADER "::INITIALIZE",
 			NES_PPU_HEADER "::IS_ALLOCATED",
 			NES_PPU_HEADER "::IS_INITIALIZED",
+			NES_PPU_HEADER "::PIPELINE",
 			NES_PPU_HEADER "::RESET",
 			NES_PPU_HEADER "::START",
 			NES_PPU_HEADER "::STEP",
 			NES_PPU_HEADER "::STOP",
+			NES_PPU_HEADER "::SYNCHRONIZE",
 			NES_PPU_HEADER "::UNINITIALIZE",
 			};
 
@@ -64,13 +81,16 @@ namespace NES {
 			nes_test_ppu::acquire,
 			nes_test_ppu::clear,
 			nes_test_ppu::cycles,
+			nes_test_ppu::hash,
 			nes_test_ppu::initialize,
 			nes_test_ppu::is_allocated,
 			nes_test_ppu::is_initialized,
+			nes_test_ppu::pipeline,
 			nes_test_ppu::reset,
 			nes_test_ppu::start,
 			nes_test_ppu::step,
 			nes_test_ppu::stop,
+			nes_test_ppu::synchronize,
 			nes_test_ppu::uninitialize,
 			};
 
@@ -184,6 +204,134 @@ exit:
 			return result;
 		}
 
+		nes_test_t 
+		_nes_test_ppu::hash(
+			__in void *context
+			)
+		{
+			size_t iter;
+			nes_ppu_ptr inst = NULL;
+			std::ifstream stream;
+			std::set<uint64_t> hashes;
+			uint64_t frame, hash_frame, hash_ram, record[PPU_HASH_RECORD_LENGTH];
+			std::vector<uint8_t> data(NES_TEST_PPU_HASH_LENGTH_MAX, 0);
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			inst = (nes_ppu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				for(iter = 0; iter < data.size(); ++iter) {
+					data.at(iter) = (std::rand() % (UINT8_MAX + 1));
+				}
+
+				for(iter = 0; iter <= data.size(); ++iter) {
+					hashes.insert(nes_hash::generate(&data[0], iter));
+				}
+
+				if(hashes.size() != (data.size() + 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				hash_frame = nes_hash::generate(&data[0], data.size());
+				data.back() ^= 1;
+
+				if((nes_hash::generate(&data[0], data.size()) == hash_frame)
+						|| (nes_hash::generate(&data[0], data.size(), 1) 
+							== nes_hash::generate(&data[0], data.size()))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->hash(hash_frame, hash_ram);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->set_hash(NES_PPU_HASH_MASK + 1);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->start();
+				inst->set_hash(NES_PPU_HASH_FRAME | NES_PPU_HASH_RAM);
+
+				if(inst->hash_flags() != (NES_PPU_HASH_FRAME | NES_PPU_HASH_RAM)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->m_memory->at(NES_MEM_MMU, 0) ^= 1;
+				inst->synchronize(inst->next_event());
+				frame = inst->hash(hash_frame, hash_ram);
+
+				if(frame || (inst->frame() != 1)
+						|| (hash_frame != nes_hash::generate(&inst->frame_buffer()[0], 
+							inst->frame_buffer().size()))
+						|| (hash_ram != nes_hash::generate(&inst->m_memory->at(NES_MEM_MMU, 0), 
+							PPU_HASH_RAM_LENGTH))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->m_memory->at(NES_MEM_MMU, 0) ^= 1;
+				inst->synchronize(inst->next_event());
+				frame = inst->hash(hash_frame, hash_ram);
+
+				if((frame != 1) || (hash_ram != nes_hash::generate(
+						&inst->m_memory->at(NES_MEM_MMU, 0), PPU_HASH_RAM_LENGTH))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->set_hash(NES_PPU_HASH_FRAME | NES_PPU_HASH_RAM, NES_TEST_PPU_HASH_PATH);
+				frame = inst->frame();
+				inst->synchronize(inst->master() + (NES_TEST_PPU_HASH_FRAMES * PPU_SCANLINES_PER_FRAME
+					* PPU_DOTS_PER_SCANLINE * PPU_MASTER_DIVIDER));
+				frame = (inst->frame() - frame);
+				inst->set_hash(NES_PPU_HASH_NONE);
+				inst->hash(hash_frame, hash_ram);
+
+				stream.open(NES_TEST_PPU_HASH_PATH, std::ios::in | std::ios::binary);
+				stream.read((char *) record, sizeof(record));
+
+				if(!stream || (frame < 2) || (record[0] != (inst->frame() - 1)) 
+						|| (record[1] != frame) || (record[2] != hash_frame) 
+						|| (record[3] != hash_ram) 
+						|| (stream.peek() != std::ifstream::traits_type::eof())) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			stream.close();
+			std::remove(NES_TEST_PPU_HASH_PATH);
+
+			return result;
+		}
+
 		nes_test_t 
 		_nes_test_ppu::initialize(
 			__in void *context
@@ -274,6 +422,153 @@ exit:
 			return result;
 		}
 
+		nes_test_t 
+		_nes_test_ppu::pipeline(
+			__in void *context
+			)
+		{
+			nes_ppu_ptr inst = NULL;
+			std::atomic<bool> gate(true);
+			std::atomic<uint64_t> count(0), last(0);
+			uint64_t frame, hash_frame, hash_ram;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_ppu_output output = [&](const nes_ppu_frame &value) {
+
+					while(!gate) {
+						std::this_thread::yield();
+					}
+
+					last = value.frame;
+					++count;
+				};
+			nes_ppu_output failure = [](const nes_ppu_frame &value) {
+					THROW_NES_PPU_EXCEPTION(NES_PPU_EXCEPTION_PIPELINE_CONSUMER);
+				};
+
+			inst = (nes_ppu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->set_pipeline((nes_ppu_pipeline_t) (NES_PPU_PIPELINE_MAX + 1));
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->reset();
+				inst->start();
+				inst->set_hash(NES_PPU_HASH_FRAME | NES_PPU_HASH_RAM);
+				inst->set_pipeline(NES_PPU_PIPELINE_BLOCK, NES_TEST_PPU_PIPELINE_CAPACITY, output);
+
+				if(!inst->pipeline().is_active() 
+						|| (inst->pipeline().capacity() != NES_TEST_PPU_PIPELINE_CAPACITY)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				gate = false;
+
+				while(inst->frame() < NES_TEST_PPU_PIPELINE_CAPACITY) {
+					inst->synchronize(inst->next_event());
+				}
+
+				if(inst->pipeline().size() != NES_TEST_PPU_PIPELINE_CAPACITY) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				gate = true;
+
+				while(inst->frame() < NES_TEST_PPU_PIPELINE_FRAMES) {
+					inst->m_memory->at(NES_MEM_MMU, 0) ^= 1;
+					inst->synchronize(inst->next_event());
+				}
+
+				frame = inst->hash(hash_frame, hash_ram);
+
+				if((frame != (NES_TEST_PPU_PIPELINE_FRAMES - 1))
+						|| (count != NES_TEST_PPU_PIPELINE_FRAMES)
+						|| (last != NES_TEST_PPU_PIPELINE_FRAMES)
+						|| inst->pipeline().dropped()
+						|| (hash_frame != nes_hash::generate(&inst->frame_buffer()[0], 
+							inst->frame_buffer().size()))
+						|| (hash_ram != nes_hash::generate(&inst->m_memory->at(NES_MEM_MMU, 0), 
+							PPU_HASH_RAM_LENGTH))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				count = 0;
+				gate = false;
+				inst->set_pipeline(NES_PPU_PIPELINE_DROP, NES_TEST_PPU_PIPELINE_CAPACITY, output);
+
+				while(inst->frame() < (NES_TEST_PPU_PIPELINE_FRAMES * 2)) {
+					inst->synchronize(inst->next_event());
+				}
+
+				gate = true;
+				inst->pipeline().flush();
+
+				if(!inst->pipeline().dropped() || (count != inst->pipeline().consumed())
+						|| ((count + inst->pipeline().dropped()) != NES_TEST_PPU_PIPELINE_FRAMES)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->set_pipeline(NES_PPU_PIPELINE_NONE);
+
+				if(inst->pipeline().is_active()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->set_pipeline(NES_PPU_PIPELINE_BLOCK, NES_TEST_PPU_PIPELINE_CAPACITY, failure);
+				frame = inst->frame();
+
+				while(inst->frame() == frame) {
+					inst->synchronize(inst->next_event());
+				}
+
+				inst->pipeline().flush();
+				inst->uninitialize();
+
+				if(inst->is_initialized() || inst->pipeline().is_active() 
+						|| !inst->pipeline().is_failed()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->initialize();
+				inst->start();
+				inst->set_hash(NES_PPU_HASH_NONE);
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			gate = true;
+
+			if(inst) {
+
+				try {
+					inst->set_pipeline(NES_PPU_PIPELINE_NONE);
+				} catch(...) { }
+			}
+
+			return result;
+		}
+
 		nes_test_t 
 		_nes_test_ppu::reset(
 			__in void *context
@@ -454,6 +749,148 @@ exit:
 
 			result = NES_TEST_SUCCESS;
 
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_ppu::synchronize(
+			__in void *context
+			)
+		{
+			nes_ppu_state state;
+			nes_ppu_ptr inst = NULL;
+			std::vector<uint64_t> steps;
+			uint64_t frame, iter, master = 0;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_ppu_sync_t sync = NES_PPU_SYNC_LAZY;
+
+			inst = (nes_ppu_ptr) context;
+			if(!inst) {
+				goto exit;
+			}
+
+			try {
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->synchronize(0);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->synchronize(0);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				frame = (PPU_POSITION_FRAME * PPU_MASTER_DIVIDER * NES_TEST_PPU_SYNCHRONIZE_FRAMES);
+
+				while(master < frame) {
+					master += ((std::rand() % NES_TEST_PPU_SYNCHRONIZE_STEP_MAX) + 1);
+					steps.push_back(master);
+				}
+
+				inst->start();
+
+				for(; sync <= NES_PPU_SYNC_MAX; sync = (nes_ppu_sync_t) (sync + 1)) {
+					inst->reset();
+					inst->set_sync(sync);
+					inst->write(PPU_REGISTER_BASE + PPU_REGISTER_MASK, PPU_MASK_RENDER);
+
+					for(iter = 0; iter < steps.size(); ++iter) {
+
+						if(iter == (steps.size() / 2)) {
+							inst->write(PPU_REGISTER_BASE + PPU_REGISTER_CONTROL, PPU_CONTROL_NMI);
+						}
+
+						inst->synchronize(steps.at(iter));
+
+						if(inst->master() != (steps.at(iter) 
+								- (steps.at(iter) % PPU_MASTER_DIVIDER))) {
+							result = NES_TEST_FAILURE;
+							goto exit;
+						}
+					}
+
+					if(inst->frame() < (NES_TEST_PPU_SYNCHRONIZE_FRAMES - 1)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+
+					if(sync == NES_PPU_SYNC_LAZY) {
+						state = inst->m_state;
+					} else if(!nes_ppu::compare(state, inst->m_state)) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+
+				inst->reset();
+				inst->write(PPU_REGISTER_BASE + PPU_REGISTER_CONTROL, PPU_CONTROL_NMI);
+				inst->synchronize(inst->next_event());
+
+				if(!inst->poll_nmi() || inst->poll_nmi()
+						|| (inst->m_state.scanline != PPU_SCANLINE_VBLANK)
+						|| (inst->m_state.dot != (PPU_DOT_VBLANK + 1))
+						|| !(inst->read(PPU_REGISTER_BASE + PPU_REGISTER_STATUS) 
+							& PPU_STATUS_VBLANK)
+						|| (inst->read(PPU_REGISTER_BASE + PPU_REGISTER_STATUS) 
+							& PPU_STATUS_VBLANK)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->synchronize(inst->next_event());
+
+				if((inst->frame() != 1) || inst->m_state.scanline || inst->m_state.dot) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				master = inst->master();
+
+				try {
+					inst->synchronize(master - PPU_MASTER_DIVIDER);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(inst->master() != master) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->rebase(PPU_MASTER_DIVIDER + 1);
+
+				if(inst->master() != PPU_MASTER_DIVIDER) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->synchronize(PPU_MASTER_DIVIDER * 2);
+
+				if((inst->master() != (PPU_MASTER_DIVIDER * 2)) || (inst->frame() != 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->stop();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
 exit:
 			return result;
 		}
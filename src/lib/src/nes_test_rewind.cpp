@@ -0,0 +1,201 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "../include/nes.h"
+#include "../include/nes_rewind_type.h"
+
+#ifndef NDEBUG
+
+namespace NES {
+
+	namespace TEST {
+
+		#define NES_TEST_REWIND_BACK 7
+		#define NES_TEST_REWIND_CAPACITY_MIN 0x800
+		#define NES_TEST_REWIND_CODEC_LENGTH 0x1003
+		#define NES_TEST_REWIND_FRAMES 20
+		#define NES_TEST_REWIND_INTERVAL 3
+		#define NES_TEST_REWIND_SESSIONS 2
+
+		enum {
+			NES_TEST_REWIND_RING = 0,
+		};
+
+		#define NES_TEST_REWIND_MAX NES_TEST_REWIND_RING
+
+		static const std::string NES_TEST_REWIND_STR[] = {
+			NES_REWIND_HEADER "::RING",
+			};
+
+		#define NES_TEST_REWIND_STRING(_TYPE_) \
+			((_TYPE_) > NES_TEST_REWIND_MAX ? UNKNOWN : \
+			CHECK_STR(NES_TEST_REWIND_STR[_TYPE_]))
+
+		static const nes_test_cb NES_TEST_REWIND_CB[] = {
+			nes_test_rewind::ring,
+			};
+
+		#define NES_TEST_REWIND_CALLBACK(_TYPE_) \
+			((_TYPE_) > NES_TEST_REWIND_MAX ? NULL : \
+			NES_TEST_REWIND_CB[_TYPE_])
+
+		nes_test_t 
+		_nes_test_rewind::ring(
+			__in void *context
+			)
+		{
+			uint64_t frame;
+			size_t iter = 0, length;
+			std::vector<nes_ptr> sessions;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			std::vector<uint8_t> current, delta, expected, previous, state;
+
+			try {
+
+				previous.resize(NES_TEST_REWIND_CODEC_LENGTH);
+				current.resize(NES_TEST_REWIND_CODEC_LENGTH);
+
+				for(; iter < NES_TEST_REWIND_CODEC_LENGTH; ++iter) {
+					previous.at(iter) = std::rand();
+					current.at(iter) = (((iter % 0x300) < 0x200) ? previous.at(iter)
+						: ((iter & 1) ? std::rand() : previous.at(iter)));
+				}
+
+				delta.resize(nes_rewind::encode_bound(NES_TEST_REWIND_CODEC_LENGTH));
+				length = nes_rewind::encode(&current[0], &previous[0], current.size(), &delta[0]);
+				state = previous;
+				nes_rewind::decode(&delta[0], length, &state[0], state.size());
+
+				if((length >= (NES_TEST_REWIND_CODEC_LENGTH / 2)) || (state != current)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < NES_TEST_REWIND_CODEC_LENGTH; ++iter) {
+					current.at(iter) = ~previous.at(iter);
+				}
+
+				length = nes_rewind::encode(&current[0], &previous[0], current.size(), &delta[0]);
+				state = previous;
+				nes_rewind::decode(&delta[0], length, &state[0], state.size());
+
+				if((length > delta.size()) || (state != current)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					nes_rewind::decode(&delta[0], length - 1, &state[0], state.size());
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!nes_test_session::session_create(sessions, NES_TEST_REWIND_SESSIONS)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->set_rewind(NES_REWIND_CAPACITY_DEFAULT, 
+					NES_TEST_REWIND_INTERVAL);
+
+				for(iter = 0; iter < NES_TEST_REWIND_FRAMES; ++iter) {
+					frame = sessions.front()->step_frame();
+				}
+
+				for(iter = 0; iter < (frame - NES_TEST_REWIND_BACK); ++iter) {
+					sessions.back()->step_frame();
+				}
+
+				if(sessions.front()->rewind(NES_TEST_REWIND_BACK) 
+						!= (frame - NES_TEST_REWIND_BACK)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				length = sessions.front()->snapshot_length();
+				expected.resize(length);
+				state.resize(length);
+				sessions.front()->snapshot(&state[0], length);
+				sessions.back()->snapshot(&expected[0], length);
+
+				if(state != expected) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < NES_TEST_REWIND_BACK; ++iter) {
+					sessions.front()->step_frame();
+					sessions.back()->step_frame();
+				}
+
+				if(sessions.front()->rewind(1) != (frame - 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->set_rewind(NES_TEST_REWIND_CAPACITY_MIN, 1);
+
+				for(iter = 0; iter < NES_TEST_REWIND_FRAMES; ++iter) {
+					frame = sessions.front()->step_frame();
+				}
+
+				length = sessions.front()->rewind(frame);
+				if(!length || (length >= frame) 
+						|| ((frame - length) >= NES_TEST_REWIND_FRAMES)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->set_rewind(0);
+
+				if(sessions.front()->rewind(1) != length) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			nes_test_session::session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_set 
+		_nes_test_rewind::set_generate(void)
+		{
+			size_t iter = 0;
+			nes_test_set result(NES_REWIND_HEADER);
+
+			for(; iter <= NES_TEST_REWIND_MAX; ++iter) {
+				result.insert(nes_test(NES_TEST_REWIND_STRING(iter),
+					NES_TEST_REWIND_CALLBACK(iter)));
+			}
+
+			return result;
+		}
+	}
+}
+
+#endif // NDEBUG
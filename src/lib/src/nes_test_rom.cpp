@@ -17,8 +17,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include "../include/nes.h"
+#include "../include/nes_mapper_type.h"
+#include "../include/nes_ppu_type.h"
 #include "../include/nes_rom_header.h"
 #include "../include/nes_rom_type.h"
 
@@ -30,8 +34,24 @@ namespace NES {
 
 		#define NES_TEST_ROM_BANKS_CHARACTER 1
 		#define NES_TEST_ROM_BANKS_PROGRAM 2
+		#define NES_TEST_ROM_DATABASE_MAPPER 4
+		#define NES_TEST_ROM_DATABASE_PATH "/tmp/nes_test_rom_database.txt"
+		#define NES_TEST_ROM_DATABASE_PROGRAM_RAM 0x4000
+		#define NES_TEST_ROM_HASH_CRC32 0xcbf43926
+		#define NES_TEST_ROM_HASH_CRC32_INPUT "123456789"
+		#define NES_TEST_ROM_HASH_SHA1 "84983e441c3bd26ebaae4aa1f95129e5e54670f1"
+		#define NES_TEST_ROM_HASH_SHA1_INPUT "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
 		#define NES_TEST_ROM_INDEX_ZERO 0
 		#define NES_TEST_ROM_INDEX_INVALID 10
+		#define NES_TEST_ROM_INES_2_EXPONENT 10
+		#define NES_TEST_ROM_INES_2_MAPPER 0x110
+		#define NES_TEST_ROM_INES_2_MAPPER_SUB 2
+		#define NES_TEST_ROM_INES_2_MULTIPLIER 1
+		#define NES_TEST_ROM_INES_2_SHIFT_CHARACTER 6
+		#define NES_TEST_ROM_INES_2_SHIFT_PROGRAM 7
+		#define NES_TEST_ROM_MAPPER_IRQ_LATCH 3
+		#define NES_TEST_ROM_MAPPER_NAMETABLE_LEN 0x1000
+		#define NES_TEST_ROM_MAPPER_VALUE 0xa5
 		#define NES_TEST_ROM_PATH_INVALID "./test/rom_invalid.nes"
 		#define NES_TEST_ROM_PATH_VALID_BANKS "./test/rom_valid_banks.nes"
 		#define NES_TEST_ROM_PATH_VALID_BANKS_LEN 40976
@@ -42,12 +62,19 @@ namespace NES {
 			NES_TEST_ROM_ACQUIRE = 0,
 			NES_TEST_ROM_BLOCK_CHARACTER,
 			NES_TEST_ROM_BLOCK_PROGRAM,
+			NES_TEST_ROM_DATABASE,
+			NES_TEST_ROM_DESCRIPTOR,
+			NES_TEST_ROM_HASH,
 			NES_TEST_ROM_HEADER,
+			NES_TEST_ROM_INES_2,
 			NES_TEST_ROM_INITIALIZE,
 			NES_TEST_ROM_IS_ALLOCATED,
 			NES_TEST_ROM_IS_INITIALIZED,
 			NES_TEST_ROM_IS_LOADED,
 			NES_TEST_ROM_LOAD,
+			NES_TEST_ROM_MAPPER,
+			NES_TEST_ROM_MAPPER_IRQ,
+			NES_TEST_ROM_SCAN,
 			NES_TEST_ROM_SIZE,
 			NES_TEST_ROM_UNINITIALIZE,
 			NES_TEST_ROM_UNLOAD,
@@ -59,12 +86,19 @@ namespace NES {
 			NES_ROM_HEADER "::ACQUIRE",
 			NES_ROM_HEADER "::BLOCK_CHARACTER",
 			NES_ROM_HEADER "::BLOCK_PROGRAM",
+			NES_ROM_HEADER "::DATABASE",
+			NES_ROM_HEADER "::DESCRIPTOR",
+			NES_ROM_HEADER "::HASH",
 			NES_ROM_HEADER "::HEADER",
+			NES_ROM_HEADER "::INES_2",
 			NES_ROM_HEADER "::INITIALIZE",
 			NES_ROM_HEADER "::IS_ALLOCATED",
 			NES_ROM_HEADER "::IS_INITIALIZED",
 			NES_ROM_HEADER "::IS_LOADED",
 			NES_ROM_HEADER "::LOAD",
+			NES_ROM_HEADER "::MAPPER",
+			NES_ROM_HEADER "::MAPPER_IRQ",
+			NES_ROM_HEADER "::SCAN",
 			NES_ROM_HEADER "::SIZE",
 			NES_ROM_HEADER "::UNINITIALIZE",
 			NES_ROM_HEADER "::UNLOAD",
@@ -78,12 +112,19 @@ namespace NES {
 			nes_test_rom::acquire,
 			nes_test_rom::block_character,
 			nes_test_rom::block_program,
+			nes_test_rom::database,
+			nes_test_rom::descriptor,
+			nes_test_rom::hash,
 			nes_test_rom::header,
+			nes_test_rom::ines_2,
 			nes_test_rom::initialize,
 			nes_test_rom::is_allocated,
 			nes_test_rom::is_initialized,
 			nes_test_rom::is_loaded,
 			nes_test_rom::load,
+			nes_test_rom::mapper,
+			nes_test_rom::mapper_irq,
+			nes_test_rom::scan,
 			nes_test_rom::size,
 			nes_test_rom::uninitialize,
 			nes_test_rom::unload,
@@ -302,6 +343,264 @@ exit:
 
 			result = NES_TEST_SUCCESS;
 
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_rom::database(
+			__in void *context
+			)
+		{
+			std::string key;
+			std::ofstream file;
+			nes_memory_block block;
+			nes_rom_ptr inst = NULL;
+			nes_rom_descriptor descriptor;
+			std::stringstream crc32, entry;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_rom_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				mapper_image(block, NES_MAPPER_NROM, NES_TEST_ROM_BANKS_PROGRAM, 
+					NES_TEST_ROM_BANKS_CHARACTER);
+				inst->load(block);
+				key = inst->key();
+				crc32 << std::setw(8) << std::setfill('0') << std::hex << inst->hash().crc32;
+
+				if(inst->descriptor().corrected) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				entry << "# test database" << std::endl << std::endl
+					<< "crc32=" << crc32.str() << " sha1=" << std::string(key.size(), '0') 
+						<< " mapper=1" << std::endl
+					<< "crc32=" << crc32.str() << " sha1=" << key << " mapper=" 
+						<< NES_TEST_ROM_DATABASE_MAPPER << " mirroring=four battery=1 timing=pal"
+						<< " prg_ram=" << NES_TEST_ROM_DATABASE_PROGRAM_RAM << " # corrected" 
+						<< std::endl;
+				file.open(NES_TEST_ROM_DATABASE_PATH, std::ios::out | std::ios::trunc);
+				file << entry.str();
+				file.close();
+				inst->set_database(NES_TEST_ROM_DATABASE_PATH);
+				inst->load(block);
+				descriptor = inst->descriptor();
+
+				if(!descriptor.corrected || !descriptor.battery
+						|| (descriptor.mapper != NES_TEST_ROM_DATABASE_MAPPER)
+						|| (descriptor.mirroring != ROM_MIRRORING_FOUR_SCREEN)
+						|| (descriptor.timing != ROM_TIMING_PAL)
+						|| (descriptor.program_ram_length != NES_TEST_ROM_DATABASE_PROGRAM_RAM)
+						|| (inst->ram_program().size() != NES_TEST_ROM_DATABASE_PROGRAM_RAM)
+						|| (inst->key() != key)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				file.open(NES_TEST_ROM_DATABASE_PATH, std::ios::out | std::ios::trunc);
+				file << "crc32=" << crc32.str() << " mirroring=diagonal" << std::endl;
+				file.close();
+
+				try {
+					inst->set_database(NES_TEST_ROM_DATABASE_PATH);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				file.open(NES_TEST_ROM_DATABASE_PATH, std::ios::out | std::ios::trunc);
+				file << "mapper=1" << std::endl;
+				file.close();
+
+				try {
+					inst->set_database(NES_TEST_ROM_DATABASE_PATH);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->load(block);
+
+				if(inst->descriptor().corrected) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->set_database();
+				inst->unload();
+				std::remove(NES_TEST_ROM_DATABASE_PATH);
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_rom::descriptor(
+			__in void *context
+			)
+		{
+			nes_rom_ptr inst = NULL;
+			nes_rom_descriptor descriptor;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_rom_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(inst->is_initialized()) {
+					inst->uninitialize();
+				}
+
+				try {
+					inst->descriptor();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				try {
+					inst->descriptor();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->load(NES_TEST_ROM_PATH_VALID_BANKS);
+				descriptor = inst->descriptor();
+
+				if((descriptor.format != 1) || descriptor.mapper || descriptor.mapper_sub
+						|| descriptor.trainer || descriptor.battery
+						|| (descriptor.mirroring != ROM_MIRRORING_VERT)
+						|| (descriptor.timing != ROM_TIMING_NTSC)
+						|| (descriptor.program_offset != sizeof(nes_rom_header))
+						|| (descriptor.program_length 
+							!= (NES_TEST_ROM_BANKS_PROGRAM * ROM_PROGRAM_LEN))
+						|| (descriptor.character_offset != (descriptor.program_offset 
+							+ descriptor.program_length))
+						|| (descriptor.character_length 
+							!= (NES_TEST_ROM_BANKS_CHARACTER * ROM_CHARACTER_LEN))
+						|| (descriptor.program_ram_length != RAM_PROGRAM_LEN)
+						|| (inst->data_program() != (inst->m_image->data() 
+							+ descriptor.program_offset))
+						|| (inst->data_character() != (inst->m_image->data() 
+							+ descriptor.character_offset))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->load(NES_TEST_ROM_PATH_VALID_HEADER);
+
+				try {
+					inst->data_program();
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_rom::hash(
+			__in void *context
+			)
+		{
+			size_t iter = 0;
+			std::stringstream key;
+			nes_memory_block block;
+			nes_rom_ptr inst = NULL;
+			uint8_t digest[HASH_SHA1_LEN];
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_rom_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				nes_hash::sha1(NES_TEST_ROM_HASH_SHA1_INPUT, std::strlen(NES_TEST_ROM_HASH_SHA1_INPUT), 
+					digest);
+
+				for(; iter < HASH_SHA1_LEN; ++iter) {
+					key << std::setw(2) << std::setfill('0') << std::hex << (int) digest[iter];
+				}
+
+				if((nes_hash::crc32(NES_TEST_ROM_HASH_CRC32_INPUT, 
+						std::strlen(NES_TEST_ROM_HASH_CRC32_INPUT)) != NES_TEST_ROM_HASH_CRC32)
+						|| (nes_hash::crc32(NES_TEST_ROM_HASH_CRC32_INPUT + 3, 
+							std::strlen(NES_TEST_ROM_HASH_CRC32_INPUT) - 3,
+							nes_hash::crc32(NES_TEST_ROM_HASH_CRC32_INPUT, 3)) 
+							!= NES_TEST_ROM_HASH_CRC32)
+						|| (key.str() != NES_TEST_ROM_HASH_SHA1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				mapper_image(block, NES_MAPPER_NROM, NES_TEST_ROM_BANKS_PROGRAM, 
+					NES_TEST_ROM_BANKS_CHARACTER);
+				block.push_back(UINT8_MAX);
+				inst->load(block);
+				nes_hash::sha1(&block[sizeof(nes_rom_header)], block.size() 
+					- (sizeof(nes_rom_header) + 1), digest);
+
+				if((inst->hash().crc32 != nes_hash::crc32(&block[sizeof(nes_rom_header)], 
+						block.size() - (sizeof(nes_rom_header) + 1)))
+						|| std::memcmp(inst->hash().sha1, digest, HASH_SHA1_LEN)
+						|| (inst->key().size() != (HASH_SHA1_LEN * 2))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				block[sizeof(nes_rom_header)] ^= UINT8_MAX;
+				key.str(inst->key());
+				inst->load(block);
+
+				if(inst->key() == key.str()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->unload();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
 exit:
 			return result;
 		}
@@ -368,6 +667,105 @@ exit:
 
 			result = NES_TEST_SUCCESS;
 
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_rom::ines_2(
+			__in void *context
+			)
+		{
+			nes_rom_header head;
+			nes_memory_block block;
+			nes_rom_ptr inst = NULL;
+			nes_rom_descriptor descriptor;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_rom_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				std::memset(&head, 0, sizeof(nes_rom_header));
+				std::memcpy(head.magic, ROM_MAGIC, ROM_MAGIC_LEN);
+				head.rom_program = NES_TEST_ROM_BANKS_PROGRAM;
+				head.rom_character = NES_TEST_ROM_BANKS_CHARACTER;
+				head.flag_6.sram = 1;
+				head.flag_6.mapper_low = (NES_TEST_ROM_INES_2_MAPPER & 0xf);
+				head.flag_7.format = ROM_INES_2;
+				head.flag_7.mapper_high = ((NES_TEST_ROM_INES_2_MAPPER >> BITS_PER_NIBBLE) & 0xf);
+				head.extension.ines_2.flag_8.mapper_high = ((NES_TEST_ROM_INES_2_MAPPER 
+					>> BITS_PER_BYTE) & 0xf);
+				head.extension.ines_2.flag_8.mapper_sub = NES_TEST_ROM_INES_2_MAPPER_SUB;
+				head.extension.ines_2.flag_10.rom_program_non_sram = NES_TEST_ROM_INES_2_SHIFT_PROGRAM;
+				head.extension.ines_2.flag_10.rom_program_sram = NES_TEST_ROM_INES_2_SHIFT_PROGRAM;
+				head.extension.ines_2.flag_11.rom_character_non_sram = NES_TEST_ROM_INES_2_SHIFT_CHARACTER;
+				head.extension.ines_2.flag_12.mode = ROM_TIMING_PAL;
+				block.assign((uint8_t *) &head, ((uint8_t *) &head) + sizeof(nes_rom_header));
+				block.resize(sizeof(nes_rom_header) + (NES_TEST_ROM_BANKS_PROGRAM * ROM_PROGRAM_LEN)
+					+ (NES_TEST_ROM_BANKS_CHARACTER * ROM_CHARACTER_LEN), 0);
+				inst->load(block);
+				descriptor = inst->descriptor();
+
+				if((descriptor.format != ROM_INES_2) || !descriptor.battery
+						|| (descriptor.mapper != NES_TEST_ROM_INES_2_MAPPER)
+						|| (descriptor.mapper_sub != NES_TEST_ROM_INES_2_MAPPER_SUB)
+						|| (descriptor.timing != ROM_TIMING_PAL)
+						|| (descriptor.program_length 
+							!= (NES_TEST_ROM_BANKS_PROGRAM * ROM_PROGRAM_LEN))
+						|| (descriptor.character_length 
+							!= (NES_TEST_ROM_BANKS_CHARACTER * ROM_CHARACTER_LEN))
+						|| (descriptor.program_ram_length 
+							!= (ROM_INES_2_RAM_LEN << NES_TEST_ROM_INES_2_SHIFT_PROGRAM))
+						|| (descriptor.program_nvram_length 
+							!= (ROM_INES_2_RAM_LEN << NES_TEST_ROM_INES_2_SHIFT_PROGRAM))
+						|| (descriptor.character_ram_length 
+							!= (ROM_INES_2_RAM_LEN << NES_TEST_ROM_INES_2_SHIFT_CHARACTER))
+						|| descriptor.character_nvram_length
+						|| (inst->ram_program().size() != (descriptor.program_ram_length 
+							+ descriptor.program_nvram_length))
+						|| (inst->ram_character().size() != descriptor.character_ram_length)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				head.rom_program = ((NES_TEST_ROM_INES_2_EXPONENT << 2) 
+					| NES_TEST_ROM_INES_2_MULTIPLIER);
+				head.extension.ines_2.flag_9.rom_program_high = ROM_INES_2_EXPONENT;
+				std::memcpy(&block[0], &head, sizeof(nes_rom_header));
+				inst->load(block);
+
+				if(inst->descriptor().program_length != ((1 << NES_TEST_ROM_INES_2_EXPONENT) 
+						* ((NES_TEST_ROM_INES_2_MULTIPLIER * 2) + 1))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				head.rom_program = UINT8_MAX;
+				std::memcpy(&block[0], &head, sizeof(nes_rom_header));
+
+				try {
+					inst->load(block);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->unload();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
 exit:
 			return result;
 		}
@@ -396,7 +794,7 @@ exit:
 
 				if(!inst->is_allocated() || !inst->is_initialized() 
 						|| inst->is_loaded() 
-						|| !inst->m_block.empty()) {
+						|| inst->m_image) {
 					result = NES_TEST_FAILURE;
 					goto exit;
 				}
@@ -529,6 +927,8 @@ exit:
 			__in void *context
 			)
 		{
+			nes_memory_block block;
+			nes_rom_image_ref image;
 			nes_rom_ptr inst = NULL;
 			nes_test_t result = NES_TEST_INCONCLUSIVE;
 
@@ -562,11 +962,465 @@ exit:
 
 				inst->load(NES_TEST_ROM_PATH_VALID_BANKS);
 
-				if(!inst->is_loaded()
+				if(!inst->is_loaded() || !inst->m_image->is_mapped()
 						|| (inst->size() != NES_TEST_ROM_PATH_VALID_BANKS_LEN)) {
 					result = NES_TEST_FAILURE;
 					goto exit;
 				}
+
+				image = inst->image();
+				block.assign(image->data(), image->data() + image->size());
+				inst->load(std::move(block));
+
+				if(!block.empty() || inst->m_image->is_mapped() || (inst->m_image == image)
+						|| (inst->size() != NES_TEST_ROM_PATH_VALID_BANKS_LEN)
+						|| std::memcmp(inst->m_image->data(), image->data(), image->size())) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->load(image);
+
+				if((inst->m_image != image) || (image.use_count() != 2)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					inst->load(nes_rom_image_ref());
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_rom::mapper(
+			__in void *context
+			)
+		{
+			uint8_t iter;
+			nes_memory_block block;
+			nes_rom_ptr inst = NULL;
+			nes_mapper_ptr map = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_memory_block nametable(NES_TEST_ROM_MAPPER_NAMETABLE_LEN, 0);
+
+			try {
+
+				inst = (nes_rom_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				mapper_image(block, NES_MAPPER_NROM, 1, 1);
+				inst->load(block);
+				map = nes_mapper::create(*inst, &nametable[0]);
+				map->write_cpu(MAPPER_RAM_BASE, NES_TEST_ROM_MAPPER_VALUE);
+				map->write_ppu(MAPPER_NAMETABLE_BASE + MAPPER_NAMETABLE_LEN, 
+					NES_TEST_ROM_MAPPER_VALUE);
+
+				if((map->mapper() != NES_MAPPER_NROM) 
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE) != 0)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (3 * MAPPER_PROGRAM_PAGE_LEN)) != 1)
+						|| (map->read_cpu(MAPPER_RAM_BASE) != NES_TEST_ROM_MAPPER_VALUE)
+						|| (map->read_ppu(MAPPER_CHARACTER_PAGE_LEN) != 1)
+						|| (map->mirroring() != NES_MAPPER_MIRRORING_HORZ)
+						|| (nametable[0] != NES_TEST_ROM_MAPPER_VALUE)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				delete map;
+				map = NULL;
+				mapper_image(block, NES_MAPPER_UXROM, 8, 0);
+				inst->load(block);
+				map = nes_mapper::create(*inst, &nametable[0]);
+				map->write_cpu(MAPPER_PROGRAM_BASE, 3);
+				map->write_ppu(0, NES_TEST_ROM_MAPPER_VALUE);
+
+				if((map->read_cpu(MAPPER_PROGRAM_BASE) != 6)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + MAPPER_PROGRAM_PAGE_LEN) != 7)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (2 * MAPPER_PROGRAM_PAGE_LEN)) != 14)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (3 * MAPPER_PROGRAM_PAGE_LEN)) != 15)
+						|| (map->read_ppu(0) != NES_TEST_ROM_MAPPER_VALUE)
+						|| (inst->ram_character()[0] != NES_TEST_ROM_MAPPER_VALUE)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				delete map;
+				map = NULL;
+				mapper_image(block, NES_MAPPER_CNROM, 2, 4);
+				inst->load(block);
+				map = nes_mapper::create(*inst, &nametable[0]);
+				map->write_cpu(MAPPER_PROGRAM_BASE, 2);
+				map->write_ppu(0, NES_TEST_ROM_MAPPER_VALUE);
+
+				if((map->read_ppu(0) != 16) || (map->read_ppu(MAPPER_CHARACTER_MAX) != 23)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				delete map;
+				map = NULL;
+				mapper_image(block, NES_MAPPER_AXROM, 16, 0);
+				inst->load(block);
+				map = nes_mapper::create(*inst, &nametable[0]);
+				map->write_cpu(MAPPER_PROGRAM_BASE, MAPPER_AXROM_MIRRORING | 3);
+				map->write_ppu(MAPPER_NAMETABLE_BASE, NES_TEST_ROM_MAPPER_VALUE + 1);
+
+				if((map->read_cpu(MAPPER_PROGRAM_BASE) != 12)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (3 * MAPPER_PROGRAM_PAGE_LEN)) != 15)
+						|| (map->mirroring() != NES_MAPPER_MIRRORING_SINGLE_HIGH)
+						|| (nametable[MAPPER_NAMETABLE_LEN] != (NES_TEST_ROM_MAPPER_VALUE + 1))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				delete map;
+				map = NULL;
+				mapper_image(block, NES_MAPPER_MMC1, 8, 4);
+				inst->load(block);
+				map = nes_mapper::create(*inst, &nametable[0]);
+
+				if((map->read_cpu(MAPPER_PROGRAM_BASE) != 0)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (2 * MAPPER_PROGRAM_PAGE_LEN)) != 14)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < (MAPPER_MMC1_SHIFT_LENGTH + 1); ++iter) {
+					map->write_cpu(MAPPER_PROGRAM_BASE, 0x1f >> iter);
+				}
+
+				for(iter = 0; iter < (MAPPER_MMC1_SHIFT_LENGTH + 1); ++iter) {
+					map->write_cpu(MAPPER_PROGRAM_BASE + (3 * MAPPER_PROGRAM_PAGE_LEN), 2 >> iter);
+				}
+
+				for(iter = 0; iter < (MAPPER_MMC1_SHIFT_LENGTH + 1); ++iter) {
+					map->write_cpu(MAPPER_PROGRAM_BASE + MAPPER_PROGRAM_PAGE_LEN, 5 >> iter);
+				}
+
+				if((map->read_cpu(MAPPER_PROGRAM_BASE) != 4)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (2 * MAPPER_PROGRAM_PAGE_LEN)) != 14)
+						|| (map->read_ppu(0) != 20)
+						|| (map->mirroring() != NES_MAPPER_MIRRORING_HORZ)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				map->write_cpu(MAPPER_PROGRAM_BASE, MAPPER_MMC1_RESET);
+
+				if(map->read_cpu(MAPPER_PROGRAM_BASE) != 4) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				delete map;
+				map = NULL;
+				mapper_image(block, NES_MAPPER_MMC3, 8, 2);
+				inst->load(block);
+				map = nes_mapper::create(*inst, &nametable[0]);
+				map->write_cpu(MAPPER_MMC3_REGISTER_BANK_SELECT, 6);
+				map->write_cpu(MAPPER_MMC3_REGISTER_BANK_DATA, 5);
+				map->write_cpu(MAPPER_MMC3_REGISTER_BANK_SELECT, 2);
+				map->write_cpu(MAPPER_MMC3_REGISTER_BANK_DATA, 9);
+				map->write_cpu(MAPPER_MMC3_REGISTER_MIRRORING, MAPPER_MMC3_MIRRORING_HORZ);
+
+				if((map->read_cpu(MAPPER_PROGRAM_BASE) != 5)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (2 * MAPPER_PROGRAM_PAGE_LEN)) != 14)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (3 * MAPPER_PROGRAM_PAGE_LEN)) != 15)
+						|| (map->read_ppu(MAPPER_CHARACTER_BANK_4KB * MAPPER_CHARACTER_PAGE_LEN) != 9)
+						|| (map->mirroring() != NES_MAPPER_MIRRORING_HORZ)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				map->write_cpu(MAPPER_MMC3_REGISTER_BANK_SELECT, MAPPER_MMC3_BANK_CHARACTER_INVERT 
+					| MAPPER_MMC3_BANK_PROGRAM_SWAP);
+
+				if((map->read_cpu(MAPPER_PROGRAM_BASE) != 14)
+						|| (map->read_cpu(MAPPER_PROGRAM_BASE + (2 * MAPPER_PROGRAM_PAGE_LEN)) != 5)
+						|| (map->read_ppu(0) != 9)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				delete map;
+				map = NULL;
+				mapper_image(block, NES_MAPPER_MMC3 + 1, 1, 1);
+				inst->load(block);
+
+				try {
+					map = nes_mapper::create(*inst, &nametable[0]);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				inst->unload();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+
+			if(map) {
+				delete map;
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_test_rom::mapper_image(
+			__out std::vector<uint8_t> &block,
+			__in uint16_t mapper,
+			__in uint8_t program,
+			__in uint8_t character
+			)
+		{
+			size_t iter = 0;
+			nes_rom_header head;
+			size_t length_character = (character * ROM_CHARACTER_LEN), 
+				length_program = (program * ROM_PROGRAM_LEN);
+
+			std::memset(&head, 0, sizeof(nes_rom_header));
+			std::memcpy(head.magic, ROM_MAGIC, ROM_MAGIC_LEN);
+			head.rom_program = program;
+			head.rom_character = character;
+			head.flag_6.mapper_low = (mapper & 0xf);
+			head.flag_7.mapper_high = ((mapper >> BITS_PER_NIBBLE) & 0xf);
+			block.assign((uint8_t *) &head, ((uint8_t *) &head) + sizeof(nes_rom_header));
+			block.resize(sizeof(nes_rom_header) + length_program + length_character, 0);
+
+			for(; iter < length_program; ++iter) {
+				block[sizeof(nes_rom_header) + iter] = (iter / MAPPER_PROGRAM_PAGE_LEN);
+			}
+
+			for(iter = 0; iter < length_character; ++iter) {
+				block[sizeof(nes_rom_header) + length_program + iter] = 
+					(iter / MAPPER_CHARACTER_PAGE_LEN);
+			}
+		}
+
+		nes_test_t 
+		_nes_test_rom::mapper_irq(
+			__in void *context
+			)
+		{
+			uint64_t event;
+			nes_memory_block block;
+			nes_rom_ptr inst = NULL;
+			nes_mapper_ptr map = NULL;
+			nes_ppu_ptr inst_ppu = NULL;
+			nes_memory_ptr inst_mem = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_memory_block nametable(NES_TEST_ROM_MAPPER_NAMETABLE_LEN, 0);
+
+			try {
+
+				inst = (nes_rom_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				mapper_image(block, NES_MAPPER_MMC3, 2, 1);
+				inst->load(block);
+				map = nes_mapper::create(*inst, &nametable[0]);
+
+				if(map->irq_scanlines()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_LATCH, NES_TEST_ROM_MAPPER_IRQ_LATCH);
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_RELOAD, 0);
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_ENABLE, 0);
+
+				if(map->irq_scanlines() != (NES_TEST_ROM_MAPPER_IRQ_LATCH + 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				map->scanline(NES_TEST_ROM_MAPPER_IRQ_LATCH);
+
+				if(map->irq_pending() || (map->irq_scanlines() != 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				map->scanline(1);
+
+				if(!map->irq_pending() || map->irq_scanlines()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_DISABLE, 0);
+
+				if(map->irq_pending()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst_mem = nes_memory::acquire();
+				if(!inst_mem->is_initialized()) {
+					inst_mem->initialize();
+				}
+
+				inst_ppu = nes_ppu::acquire();
+				if(inst_ppu->is_initialized()) {
+					inst_ppu->uninitialize();
+				}
+
+				inst_ppu->initialize();
+				inst_ppu->reset();
+				inst_ppu->start();
+				inst_ppu->set_mapper(map);
+				map->reset();
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_LATCH, NES_TEST_ROM_MAPPER_IRQ_LATCH);
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_RELOAD, 0);
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_ENABLE, 0);
+
+				if(inst_ppu->next_event() != (PPU_POSITION_FRAME * PPU_MASTER_DIVIDER)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst_ppu->write(PPU_REGISTER_BASE + PPU_REGISTER_MASK, PPU_MASK_RENDER);
+				event = inst_ppu->next_event();
+
+				if(event != ((PPU_POSITION(NES_TEST_ROM_MAPPER_IRQ_LATCH, PPU_DOT_MAPPER) + 1) 
+						* PPU_MASTER_DIVIDER)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst_ppu->synchronize(event - PPU_MASTER_DIVIDER);
+
+				if(map->irq_pending()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst_ppu->synchronize(event);
+
+				if(!map->irq_pending()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_DISABLE, 0);
+				map->write_cpu(MAPPER_MMC3_REGISTER_IRQ_ENABLE, 0);
+				event = inst_ppu->next_event();
+				inst_ppu->synchronize(event);
+
+				if(!map->irq_pending() || (event != ((PPU_POSITION(
+						(NES_TEST_ROM_MAPPER_IRQ_LATCH * 2) + 1, PPU_DOT_MAPPER) + 1) 
+						* PPU_MASTER_DIVIDER))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst_ppu->set_mapper(NULL);
+				inst_ppu->uninitialize();
+				inst->unload();
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+
+			if(inst_ppu) {
+				inst_ppu->set_mapper(NULL);
+			}
+
+			if(map) {
+				delete map;
+			}
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_rom::scan(
+			__in void *context
+			)
+		{
+			nes_memory_block block;
+			nes_rom_ptr inst = NULL;
+			nes_rom_hash hash;
+			nes_rom_descriptor descriptor;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				inst = (nes_rom_ptr) context;
+				if(!inst) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(!inst->is_initialized()) {
+					inst->initialize();
+				}
+
+				mapper_image(block, NES_MAPPER_MMC1, NES_TEST_ROM_BANKS_PROGRAM, 
+					NES_TEST_ROM_BANKS_CHARACTER);
+				inst->load(block);
+
+				if(!nes_rom::scan(&block[0], block.size(), descriptor, hash)
+						|| (descriptor.mapper != NES_MAPPER_MMC1)
+						|| (descriptor.program_length != inst->descriptor().program_length)
+						|| (descriptor.character_length != inst->descriptor().character_length)
+						|| (hash.crc32 != inst->hash().crc32)
+						|| std::memcmp(hash.sha1, inst->hash().sha1, HASH_SHA1_LEN)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(nes_rom::scan(&block[0], block.size() - 1, descriptor, hash)
+						|| (descriptor.mapper != NES_MAPPER_MMC1)
+						|| nes_rom::scan(&block[0], sizeof(nes_rom_header) - 1, descriptor, hash)
+						|| nes_rom::scan(NULL, block.size(), descriptor, hash)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				block[0] ^= UINT8_MAX;
+
+				if(nes_rom::scan(&block[0], block.size(), descriptor, hash)
+						|| descriptor.program_length || hash.crc32) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				inst->unload();
 			} catch(...) {
 				result = NES_TEST_FAILURE;
 				goto exit;
@@ -742,7 +1596,7 @@ exit:
 
 				if(!inst->is_allocated() || inst->is_initialized() 
 						|| inst->is_loaded() 
-						|| !inst->m_block.empty()) {
+						|| inst->m_image) {
 					result = NES_TEST_FAILURE;
 					goto exit;
 				}
@@ -791,7 +1645,7 @@ exit:
 
 				if(!inst->is_allocated() || !inst->is_initialized() 
 						|| inst->is_loaded() 
-						|| !inst->m_block.empty()) {
+						|| inst->m_image) {
 					result = NES_TEST_FAILURE;
 					goto exit;
 				}
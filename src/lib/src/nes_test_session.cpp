@@ -0,0 +1,566 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <fstream>
+#include "../include/nes.h"
+#include "../include/nes_cpu_type.h"
+#include "../include/nes_type.h"
+
+#ifndef NDEBUG
+
+namespace NES {
+
+	namespace TEST {
+
+		#define NES_TEST_SESSION_BANKS_CHARACTER 1
+		#define NES_TEST_SESSION_BANKS_PROGRAM 2
+		#define NES_TEST_SESSION_CYCLES_COUNT 0x10000
+		#define NES_TEST_SESSION_CYCLES_FRAMES 2
+		#define NES_TEST_SESSION_IMAGE_PATH "/tmp/nes_test_session.nes"
+		#define NES_TEST_SESSION_PACING_ELAPSED_MIN 0.08
+		#define NES_TEST_SESSION_PACING_FRAMES 6
+		#define NES_TEST_SESSION_PACING_RATE_MAX 63.0
+		#define NES_TEST_SESSION_PACING_UNCAPPED_FRAMES 30
+		#define NES_TEST_SESSION_POST_COMMANDS 0x400
+		#define NES_TEST_SESSION_SNAPSHOT_FRAMES 3
+		#define NES_TEST_SESSION_SNAPSHOT_SESSIONS 2
+		#define NES_TEST_SESSION_WRAP_CYCLES 0x100000000
+		#define NES_TEST_SESSION_WRAP_FRAMES 3
+
+		enum {
+			NES_TEST_SESSION_CYCLES = 0,
+			NES_TEST_SESSION_PACING,
+			NES_TEST_SESSION_POST,
+			NES_TEST_SESSION_SNAPSHOT,
+			NES_TEST_SESSION_WRAP,
+		};
+
+		#define NES_TEST_SESSION_MAX NES_TEST_SESSION_WRAP
+
+		static const std::string NES_TEST_SESSION_STR[] = {
+			NES_HEADER "::CYCLES",
+			NES_HEADER "::PACING",
+			NES_HEADER "::POST",
+			NES_HEADER "::SNAPSHOT",
+			NES_HEADER "::WRAP",
+			};
+
+		#define NES_TEST_SESSION_STRING(_TYPE_) \
+			((_TYPE_) > NES_TEST_SESSION_MAX ? UNKNOWN : \
+			CHECK_STR(NES_TEST_SESSION_STR[_TYPE_]))
+
+		static const nes_test_cb NES_TEST_SESSION_CB[] = {
+			nes_test_session::cycles,
+			nes_test_session::pacing,
+			nes_test_session::post,
+			nes_test_session::snapshot,
+			nes_test_session::wrap,
+			};
+
+		#define NES_TEST_SESSION_CALLBACK(_TYPE_) \
+			((_TYPE_) > NES_TEST_SESSION_MAX ? NULL : \
+			NES_TEST_SESSION_CB[_TYPE_])
+
+		nes_test_t 
+		_nes_test_session::cycles(
+			__in void *context
+			)
+		{
+			uint64_t elapsed, frame, previous;
+			std::vector<nes_ptr> sessions;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				if(!session_create(sessions, 1, false)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					sessions.front()->run_cycles(NES_TEST_SESSION_CYCLES_COUNT);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				session_destroy(sessions);
+
+				if(!session_create(sessions, 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				if(sessions.front()->run_cycles(0)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				frame = sessions.front()->acquire_ppu()->frame();
+				previous = sessions.front()->acquire_cpu()->cycles();
+				elapsed = sessions.front()->run_cycles(NES_TEST_SESSION_CYCLES_COUNT);
+
+				if((elapsed < NES_TEST_SESSION_CYCLES_COUNT) 
+						|| (elapsed != (sessions.front()->acquire_cpu()->cycles() 
+							- previous))
+						|| (sessions.front()->acquire_ppu()->frame() 
+							< (frame + NES_TEST_SESSION_CYCLES_FRAMES))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->reset();
+
+				if(sessions.front()->acquire_cpu()->cycles()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				frame = sessions.front()->acquire_ppu()->frame();
+
+				if(sessions.front()->step_frame() != (frame + 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_session::pacing(
+			__in void *context
+			)
+		{
+			double elapsed, rate;
+			nes_ptr session = NULL;
+			std::thread runner;
+			std::vector<nes_ptr> sessions;
+			std::atomic<bool> failed(false);
+			std::chrono::steady_clock::time_point begin;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			UNREF_PARAM(context);
+
+			try {
+
+				if(!session_create(sessions, 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				session = sessions.front();
+
+				try {
+					session->run(NES_TEST_SESSION_IMAGE_PATH, false, 
+						(nes_pacing_t) (NES_RUN_PACING_REALTIME + 1));
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				rate = session->run(NES_TEST_SESSION_IMAGE_PATH, false, NES_RUN_PACING_UNCAPPED, 
+					NES_TEST_SESSION_PACING_UNCAPPED_FRAMES);
+				if((rate <= 0.0) || session->is_running()
+						|| (session->acquire_ppu()->frame() < NES_TEST_SESSION_PACING_UNCAPPED_FRAMES)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				begin = std::chrono::steady_clock::now();
+				rate = session->run(NES_TEST_SESSION_IMAGE_PATH, false, NES_RUN_PACING_REALTIME, 
+					NES_TEST_SESSION_PACING_FRAMES);
+				elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() 
+					- begin).count();
+				if((rate <= 0.0) || (rate > NES_TEST_SESSION_PACING_RATE_MAX)
+						|| (elapsed < NES_TEST_SESSION_PACING_ELAPSED_MIN)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				runner = std::thread([&]() {
+
+						try {
+							session->run(NES_TEST_SESSION_IMAGE_PATH);
+						} catch(...) {
+							failed = true;
+						}
+					});
+
+				while(!session->is_running() && !failed) {
+					std::this_thread::yield();
+				}
+
+				session->stop();
+				runner.join();
+
+				if(failed || session->is_running()) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_session::post(
+			__in void *context
+			)
+		{
+			size_t iter = 0;
+			std::thread holder;
+			nes_ptr session = NULL;
+			std::vector<nes_ptr> sessions;
+			std::atomic<bool> posting(true);
+			std::atomic<size_t> count(0), held(0);
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			nes_command command = [&count](nes &) { ++count; };
+
+			UNREF_PARAM(context);
+
+			try {
+
+				if(!session_create(sessions, 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				session = sessions.front();
+				holder = std::thread([&]() {
+
+						while(posting) {
+							session->snapshot_length();
+							++held;
+						}
+					});
+
+				while(!held) {
+					std::this_thread::yield();
+				}
+
+				for(; iter < NES_TEST_SESSION_POST_COMMANDS; ++iter) {
+					session->post(command);
+				}
+
+				posting = false;
+				holder.join();
+
+				if(count != NES_TEST_SESSION_POST_COMMANDS) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+
+				if(holder.joinable()) {
+					posting = false;
+					holder.join();
+				}
+
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			session_destroy(sessions);
+
+			return result;
+		}
+
+		bool 
+		_nes_test_session::session_create(
+			__inout std::vector<nes_ptr> &sessions,
+			__in size_t count,
+			__in_opt bool load
+			)
+		{
+			size_t iter = 0;
+			std::ofstream file;
+			bool result = true;
+			nes_ptr session = NULL;
+			std::vector<uint8_t> block;
+
+			try {
+
+				if(load) {
+					nes_test_rom::mapper_image(block, NES_MAPPER_NROM, 
+						NES_TEST_SESSION_BANKS_PROGRAM, NES_TEST_SESSION_BANKS_CHARACTER);
+					file.open(NES_TEST_SESSION_IMAGE_PATH, std::ios::out | std::ios::binary 
+						| std::ios::trunc);
+					file.write((char *) &block[0], block.size());
+					file.close();
+				}
+
+				for(; iter < count; ++iter) {
+					session = nes::create();
+					sessions.push_back(session);
+					session->initialize();
+
+					if(load) {
+						session->load(NES_TEST_SESSION_IMAGE_PATH);
+					}
+				}
+			} catch(...) {
+				result = false;
+			}
+
+			return result;
+		}
+
+		void 
+		_nes_test_session::session_destroy(
+			__inout std::vector<nes_ptr> &sessions
+			)
+		{
+			size_t iter = 0;
+
+			for(; iter < sessions.size(); ++iter) {
+				delete sessions.at(iter);
+			}
+
+			sessions.clear();
+		}
+
+		nes_test_set 
+		_nes_test_session::set_generate(void)
+		{
+			size_t iter = 0;
+			nes_test_set result(NES_HEADER);
+
+			for(; iter <= NES_TEST_SESSION_MAX; ++iter) {
+				result.insert(nes_test(NES_TEST_SESSION_STRING(iter),
+					NES_TEST_SESSION_CALLBACK(iter)));
+			}
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_session::snapshot(
+			__in void *context
+			)
+		{
+			size_t iter = 0, length;
+			std::vector<nes_ptr> sessions;
+			nes_snapshot_header *header = NULL;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+			std::vector<uint8_t> expected, initial, restored;
+
+			try {
+
+				if(!session_create(sessions, NES_TEST_SESSION_SNAPSHOT_SESSIONS)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(; iter < NES_TEST_SESSION_SNAPSHOT_FRAMES; ++iter) {
+					sessions.front()->step_frame();
+				}
+
+				length = sessions.front()->snapshot_length();
+				if((length != sessions.back()->snapshot_length())
+						|| (length % NES_SNAPSHOT_ALIGNMENT)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				initial.resize(length);
+				expected.resize(length);
+				restored.resize(length);
+
+				if(sessions.front()->snapshot(&initial[0], length) != length) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < NES_TEST_SESSION_SNAPSHOT_FRAMES; ++iter) {
+					sessions.front()->step_frame();
+				}
+
+				sessions.front()->snapshot(&expected[0], length);
+				sessions.back()->restore(&initial[0], length);
+				sessions.back()->snapshot(&restored[0], length);
+
+				if(restored != initial) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(iter = 0; iter < NES_TEST_SESSION_SNAPSHOT_FRAMES; ++iter) {
+					sessions.back()->step_frame();
+				}
+
+				sessions.back()->snapshot(&restored[0], length);
+
+				if(restored != expected) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->restore(&initial[0], length);
+
+				for(iter = 0; iter < NES_TEST_SESSION_SNAPSHOT_FRAMES; ++iter) {
+					sessions.front()->step_frame();
+				}
+
+				sessions.front()->snapshot(&restored[0], length);
+
+				if(restored != expected) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				try {
+					sessions.front()->snapshot(&restored[0], length - 1);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				try {
+					sessions.front()->restore(&initial[0], length - 1);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				header = (nes_snapshot_header *) &initial[0];
+				++header->version;
+
+				try {
+					sessions.front()->restore(&initial[0], length);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				--header->version;
+				--header->sections;
+
+				try {
+					sessions.front()->restore(&initial[0], length);
+					result = NES_TEST_FAILURE;
+					goto exit;
+				} catch(...) { }
+
+				sessions.front()->snapshot(&restored[0], length);
+
+				if(restored != expected) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			session_destroy(sessions);
+
+			return result;
+		}
+
+		nes_test_t 
+		_nes_test_session::wrap(
+			__in void *context
+			)
+		{
+			size_t iter = 0;
+			nes_apu_snapshot apu;
+			nes_cpu_snapshot cpu;
+			nes_ppu_snapshot ppu;
+			uint64_t frame, previous;
+			std::vector<nes_ptr> sessions;
+			nes_test_t result = NES_TEST_INCONCLUSIVE;
+
+			try {
+
+				if(!session_create(sessions, 1)) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				sessions.front()->step_frame();
+				sessions.front()->acquire_apu()->snapshot(apu);
+				sessions.front()->acquire_cpu()->snapshot(cpu);
+				sessions.front()->acquire_ppu()->snapshot(ppu);
+				apu.cycles += NES_TEST_SESSION_WRAP_CYCLES;
+				apu.master += (NES_TEST_SESSION_WRAP_CYCLES * CPU_MASTER_DIVIDER);
+				cpu.apu_event += (NES_TEST_SESSION_WRAP_CYCLES * CPU_MASTER_DIVIDER);
+				cpu.cycles += NES_TEST_SESSION_WRAP_CYCLES;
+				cpu.ppu_event += (NES_TEST_SESSION_WRAP_CYCLES * CPU_MASTER_DIVIDER);
+				ppu.cycles += NES_TEST_SESSION_WRAP_CYCLES;
+				ppu.master += (NES_TEST_SESSION_WRAP_CYCLES * CPU_MASTER_DIVIDER);
+				sessions.front()->acquire_apu()->restore(apu);
+				sessions.front()->acquire_cpu()->restore(cpu);
+				sessions.front()->acquire_ppu()->restore(ppu);
+
+				if((sessions.front()->acquire_cpu()->cycles() < NES_TEST_SESSION_WRAP_CYCLES)
+						|| (sessions.front()->acquire_cpu()->master() 
+							< (NES_TEST_SESSION_WRAP_CYCLES * CPU_MASTER_DIVIDER))
+						|| (sessions.front()->acquire_ppu()->next_event() 
+							< (NES_TEST_SESSION_WRAP_CYCLES * CPU_MASTER_DIVIDER))) {
+					result = NES_TEST_FAILURE;
+					goto exit;
+				}
+
+				for(; iter < NES_TEST_SESSION_WRAP_FRAMES; ++iter) {
+					frame = sessions.front()->acquire_ppu()->frame();
+					previous = sessions.front()->acquire_cpu()->cycles();
+
+					if((sessions.front()->step_frame() != (frame + 1))
+							|| (sessions.front()->acquire_cpu()->cycles() <= previous)
+							|| (sessions.front()->acquire_ppu()->master() 
+								< (NES_TEST_SESSION_WRAP_CYCLES * CPU_MASTER_DIVIDER))) {
+						result = NES_TEST_FAILURE;
+						goto exit;
+					}
+				}
+			} catch(...) {
+				result = NES_TEST_FAILURE;
+				goto exit;
+			}
+
+			result = NES_TEST_SUCCESS;
+
+exit:
+			session_destroy(sessions);
+
+			return result;
+		}
+	}
+}
+
+#endif // NDEBUG
@@ -20,8 +20,10 @@
 #include "../lib/include/libnes.h"
 #include "../lib/include/nes.h"
 
+#define USAGE_ARG_FRAMES 3
 #define USAGE_ARG_MIN 3
-#define USAGE_ARG_STR " [INPUT] [DEBUG]"
+#define USAGE_ARG_PACING 4
+#define USAGE_ARG_STR " [INPUT] [DEBUG] [FRAMES] [PACING]"
 
 int 
 main(
@@ -34,7 +36,10 @@ main(
 	std::stringstream stream;
 	size_t failure, inconclusive, success;
 #else
+	double rate = 0.0;
+	uint64_t frames = 0;
 	nes_context context = { 0 };
+	unsigned pacing = NES_PACING_REALTIME;
 #endif // NDEBUG
 
 	try {
@@ -57,10 +62,22 @@ main(
 					<< VALUE_AS_HEX(neserr_t, result) << std::endl;
 			} else {
 
-				result = nes_run(&context, argv[1], std::atoi(argv[2]));
+				if(argc > USAGE_ARG_FRAMES) {
+					frames = std::strtoull(argv[USAGE_ARG_FRAMES], NULL, 0);
+				}
+
+				if(argc > USAGE_ARG_PACING) {
+					pacing = std::atoi(argv[USAGE_ARG_PACING]);
+				}
+
+				result = nes_run_frames(&context, argv[1], std::atoi(argv[2]), pacing, 
+					frames, &rate);
 				if(!NES_SUCCESS(result)) {
-					std::cerr << "nes_run failed, status 0x" 
+					std::cerr << "nes_run_frames failed, status 0x" 
 						<< VALUE_AS_HEX(neserr_t, result) << std::endl;
+				} else {
+					std::cout << std::fixed << std::setprecision(2) << rate 
+						<< " fps" << std::endl;
 				}
 
 				result = nes_uninitialize(&context);
@@ -0,0 +1,258 @@
+/**
+ * libnes
+ * Copyright (C) 2015 David Jolly
+ * ----------------------
+ *
+ * libnes is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libnes is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include "../lib/include/libnes.h"
+#include "../lib/include/nes.h"
+
+#define SCAN_COLUMNS "path,crc32,sha1,status,format,mapper,submapper,prg_rom,chr_rom,prg_ram,"\
+	"prg_nvram,chr_ram,chr_nvram,battery,trainer,mirroring,timing"
+#define SCAN_EXTENSION ".nes"
+#define SCAN_EXTENSION_LEN 4
+#define SCAN_THREADS_DEFAULT 4
+#define USAGE_ARG_MIN 3
+#define USAGE_ARG_STR " [DIRECTORY] [OUTPUT] [THREADS]"
+
+enum {
+	SCAN_STATUS_VALID = 0,
+	SCAN_STATUS_MALFORMED,
+	SCAN_STATUS_OPEN,
+	SCAN_STATUS_TRUNCATED,
+};
+
+#define SCAN_STATUS_MAX SCAN_STATUS_TRUNCATED
+
+static const std::string SCAN_STATUS_STR[] = {
+	"valid", "malformed", "open", "truncated",
+	};
+
+#define SCAN_STATUS_STRING(_TYPE_) \
+	((_TYPE_) > SCAN_STATUS_MAX ? UNKNOWN : \
+	CHECK_STR(SCAN_STATUS_STR[_TYPE_]))
+
+typedef struct {
+	nes_rom_descriptor descriptor;
+	nes_rom_hash hash;
+	size_t size;
+	uint8_t status;
+} scan_entry;
+
+static const std::string MIRRORING_STR[] = {
+	"horz", "vert", "four",
+	};
+
+static const std::string TIMING_STR[] = {
+	"ntsc", "pal", "dual", "dendy",
+	};
+
+void
+scan_file(
+	__in const std::string &path,
+	__out scan_entry &entry
+	)
+{
+	int file;
+	struct stat status;
+	void *mapping = MAP_FAILED;
+
+	entry.size = 0;
+	entry.status = SCAN_STATUS_OPEN;
+
+	file = open(path.c_str(), O_RDONLY);
+	if(file >= 0) {
+
+		if(!fstat(file, &status) && (status.st_size > 0)) {
+			entry.size = status.st_size;
+			mapping = mmap(NULL, entry.size, PROT_READ, MAP_PRIVATE, file, 0);
+		}
+
+		close(file);
+	}
+
+	if(mapping != MAP_FAILED) {
+		madvise(mapping, entry.size, MADV_SEQUENTIAL);
+
+		if(nes_rom::scan((const uint8_t *) mapping, entry.size, entry.descriptor, entry.hash)) {
+			entry.status = SCAN_STATUS_VALID;
+		} else {
+			entry.status = (entry.descriptor.character_offset ? SCAN_STATUS_TRUNCATED
+				: SCAN_STATUS_MALFORMED);
+		}
+
+		munmap(mapping, entry.size);
+	} else {
+		std::memset(&entry.descriptor, 0, sizeof(nes_rom_descriptor));
+		std::memset(&entry.hash, 0, sizeof(nes_rom_hash));
+	}
+}
+
+void
+scan_worker(
+	__in const std::vector<std::string> *paths,
+	__inout std::vector<scan_entry> *entries,
+	__inout std::atomic<size_t> *next
+	)
+{
+	size_t index;
+
+	for(;;) {
+
+		index = next->fetch_add(1, std::memory_order_relaxed);
+		if(index >= paths->size()) {
+			break;
+		}
+
+		scan_file(paths->at(index), entries->at(index));
+	}
+}
+
+bool
+scan_directory(
+	__in const std::string &directory,
+	__out std::vector<std::string> &paths
+	)
+{
+	size_t length;
+	DIR *handle = NULL;
+	bool result = false;
+	struct dirent *entry = NULL;
+
+	handle = opendir(directory.c_str());
+	if(handle) {
+
+		for(entry = readdir(handle); entry; entry = readdir(handle)) {
+
+			length = std::strlen(entry->d_name);
+			if((length > SCAN_EXTENSION_LEN) && !strcasecmp(entry->d_name
+					+ (length - SCAN_EXTENSION_LEN), SCAN_EXTENSION)) {
+				paths.push_back(directory + "/" + entry->d_name);
+			}
+		}
+
+		closedir(handle);
+		std::sort(paths.begin(), paths.end());
+		result = true;
+	}
+
+	return result;
+}
+
+void
+scan_write(
+	__in FILE *output,
+	__in const std::string &path,
+	__in const scan_entry &entry
+	)
+{
+	size_t iter = 0;
+	const nes_rom_descriptor &descriptor = entry.descriptor;
+
+	std::fprintf(output, "%s,%08x,", path.c_str(), entry.hash.crc32);
+
+	for(; iter < HASH_SHA1_LEN; ++iter) {
+		std::fprintf(output, "%02x", entry.hash.sha1[iter]);
+	}
+
+	std::fprintf(output, ",%s,%u,%u,%u,%lu,%lu,%lu,%lu,%lu,%lu,%u,%u,%s,%s\n",
+		SCAN_STATUS_STRING(entry.status), descriptor.format, descriptor.mapper,
+		descriptor.mapper_sub, descriptor.program_length, descriptor.character_length,
+		descriptor.program_ram_length, descriptor.program_nvram_length,
+		descriptor.character_ram_length, descriptor.character_nvram_length,
+		descriptor.battery, descriptor.trainer,
+		(descriptor.mirroring > ROM_MIRRORING_MAX) ? UNKNOWN
+			: CHECK_STR(MIRRORING_STR[descriptor.mirroring]),
+		(descriptor.timing > ROM_TIMING_MAX) ? UNKNOWN
+			: CHECK_STR(TIMING_STR[descriptor.timing]));
+}
+
+int
+main(
+	__in int argc,
+	__in const char **argv
+	)
+{
+	size_t iter = 0, threads;
+	FILE *output = NULL;
+	std::atomic<size_t> next(0);
+	std::vector<scan_entry> entries;
+	std::vector<std::string> paths;
+	std::vector<std::thread> workers;
+	neserr_t result = NES_ERR_NONE;
+
+	try {
+
+		if(argc < USAGE_ARG_MIN) {
+			std::cerr << "USAGE: " << argv[0] << USAGE_ARG_STR << std::endl;
+			result = NES_ERR_INVALID_ARGUMENT;
+		} else if(!scan_directory(argv[1], paths)) {
+			std::cerr << "Failed to open directory: " << argv[1] << std::endl;
+			result = NES_ERR_INVALID_ARGUMENT;
+		} else {
+
+			threads = ((argc > USAGE_ARG_MIN) ? std::atoi(argv[USAGE_ARG_MIN])
+				: std::thread::hardware_concurrency());
+			if(!threads) {
+				threads = SCAN_THREADS_DEFAULT;
+			}
+
+			threads = std::max(std::min(threads, paths.size()), (size_t) 1);
+			entries.resize(paths.size());
+
+			for(; iter < threads; ++iter) {
+				workers.push_back(std::thread(scan_worker, &paths, &entries, &next));
+			}
+
+			for(iter = 0; iter < workers.size(); ++iter) {
+				workers.at(iter).join();
+			}
+
+			output = std::fopen(argv[2], "w");
+			if(!output) {
+				std::cerr << "Failed to open output: " << argv[2] << std::endl;
+				result = NES_ERR_INVALID_ARGUMENT;
+			} else {
+				std::fprintf(output, "%s\n", SCAN_COLUMNS);
+
+				for(iter = 0; iter < entries.size(); ++iter) {
+					scan_write(output, paths.at(iter), entries.at(iter));
+				}
+
+				std::fclose(output);
+			}
+		}
+	} catch(nes_exception &exc) {
+		std::cerr << exc.to_string(true) << std::endl;
+		result = NES_ERR_FAILURE;
+	} catch(std::exception &exc) {
+		std::cerr << exc.what() << std::endl;
+		result = NES_ERR_FAILURE;
+	}
+
+	return result;
+}